@@ -460,6 +460,7 @@
 #define BSP_USING_CANFD
 #define BSP_USING_CANFD0
 #define BSP_USING_CANFD1
+#define BSP_USING_HYPERRAM
 #define BSP_USING_I2C
 #define BSP_USING_HW_I2C
 #define BSP_USING_HW_I2C0
@@ -261,6 +261,9 @@ typedef enum e_canfd_minimum_dlc
     CANFD_MINIMUM_DLC_64,
 } canfd_minimum_dlc_t;
 
+/** Position of the 16-bit RX timestamp in can_frame_t::options (received frames only) */
+#define CANFD_FRAME_OPTION_TIMESTAMP_Pos    (16U)
+
 /** CANFD Frame Options */
 typedef enum e_canfd_frame_option
 {
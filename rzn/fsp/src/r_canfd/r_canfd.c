@@ -876,13 +876,15 @@ static void r_canfd_mb_read (R_CANFD_Type * p_reg, uint32_t buffer, can_frame_t
     }
 
     /* Get frame data. */
-    uint32_t id = mb_regs->ID;
+    uint32_t id  = mb_regs->ID;
+    uint32_t ptr = mb_regs->PTR;
 
     /* Get the frame type */
     frame->type = (can_frame_type_t) ((id & CANFD_PRV_RMRTR_MASK) >> CANFD_PRV_RMRTR_POSITION);
 
-    /* Get FD status bits (ESI, BRS and FDF) */
-    frame->options = mb_regs->FDSTS & 7U;
+    /* Get FD status bits (ESI, BRS and FDF) and the 16-bit RX timestamp */
+    frame->options = (mb_regs->FDSTS & 7U) |
+                     ((ptr & R_CANFD_CFDRM_PTR_RMTS_Msk) << CANFD_FRAME_OPTION_TIMESTAMP_Pos);
 
     /* Get the frame ID */
     frame->id = id & CANFD_PRV_RMID_MASK;
@@ -891,7 +893,7 @@ static void r_canfd_mb_read (R_CANFD_Type * p_reg, uint32_t buffer, can_frame_t
     frame->id_mode = (can_id_mode_t) (id >> CANFD_PRV_RMIDE_POSITION);
 
     /* Get the frame data length code */
-    frame->data_length_code = dlc_to_bytes[mb_regs->PTR >> CANFD_PRV_RMDLC_POSITION];
+    frame->data_length_code = dlc_to_bytes[ptr >> CANFD_PRV_RMDLC_POSITION];
 
     /* Copy data to frame */
     uint32_t           len    = frame->data_length_code;
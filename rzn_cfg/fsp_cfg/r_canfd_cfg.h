@@ -1,7 +1,7 @@
 /* generated configuration header file - do not edit */
 #ifndef R_CANFD_CFG_H_
 #define R_CANFD_CFG_H_
-/* Buffer RAM used: 2432 bytes */
+/* Buffer RAM used: 4864 bytes */
 
             #define CANFD_CFG_PARAM_CHECKING_ENABLE   ((BSP_CFG_PARAM_CHECKING_ENABLE))
 
@@ -27,6 +27,7 @@
             #define CANFD_CFD_CLOCK_SOURCE          (R_CANFD_CFDGCFG_DCS_Msk)
             #define CANFD_CFG_FD_OVERFLOW           ((0))
             #define CANFD_CFG_TIMER_PRESCALER       (0)
+            #define CANFD_CFG_TIMESTAMP_PRESCALER   (6)
             #define CANFD_CFG_RXMB_NUMBER           (0)
             #define CANFD_CFG_RXMB_SIZE             ((0))
             #define CANFD_CFG_GLOBAL_ERR_IPL        ((12))
@@ -41,20 +42,20 @@
             #define CANFD_CFG_RXFIFO1_INT_THRESHOLD ((3U))
             #define CANFD_CFG_RXFIFO1_DEPTH         ((3))
             #define CANFD_CFG_RXFIFO1_PAYLOAD       ((7))
-            #define CANFD_CFG_RXFIFO1_INT_MODE      ((R_CANFD_CFDRFCC_RFIE_Msk | R_CANFD_CFDRFCC_RFIM_Msk))
+            #define CANFD_CFG_RXFIFO1_INT_MODE      ((R_CANFD_CFDRFCC_RFIE_Msk))
             #define CANFD_CFG_RXFIFO1_ENABLE        ((1))
 
             #define CANFD_CFG_RXFIFO2_INT_THRESHOLD ((3U))
             #define CANFD_CFG_RXFIFO2_DEPTH         ((3))
             #define CANFD_CFG_RXFIFO2_PAYLOAD       ((7))
             #define CANFD_CFG_RXFIFO2_INT_MODE      ((R_CANFD_CFDRFCC_RFIE_Msk | R_CANFD_CFDRFCC_RFIM_Msk))
-            #define CANFD_CFG_RXFIFO2_ENABLE        ((0))
+            #define CANFD_CFG_RXFIFO2_ENABLE        ((1))
 
             #define CANFD_CFG_RXFIFO3_INT_THRESHOLD ((3U))
             #define CANFD_CFG_RXFIFO3_DEPTH         ((3))
             #define CANFD_CFG_RXFIFO3_PAYLOAD       ((7))
-            #define CANFD_CFG_RXFIFO3_INT_MODE      ((R_CANFD_CFDRFCC_RFIE_Msk | R_CANFD_CFDRFCC_RFIM_Msk))
-            #define CANFD_CFG_RXFIFO3_ENABLE        ((0))
+            #define CANFD_CFG_RXFIFO3_INT_MODE      ((R_CANFD_CFDRFCC_RFIE_Msk))
+            #define CANFD_CFG_RXFIFO3_ENABLE        ((1))
 
             #define CANFD_CFG_RXFIFO4_INT_THRESHOLD ((3U))
             #define CANFD_CFG_RXFIFO4_DEPTH         ((3))
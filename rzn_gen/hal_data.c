@@ -826,7 +826,7 @@ extern const canfd_afl_entry_t p_canfd1_afl[CANFD_CFG_AFL_CH1_RULE_NUM];
 canfd_global_cfg_t g_canfd_global_cfg =
 {
     .global_interrupts = CANFD_CFG_GLOBAL_ERR_SOURCES,
-    .global_config     = (CANFD_CFG_TX_PRIORITY | CANFD_CFG_DLC_CHECK | CANFD_CFD_CLOCK_SOURCE | CANFD_CFG_FD_OVERFLOW | (uint32_t) (CANFD_CFG_TIMER_PRESCALER << R_CANFD_CFDGCFG_ITRCP_Pos)),
+    .global_config     = (CANFD_CFG_TX_PRIORITY | CANFD_CFG_DLC_CHECK | CANFD_CFD_CLOCK_SOURCE | CANFD_CFG_FD_OVERFLOW | (uint32_t) (CANFD_CFG_TIMER_PRESCALER << R_CANFD_CFDGCFG_ITRCP_Pos) | (uint32_t) (CANFD_CFG_TIMESTAMP_PRESCALER << R_CANFD_CFDGCFG_TSP_Pos)),
     .rx_mb_config      = (CANFD_CFG_RXMB_NUMBER | (CANFD_CFG_RXMB_SIZE << R_CANFD_CFDRMNB_RMPLS_Pos)),
     .global_err_ipl = CANFD_CFG_GLOBAL_ERR_IPL,
     .rx_fifo_ipl    = CANFD_CFG_RX_FIFO_IPL,
@@ -856,8 +856,8 @@ canfd_global_cfg_t g_canfd_global_cfg =
 canfd_extended_cfg_t g_canfd1_extended_cfg =
 {
     .p_afl              = p_canfd1_afl,
-    .txmb_txi_enable    = ((1ULL << 0) | (1ULL << 1) |  0ULL),
-    .error_interrupts   = ( 0U),
+    .txmb_txi_enable    = ((1ULL << 0) | (1ULL << 1) | (1ULL << 2) | (1ULL << 3) | (1ULL << 4) | (1ULL << 5) | (1ULL << 6) | (1ULL << 7) |  0ULL),
+    .error_interrupts   = (R_CANFD_CFDC_CTR_BEIE_Msk | R_CANFD_CFDC_CTR_EWIE_Msk | R_CANFD_CFDC_CTR_EPIE_Msk | R_CANFD_CFDC_CTR_BOEIE_Msk | R_CANFD_CFDC_CTR_BORIE_Msk | R_CANFD_CFDC_CTR_OLIE_Msk |  0U),
     .p_data_timing      = &g_canfd1_data_timing_cfg,
     .delay_compensation = (1),
     .p_global_cfg       = &g_canfd_global_cfg,
@@ -1059,7 +1059,7 @@ extern const canfd_afl_entry_t p_canfd0_afl[CANFD_CFG_AFL_CH0_RULE_NUM];
 canfd_global_cfg_t g_canfd_global_cfg =
 {
     .global_interrupts = CANFD_CFG_GLOBAL_ERR_SOURCES,
-    .global_config     = (CANFD_CFG_TX_PRIORITY | CANFD_CFG_DLC_CHECK | CANFD_CFD_CLOCK_SOURCE | CANFD_CFG_FD_OVERFLOW | (uint32_t) (CANFD_CFG_TIMER_PRESCALER << R_CANFD_CFDGCFG_ITRCP_Pos)),
+    .global_config     = (CANFD_CFG_TX_PRIORITY | CANFD_CFG_DLC_CHECK | CANFD_CFD_CLOCK_SOURCE | CANFD_CFG_FD_OVERFLOW | (uint32_t) (CANFD_CFG_TIMER_PRESCALER << R_CANFD_CFDGCFG_ITRCP_Pos) | (uint32_t) (CANFD_CFG_TIMESTAMP_PRESCALER << R_CANFD_CFDGCFG_TSP_Pos)),
     .rx_mb_config      = (CANFD_CFG_RXMB_NUMBER | (CANFD_CFG_RXMB_SIZE << R_CANFD_CFDRMNB_RMPLS_Pos)),
     .global_err_ipl = CANFD_CFG_GLOBAL_ERR_IPL,
     .rx_fifo_ipl    = CANFD_CFG_RX_FIFO_IPL,
@@ -1089,8 +1089,8 @@ canfd_global_cfg_t g_canfd_global_cfg =
 canfd_extended_cfg_t g_canfd0_extended_cfg =
 {
     .p_afl              = p_canfd0_afl,
-    .txmb_txi_enable    = ((1ULL << 0) |  0ULL),
-    .error_interrupts   = ( 0U),
+    .txmb_txi_enable    = ((1ULL << 0) | (1ULL << 1) | (1ULL << 2) | (1ULL << 3) | (1ULL << 4) | (1ULL << 5) | (1ULL << 6) | (1ULL << 7) |  0ULL),
+    .error_interrupts   = (R_CANFD_CFDC_CTR_BEIE_Msk | R_CANFD_CFDC_CTR_EWIE_Msk | R_CANFD_CFDC_CTR_EPIE_Msk | R_CANFD_CFDC_CTR_BOEIE_Msk | R_CANFD_CFDC_CTR_BORIE_Msk | R_CANFD_CFDC_CTR_OLIE_Msk |  0U),
     .p_data_timing      = &g_canfd0_data_timing_cfg,
     .delay_compensation = (1),
     .p_global_cfg       = &g_canfd_global_cfg,
@@ -1206,10 +1206,10 @@ adc_instance_ctrl_t g_adc1_ctrl;
 const adc_extended_cfg_t g_adc1_cfg_extend =
 {
     .add_average_count   = ADC_ADD_OFF,
-    .clearing            = ADC_CLEAR_AFTER_READ_ON,
+    .clearing            = ADC_CLEAR_AFTER_READ_OFF,
     .trigger_group_b     = ADC_TRIGGER_SYNC_ELC,
     .double_trigger_mode = ADC_DOUBLE_TRIGGER_DISABLED,
-    .adc_start_trigger_a  = ADC_ACTIVE_TRIGGER_DISABLED,
+    .adc_start_trigger_a  = ADC_ACTIVE_TRIGGER_ELC_TRIGGER,
     .adc_start_trigger_b  = ADC_ACTIVE_TRIGGER_DISABLED,
     .adc_start_trigger_c_enabled = 0,
     .adc_start_trigger_c  = ADC_ACTIVE_TRIGGER_DISABLED,
@@ -1221,13 +1221,13 @@ const adc_extended_cfg_t g_adc1_cfg_extend =
 #else
     .window_a_irq        = FSP_INVALID_VECTOR,
 #endif
-    .window_a_ipl        = (BSP_IRQ_DISABLED),
+    .window_a_ipl        = (10),
 #if defined(VECTOR_NUMBER_ADC1_CMPBI)
     .window_b_irq      = VECTOR_NUMBER_ADC1_CMPBI,
 #else
     .window_b_irq      = FSP_INVALID_VECTOR,
 #endif
-    .window_b_ipl      = (BSP_IRQ_DISABLED),
+    .window_b_ipl      = (10),
 #endif
 #if (3U == BSP_FEATURE_ADC_REGISTER_MASK_TYPE)
 #if defined(VECTOR_NUMBER_ADC121_CMPAI)
@@ -1235,13 +1235,13 @@ const adc_extended_cfg_t g_adc1_cfg_extend =
 #else
     .window_a_irq        = FSP_INVALID_VECTOR,
 #endif
-    .window_a_ipl        = (BSP_IRQ_DISABLED),
+    .window_a_ipl        = (10),
 #if defined(VECTOR_NUMBER_ADC121_CMPBI)
     .window_b_irq      = VECTOR_NUMBER_ADC121_CMPBI,
 #else
     .window_b_irq      = FSP_INVALID_VECTOR,
 #endif
-    .window_b_ipl      = (BSP_IRQ_DISABLED),
+    .window_b_ipl      = (10),
 #endif
 };
 const adc_cfg_t g_adc1_cfg =
@@ -1250,8 +1250,8 @@ const adc_cfg_t g_adc1_cfg =
     .mode                = ADC_MODE_SINGLE_SCAN,
     .resolution          = ADC_RESOLUTION_12_BIT,
     .alignment           = (adc_alignment_t)ADC_ALIGNMENT_RIGHT,
-    .trigger             = ADC_TRIGGER_SOFTWARE,
-    .p_callback          = NULL,
+    .trigger             = ADC_TRIGGER_ADC1_A,
+    .p_callback          = adc_acq_callback,
     .p_context           = NULL,
     .p_extend            = &g_adc1_cfg_extend,
 #if (1U == BSP_FEATURE_ADC_REGISTER_MASK_TYPE)
@@ -1260,7 +1260,7 @@ const adc_cfg_t g_adc1_cfg =
 #else
     .scan_end_irq        = FSP_INVALID_VECTOR,
 #endif
-    .scan_end_ipl        = (BSP_IRQ_DISABLED),
+    .scan_end_ipl        = (12),
 #if defined(VECTOR_NUMBER_ADC1_GBADI)
     .scan_end_b_irq      = VECTOR_NUMBER_ADC1_GBADI,
 #else
@@ -1280,7 +1280,7 @@ const adc_cfg_t g_adc1_cfg =
 #else
     .scan_end_irq        = FSP_INVALID_VECTOR,
 #endif
-    .scan_end_ipl        = (BSP_IRQ_DISABLED),
+    .scan_end_ipl        = (12),
 #if defined(VECTOR_NUMBER_ADC121_GBADI)
     .scan_end_b_irq      = VECTOR_NUMBER_ADC121_GBADI,
 #else
@@ -1337,10 +1337,10 @@ adc_instance_ctrl_t g_adc0_ctrl;
 const adc_extended_cfg_t g_adc0_cfg_extend =
 {
     .add_average_count   = ADC_ADD_OFF,
-    .clearing            = ADC_CLEAR_AFTER_READ_ON,
+    .clearing            = ADC_CLEAR_AFTER_READ_OFF,
     .trigger_group_b     = ADC_TRIGGER_SYNC_ELC,
     .double_trigger_mode = ADC_DOUBLE_TRIGGER_DISABLED,
-    .adc_start_trigger_a  = ADC_ACTIVE_TRIGGER_DISABLED,
+    .adc_start_trigger_a  = ADC_ACTIVE_TRIGGER_ELC_TRIGGER,
     .adc_start_trigger_b  = ADC_ACTIVE_TRIGGER_DISABLED,
     .adc_start_trigger_c_enabled = 0,
     .adc_start_trigger_c  = ADC_ACTIVE_TRIGGER_DISABLED,
@@ -1352,13 +1352,13 @@ const adc_extended_cfg_t g_adc0_cfg_extend =
 #else
     .window_a_irq        = FSP_INVALID_VECTOR,
 #endif
-    .window_a_ipl        = (BSP_IRQ_DISABLED),
+    .window_a_ipl        = (10),
 #if defined(VECTOR_NUMBER_ADC0_CMPBI)
     .window_b_irq      = VECTOR_NUMBER_ADC0_CMPBI,
 #else
     .window_b_irq      = FSP_INVALID_VECTOR,
 #endif
-    .window_b_ipl      = (BSP_IRQ_DISABLED),
+    .window_b_ipl      = (10),
 #endif
 #if (3U == BSP_FEATURE_ADC_REGISTER_MASK_TYPE)
 #if defined(VECTOR_NUMBER_ADC120_CMPAI)
@@ -1366,23 +1366,23 @@ const adc_extended_cfg_t g_adc0_cfg_extend =
 #else
     .window_a_irq        = FSP_INVALID_VECTOR,
 #endif
-    .window_a_ipl        = (BSP_IRQ_DISABLED),
+    .window_a_ipl        = (10),
 #if defined(VECTOR_NUMBER_ADC120_CMPBI)
     .window_b_irq      = VECTOR_NUMBER_ADC120_CMPBI,
 #else
     .window_b_irq      = FSP_INVALID_VECTOR,
 #endif
-    .window_b_ipl      = (BSP_IRQ_DISABLED),
+    .window_b_ipl      = (10),
 #endif
 };
 const adc_cfg_t g_adc0_cfg =
 {
     .unit                = 0,
-    .mode                = ADC_MODE_CONTINUOUS_SCAN,
+    .mode                = ADC_MODE_SINGLE_SCAN,
     .resolution          = ADC_RESOLUTION_12_BIT,
     .alignment           = (adc_alignment_t)ADC_ALIGNMENT_RIGHT,
-    .trigger             = ADC_TRIGGER_SOFTWARE,
-    .p_callback          = NULL,
+    .trigger             = ADC_TRIGGER_ADC0_A,
+    .p_callback          = adc_acq_callback,
     .p_context           = NULL,
     .p_extend            = &g_adc0_cfg_extend,
 #if (1U == BSP_FEATURE_ADC_REGISTER_MASK_TYPE)
@@ -1391,7 +1391,7 @@ const adc_cfg_t g_adc0_cfg =
 #else
     .scan_end_irq        = FSP_INVALID_VECTOR,
 #endif
-    .scan_end_ipl        = (BSP_IRQ_DISABLED),
+    .scan_end_ipl        = (12),
 #if defined(VECTOR_NUMBER_ADC0_GBADI)
     .scan_end_b_irq      = VECTOR_NUMBER_ADC0_GBADI,
 #else
@@ -1411,7 +1411,7 @@ const adc_cfg_t g_adc0_cfg =
 #else
     .scan_end_irq        = FSP_INVALID_VECTOR,
 #endif
-    .scan_end_ipl        = (BSP_IRQ_DISABLED),
+    .scan_end_ipl        = (12),
 #if defined(VECTOR_NUMBER_ADC120_GBADI)
     .scan_end_b_irq      = VECTOR_NUMBER_ADC120_GBADI,
 #else
@@ -355,8 +355,8 @@ extern adc_instance_ctrl_t g_adc1_ctrl;
 extern const adc_cfg_t g_adc1_cfg;
 extern const adc_channel_cfg_t g_adc1_channel_cfg;
 
-#ifndef NULL
-void NULL(adc_callback_args_t * p_args);
+#ifndef adc_acq_callback
+void adc_acq_callback(adc_callback_args_t * p_args);
 #endif
 /** ADC on ADC Instance. */
 extern const adc_instance_t g_adc0;
@@ -366,8 +366,8 @@ extern adc_instance_ctrl_t g_adc0_ctrl;
 extern const adc_cfg_t g_adc0_cfg;
 extern const adc_channel_cfg_t g_adc0_channel_cfg;
 
-#ifndef NULL
-void NULL(adc_callback_args_t * p_args);
+#ifndef adc_acq_callback
+void adc_acq_callback(adc_callback_args_t * p_args);
 #endif
 extern const hyperbus_instance_t g_hyperbus0;
             extern xspi_hyper_instance_ctrl_t g_hyperbus0_ctrl;
@@ -38,6 +38,12 @@
             [321] = canfd_channel_tx_isr, /* CAN1_TX (CANFD1 Channel TX interrupt) */
             [322] = canfd_error_isr, /* CAN1_CHERR (CANFD1 Channel CAN error interrupt) */
             [323] = canfd_common_fifo_rx_isr, /* CAN1_COMFRX (CANFD1 Common RX FIFO or TXQ interrupt) */
+            [345] = adc_scan_end_isr, /* ADC0_ADI (ADC0 A/D scan end interrupt) */
+            [348] = adc_window_compare_isr, /* ADC0_CMPAI (ADC0 Window A compare match) */
+            [349] = adc_window_compare_isr, /* ADC0_CMPBI (ADC0 Window B compare match) */
+            [350] = adc_scan_end_isr, /* ADC1_ADI (ADC1 A/D scan end interrupt) */
+            [353] = adc_window_compare_isr, /* ADC1_CMPAI (ADC1 Window A compare match) */
+            [354] = adc_window_compare_isr, /* ADC1_CMPBI (ADC1 Window B compare match) */
             [432] = rtc_alarm_periodic_isr, /* RTC_ALM (Alarm interrupt) */
             [434] = rtc_alarm_periodic_isr, /* RTC_PRD (Fixed interval interrupt) */
             [435] = sci_uart_eri_isr, /* SCI5_ERI (SCI5 Receive error) */
@@ -82,6 +88,12 @@
             [321] = BSP_PRV_CR52_SEL_ENUM(EVENT_CAN1_TX), /* CAN1_TX (CANFD1 Channel TX interrupt) */
             [322] = BSP_PRV_CR52_SEL_ENUM(EVENT_CAN1_CHERR), /* CAN1_CHERR (CANFD1 Channel CAN error interrupt) */
             [323] = BSP_PRV_CR52_SEL_ENUM(EVENT_CAN1_COMFRX), /* CAN1_COMFRX (CANFD1 Common RX FIFO or TXQ interrupt) */
+            [345] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC0_ADI), /* ADC0_ADI (ADC0 A/D scan end interrupt) */
+            [348] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC0_CMPAI), /* ADC0_CMPAI (ADC0 Window A compare match) */
+            [349] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC0_CMPBI), /* ADC0_CMPBI (ADC0 Window B compare match) */
+            [350] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC1_ADI), /* ADC1_ADI (ADC1 A/D scan end interrupt) */
+            [353] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC1_CMPAI), /* ADC1_CMPAI (ADC1 Window A compare match) */
+            [354] = BSP_PRV_CR52_SEL_ENUM(EVENT_ADC1_CMPBI), /* ADC1_CMPBI (ADC1 Window B compare match) */
             [432] = BSP_PRV_CR52_SEL_ENUM(EVENT_RTC_ALM), /* RTC_ALM (Alarm interrupt) */
             [434] = BSP_PRV_CR52_SEL_ENUM(EVENT_RTC_PRD), /* RTC_PRD (Fixed interval interrupt) */
             [435] = BSP_PRV_CR52_SEL_ENUM(EVENT_SCI5_ERI), /* SCI5_ERI (SCI5 Receive error) */
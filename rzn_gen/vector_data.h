@@ -8,7 +8,7 @@
 
                 /* Number of interrupts allocated */
         #ifndef VECTOR_DATA_IRQ_COUNT
-        #define VECTOR_DATA_IRQ_COUNT    (40)
+        #define VECTOR_DATA_IRQ_COUNT    (46)
         #endif
         /* ISR prototypes */
         void r_icu_isr(void);
@@ -30,6 +30,8 @@
         void canfd_error_isr(void);
         void canfd_channel_tx_isr(void);
         void canfd_common_fifo_rx_isr(void);
+        void adc_scan_end_isr(void);
+        void adc_window_compare_isr(void);
         void rtc_alarm_periodic_isr(void);
 
         /* Vector table allocations */
@@ -67,6 +69,12 @@
         #define VECTOR_NUMBER_CAN1_TX ((IRQn_Type) 321) /* CAN1_TX (CANFD1 Channel TX interrupt) */
         #define VECTOR_NUMBER_CAN1_CHERR ((IRQn_Type) 322) /* CAN1_CHERR (CANFD1 Channel CAN error interrupt) */
         #define VECTOR_NUMBER_CAN1_COMFRX ((IRQn_Type) 323) /* CAN1_COMFRX (CANFD1 Common RX FIFO or TXQ interrupt) */
+        #define VECTOR_NUMBER_ADC0_ADI ((IRQn_Type) 345) /* ADC0_ADI (ADC0 A/D scan end interrupt) */
+        #define VECTOR_NUMBER_ADC0_CMPAI ((IRQn_Type) 348) /* ADC0_CMPAI (ADC0 Window A compare match) */
+        #define VECTOR_NUMBER_ADC0_CMPBI ((IRQn_Type) 349) /* ADC0_CMPBI (ADC0 Window B compare match) */
+        #define VECTOR_NUMBER_ADC1_ADI ((IRQn_Type) 350) /* ADC1_ADI (ADC1 A/D scan end interrupt) */
+        #define VECTOR_NUMBER_ADC1_CMPAI ((IRQn_Type) 353) /* ADC1_CMPAI (ADC1 Window A compare match) */
+        #define VECTOR_NUMBER_ADC1_CMPBI ((IRQn_Type) 354) /* ADC1_CMPBI (ADC1 Window B compare match) */
         #define VECTOR_NUMBER_RTC_ALM ((IRQn_Type) 432) /* RTC_ALM (Alarm interrupt) */
         #define VECTOR_NUMBER_RTC_PRD ((IRQn_Type) 434) /* RTC_PRD (Fixed interval interrupt) */
         #define VECTOR_NUMBER_SCI5_ERI ((IRQn_Type) 435) /* SCI5_ERI (SCI5 Receive error) */
@@ -131,6 +139,12 @@
             CAN1_TX_IRQn = 321, /* CAN1_TX (CANFD1 Channel TX interrupt) */
             CAN1_CHERR_IRQn = 322, /* CAN1_CHERR (CANFD1 Channel CAN error interrupt) */
             CAN1_COMFRX_IRQn = 323, /* CAN1_COMFRX (CANFD1 Common RX FIFO or TXQ interrupt) */
+            ADC0_ADI_IRQn = 345, /* ADC0_ADI (ADC0 A/D scan end interrupt) */
+            ADC0_CMPAI_IRQn = 348, /* ADC0_CMPAI (ADC0 Window A compare match) */
+            ADC0_CMPBI_IRQn = 349, /* ADC0_CMPBI (ADC0 Window B compare match) */
+            ADC1_ADI_IRQn = 350, /* ADC1_ADI (ADC1 A/D scan end interrupt) */
+            ADC1_CMPAI_IRQn = 353, /* ADC1_CMPAI (ADC1 Window A compare match) */
+            ADC1_CMPBI_IRQn = 354, /* ADC1_CMPBI (ADC1 Window B compare match) */
             RTC_ALM_IRQn = 432, /* RTC_ALM (Alarm interrupt) */
             RTC_PRD_IRQn = 434, /* RTC_PRD (Fixed interval interrupt) */
             SCI5_ERI_IRQn = 435, /* SCI5_ERI (SCI5 Receive error) */
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+把网关 CAN 抓包 (msh: can_capture dump) 转换为 candump 日志，可直接回放到 vcan。
+
+输入为包含 CCAP-BEGIN / CCAP / CCAP-END 行的串口日志，记录格式见 src/can_capture.h。
+时间戳为设备启动后的秒数，--epoch 可加上绝对时间偏移。
+
+用法:
+    can_capture.py serial.log > capture.log                  # 转换为 candump -l 格式
+    can_capture.py serial.log --replay vcan0 [--speed 2.0]   # 转换后按原始时序回放 (见 can_replay.py)
+"""
+import argparse
+import os
+import sys
+import zlib
+
+SYNC = 0xFF
+FLAG_EXT = 0x01
+FLAG_RTR = 0x02
+FLAG_FD = 0x04
+FLAG_BRS = 0x08
+FLAG_ESI = 0x10
+FLAG_CH1 = 0x20
+VERSION = 1
+
+
+def extract(lines):
+    """从串口日志中提取抓包字节流，返回 (base_us, data, frames)"""
+    data = None
+    base_us = frames = 0
+    for line in lines:
+        line = line.strip()
+        pos = line.find('CCAP')
+        if pos < 0:
+            continue
+        line = line[pos:]
+        if line.startswith('CCAP-BEGIN'):
+            fields = dict(f.split('=') for f in line.split()[2:])
+            if line.split()[1] != 'v%d' % VERSION:
+                raise SystemExit('unsupported capture version %s' % line.split()[1])
+            sec, _, usec = fields['base'].partition('.')
+            base_us = int(sec) * 1000000 + int(usec)
+            frames = int(fields['frames'])
+            data = bytearray()
+        elif line.startswith('CCAP-END'):
+            if data is None:
+                raise SystemExit('CCAP-END without CCAP-BEGIN')
+            crc = int(line.split('=')[1], 16)
+            if zlib.crc32(bytes(data)) != crc:
+                raise SystemExit('capture CRC mismatch (serial log corrupted?)')
+            return base_us, bytes(data), frames
+        elif data is not None and line.startswith('CCAP '):
+            data += bytes.fromhex(line[5:])
+    raise SystemExit('no complete capture found in input')
+
+
+def zigzag_decode(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def parse(base_us, data):
+    """逐条解析记录，生成 (time_us, channel, can_id, flags, payload)"""
+    t = base_us
+    pos = 0
+    while pos < len(data):
+        flags = data[pos]
+        pos += 1
+        if flags == SYNC:
+            t = int.from_bytes(data[pos:pos + 8], 'little')
+            pos += 8
+            continue
+        dsz = (flags >> 6) + 1
+        t += zigzag_decode(int.from_bytes(data[pos:pos + dsz], 'little'))
+        pos += dsz
+        length = data[pos]
+        pos += 1
+        idsz = 4 if flags & FLAG_EXT else 2
+        can_id = int.from_bytes(data[pos:pos + idsz], 'little')
+        pos += idsz
+        payload = data[pos:pos + length]
+        pos += length
+        yield t, 1 if flags & FLAG_CH1 else 0, can_id, flags & 0x1F, payload
+
+
+def to_candump(t_us, channel, can_id, flags, payload, epoch):
+    ident = '%08X' % can_id if flags & FLAG_EXT else '%03X' % can_id
+    if flags & FLAG_FD:
+        fd_flags = (1 if flags & FLAG_BRS else 0) | (2 if flags & FLAG_ESI else 0)
+        body = '%s##%X%s' % (ident, fd_flags, payload.hex().upper())
+    elif flags & FLAG_RTR:
+        body = '%s#R' % ident
+    else:
+        body = '%s#%s' % (ident, payload.hex().upper())
+    t = epoch + t_us / 1e6
+    return '(%.6f) can%d %s' % (t, channel, body)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input', nargs='?', help='serial log containing the dump (default: stdin)')
+    ap.add_argument('--epoch', type=float, default=0.0, help='seconds added to device uptime timestamps')
+    ap.add_argument('--replay', metavar='IFACE', help='replay into SocketCAN interface instead of printing')
+    ap.add_argument('--speed', type=float, default=1.0, help='replay speed factor')
+    args = ap.parse_args()
+
+    if args.input:
+        with open(args.input, errors='replace') as f:
+            base_us, data, frames = extract(f)
+    else:
+        base_us, data, frames = extract(sys.stdin)
+
+    # 按时间排序：多 FIFO 读出顺序可能与接收顺序不同
+    records = sorted(parse(base_us, data), key=lambda r: r[0])
+    if len(records) != frames:
+        print('warning: header says %d frames, decoded %d' % (frames, len(records)), file=sys.stderr)
+    lines = [to_candump(*r, epoch=args.epoch) for r in records]
+
+    if args.replay:
+        sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+        import can_replay
+        n = can_replay.replay(can_replay.open_socket(args.replay), lines, args.speed)
+        print('replayed %d frames' % n, file=sys.stderr)
+    else:
+        for line in lines:
+            print(line)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+按原始时序把 candump 日志回放到 SocketCAN 接口 (vcan/can)，支持 CAN-FD 帧。
+
+日志格式 (candump -l):
+    (1700000000.123456) can0 123#DEADBEEF
+    (1700000000.124000) can0 18FF0001##3112233...      # CAN-FD, ## 后一位为 flags (1=BRS, 2=ESI)
+
+用法:
+    sudo ip link add dev vcan0 type vcan && sudo ip link set vcan0 mtu 72 up
+    can_replay.py vcan0 capture.log [--speed 2.0] [--loop]
+    can_replay.py vcan0 --gen-fd 1000       # 生成 DLC 0-64 的 CAN-FD 测试流量
+"""
+import argparse
+import random
+import socket
+import struct
+import sys
+import time
+
+CAN_EFF_FLAG = 0x80000000
+CAN_RTR_FLAG = 0x40000000
+CANFD_BRS = 0x01
+CANFD_ESI = 0x02
+CAN_RAW_FD_FRAMES = getattr(socket, 'CAN_RAW_FD_FRAMES', 5)
+SOL_CAN_RAW = getattr(socket, 'SOL_CAN_RAW', 101)
+
+CAN_FRAME = struct.Struct('=IB3x8s')
+CANFD_FRAME = struct.Struct('=IBB2x64s')
+FD_LENGTHS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64]
+
+
+def parse_line(line):
+    """解析一行 candump 日志，返回 (timestamp, can_id, data, fd, fd_flags)"""
+    parts = line.split()
+    if len(parts) < 3 or not parts[0].startswith('('):
+        return None
+    ts = float(parts[0].strip('()'))
+    ident, sep, rest = parts[2].partition('#')
+    can_id = int(ident, 16)
+    if len(ident) > 3:
+        can_id |= CAN_EFF_FLAG
+    if rest.startswith('#'):
+        fd_flags = int(rest[1], 16)
+        return ts, can_id, bytes.fromhex(rest[2:]), True, fd_flags
+    if rest.startswith('R'):
+        return ts, can_id | CAN_RTR_FLAG, b'', False, 0
+    return ts, can_id, bytes.fromhex(rest), False, 0
+
+
+def pack(can_id, data, fd, fd_flags):
+    if fd:
+        length = next(n for n in FD_LENGTHS if n >= len(data))
+        return CANFD_FRAME.pack(can_id, length, fd_flags, data.ljust(64, b'\0'))
+    return CAN_FRAME.pack(can_id, len(data), data.ljust(8, b'\0'))
+
+
+def open_socket(iface):
+    s = socket.socket(socket.AF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+    s.setsockopt(SOL_CAN_RAW, CAN_RAW_FD_FRAMES, 1)
+    s.bind((iface,))
+    return s
+
+
+def replay(sock, lines, speed):
+    sent = 0
+    start_wall = time.monotonic()
+    start_log = None
+    for line in lines:
+        rec = parse_line(line)
+        if rec is None:
+            continue
+        ts, can_id, data, fd, fd_flags = rec
+        if start_log is None:
+            start_log = ts
+        delay = (ts - start_log) / speed - (time.monotonic() - start_wall)
+        if delay > 0:
+            time.sleep(delay)
+        sock.send(pack(can_id, data, fd, fd_flags))
+        sent += 1
+    return sent
+
+
+def gen_fd(count):
+    """生成覆盖全部 CAN-FD 长度、BRS/ESI 组合的测试日志"""
+    t = time.time()
+    for i in range(count):
+        length = FD_LENGTHS[i % len(FD_LENGTHS)]
+        flags = i & 0x3
+        data = bytes(random.randrange(256) for _ in range(length))
+        yield '(%.6f) vcan0 %08X##%X%s' % (t + i * 0.001, 0x18FF0000 + (i & 0xFF), flags, data.hex().upper())
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('iface', help='SocketCAN interface, e.g. vcan0')
+    ap.add_argument('log', nargs='?', help='candump log file')
+    ap.add_argument('--speed', type=float, default=1.0, help='replay speed factor')
+    ap.add_argument('--loop', action='store_true', help='replay forever')
+    ap.add_argument('--gen-fd', type=int, metavar='N', help='send N generated CAN-FD frames instead of a log')
+    args = ap.parse_args()
+
+    if args.gen_fd:
+        lines = list(gen_fd(args.gen_fd))
+    elif args.log:
+        with open(args.log) as f:
+            lines = f.readlines()
+    else:
+        ap.error('log file or --gen-fd required')
+
+    sock = open_socket(args.iface)
+    while True:
+        n = replay(sock, lines, args.speed)
+        print('replayed %d frames' % n, file=sys.stderr)
+        if not args.loop:
+            break
+
+
+if __name__ == '__main__':
+    main()
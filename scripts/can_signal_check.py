@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+CAN 信号解码 (src/can_signal.c) 的主机侧参考测试与基准。
+
+用主机编译器把 src/can_signal.c、src/can_signal_db.c 和 scripts/can_signal_host.c 编译为测试程序
+(rtthread.h 等最小替身见 host_build.py)，用逐位展开的 DBC 参考解码核对每个信号的物理值 (单精度，允许 1 ulp)：
+
+  流量    按内置信号库 (或 --dbc 指定的 DBC 文件) 生成 5000 帧/s 的总线流量，其中混有库外 ID、
+          帧长不足和远程帧，逐帧核对后按 1 s 分段重复解码，统计每帧耗时和 5000 帧/s 下的主机 CPU 占用；
+  随机布局 随机生成起始位、长度 (1-57)、字节序、符号、比例和偏移的信号，每批 64 个报文 x 4 个信号，
+          默认共 65536 个信号，每个报文两帧随机数据。
+
+主机耗时只反映算法开销，目标板上的周期数和 CPU 占用用 msh 命令 can_signal_bench。
+只用标准库，需要主机 C 编译器 (cc，或 --cc / 环境变量 CC 指定)。
+
+用法:
+    can_signal_check.py                              # 内置信号库 5000 帧/s x 10 s，随机布局 65536 个信号
+    can_signal_check.py --dbc vehicle.dbc            # 流量改用 DBC 中的报文 (跳过复用信号和超过 57 位的信号)
+    can_signal_check.py --seconds 60 --random 0      # 只跑流量部分
+"""
+import argparse
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+import host_build
+
+MAX_MSGS = 64           # can_signal.h CAN_SIGNAL_MAX_MSGS
+MAX_SIGNALS = 256       # CAN_SIGNAL_MAX_SIGNALS
+MAX_LEN = 57            # signal_compile() 支持的最大位数
+FRAME_MAX = 64          # CAN_FRAME_MAX_LEN
+FLAG_EXT, FLAG_RTR, FLAG_FD = 0x01, 0x02, 0x04
+INTEL, MOTOROLA = 0, 1
+
+def f32(v):
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def f32_bits(v):
+    return struct.unpack('<I', struct.pack('<f', v))[0]
+
+
+def bits_f32(b):
+    return struct.unpack('<f', struct.pack('<I', b))[0]
+
+
+def int_to_f32(v):
+    """整数按就近舍入转单精度 (与 C 的 (float)int64 一致)，超过 53 位时避免经双精度二次舍入"""
+    if abs(v) < (1 << 53):
+        return f32(float(v))
+    sign, n = (-1 if v < 0 else 1), abs(v)
+    shift = n.bit_length() - 24
+    q, r = divmod(n, 1 << shift)
+    half = 1 << (shift - 1)
+    if r > half or (r == half and q & 1):
+        q += 1
+    return sign * f32(float(q << shift))
+
+
+def ulp_diff(a, b):
+    def ordered(x):
+        u = f32_bits(x)
+        return -(u & 0x7FFFFFFF) if u & 0x80000000 else u
+    return abs(ordered(a) - ordered(b))
+
+
+class Signal:
+    def __init__(self, name, start, length, order, signed, scale, offset):
+        self.name, self.start, self.length, self.order, self.signed = name, start, length, order, signed
+        self.scale, self.offset = f32(scale), f32(offset)
+        self.bits = self.positions()
+
+    def positions(self):
+        """按 DBC 定义逐位展开的 (字节, 位) 序列，从 LSB (Intel) 或 MSB (Motorola) 开始"""
+        out, pos = [], self.start
+        for _ in range(self.length):
+            out.append((pos // 8, pos % 8))
+            if self.order == INTEL:
+                pos += 1
+            elif pos % 8 == 0:
+                pos += 15
+            else:
+                pos -= 1
+        return out
+
+    def end(self):
+        return max(b for b, _ in self.bits) + 1
+
+    def decode(self, data):
+        raw = 0
+        bits = self.bits if self.order == MOTOROLA else reversed(self.bits)
+        for byte, bit in bits:
+            raw = (raw << 1) | ((data[byte] >> bit) & 1)
+        if self.signed and raw >> (self.length - 1):
+            raw -= 1 << self.length
+        return f32(f32(int_to_f32(raw) * self.scale) + self.offset)
+
+
+class Message:
+    def __init__(self, mid, ext, name, dlc=None):
+        self.id, self.ext, self.name, self.dlc = mid, ext, name, dlc
+        self.signals = []
+
+    def key(self):
+        return (self.id, self.ext)
+
+    def min_len(self):
+        return max([s.end() for s in self.signals] or [0])
+
+    def frame_len(self):
+        if self.dlc and self.dlc >= self.min_len():
+            return self.dlc
+        return 8 if self.min_len() <= 8 else FRAME_MAX
+
+
+def parse_dbc(path):
+    bo = re.compile(r'^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)')
+    sg = re.compile(r'^\s*SG_\s+(\w+)\s*(\w*)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*\(\s*([^,\s]+)\s*,\s*([^)\s]+)\s*\)')
+    msgs, msg, skipped = [], None, 0
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            m = bo.match(line)
+            if m:
+                raw, name = int(m.group(1)), m.group(2)
+                msg = None
+                if name != 'VECTOR__INDEPENDENT_SIG_MSG':
+                    msg = Message(raw & 0x1FFFFFFF, 1 if raw & 0x80000000 else 0, name, int(m.group(3)))
+                    msgs.append(msg)
+                continue
+            m = sg.match(line)
+            if m and msg is not None:
+                length = int(m.group(4))
+                if m.group(2) or length > MAX_LEN:
+                    skipped += 1
+                    continue
+                msg.signals.append(Signal(m.group(1), int(m.group(3)), length,
+                                          INTEL if m.group(5) == '1' else MOTOROLA, m.group(6) == '-',
+                                          float(m.group(7)), float(m.group(8))))
+    msgs = [m for m in msgs if m.signals]
+    kept, total = [], 0
+    for m in msgs:
+        if len(kept) >= MAX_MSGS or total + len(m.signals) > MAX_SIGNALS:
+            skipped += sum(len(x.signals) for x in msgs[len(kept):])
+            break
+        kept.append(m)
+        total += len(m.signals)
+    if skipped:
+        print('%s: skipped %d signals (multiplexed, > %d bits or over the table size)' % (path, skipped, MAX_LEN))
+    return kept
+
+
+def run(exe, lines):
+    p = subprocess.run([exe], input='\n'.join(lines) + '\n', stdout=subprocess.PIPE, universal_newlines=True,
+                       check=True)
+    return p.stdout.splitlines()
+
+
+def builtin_db(exe):
+    msgs = []
+    for line in run(exe, ['db']):
+        w = line.split()
+        if w[0] == 'dbmsg':
+            msgs.append(Message(int(w[1], 16), int(w[2]), w[3]))
+        elif w[0] == 'dbsig':
+            msgs[-1].signals.append(Signal(w[7], int(w[1]), int(w[2]), int(w[3]), int(w[4]) != 0,
+                                           bits_f32(int(w[5], 16)), bits_f32(int(w[6], 16))))
+    return msgs
+
+
+def load_lines(msgs):
+    out = []
+    for m in msgs:
+        out.append('msg %x %d' % (m.id, m.ext))
+        for s in m.signals:
+            out.append('sig %d %d %d %d %08x %08x' % (s.start, s.length, s.order, 1 if s.signed else 0,
+                                                     f32_bits(s.scale), f32_bits(s.offset)))
+    out.append('load')
+    return out
+
+
+def frame_line(mid, flags, data):
+    return 'f %x %x %d %s' % (mid, flags, len(data), bytes(data).hex())
+
+
+class Checker:
+    """按加载顺序给信号编号 (与 can_signal_load 一致)，逐帧比对解码结果"""
+
+    def __init__(self):
+        self.frames = self.signals = self.exact = self.near = self.errors = 0
+
+    def expect(self, table, mid, flags, data):
+        msg = table.get((mid, 1 if flags & FLAG_EXT else 0))
+        if msg is None or flags & FLAG_RTR or len(data) < msg[1].min_len():
+            return []
+        first, m = msg
+        return [(first + i, s.decode(data)) for i, s in enumerate(m.signals)]
+
+    def compare(self, expect, line, what):
+        self.frames += 1
+        w = line.split()
+        got = [(int(x.split(':')[0]), bits_f32(int(x.split(':')[1], 16))) for x in w[1:]]
+        if int(w[0]) != len(expect) or [g[0] for g in got] != [e[0] for e in expect]:
+            self.fail('%s: expected %d signals, got "%s"' % (what, len(expect), line))
+            return
+        for (sig, ref), (_, val) in zip(expect, got):
+            self.signals += 1
+            d = ulp_diff(ref, val)
+            if d == 0:
+                self.exact += 1
+            elif d == 1:
+                self.near += 1
+            else:
+                self.fail('%s: signal %d = %r, reference %r' % (what, sig, val, ref))
+
+    def fail(self, text):
+        self.errors += 1
+        if self.errors <= 10:
+            print('MISMATCH ' + text)
+
+
+def table_of(msgs):
+    table, first = {}, 0
+    for m in msgs:
+        table[m.key()] = (first, m)
+        first += len(m.signals)
+    return table
+
+
+def traffic(exe, msgs, builtin, rate, seconds, rounds, rng):
+    """库内报文随机数据，另混 15% 库外 ID、2% 帧长不足、1% 远程帧"""
+    table = table_of(msgs)
+    frames = []
+    for _ in range(rate * seconds):
+        m = rng.choice(msgs)
+        flags = (FLAG_EXT if m.ext else 0) | (FLAG_FD if m.frame_len() > 8 else 0)
+        data = [rng.randrange(256) for _ in range(m.frame_len())]
+        mid, p = m.id, rng.random()
+        if p < 0.15:
+            while (mid, m.ext) in table:
+                mid = rng.randrange(1 << 29) if m.ext else rng.randrange(1 << 11)
+        elif p < 0.17:
+            data = data[:rng.randrange(m.min_len())]
+        elif p < 0.18:
+            flags |= FLAG_RTR
+        frames.append((mid, flags, data))
+
+    lines = ['db'] if builtin else load_lines(msgs)
+    lines += [frame_line(*f) for f in frames]
+    lines.append('bench %d %d' % (rate, rounds))
+    out = run(exe, lines)
+    if builtin:
+        out = [l for l in out if not l.startswith('db')]
+    if int(out[0].split()[1]) != len(msgs):
+        raise SystemExit('load failed: %s' % out[0])
+
+    chk = Checker()
+    for f, line in zip(frames, out[1:]):
+        chk.compare(chk.expect(table, *f), line, 'frame %x' % f[0])
+
+    _, n, sigs, total, worst = out[-1].split()
+    n, total, worst = int(n), int(total), int(worst)
+    ns = total / float(n)
+    print('traffic: %d messages, %d signals, %d frames at %d frames/s: %d signals checked (%d exact, %d within 1 ulp), '
+          '%d mismatches' % (len(msgs), sum(len(m.signals) for m in msgs), chk.frames, rate, chk.signals, chk.exact,
+                             chk.near, chk.errors))
+    print('  host decode: %.1f ns/frame (%s signals in %d rounds), CPU @%d frames/s %.3f%% avg, %.3f%% worst second'
+          % (ns, sigs, rounds, rate, ns * rate / 1e7, worst / 1e7))
+    return chk.errors
+
+
+def random_signal(rng, flen):
+    length = rng.randint(1, min(MAX_LEN, flen * 8))
+    order = rng.choice((INTEL, MOTOROLA))
+    first = rng.randrange(flen * 8 - length + 1)
+    start = first if order == INTEL else (first // 8) * 8 + (7 - first % 8)
+    return Signal('r', start, length, order, rng.random() < 0.5,
+                  rng.choice((1.0, 0.1, 0.5, 0.001, 1.0 / 256, 0.05, 0.03125, -2.0)),
+                  rng.choice((0.0, -40.0, -125.0, -273.0, 0.5, 1000.0)))
+
+
+def random_layouts(exe, count, rng):
+    per_msg = MAX_SIGNALS // MAX_MSGS
+    batches = (count + MAX_SIGNALS - 1) // MAX_SIGNALS
+    lines, plan = [], []
+    for _ in range(batches):
+        msgs, keys = [], set()
+        while len(msgs) < MAX_MSGS:
+            ext = rng.random() < 0.5
+            mid = rng.randrange(1 << 29) if ext else rng.randrange(1 << 11)
+            if (mid, ext) in keys:
+                continue
+            keys.add((mid, ext))
+            m = Message(mid, 1 if ext else 0, 'r')
+            flen = FRAME_MAX if rng.random() < 0.4 else 8
+            m.signals = [random_signal(rng, flen) for _ in range(per_msg)]
+            m.dlc = flen
+            msgs.append(m)
+        frames = []
+        for m in msgs:
+            flags = (FLAG_EXT if m.ext else 0) | (FLAG_FD if m.dlc > 8 else 0)
+            for _ in range(2):
+                frames.append((m.id, flags, [rng.randrange(256) for _ in range(m.dlc)]))
+            if m.min_len() > 0:
+                frames.append((m.id, flags, [0] * (m.min_len() - 1)))
+        lines += load_lines(msgs) + [frame_line(*f) for f in frames]
+        plan.append((table_of(msgs), frames))
+
+    out = iter(run(exe, lines))
+    chk = Checker()
+    for table, frames in plan:
+        line = next(out)
+        if line != 'load %d' % MAX_MSGS:
+            chk.fail('random batch: %s' % line)
+            return chk.errors
+        for f in frames:
+            chk.compare(chk.expect(table, *f), next(out), 'random frame %x' % f[0])
+    print('random layouts: %d signals in %d batches, %d frames: %d values checked (%d exact, %d within 1 ulp), '
+          '%d mismatches' % (batches * MAX_SIGNALS, batches, chk.frames, chk.signals, chk.exact,
+                             chk.near, chk.errors))
+    return chk.errors
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--dbc', help='DBC file for the traffic test (default: src/can_signal_db.c)')
+    ap.add_argument('--rate', type=int, default=5000, help='frames per second (default 5000)')
+    ap.add_argument('--seconds', type=int, default=10, help='seconds of traffic (default 10)')
+    ap.add_argument('--rounds', type=int, default=5, help='benchmark repetitions of the traffic (default 5)')
+    ap.add_argument('--random', type=int, default=65536, help='random signal layouts to check (default 65536)')
+    ap.add_argument('--seed', type=int, default=1)
+    ap.add_argument('--cc', default=os.environ.get('CC', 'cc'), help='host C compiler')
+    args = ap.parse_args()
+
+    rng = random.Random(args.seed)
+    workdir = tempfile.mkdtemp(prefix='can_signal_')
+    try:
+        exe = host_build.build('can_signal_host', [os.path.join(host_build.HERE, 'can_signal_host.c'), 'can_signal.c',
+                                                   'can_signal_db.c'], workdir, args.cc)
+        msgs = parse_dbc(args.dbc) if args.dbc else builtin_db(exe)
+        if not msgs:
+            raise SystemExit('no decodable messages')
+        errors = traffic(exe, msgs, not args.dbc, args.rate, args.seconds, args.rounds, rng)
+        if args.random > 0:
+            errors += random_layouts(exe, args.random, rng)
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+    print('FAIL' if errors else 'OK')
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
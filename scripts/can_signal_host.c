@@ -0,0 +1,178 @@
+/*
+ * src/can_signal.c 的主机侧测试桩，由 scripts/can_signal_check.py 连同 can_signal.c / can_signal_db.c
+ * 用主机编译器编译 (RT-Thread 头文件由脚本生成最小替身)，不属于固件。
+ *
+ * 从标准输入逐行读取命令，结果写到标准输出：
+ *   db                                  加载内置信号库，输出 "load <n>" 及每个报文/信号的定义
+ *   msg <id> <ext>                      开始一个自定义报文
+ *   sig <start> <len> <order> <signed> <scale> <offset>    scale/offset 为 IEEE754 单精度十六进制
+ *   load                                编译已累积的自定义报文，输出 "load <n>" (负数为错误码)
+ *   f <id> <flags> <len> <hex>          解码一帧并保存，输出 "<n> <sig>:<value 十六进制> ..."
+ *   bench <rate> <rounds>               把保存的帧按每秒 rate 帧分段重复解码 rounds 次，
+ *                                       输出 "bench <frames> <signals> <total_ns> <worst_second_ns>"
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "can_signal.h"
+
+#define HOST_MAX_FRAMES     200000
+#define HOST_LINE           512
+
+static CanMessageDef host_msgs[CAN_SIGNAL_MAX_MSGS];
+static CanSignalDef host_sigs[CAN_SIGNAL_MAX_SIGNALS];
+static int host_msg_num, host_sig_num;
+static CanFrame *host_frames;
+static int host_frame_num;
+
+static float from_bits(unsigned long bits)
+{
+    rt_uint32_t u = (rt_uint32_t)bits;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static rt_uint32_t to_bits(float f)
+{
+    rt_uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static rt_uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void host_db(void)
+{
+    printf("load %d\n", can_signal_load(can_signal_db, can_signal_db_num));
+    for (rt_size_t m = 0; m < can_signal_db_num; m++) {
+        const CanMessageDef *msg = &can_signal_db[m];
+        printf("dbmsg %lx %d %s\n", (unsigned long)msg->id, msg->ext, msg->name);
+        for (int s = 0; s < msg->signal_num; s++) {
+            const CanSignalDef *sig = &msg->signals[s];
+            printf("dbsig %d %d %d %d %08x %08x %s\n", sig->start_bit, sig->length, sig->order, sig->is_signed,
+                   to_bits(sig->scale), to_bits(sig->offset), sig->name);
+        }
+    }
+}
+
+static void host_decode(char *args)
+{
+    static CanSignalValue values[CAN_SIGNAL_MAX_SIGNALS];
+    CanFrame frame;
+    unsigned long id;
+    unsigned flags, len;
+    char hex[2 * CAN_FRAME_MAX_LEN + 1] = "";
+
+    memset(&frame, 0, sizeof(frame));
+    if (sscanf(args, "%lx %x %u %128s", &id, &flags, &len, hex) < 3 || len > CAN_FRAME_MAX_LEN) {
+        printf("error\n");
+        return;
+    }
+    frame.id = (rt_uint32_t)id;
+    frame.flags = (rt_uint8_t)flags;
+    frame.len = (rt_uint8_t)len;
+    for (unsigned i = 0; i < len && hex[2 * i] && hex[2 * i + 1]; i++) {
+        unsigned b;
+        sscanf(&hex[2 * i], "%2x", &b);
+        frame.data[i] = (rt_uint8_t)b;
+    }
+    if (host_frame_num < HOST_MAX_FRAMES) host_frames[host_frame_num++] = frame;
+
+    int n = can_signal_decode(&frame, values, CAN_SIGNAL_MAX_SIGNALS);
+    printf("%d", n);
+    for (int i = 0; i < n; i++) printf(" %u:%08x", values[i].sig, to_bits(values[i].value));
+    printf("\n");
+}
+
+/* 每 rate 帧为 1 s 的流量，统计总耗时和最慢的一秒 */
+static void host_bench(int rate, int rounds)
+{
+    static CanSignalValue values[CAN_SIGNAL_MAX_SIGNALS];
+    rt_uint64_t total = 0, worst = 0, signals = 0;
+    volatile float sink = 0;
+
+    if (host_frame_num == 0 || rate <= 0 || rounds <= 0) {
+        printf("bench 0 0 0 0\n");
+        return;
+    }
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < host_frame_num; i += rate) {
+            int end = (i + rate < host_frame_num) ? i + rate : host_frame_num;
+            rt_uint64_t t0 = host_ns();
+            for (int k = i; k < end; k++) {
+                int n = can_signal_decode(&host_frames[k], values, CAN_SIGNAL_MAX_SIGNALS);
+                signals += n;
+                if (n > 0) sink += values[0].value;
+            }
+            rt_uint64_t t = host_ns() - t0;
+            total += t;
+            /* 不足 rate 帧的末段按比例折算到 1 s */
+            t = t * rate / (end - i);
+            if (t > worst) worst = t;
+        }
+    }
+    (void)sink;
+    printf("bench %llu %llu %llu %llu\n", (unsigned long long)host_frame_num * rounds, (unsigned long long)signals,
+           (unsigned long long)total, (unsigned long long)worst);
+}
+
+int main(void)
+{
+    char line[HOST_LINE];
+
+    host_frames = malloc(sizeof(CanFrame) * HOST_MAX_FRAMES);
+    if (host_frames == NULL) return 1;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        if (strncmp(line, "f ", 2) == 0) {
+            host_decode(line + 2);
+        } else if (strncmp(line, "msg ", 4) == 0) {
+            unsigned long id;
+            int ext;
+            if (host_msg_num < CAN_SIGNAL_MAX_MSGS && sscanf(line + 4, "%lx %d", &id, &ext) == 2) {
+                CanMessageDef *msg = &host_msgs[host_msg_num++];
+                msg->id = (rt_uint32_t)id;
+                msg->ext = (rt_uint8_t)ext;
+                msg->name = "host";
+                msg->signals = &host_sigs[host_sig_num];
+                msg->signal_num = 0;
+            }
+        } else if (strncmp(line, "sig ", 4) == 0) {
+            int start, len, order, sign;
+            unsigned long scale, offset;
+            if (host_msg_num > 0 && host_sig_num < CAN_SIGNAL_MAX_SIGNALS &&
+                sscanf(line + 4, "%d %d %d %d %lx %lx", &start, &len, &order, &sign, &scale, &offset) == 6) {
+                CanSignalDef *sig = &host_sigs[host_sig_num++];
+                sig->name = "host";
+                sig->start_bit = (rt_uint16_t)start;
+                sig->length = (rt_uint8_t)len;
+                sig->order = (rt_uint8_t)order;
+                sig->is_signed = (rt_uint8_t)sign;
+                sig->scale = from_bits(scale);
+                sig->offset = from_bits(offset);
+                host_msgs[host_msg_num - 1].signal_num++;
+            }
+        } else if (strncmp(line, "load", 4) == 0) {
+            printf("load %d\n", can_signal_load(host_msgs, host_msg_num));
+            host_msg_num = 0;
+            host_sig_num = 0;
+            host_frame_num = 0;
+        } else if (strncmp(line, "db", 2) == 0) {
+            host_db();
+            host_frame_num = 0;
+        } else if (strncmp(line, "bench ", 6) == 0) {
+            int rate = 0, rounds = 0;
+            sscanf(line + 6, "%d %d", &rate, &rounds);
+            host_bench(rate, rounds);
+        }
+    }
+    free(host_frames);
+    return 0;
+}
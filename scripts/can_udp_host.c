@@ -0,0 +1,227 @@
+/*
+ * src/can_udp.c 的主机侧测试桩，由 scripts/can_udp_peer.py selftest --host 连同 can_udp.c 用主机编译器编译
+ * (RT-Thread 头文件替身见 host_build.py，线程与信号量由本文件以 pthread 实现，socket 直接使用主机协议栈)，
+ * 不属于固件。can_tx / can_ring 由本文件代替，桥接发到总线或注入接收队列的帧写到标准输出。
+ *
+ * 标准输入逐行命令：
+ *   start <peer_ip> <port> <local_port> <flush_ms>   can_udp_start，输出 "start <ret>"
+ *   f <ch> <id> <flags> <hex>                        CAN 线程收到一帧 (flags 为 CAN_FRAME_FLAG_*)，交给 can_udp_feed
+ *   send <ch> <id> <flags> <hex>                     本机经 can_tx 发送一帧，虚拟总线模式下走桥接的重定向
+ *   vbus <0|1>                                       can_udp_set_vbus
+ *   stats <ch>                                       输出 "stats <ch> <tx_frames> <tx_datagrams> <tx_errors>
+ *                                                    <rx_frames> <rx_datagrams> <rx_errors> <rx_seq_gaps>"
+ *   stop                                             can_udp_stop，输出 "stop"
+ * 标准输出 (接收线程写出)：
+ *   tx <ch> <id> <flags> <hex>                       下行帧经 can_tx_send 发到总线
+ *   inj <ch> <id> <flags> <hex>                      虚拟总线模式下行帧经 can_ring_inject 注入
+ * 两次输入之间按 can_udp_flush 返回的时间调用 can_udp_flush，处理聚合超时。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include "can_udp.h"
+#include "can_tx.h"
+
+#define HOST_LINE   512
+
+struct rt_thread {
+    pthread_t tid;
+    void (*entry)(void *parameter);
+    void *parameter;
+};
+
+static pthread_mutex_t host_sem_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_sem_cond = PTHREAD_COND_INITIALIZER;
+static CanTxRedirect host_redirect = RT_NULL;
+
+static void *host_thread_entry(void *arg)
+{
+    rt_thread_t thread = (rt_thread_t)arg;
+
+    thread->entry(thread->parameter);
+    return NULL;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    rt_thread_t thread = calloc(1, sizeof(*thread));
+
+    (void)name;
+    (void)stack_size;
+    (void)priority;
+    (void)tick;
+    if (thread) {
+        thread->entry = entry;
+        thread->parameter = parameter;
+    }
+    return thread;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    if (pthread_create(&thread->tid, NULL, host_thread_entry, thread) != 0) return -RT_ERROR;
+    pthread_detach(thread->tid);
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_init(struct rt_semaphore *sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    (void)name;
+    (void)flag;
+    sem->value = (int)value;
+    return RT_EOK;
+}
+
+rt_err_t rt_sem_take(struct rt_semaphore *sem, rt_int32_t time)
+{
+    struct timespec deadline;
+    rt_err_t ret = RT_EOK;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += time / 1000;
+    deadline.tv_nsec += (time % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&host_sem_lock);
+    while (sem->value == 0 && ret == RT_EOK) {
+        if (time < 0) {
+            pthread_cond_wait(&host_sem_cond, &host_sem_lock);
+        } else if (pthread_cond_timedwait(&host_sem_cond, &host_sem_lock, &deadline) != 0) {
+            ret = -RT_ETIMEOUT;
+        }
+    }
+    if (ret == RT_EOK) sem->value--;
+    pthread_mutex_unlock(&host_sem_lock);
+    return ret;
+}
+
+rt_err_t rt_sem_release(struct rt_semaphore *sem)
+{
+    pthread_mutex_lock(&host_sem_lock);
+    sem->value++;
+    pthread_cond_broadcast(&host_sem_cond);
+    pthread_mutex_unlock(&host_sem_lock);
+    return RT_EOK;
+}
+
+static void host_print(const char *tag, rt_uint8_t channel, const CanFrame *frame)
+{
+    flockfile(stdout);
+    printf("%s %u %lx %x ", tag, channel, (unsigned long)frame->id, frame->flags);
+    for (int i = 0; i < frame->len; i++) printf("%02x", frame->data[i]);
+    printf("\n");
+    fflush(stdout);
+    funlockfile(stdout);
+}
+
+int can_tx_send(rt_uint8_t channel, const CanFrame *frame, rt_uint8_t prio)
+{
+    (void)prio;
+    if (host_redirect) return host_redirect(channel, frame);
+    host_print("tx", channel, frame);
+    return RT_EOK;
+}
+
+void can_tx_set_redirect(CanTxRedirect fn)
+{
+    host_redirect = fn;
+}
+
+int can_ring_inject(const CanFrame *frame)
+{
+    host_print("inj", frame->channel, frame);
+    return RT_EOK;
+}
+
+/* "<ch> <id> <flags> <hex>"，解析失败返回 -1 */
+static int host_parse_frame(const char *args, CanFrame *frame)
+{
+    unsigned ch, flags;
+    unsigned long id;
+    char hex[2 * CAN_FRAME_MAX_LEN + 1] = "";
+
+    memset(frame, 0, sizeof(*frame));
+    if (sscanf(args, "%u %lx %x %128s", &ch, &id, &flags, hex) < 3) return -1;
+    frame->channel = (rt_uint8_t)ch;
+    frame->id = (rt_uint32_t)id;
+    frame->flags = (rt_uint8_t)flags;
+    for (rt_size_t i = 0; i < CAN_FRAME_MAX_LEN && hex[2 * i] && hex[2 * i + 1]; i++) {
+        unsigned b;
+        sscanf(&hex[2 * i], "%2x", &b);
+        frame->data[i] = (rt_uint8_t)b;
+        frame->len = (rt_uint8_t)(i + 1);
+    }
+    return 0;
+}
+
+static void host_line(char *line)
+{
+    CanFrame frame;
+
+    if (strncmp(line, "f ", 2) == 0) {
+        if (host_parse_frame(line + 2, &frame) == 0) can_udp_feed(&frame, 1);
+    } else if (strncmp(line, "send ", 5) == 0) {
+        if (host_parse_frame(line + 5, &frame) == 0) can_tx_send(frame.channel, &frame, CAN_TX_PRIO_NORMAL);
+    } else if (strncmp(line, "start ", 6) == 0) {
+        char ip[64];
+        unsigned port, local_port, flush_ms;
+        int ret = -RT_EINVAL;
+        if (sscanf(line + 6, "%63s %u %u %u", ip, &port, &local_port, &flush_ms) == 4) {
+            ret = can_udp_start(ip, (rt_uint16_t)port, (rt_uint16_t)local_port, flush_ms);
+        }
+        printf("start %d\n", ret);
+    } else if (strncmp(line, "vbus ", 5) == 0) {
+        can_udp_set_vbus(atoi(line + 5) ? RT_TRUE : RT_FALSE);
+    } else if (strncmp(line, "stats ", 6) == 0) {
+        CanUdpStats s;
+        rt_uint8_t ch = (rt_uint8_t)atoi(line + 6);
+        can_udp_get_stats(ch, &s);
+        printf("stats %u %lu %lu %lu %lu %lu %lu %lu\n", ch, (unsigned long)s.tx_frames, (unsigned long)s.tx_datagrams,
+               (unsigned long)s.tx_errors, (unsigned long)s.rx_frames, (unsigned long)s.rx_datagrams,
+               (unsigned long)s.rx_errors, (unsigned long)s.rx_seq_gaps);
+    } else if (strncmp(line, "stop", 4) == 0) {
+        can_udp_stop();
+        printf("stop\n");
+    }
+    fflush(stdout);
+}
+
+int main(void)
+{
+    static char buf[HOST_LINE * 8];
+    size_t used = 0;
+
+    for (;;) {
+        rt_int32_t wait = can_udp_flush();
+        struct timeval tv = { wait / 1000, (wait % 1000) * 1000 };
+        fd_set rd;
+
+        FD_ZERO(&rd);
+        FD_SET(0, &rd);
+        if (select(1, &rd, NULL, NULL, (wait < 0) ? NULL : &tv) <= 0) continue;
+
+        ssize_t n = read(0, buf + used, sizeof(buf) - used - 1);
+        if (n <= 0) break;
+        used += (size_t)n;
+        buf[used] = '\0';
+
+        char *line = buf, *end;
+        while ((end = strchr(line, '\n')) != NULL) {
+            *end = '\0';
+            host_line(line);
+            line = end + 1;
+        }
+        used -= (size_t)(line - buf);
+        memmove(buf, line, used);
+        if (used >= sizeof(buf) - 1) used = 0;     /* 超长行丢弃 */
+    }
+    can_udp_stop();
+    return 0;
+}
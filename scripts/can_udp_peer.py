@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+网关 CAN-over-UDP 桥接 (src/can_udp.c，cannelloni v2 协议) 的主机侧对端与测试工具。
+
+网关每个 CAN 通道使用一个端口 (port + 通道号)，主机侧同样绑定该端口。
+
+用法:
+    can_udp_peer.py listen [--port 20000]                 # 打印网关上行的帧 (candump 格式) 与延迟统计
+    can_udp_peer.py bridge vcan0 <gw_ip> [--port 20000]   # 与 SocketCAN 接口双向桥接 (同 cannelloni)
+    can_udp_peer.py send <gw_ip> --gen N [--port 20000]   # 向网关发送 N 个测试帧，由网关发到总线
+    can_udp_peer.py selftest                              # 回环地址上验证编解码、分包和序号
+    can_udp_peer.py selftest --host [--cc gcc]            # 用主机编译器编译 src/can_udp.c (测试桩 can_udp_host.c)，
+                                                          # 经回环地址与本脚本的编解码双向对测
+"""
+import argparse
+import os
+import queue
+import random
+import select
+import shutil
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+VERSION = 2
+OP_DATA = 0
+HEADER = struct.Struct('>BBBH')
+CAN_EFF_FLAG = 0x80000000
+CAN_RTR_FLAG = 0x40000000
+LEN_FD = 0x80
+FD_BRS = 0x01
+FD_ESI = 0x02
+MTU = 1472
+FD_LENGTHS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64]
+
+# --host 时与 can_udp_host.c 交换的 CAN_FRAME_FLAG_*
+HOST_FLAG_EXT = 0x01
+HOST_FLAG_RTR = 0x02
+HOST_FLAG_FD = 0x04
+HOST_FLAG_BRS = 0x08
+HOST_FLAG_ESI = 0x10
+
+
+def encode(frames, seq):
+    """frames: [(can_id, data, fd, fd_flags)]，can_id 带 SocketCAN 标志位"""
+    body = bytearray()
+    for can_id, data, fd, fd_flags in frames:
+        body += struct.pack('>I', can_id)
+        if fd:
+            body += bytes([len(data) | LEN_FD, fd_flags])
+        else:
+            body.append(len(data))
+        if not can_id & CAN_RTR_FLAG:
+            body += data
+    return HEADER.pack(VERSION, OP_DATA, seq & 0xFF, len(frames)) + bytes(body)
+
+
+def decode(buf):
+    version, op, seq, count = HEADER.unpack_from(buf, 0)
+    if version != VERSION or op != OP_DATA:
+        raise ValueError('not a cannelloni v2 data frame')
+    pos = HEADER.size
+    frames = []
+    for _ in range(count):
+        can_id, length = struct.unpack_from('>IB', buf, pos)
+        pos += 5
+        fd = bool(length & LEN_FD)
+        length &= ~LEN_FD
+        fd_flags = 0
+        if fd:
+            fd_flags = buf[pos]
+            pos += 1
+        if can_id & CAN_RTR_FLAG:
+            data = b''
+        else:
+            data = bytes(buf[pos:pos + length])
+            pos += length
+        frames.append((can_id, data, fd, fd_flags))
+    if pos != len(buf):
+        raise ValueError('trailing bytes in datagram')
+    return seq, frames
+
+
+def candump(can_id, data, fd, fd_flags, channel=0, ts=None):
+    ident = '%08X' % (can_id & 0x1FFFFFFF) if can_id & CAN_EFF_FLAG else '%03X' % (can_id & 0x7FF)
+    if fd:
+        body = '%s##%X%s' % (ident, fd_flags, data.hex().upper())
+    elif can_id & CAN_RTR_FLAG:
+        body = '%s#R' % ident
+    else:
+        body = '%s#%s' % (ident, data.hex().upper())
+    return '(%.6f) can%d %s' % (time.time() if ts is None else ts, channel, body)
+
+
+def gen_frames(count):
+    for i in range(count):
+        kind = i % 4
+        if kind == 0:
+            yield (0x100 + (i & 0xFF), bytes(random.randrange(256) for _ in range(i % 9)), False, 0)
+        elif kind == 1:
+            yield (CAN_EFF_FLAG | (0x18FF0000 + (i & 0xFF)), bytes(8), False, 0)
+        elif kind == 2:
+            length = FD_LENGTHS[i % len(FD_LENGTHS)]
+            yield (CAN_EFF_FLAG | 0x0CF00400, bytes(random.randrange(256) for _ in range(length)), True, (i >> 2) & 3)
+        else:
+            yield (CAN_RTR_FLAG | 0x7FF, b'', False, 0)
+
+
+def open_ports(port, channels):
+    socks = []
+    for ch in range(channels):
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        s.bind(('0.0.0.0', port + ch))
+        socks.append(s)
+    return socks
+
+
+def cmd_listen(args):
+    socks = open_ports(args.port, 2)
+    last_seq = {}
+    stats = {'frames': 0, 'datagrams': 0, 'gaps': 0}
+    last_print = time.monotonic()
+    while True:
+        ready, _, _ = select.select(socks, [], [], 1.0)
+        for s in ready:
+            ch = socks.index(s)
+            seq, frames = decode(s.recv(65535))
+            if ch in last_seq and seq != (last_seq[ch] + 1) & 0xFF:
+                stats['gaps'] += 1
+            last_seq[ch] = seq
+            stats['datagrams'] += 1
+            stats['frames'] += len(frames)
+            if not args.quiet:
+                for f in frames:
+                    print(candump(*f, channel=ch))
+        if args.quiet and time.monotonic() - last_print >= 1.0:
+            print('%(frames)d frames, %(datagrams)d datagrams, %(gaps)d seq gaps' % stats, file=sys.stderr)
+            last_print = time.monotonic()
+
+
+def cmd_bridge(args):
+    can_sock = socket.socket(socket.AF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+    can_sock.setsockopt(getattr(socket, 'SOL_CAN_RAW', 101), getattr(socket, 'CAN_RAW_FD_FRAMES', 5), 1)
+    can_sock.bind((args.iface,))
+    udp = open_ports(args.port + args.channel, 1)[0]
+    peer = (args.gateway, args.port + args.channel)
+    seq = 0
+    pending = []
+    deadline = None
+    while True:
+        timeout = None if deadline is None else max(0.0, deadline - time.monotonic())
+        ready, _, _ = select.select([can_sock, udp], [], [], timeout)
+        if udp in ready:
+            for can_id, data, fd, fd_flags in decode(udp.recv(65535))[1]:
+                if fd:
+                    length = next(n for n in FD_LENGTHS if n >= len(data))
+                    can_sock.send(struct.pack('=IBB2x64s', can_id, length, fd_flags, data.ljust(64, b'\0')))
+                else:
+                    can_sock.send(struct.pack('=IB3x8s', can_id, len(data), data.ljust(8, b'\0')))
+        if can_sock in ready:
+            raw = can_sock.recv(72)
+            if len(raw) == 72:
+                can_id, length, fd_flags = struct.unpack_from('=IBB', raw)
+                pending.append((can_id, raw[8:8 + length], True, fd_flags))
+            else:
+                can_id, length = struct.unpack_from('=IB', raw)
+                pending.append((can_id, raw[8:8 + length], False, 0))
+            if deadline is None:
+                deadline = time.monotonic() + args.flush_ms / 1000.0
+        if pending and (len(pending) >= 16 or time.monotonic() >= deadline):
+            udp.sendto(encode(pending, seq), peer)
+            seq += 1
+            pending = []
+            deadline = None
+
+
+def cmd_send(args):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    frames = list(gen_frames(args.gen))
+    seq = 0
+    for i in range(0, len(frames), args.batch):
+        s.sendto(encode(frames[i:i + args.batch], seq), (args.gateway, args.port + args.channel))
+        seq += 1
+        time.sleep(args.interval / 1000.0)
+    print('sent %d frames in %d datagrams' % (len(frames), seq), file=sys.stderr)
+
+
+def to_host(frame, esi=True):
+    """(can_id, data, fd, fd_flags) -> 测试桩的 (id, flags, data)，esi=False 时不含 ESI (下行帧发往总线不带 ESI)"""
+    can_id, data, fd, fd_flags = frame
+    flags = (HOST_FLAG_EXT if can_id & CAN_EFF_FLAG else 0) | (HOST_FLAG_RTR if can_id & CAN_RTR_FLAG else 0)
+    if fd:
+        flags |= HOST_FLAG_FD | (HOST_FLAG_BRS if fd_flags & FD_BRS else 0)
+        flags |= HOST_FLAG_ESI if esi and fd_flags & FD_ESI else 0
+    return can_id & (0x1FFFFFFF if can_id & CAN_EFF_FLAG else 0x7FF), flags, data
+
+
+class HostBridge:
+    """主机编译的 can_udp.c (can_udp_host.c)，经标准输入/输出交换命令与总线帧，扮演网关一端"""
+
+    def __init__(self, exe):
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=1,
+                                     universal_newlines=True)
+        self.replies = queue.Queue()
+        self.bus = queue.Queue()    # (tag, ch, (id, flags, data))
+        threading.Thread(target=self._reader, daemon=True).start()
+
+    def _reader(self):
+        for line in self.proc.stdout:
+            words = line.split()
+            if words[0] in ('tx', 'inj'):
+                data = bytes.fromhex(words[4]) if len(words) > 4 else b''
+                self.bus.put((words[0], int(words[1]), (int(words[2], 16), int(words[3], 16), data)))
+            else:
+                self.replies.put(words)
+
+    def write(self, line):
+        self.proc.stdin.write(line + '\n')
+        self.proc.stdin.flush()
+
+    def call(self, line):
+        self.write(line)
+        return self.replies.get(timeout=5.0)
+
+    def frame(self, cmd, ch, frame):
+        can_id, flags, data = to_host(frame)
+        self.write('%s %d %x %x %s' % (cmd, ch, can_id, flags, data.hex()))
+
+    def stats(self, ch):
+        words = self.call('stats %d' % ch)
+        keys = ('tx_frames', 'tx_datagrams', 'tx_errors', 'rx_frames', 'rx_datagrams', 'rx_errors', 'rx_seq_gaps')
+        return dict(zip(keys, map(int, words[2:])))
+
+    def expect_bus(self, tag, count):
+        got = {}
+        for _ in range(count):
+            t, ch, f = self.bus.get(timeout=5.0)
+            if t != tag:
+                raise SystemExit('expected %s frame, got %s' % (tag, t))
+            got.setdefault(ch, []).append(f)
+        return got
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait(timeout=5.0)
+
+
+def free_port_pair():
+    """返回 base，使 base 与 base+1 均可绑定，返回已绑定的两个 socket"""
+    while True:
+        base = random.randrange(20000, 60000, 2)
+        try:
+            return base, open_ports(base, 2)
+        except OSError:
+            continue
+
+
+def recv_uplink(socks, count, seqs):
+    """收取网关上行的 count 帧，按通道返回帧列表、报文数与单个报文的最多帧数；检查 MTU 与序号，seqs 为各通道下一个序号"""
+    frames = {ch: [] for ch in range(len(socks))}
+    datagrams = {ch: 0 for ch in range(len(socks))}
+    packed = 0
+    while sum(map(len, frames.values())) < count:
+        ready, _, _ = select.select(socks, [], [], 2.0)
+        if not ready:
+            raise SystemExit('uplink timeout: %d of %d frames' % (sum(map(len, frames.values())), count))
+        for s in ready:
+            ch = socks.index(s)
+            buf = s.recv(65535)
+            if len(buf) > MTU:
+                raise SystemExit('datagram exceeds MTU: %d' % len(buf))
+            seq, fr = decode(buf)
+            if seq != seqs[ch] & 0xFF:
+                raise SystemExit('ch%d sequence mismatch %d != %d' % (ch, seq, seqs[ch] & 0xFF))
+            seqs[ch] += 1
+            datagrams[ch] += 1
+            packed = max(packed, len(fr))
+            frames[ch] += fr
+    return frames, datagrams, packed
+
+
+def host_selftest(args):
+    """主机编译 can_udp.c，在回环地址上与本脚本的 encode/decode 双向对测：上行聚合与分包、下行转发、序号缺口、虚拟总线"""
+    import host_build
+    workdir = tempfile.mkdtemp(prefix='can_udp_host_')
+    try:
+        exe = host_build.build('can_udp_host', [os.path.join(host_build.HERE, 'can_udp_host.c'), 'can_udp.c'],
+                               workdir, args.cc, extra_headers={'rtdevice.h': HOST_RTDEVICE_H}, cflags=('-pthread',))
+        port, socks = free_port_pair()
+        local_port, probe = free_port_pair()
+        for s in probe:
+            s.close()
+        gw = HostBridge(exe)
+        ret = gw.call('start 127.0.0.1 %d %d 20' % (port, local_port))
+        if ret != ['start', '0']:
+            raise SystemExit('can_udp_start failed: %s' % ' '.join(ret))
+
+        # 上行：两通道交替喂帧，报文满即发出，余下的在 flush_ms 后发出
+        frames = list(gen_frames(2000))
+        for i, f in enumerate(frames):
+            gw.frame('f', i & 1, f)
+        up_seqs = [0, 0]
+        got, datagrams, packed = recv_uplink(socks, len(frames), up_seqs)
+        for ch in (0, 1):
+            if got[ch] != frames[ch::2]:
+                raise SystemExit('uplink ch%d mismatch' % ch)
+            st = gw.stats(ch)
+            if st['tx_frames'] != len(got[ch]) or st['tx_datagrams'] != datagrams[ch] or st['tx_errors']:
+                raise SystemExit('uplink ch%d stats mismatch: %s' % (ch, st))
+        if packed < 2:
+            raise SystemExit('uplink frames were not aggregated')
+        print('uplink ok: %d frames, %d datagrams, up to %d frames per datagram'
+              % (len(frames), sum(datagrams.values()), packed))
+
+        # 下行：按 MTU 分包发往网关，各帧经 can_tx_send 发出
+        frames = list(gen_frames(400))
+        seq = 0
+        for i in range(0, len(frames), 16):
+            for ch in (0, 1):
+                socks[ch].sendto(encode(frames[i:i + 16], seq), ('127.0.0.1', local_port + ch))
+            seq += 1
+        got = gw.expect_bus('tx', 2 * len(frames))
+        expect = [to_host(f, esi=False) for f in frames]
+        for ch in (0, 1):
+            if got.get(ch) != expect:
+                raise SystemExit('downlink ch%d mismatch' % ch)
+
+        # 序号缺口与格式错误的报文
+        socks[0].sendto(encode(frames[:1], seq + 1), ('127.0.0.1', local_port))
+        gw.expect_bus('tx', 1)
+        socks[0].sendto(encode(frames[:1], seq + 2)[:-1], ('127.0.0.1', local_port))
+        socks[0].sendto(encode(frames[:1], seq + 3), ('127.0.0.1', local_port))
+        gw.expect_bus('tx', 1)
+        st = gw.stats(0)
+        if st['rx_frames'] != len(frames) + 2 or st['rx_seq_gaps'] != 1 or st['rx_errors'] != 1:
+            raise SystemExit('downlink stats mismatch: %s' % st)
+        print('downlink ok: %d frames, %d seq gap, %d bad datagram' % (st['rx_frames'], st['rx_seq_gaps'],
+                                                                          st['rx_errors']))
+
+        # 虚拟总线：下行帧注入接收队列，本机经 can_tx 发送的帧改发给对端
+        gw.write('vbus 1')
+        frames = list(gen_frames(40))
+        socks[1].sendto(encode(frames, seq), ('127.0.0.1', local_port + 1))
+        got = gw.expect_bus('inj', len(frames))
+        if got.get(1) != [to_host(f, esi=False) for f in frames]:
+            raise SystemExit('vbus inject mismatch')
+        for f in frames:
+            gw.frame('send', 1, f)
+        got = recv_uplink(socks, len(frames), up_seqs)[0]
+        if got[1] != frames:
+            raise SystemExit('vbus redirect mismatch')
+        print('vbus ok: %d frames each way' % len(frames))
+
+        if gw.call('stop') != ['stop']:
+            raise SystemExit('can_udp_stop failed')
+        gw.close()
+        print('host selftest ok')
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+# can_udp.c 另需的 RT-Thread 线程/信号量接口与 lwIP 名称，实现见 can_udp_host.c
+HOST_RTDEVICE_H = r'''
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#define RT_NAME_MAX 8
+#define closesocket close
+typedef struct rt_thread *rt_thread_t;
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_err_t rt_sem_init(struct rt_semaphore *sem, const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t rt_sem_take(struct rt_semaphore *sem, rt_int32_t time);
+rt_err_t rt_sem_release(struct rt_semaphore *sem);
+'''
+
+
+def cmd_selftest(args):
+    if args.host:
+        host_selftest(args)
+        return
+    rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx.bind(('127.0.0.1', 0))
+    tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    frames = list(gen_frames(2000))
+    sent, seq, batch = 0, 0, []
+    size = HEADER.size
+    for f in frames:
+        fsize = 6 + 64
+        if size + fsize > MTU:
+            tx.sendto(encode(batch, seq), rx.getsockname())
+            seq, batch, size = seq + 1, [], HEADER.size
+        batch.append(f)
+        size += 4 + (2 if f[2] else 1) + (0 if f[0] & CAN_RTR_FLAG else len(f[1]))
+        sent += 1
+    tx.sendto(encode(batch, seq), rx.getsockname())
+    got = []
+    rx.settimeout(1.0)
+    for expect_seq in range(seq + 1):
+        buf = rx.recv(65535)
+        if len(buf) > MTU:
+            raise SystemExit('datagram exceeds MTU: %d' % len(buf))
+        s, fr = decode(buf)
+        if s != expect_seq & 0xFF:
+            raise SystemExit('sequence mismatch %d != %d' % (s, expect_seq))
+        got += fr
+    if got != frames:
+        raise SystemExit('round trip mismatch')
+    print('selftest ok: %d frames, %d datagrams' % (len(got), seq + 1))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+    p = sub.add_parser('listen')
+    p.add_argument('--port', type=int, default=20000)
+    p.add_argument('--quiet', action='store_true', help='print rates only')
+    p = sub.add_parser('bridge')
+    p.add_argument('iface')
+    p.add_argument('gateway')
+    p.add_argument('--port', type=int, default=20000)
+    p.add_argument('--channel', type=int, default=0)
+    p.add_argument('--flush-ms', type=float, default=2.0)
+    p = sub.add_parser('send')
+    p.add_argument('gateway')
+    p.add_argument('--gen', type=int, default=100)
+    p.add_argument('--batch', type=int, default=8)
+    p.add_argument('--interval', type=float, default=1.0, help='ms between datagrams')
+    p.add_argument('--port', type=int, default=20000)
+    p.add_argument('--channel', type=int, default=0)
+    p = sub.add_parser('selftest')
+    p.add_argument('--host', action='store_true', help='test src/can_udp.c compiled for the host')
+    p.add_argument('--cc', help='host C compiler for --host (default $CC or cc)')
+    args = ap.parse_args()
+    {'listen': cmd_listen, 'bridge': cmd_bridge, 'send': cmd_send, 'selftest': cmd_selftest}[args.cmd](args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+网关 FFT 特征提取 (src/fft_feature.c) 的主机侧精度与耗时检查。
+
+网关 msh 命令 "fft_feature check [n] [rate]" 用整数运算生成测试帧 (三角波 + 伪随机噪声)，
+计算后把单边功率谱、特征向量 (IEEE754 十六进制) 和耗时打印到串口。本脚本逐位复现同一测试帧，
+用双精度 FFT 计算参考值，输出频谱误差、各特征的相对误差和耗时。
+
+只用标准库，不依赖 numpy。
+
+用法:
+    fft_check.py serial.log                    # 串口日志中含 FFTCHK 行，可含多次 check
+    fft_check.py serial.log --cpu-mhz 400      # 周期数换算为微秒
+    fft_check.py --selftest [--size 1024]      # 用单精度模拟代替网关输出，验证脚本本身
+"""
+import argparse
+import cmath
+import math
+import struct
+import sys
+
+FEATURE_NAMES = ['rms', 'peak', 'crest', 'dom_freq', 'dom_amp'] + ['band%d' % i for i in range(8)]
+BANDS = 8
+
+
+def f32(v):
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def from_hex(h):
+    return struct.unpack('<f', struct.pack('<I', int(h, 16)))[0]
+
+
+def test_frame(n, period):
+    """与 fft_test_frame() 一致：12 位码值乘以 f32(3.3 / 4096)"""
+    seed = 1
+    scale = f32(3.3 / 4096.0)
+    frame = []
+    for i in range(n):
+        seed = (seed * 1103515245 + 12345) & 0xFFFFFFFF
+        ph = (i % period) * 2 * 1600 // period - 1600
+        code = 2048 + abs(ph) - 800 + ((seed >> 16) & 0x3F) - 32
+        frame.append(f32(code * scale))
+    return frame
+
+
+def fft(x):
+    """基 2 迭代 FFT (复数，双精度)"""
+    n = len(x)
+    bits = n.bit_length() - 1
+    a = [x[int('{:0{w}b}'.format(i, w=bits)[::-1], 2)] for i in range(n)]
+    h = 1
+    while h < n:
+        w_step = cmath.exp(-1j * math.pi / h)
+        for g in range(0, n, 2 * h):
+            w = 1.0
+            for k in range(g, g + h):
+                t = w * a[k + h]
+                a[k + h] = a[k] - t
+                a[k] = a[k] + t
+                w *= w_step
+        h *= 2
+    return a
+
+
+def reference(frame, rate):
+    """双精度参考：去直流、Hann 窗、单边功率谱和特征，公式与设备端相同"""
+    n = len(frame)
+    m = n // 2
+    mean = sum(frame) / n
+    ac = [v - mean for v in frame]
+    rms = math.sqrt(sum(v * v for v in ac) / n)
+    peak = max(abs(v) for v in ac)
+    win = [0.5 - 0.5 * math.cos(2 * math.pi * i / n) for i in range(n)]
+    s1 = sum(win)
+    s2 = sum(w * w for w in win)
+    spec = fft([complex(ac[i] * win[i], 0) for i in range(n)])
+    mag2 = [abs(spec[k]) ** 2 for k in range(m + 1)]
+
+    kmax = max(range(1, m), key=lambda k: mag2[k])
+    a, b, c = (math.sqrt(mag2[kmax + d]) for d in (-1, 0, 1))
+    den = a - 2 * b + c
+    delta = 0.5 * (a - c) / den if den else 0.0
+    scale = 2.0 / (n * s2)
+    bands = []
+    for band in range(BANDS):
+        k0 = 1 + band * m // BANDS
+        k1 = 1 + (band + 1) * m // BANDS
+        bands.append(math.sqrt(sum(mag2[k] for k in range(k0, min(k1, m + 1))) * scale))
+    feats = [rms, peak, peak / rms if rms else 0.0, (kmax + delta) * rate / n, 2 * b / s1] + bands
+    return mag2, feats
+
+
+def simulate(n, rate, period):
+    """单精度模拟网关输出 (功率谱按 f32 舍入)，用于 --selftest"""
+    mag2, feats = reference(test_frame(n, period), rate)
+    return {'n': n, 'rate': rate, 'period': period, 'mag2': [f32(v) for v in mag2],
+            'feat': [f32(v) for v in feats], 'cycles': None}
+
+
+def parse_log(lines):
+    """按 "FFTCHK N ..." 分段，返回每次 check 的结果"""
+    runs = []
+    cur = None
+    for line in lines:
+        line = line.strip()
+        pos = line.find('FFTCHK ')
+        if pos < 0:
+            continue
+        f = line[pos:].split()
+        if f[1] == 'N':
+            cur = {'n': int(f[2]), 'rate': int(f[4]), 'period': int(f[6]), 'mag2': [], 'feat': [], 'cycles': None}
+            runs.append(cur)
+        elif cur is None:
+            continue
+        elif f[1] in ('MAG2', 'FEAT'):
+            key = f[1].lower()
+            idx = int(f[2])
+            vals = [from_hex(h) for h in f[3:]]
+            if idx != len(cur[key]):
+                raise SystemExit('FFTCHK %s: missing lines before index %d (serial log truncated?)' % (f[1], idx))
+            cur[key].extend(vals)
+        elif f[1] == 'TIME':
+            cur['cycles'] = int(f[2])
+    return runs
+
+
+def check(run, cpu_mhz):
+    n, rate = run['n'], run['rate']
+    ref_mag2, ref_feats = reference(test_frame(n, run['period']), rate)
+    if len(run['mag2']) != n // 2 + 1 or len(run['feat']) != len(FEATURE_NAMES):
+        raise SystemExit('N=%d: incomplete dump (%d bins, %d features)' % (n, len(run['mag2']), len(run['feat'])))
+
+    # 幅值谱误差，以参考谱峰值为基准
+    ref_mag = [math.sqrt(v) for v in ref_mag2]
+    dev_mag = [math.sqrt(max(v, 0.0)) for v in run['mag2']]
+    peak = max(ref_mag[1:])
+    err = [abs(d - r) for d, r in zip(dev_mag, ref_mag)]
+    noise = sum(e * e for e in err)
+    snr = 10 * math.log10(sum(r * r for r in ref_mag) / noise) if noise else float('inf')
+
+    print('N=%d rate=%d Hz' % (n, rate))
+    print('  spectrum: max |err| %.2e of peak (bin %d), SNR %.1f dB' %
+          (max(err) / peak, err.index(max(err)), snr))
+    print('  %-9s %14s %14s %10s' % ('feature', 'device', 'reference', 'rel err'))
+    worst = 0.0
+    for name, d, r in zip(FEATURE_NAMES, run['feat'], ref_feats):
+        rel = abs(d - r) / abs(r) if r else abs(d)
+        worst = max(worst, rel)
+        print('  %-9s %14.6g %14.6g %10.2e' % (name, d, r, rel))
+    if run['cycles'] is not None:
+        line = '  time: %d cycles, %.1f cycles/sample' % (run['cycles'], run['cycles'] / n)
+        if cpu_mhz:
+            line += ', %.1f us' % (run['cycles'] / cpu_mhz)
+        print(line)
+    return max(err) / peak, worst
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input', nargs='?', help='serial log with FFTCHK lines (default: stdin)')
+    ap.add_argument('--cpu-mhz', type=float, default=0, help='CPU clock for cycles -> us')
+    ap.add_argument('--tol', type=float, default=1e-4, help='max relative error (spectrum / features)')
+    ap.add_argument('--selftest', action='store_true', help='check against a single-precision simulation')
+    ap.add_argument('--size', type=int, default=1024, help='frame size for --selftest')
+    args = ap.parse_args()
+
+    if args.selftest:
+        runs = [simulate(args.size, 1000, 50)]
+    else:
+        src = open(args.input, errors='replace') if args.input else sys.stdin
+        runs = parse_log(src)
+    if not runs:
+        raise SystemExit('no FFTCHK output found')
+
+    failed = False
+    for run in runs:
+        spec_err, feat_err = check(run, args.cpu_mhz)
+        if spec_err > args.tol or feat_err > args.tol * 10:
+            print('  FAIL (tolerance %.0e)' % args.tol)
+            failed = True
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
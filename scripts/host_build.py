@@ -0,0 +1,107 @@
+# -*- coding: utf-8 -*-
+"""
+主机侧测试桩的公共部分：生成最小的 RT-Thread / BSP 头文件替身，用主机编译器编译未经修改的固件源文件。
+
+替身只覆盖被测模块用到的接口：整数类型与错误码、rt_kprintf (输出到 stderr)、rt_tick_get (单调时钟 ms)、
+互斥量与临界区 (测试桩为单线程，均为空操作)，board.h 的 CNTPCT 以纳秒计。
+模块另需的头文件 (如 hal_data.h) 由调用方经 extra_headers 提供。
+
+由 can_signal_check.py、isotp_test.py、can_udp_peer.py 等脚本导入，不单独运行。
+"""
+import os
+import subprocess
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SRC = os.path.normpath(os.path.join(HERE, '..', 'src'))
+
+RTTHREAD_H = r'''
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+typedef int8_t rt_int8_t; typedef int16_t rt_int16_t; typedef int32_t rt_int32_t; typedef int64_t rt_int64_t;
+typedef uint8_t rt_uint8_t; typedef uint16_t rt_uint16_t; typedef uint32_t rt_uint32_t; typedef uint64_t rt_uint64_t;
+typedef int rt_bool_t; typedef long rt_base_t; typedef long rt_err_t; typedef size_t rt_size_t; typedef long rt_ssize_t;
+typedef rt_uint32_t rt_tick_t;
+typedef struct rt_device *rt_device_t;
+struct rt_mutex { int locked; };
+struct rt_semaphore { int value; };
+#define RT_TRUE 1
+#define RT_FALSE 0
+#define RT_NULL NULL
+#define RT_EOK 0
+#define RT_ERROR 1
+#define RT_ETIMEOUT 2
+#define RT_EFULL 3
+#define RT_EEMPTY 4
+#define RT_ENOMEM 5
+#define RT_ENOSYS 6
+#define RT_EBUSY 7
+#define RT_EIO 8
+#define RT_EINVAL 10
+#define RT_WAITING_FOREVER -1
+#define RT_WAITING_NO 0
+#define RT_IPC_FLAG_FIFO 0
+#define RT_IPC_FLAG_PRIO 1
+#define RT_TICK_PER_SECOND 1000
+#define RT_ASSERT(x)
+#define rt_inline static inline
+#define rt_kprintf(...) fprintf(stderr, __VA_ARGS__)
+#define rt_snprintf snprintf
+#define rt_strncpy strncpy
+#define rt_memcpy memcpy
+#define rt_memset memset
+#define MSH_CMD_EXPORT(cmd, desc)
+#define INIT_APP_EXPORT(fn)
+static inline rt_tick_t rt_tick_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_tick_t)(ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000);
+}
+static inline rt_tick_t rt_tick_from_millisecond(rt_int32_t ms) { return (rt_tick_t)ms; }
+static inline rt_err_t rt_mutex_init(struct rt_mutex *m, const char *name, rt_uint8_t flag)
+{
+    (void)name; (void)flag; m->locked = 0; return RT_EOK;
+}
+static inline rt_err_t rt_mutex_take(struct rt_mutex *m, rt_int32_t t) { (void)t; m->locked++; return RT_EOK; }
+static inline rt_err_t rt_mutex_release(struct rt_mutex *m) { m->locked--; return RT_EOK; }
+static inline void rt_enter_critical(void) {}
+static inline void rt_exit_critical(void) {}
+static inline rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    return RT_EOK;
+}
+'''
+
+BOARD_H = r'''
+#include <time.h>
+static inline uint64_t __get_CNTPCT(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+static inline uint32_t __get_CNTFRQ(void) { return 1000000000U; }
+#define SystemCoreClock 1000000000U
+'''
+
+
+def build(name, sources, workdir, cc=None, extra_headers=None, cflags=()):
+    """sources 为相对 src/ 的固件源文件名或脚本目录下的测试桩路径，返回可执行文件路径"""
+    inc = os.path.join(workdir, 'inc')
+    os.makedirs(inc, exist_ok=True)
+    headers = {'rtthread.h': RTTHREAD_H, 'rtdevice.h': '', 'board.h': BOARD_H}
+    headers.update(extra_headers or {})
+    for hname, text in headers.items():
+        with open(os.path.join(inc, hname), 'w') as f:
+            f.write('#pragma once\n' + text)
+
+    exe = os.path.join(workdir, name)
+    paths = [s if os.path.isabs(s) else os.path.join(SRC, s) for s in sources]
+    cmd = [cc or os.environ.get('CC', 'cc'), '-std=gnu99', '-O2', '-ffp-contract=off', '-I', inc, '-I', SRC]
+    subprocess.run(cmd + list(cflags) + ['-o', exe] + paths, check=True)
+    return exe
@@ -0,0 +1,106 @@
+/*
+ * src/isotp.c 的主机侧测试桩，由 scripts/isotp_test.py --host 连同 isotp.c 用主机编译器编译
+ * (RT-Thread 头文件替身见 host_build.py)，不属于固件。can_tx 由本文件代替，发出的帧写到标准输出。
+ *
+ * 标准输入逐行命令：
+ *   bind <ch> <rx_id> <tx_id> <flags> <bs> <stmin>   绑定 ID 对 (十六进制 ID，flags 为 ISOTP_FLAG_*)，输出 "bind <n>"
+ *   f <id> <flags> <hex>                             收到一帧 (flags 为 CAN_FRAME_FLAG_*)，交给 isotp_input
+ * 标准输出：
+ *   f <id> <flags> <hex>                             引擎经 can_tx_send 发出的帧
+ * 两次输入之间按 isotp_poll 返回的时间调用 isotp_poll，处理超时与 STmin 节拍。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include "isotp.h"
+#include "can_tx.h"
+
+#define HOST_LINE   512
+
+int can_tx_send(rt_uint8_t channel, const CanFrame *frame, rt_uint8_t prio)
+{
+    (void)channel;
+    (void)prio;
+    printf("f %lx %x ", (unsigned long)frame->id, frame->flags);
+    for (int i = 0; i < frame->len; i++) printf("%02x", frame->data[i]);
+    printf("\n");
+    fflush(stdout);
+    return RT_EOK;
+}
+
+rt_size_t can_tx_pending(rt_uint8_t channel)
+{
+    (void)channel;
+    return 0;
+}
+
+static void host_frame(const char *args)
+{
+    CanFrame frame;
+    unsigned long id;
+    unsigned flags;
+    char hex[2 * CAN_FRAME_MAX_LEN + 1] = "";
+
+    memset(&frame, 0, sizeof(frame));
+    if (sscanf(args, "%lx %x %128s", &id, &flags, hex) < 2) return;
+    frame.id = (rt_uint32_t)id;
+    frame.flags = (rt_uint8_t)flags;
+    for (rt_size_t i = 0; i < CAN_FRAME_MAX_LEN && hex[2 * i] && hex[2 * i + 1]; i++) {
+        unsigned b;
+        sscanf(&hex[2 * i], "%2x", &b);
+        frame.data[i] = (rt_uint8_t)b;
+        frame.len = (rt_uint8_t)(i + 1);
+    }
+    isotp_input(&frame);
+}
+
+static void host_line(char *line)
+{
+    if (strncmp(line, "f ", 2) == 0) {
+        host_frame(line + 2);
+    } else if (strncmp(line, "bind ", 5) == 0) {
+        unsigned ch, flags, bs, stmin;
+        unsigned long rx, tx;
+        int n = -RT_EINVAL;
+        if (sscanf(line + 5, "%u %lx %lx %x %u %u", &ch, &rx, &tx, &flags, &bs, &stmin) == 6) {
+            n = isotp_bind((rt_uint8_t)ch, (rt_uint32_t)rx, (rt_uint32_t)tx, (rt_uint8_t)flags, (rt_uint8_t)bs,
+                           (rt_uint8_t)stmin);
+        }
+        printf("bind %d\n", n);
+        fflush(stdout);
+    }
+}
+
+int main(void)
+{
+    static char buf[HOST_LINE * 8];
+    size_t used = 0;
+
+    for (;;) {
+        rt_int32_t wait = isotp_poll();
+        struct timeval tv = { wait / 1000, (wait % 1000) * 1000 };
+        fd_set rd;
+
+        FD_ZERO(&rd);
+        FD_SET(0, &rd);
+        if (select(1, &rd, NULL, NULL, (wait < 0) ? NULL : &tv) <= 0) continue;
+
+        ssize_t n = read(0, buf + used, sizeof(buf) - used - 1);
+        if (n <= 0) break;
+        used += (size_t)n;
+        buf[used] = '\0';
+
+        char *line = buf, *end;
+        while ((end = strchr(line, '\n')) != NULL) {
+            *end = '\0';
+            host_line(line);
+            line = end + 1;
+        }
+        used -= (size_t)(line - buf);
+        memmove(buf, line, used);
+        if (used >= sizeof(buf) - 1) used = 0;     /* 超长行丢弃 */
+    }
+    return 0;
+}
@@ -0,0 +1,564 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+网关 ISO-TP 引擎 (src/isotp.c) 的主机侧测试套件，经 vcan 与网关交换 ISO-TP 报文。
+
+网关以回显模式绑定 ID 对，收到的完整报文原样发回；测试覆盖单帧/多帧/长度转义、流控参数、
+BS/STmin/WAIT 流控的遵守、序号错误与超时后的恢复、缓冲溢出、两个会话交错收发。
+
+连接方式 (无 CAN 硬件，网关作为 vcan 上的一个节点):
+    sudo ip link add dev vcan0 type vcan && sudo ip link set vcan0 mtu 72 up
+    can_udp_peer.py bridge vcan0 <gw_ip>                 # 或 cannelloni
+    网关 msh: can_udp start <host_ip>
+              can_udp vbus on
+              isotp bind 0 7E0 7E8 8 0 echo
+              isotp bind 0 7E1 7E9 8 0 echo              # 并发会话测试用
+
+用法:
+    isotp_test.py vcan0 [--tx 0x7E0 --rx 0x7E8] [--tx2 0x7E1 --rx2 0x7E9] [--bs 8] [--stmin 0]
+    isotp_test.py --selftest [vcan0]   # 用 Python 参考实现代替网关，验证测试套件本身
+    isotp_test.py --host [--cc gcc]    # 用主机编译器编译 src/isotp.c (测试桩 isotp_host.c)，不经网关直接测试引擎
+"""
+import argparse
+import os
+import queue
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from can_replay import CAN_EFF_FLAG, CAN_FRAME, CANFD_FRAME, FD_LENGTHS, CANFD_BRS, pack, open_socket
+
+PAD = 0xCC
+TIMEOUT = 1.0           # N_Bs / N_Cr，与 ISOTP_TIMEOUT_MS 一致
+MAX_LEN = 8192 - 32     # ISOTP_MAX_LEN
+
+# --host 时与 isotp_host.c 交换的标志：CAN_FRAME_FLAG_* 与 ISOTP_FLAG_*
+HOST_FLAG_EXT = 0x01
+HOST_FLAG_FD = 0x04
+ISOTP_FLAG_EXT = 0x01
+ISOTP_FLAG_FD = 0x02
+ISOTP_FLAG_ECHO = 0x08
+
+
+class IsoTpError(Exception):
+    pass
+
+
+class SocketCanBus:
+    """SocketCAN 接口，后台线程按 CAN ID 分发接收帧"""
+
+    def __init__(self, iface):
+        self.sock = open_socket(iface)
+        self.queues = {}
+        self.lock = threading.Lock()
+        threading.Thread(target=self._reader, daemon=True).start()
+
+    def _reader(self):
+        while True:
+            buf = self.sock.recv(CANFD_FRAME.size)
+            if len(buf) == CANFD_FRAME.size:
+                can_id, length, _, data = CANFD_FRAME.unpack(buf)
+            else:
+                can_id, length, data = CAN_FRAME.unpack(buf)
+            self._deliver(can_id, data[:length])
+
+    def _deliver(self, can_id, data):
+        with self.lock:
+            q = self.queues.setdefault(can_id, queue.Queue())
+        q.put((time.monotonic(), data))
+
+    def queue(self, can_id):
+        with self.lock:
+            return self.queues.setdefault(can_id, queue.Queue())
+
+    def send(self, can_id, data, fd):
+        self.sock.send(pack(can_id, data, fd, CANFD_BRS if fd else 0))
+
+
+class LoopBus(SocketCanBus):
+    """进程内总线 (无 vcan 时自测用)，两个端点互为对端"""
+
+    def __init__(self):
+        self.queues = {}
+        self.lock = threading.Lock()
+        self.peer = None
+
+    @staticmethod
+    def pair():
+        a, b = LoopBus(), LoopBus()
+        a.peer, b.peer = b, a
+        return a, b
+
+    def send(self, can_id, data, fd):
+        if fd:
+            data = data.ljust(next(n for n in FD_LENGTHS if n >= len(data)), b'\0')
+        self.peer._deliver(can_id, bytes(data))
+
+
+class HostBus(SocketCanBus):
+    """主机编译的 isotp.c 引擎 (isotp_host.c)，经标准输入/输出交换帧，扮演网关一端"""
+
+    def __init__(self, exe):
+        self.queues = {}
+        self.lock = threading.Lock()
+        self.proc = subprocess.Popen([exe], stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=1,
+                                     universal_newlines=True)
+        self.binds = queue.Queue()
+        threading.Thread(target=self._reader, daemon=True).start()
+
+    def _reader(self):
+        for line in self.proc.stdout:
+            words = line.split()
+            if words[0] == 'bind':
+                self.binds.put(int(words[1]))
+            elif words[0] == 'f':
+                can_id, flags = int(words[1], 16), int(words[2], 16)
+                data = bytes.fromhex(words[3]) if len(words) > 3 else b''
+                self._deliver(can_id | (CAN_EFF_FLAG if flags & HOST_FLAG_EXT else 0), data)
+
+    def _write(self, line):
+        with self.lock:
+            self.proc.stdin.write(line + '\n')
+            self.proc.stdin.flush()
+
+    def bind(self, rx_id, tx_id, flags, bs, stmin):
+        self._write('bind 0 %x %x %x %d %d' % (rx_id & ~CAN_EFF_FLAG, tx_id & ~CAN_EFF_FLAG, flags, bs, stmin))
+        n = self.binds.get(timeout=5.0)
+        if n < 0:
+            raise IsoTpError('isotp_bind failed (%d)' % n)
+
+    def send(self, can_id, data, fd):
+        flags = (HOST_FLAG_EXT if can_id & CAN_EFF_FLAG else 0) | (HOST_FLAG_FD if fd else 0)
+        self._write('f %x %x %s' % (can_id & ~CAN_EFF_FLAG, flags, bytes(data).hex()))
+
+    def close(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+class Link:
+    """一个 ISO-TP 会话 (普通寻址)，bs/stmin 为本端接收时回复的流控参数"""
+
+    def __init__(self, bus, tx_id, rx_id, fd=False, bs=0, stmin=0, max_len=MAX_LEN):
+        self.bus = bus
+        self.tx_id = tx_id
+        self.rx_id = rx_id
+        self.rxq = bus.queue(rx_id)
+        self.fd = fd
+        self.dl = 64 if fd else 8
+        self.bs = bs
+        self.stmin = stmin
+        self.max_len = max_len
+        self.sent = []          # (时间, 帧数据)，供测试检查发送时序
+        self.fc_hook = None     # fc_hook(block_index) -> [(延迟 s, FC 帧数据)]，None 时回复默认 CTS
+
+    def send_frame(self, data):
+        length = 8 if len(data) <= 8 else next(n for n in FD_LENGTHS if n >= len(data))
+        data = bytes(data).ljust(length, bytes([PAD]))
+        self.bus.send(self.tx_id, data, self.fd)
+        self.sent.append((time.monotonic(), data))
+
+    def recv_frame(self, timeout):
+        try:
+            return self.rxq.get(timeout=timeout)
+        except queue.Empty:
+            return None, None
+
+    def flush(self):
+        while self.recv_frame(0)[1] is not None:
+            pass
+
+    # ---- 发送 ----
+    def send(self, msg):
+        msg = bytes(msg)
+        if len(msg) <= 7:
+            self.send_frame(bytes([len(msg)]) + msg)
+            return
+        if self.fd and len(msg) <= 62:
+            self.send_frame(bytes([0, len(msg)]) + msg)
+            return
+        if len(msg) <= 4095:
+            head = bytes([0x10 | (len(msg) >> 8), len(msg) & 0xFF])
+        else:
+            head = bytes([0x10, 0]) + struct.pack('>I', len(msg))
+        pos = self.dl - len(head)
+        self.send_frame(head + msg[:pos])
+        sn = 1
+        while pos < len(msg):
+            bs, stmin = self.wait_fc()
+            sent = 0
+            while pos < len(msg) and (bs == 0 or sent < bs):
+                if sent or stmin:
+                    time.sleep(stmin)
+                chunk = msg[pos:pos + self.dl - 1]
+                self.send_frame(bytes([0x20 | sn]) + chunk)
+                pos += len(chunk)
+                sn = (sn + 1) & 0x0F
+                sent += 1
+
+    def wait_fc(self):
+        while True:
+            _, fc = self.recv_frame(TIMEOUT)
+            if fc is None:
+                raise IsoTpError('N_Bs timeout waiting for flow control')
+            if fc[0] >> 4 != 3:
+                continue
+            fs = fc[0] & 0x0F
+            if fs == 0:
+                st = fc[2]
+                stmin = st / 1000.0 if st <= 0x7F else ((st - 0xF0) / 10000.0 if 0xF1 <= st <= 0xF9 else 0.127)
+                return fc[1], stmin
+            if fs == 1:
+                continue
+            if fs == 2:
+                raise IsoTpError('overflow')
+            raise IsoTpError('invalid flow status %d' % fs)
+
+    # ---- 接收 ----
+    def send_fc(self, block):
+        """回复流控帧，返回最后一个 CTS 中的 BS"""
+        fcs = self.fc_hook(block) if self.fc_hook else [(0, bytes([0x30, self.bs, self.stmin]))]
+        for delay, fc in fcs:
+            time.sleep(delay)
+            self.send_frame(fc)
+        return fcs[-1][1][1]
+
+    def recv(self, timeout=TIMEOUT):
+        """接收一条完整报文，返回 (报文, 各帧接收时间)；接收中途的新 SF/FF 打断当前报文"""
+        t, f = self.recv_frame(timeout)
+        while True:
+            if f is None:
+                raise IsoTpError('timeout waiting for message')
+            pci = f[0] >> 4
+            if pci == 0:
+                if f[0] & 0x0F:
+                    return f[1:1 + (f[0] & 0x0F)], [t]
+                return f[2:2 + f[1]], [t]
+            if pci != 1:
+                t, f = self.recv_frame(timeout)
+                continue
+            length = ((f[0] & 0x0F) << 8) | f[1]
+            off = 2
+            if length == 0:
+                length = struct.unpack_from('>I', f, 2)[0]
+                off = 6
+            if length > self.max_len:
+                self.send_frame(bytes([0x32, 0, 0]))
+                t, f = self.recv_frame(timeout)
+                continue
+            done, t, f = self._recv_cfs(length, f[off:], t)
+            if done:
+                return f, t
+
+    def _recv_cfs(self, length, first, t0):
+        """接收连续帧；完成时返回 (True, 各帧时间, 报文)，被新 SF/FF 打断时返回 (False, 时间, 新帧)"""
+        data = bytearray(first)
+        times = [t0]
+        sn, block, cnt = 1, 0, 0
+        bs = self.send_fc(block)
+        while len(data) < length:
+            t, f = self.recv_frame(TIMEOUT)
+            if f is None:
+                raise IsoTpError('N_Cr timeout after %d of %d bytes' % (len(data), length))
+            if f[0] >> 4 in (0, 1):
+                return False, t, f
+            if f[0] >> 4 != 2:
+                continue
+            if f[0] & 0x0F != sn:
+                raise IsoTpError('sequence error: got %d, expected %d' % (f[0] & 0x0F, sn))
+            data += f[1:1 + length - len(data)]
+            times.append(t)
+            sn = (sn + 1) & 0x0F
+            cnt += 1
+            if bs and cnt == bs and len(data) < length:
+                block += 1
+                cnt = 0
+                bs = self.send_fc(block)
+        return True, times, bytes(data)
+
+
+def pattern(n, seed=0):
+    return bytes((i * 7 + seed) & 0xFF for i in range(n))
+
+
+# ---- 测试用例 ----
+def echo(link, msg, timeout=5.0):
+    link.flush()
+    link.send(msg)
+    got, times = link.recv(timeout)
+    assert got == msg, 'echo mismatch: sent %d bytes, got %d bytes' % (len(msg), len(got))
+    return times
+
+
+def test_single_frames(ctx):
+    for n in range(1, 8):
+        echo(ctx.link, pattern(n, n))
+
+
+def test_multi_frame(ctx):
+    for n in (8, 9, 62, 63, 64, 100, 255, 256, 1000, 4095):
+        echo(ctx.link, pattern(n, n))
+
+
+def test_escape_length(ctx):
+    echo(ctx.link, pattern(5000, 3), timeout=20.0)
+
+
+def test_device_flow_control(ctx):
+    """网关回复的流控帧：CTS，BS/STmin 与绑定一致，每 BS 个连续帧后再次回复"""
+    link = ctx.link
+    bs = ctx.args.bs
+    step = link.dl - 1
+    msg = pattern((bs + 1) * step + link.dl if bs else 4 * step, 8)
+    link.flush()
+
+    def expect_fc():
+        _, fc = link.recv_frame(TIMEOUT)
+        assert fc is not None, 'no flow control frame'
+        assert fc[0] == 0x30, 'flow status 0x%02X' % fc[0]
+        assert fc[1] == bs and fc[2] == ctx.args.stmin, 'FC BS=%d STmin=0x%02X' % (fc[1], fc[2])
+
+    pos = link.dl - 2
+    link.send_frame(bytes([0x10 | (len(msg) >> 8), len(msg) & 0xFF]) + msg[:pos])
+    expect_fc()
+    sn = 1
+    while pos < len(msg):
+        if bs and sn > 1 and (sn - 1) % bs == 0:
+            expect_fc()
+        link.send_frame(bytes([0x20 | (sn & 0x0F)]) + msg[pos:pos + step])
+        pos += step
+        sn += 1
+        time.sleep(ctx.args.stmin / 1000.0)
+    got, _ = link.recv(5.0)
+    assert got == msg, 'echo mismatch'
+
+
+def test_honours_block_size(ctx):
+    """本端回复 BS=4：每 4 个连续帧后网关必须停下等待下一个流控帧"""
+    link = ctx.link
+    hold = 0.2
+    link.fc_hook = lambda block: [(hold if block else 0, bytes([0x30, 4, 0]))]
+    try:
+        n = 4 * 4 * 7 + 20
+        times = echo(link, pattern(n, 9), timeout=10.0)
+    finally:
+        link.fc_hook = None
+    # times[0] 为 FF，之后每 4 个 CF 一块，块间至少间隔 hold
+    cfs = times[1:]
+    for k in range(4, len(cfs), 4):
+        gap = cfs[k] - cfs[k - 1]
+        assert gap >= hold - 0.02, 'CF %d sent %.1f ms after previous block, before FC' % (k, gap * 1000)
+
+
+def test_honours_stmin(ctx):
+    """本端回复 STmin=10 ms：连续帧间隔不小于 STmin (允许 UDP 聚合抖动)"""
+    link = ctx.link
+    link.fc_hook = lambda block: [(0, bytes([0x30, 0, 10]))]
+    try:
+        times = echo(link, pattern(20 * 7, 5), timeout=10.0)
+    finally:
+        link.fc_hook = None
+    gaps = [b - a for a, b in zip(times[1:], times[2:])]
+    avg = sum(gaps) / len(gaps)
+    assert avg >= 0.010 - 0.001, 'average CF gap %.2f ms < STmin' % (avg * 1000)
+    assert min(gaps) >= 0.010 - ctx.args.jitter / 1000.0, 'min CF gap %.2f ms' % (min(gaps) * 1000)
+
+
+def test_wait_flow_control(ctx):
+    """本端先回复两次 WAIT 再 CTS，网关应继续发送"""
+    link = ctx.link
+    link.fc_hook = lambda block: [(0, bytes([0x31, 0, 0])), (0.3, bytes([0x31, 0, 0])), (0.3, bytes([0x30, 0, 0]))]
+    try:
+        echo(link, pattern(50, 1), timeout=10.0)
+    finally:
+        link.fc_hook = None
+
+
+def test_sequence_error_recovery(ctx):
+    link = ctx.link
+    link.flush()
+    msg = pattern(30)
+    link.send_frame(bytes([0x10, len(msg)]) + msg[:6])
+    link.wait_fc()
+    link.send_frame(bytes([0x22]) + msg[6:13])     # 跳过 SN 1
+    link.send_frame(bytes([0x23]) + msg[13:20])
+    try:
+        got, _ = link.recv(0.5)
+        raise AssertionError('gateway echoed a message with a sequence gap (%d bytes)' % len(got))
+    except IsoTpError:
+        pass
+    echo(link, pattern(40, 2))
+
+
+def test_timeout_recovery(ctx):
+    link = ctx.link
+    link.flush()
+    msg = pattern(30)
+    link.send_frame(bytes([0x10, len(msg)]) + msg[:6])
+    link.wait_fc()
+    time.sleep(TIMEOUT + 0.3)
+    link.send_frame(bytes([0x21]) + msg[6:13])      # N_Cr 超时后的 CF 应被忽略
+    try:
+        got, _ = link.recv(0.5)
+        raise AssertionError('gateway accepted CF after N_Cr timeout')
+    except IsoTpError:
+        pass
+    echo(link, pattern(20, 4))
+
+
+def test_interrupted_by_new_message(ctx):
+    """未完成的报文被新 FF 打断时，按新报文接收"""
+    link = ctx.link
+    link.flush()
+    link.send_frame(bytes([0x10, 50]) + pattern(6))
+    link.wait_fc()
+    echo(link, pattern(25, 6))
+
+
+def test_overflow(ctx):
+    link = ctx.link
+    link.flush()
+    link.send_frame(bytes([0x10, 0]) + struct.pack('>I', MAX_LEN + 1) + pattern(2))
+    try:
+        link.wait_fc()
+        raise AssertionError('gateway accepted FF_DL %d' % (MAX_LEN + 1))
+    except IsoTpError as e:
+        assert str(e) == 'overflow', str(e)
+    echo(link, pattern(10))
+
+
+def test_concurrent_sessions(ctx):
+    """两个 ID 对的报文在总线上交错，网关分别组包并回显"""
+    if ctx.link2 is None:
+        return 'skipped (no --tx2/--rx2)'
+    a, b = ctx.link, ctx.link2
+    a.flush()
+    b.flush()
+    ma, mb = pattern(200, 1), pattern(300, 2)
+    results = {}
+
+    def run(link, msg, key):
+        try:
+            link.send(msg)
+            results[key] = link.recv(10.0)[0]
+        except Exception as e:  # noqa: BLE001 - 在主线程中报告
+            results[key] = e
+
+    threads = [threading.Thread(target=run, args=(a, ma, 'a')), threading.Thread(target=run, args=(b, mb, 'b'))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert results.get('a') == ma, 'session A: %r' % (results.get('a'),)
+    assert results.get('b') == mb, 'session B: %r' % (results.get('b'),)
+
+
+TESTS = [
+    test_single_frames, test_multi_frame, test_escape_length, test_device_flow_control,
+    test_honours_block_size, test_honours_stmin, test_wait_flow_control, test_sequence_error_recovery,
+    test_timeout_recovery, test_interrupted_by_new_message, test_overflow, test_concurrent_sessions,
+]
+
+
+def reference_gateway(bus, pairs, bs, stmin, fd):
+    """网关回显绑定的 Python 参考实现，--selftest 时代替网关"""
+    def serve(tx_id, rx_id):
+        link = Link(bus, tx_id, rx_id, fd=fd, bs=bs, stmin=stmin)
+        while True:
+            try:
+                msg, _ = link.recv(None)
+                link.send(msg)
+            except IsoTpError:
+                pass
+
+    for host_tx, host_rx in pairs:
+        threading.Thread(target=serve, args=(host_rx, host_tx), daemon=True).start()
+
+
+def host_gateway(pairs, args, workdir):
+    """编译 isotp.c 与测试桩，按网关的回显绑定方式绑定各 ID 对"""
+    import host_build
+    exe = host_build.build('isotp_host', [os.path.join(host_build.HERE, 'isotp_host.c'), 'isotp.c'], workdir, args.cc)
+    bus = HostBus(exe)
+    flags = ISOTP_FLAG_ECHO | (ISOTP_FLAG_EXT if args.ext else 0) | (ISOTP_FLAG_FD if args.fd else 0)
+    for host_tx, host_rx in pairs:
+        bus.bind(host_tx, host_rx, flags, args.bs, args.stmin)
+    return bus
+
+
+class Context:
+    pass
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('iface', nargs='?', help='SocketCAN interface (vcan0)')
+    ap.add_argument('--tx', type=lambda s: int(s, 16), default=0x7E0, help='ID the host sends on (hex)')
+    ap.add_argument('--rx', type=lambda s: int(s, 16), default=0x7E8, help='ID the gateway replies on (hex)')
+    ap.add_argument('--tx2', type=lambda s: int(s, 16), help='second ID pair for the concurrency test')
+    ap.add_argument('--rx2', type=lambda s: int(s, 16))
+    ap.add_argument('--bs', type=int, default=8, help='block size configured on the gateway binding')
+    ap.add_argument('--stmin', type=int, default=0, help='STmin configured on the gateway binding')
+    ap.add_argument('--fd', action='store_true', help='binding uses CAN-FD frames')
+    ap.add_argument('--ext', action='store_true', help='29-bit IDs')
+    ap.add_argument('--jitter', type=float, default=3.0, help='allowed timing jitter in ms (UDP batching)')
+    ap.add_argument('--selftest', action='store_true', help='test against the Python reference gateway')
+    ap.add_argument('--host', action='store_true', help='test src/isotp.c compiled for the host')
+    ap.add_argument('--cc', help='host C compiler for --host (default $CC or cc)')
+    ap.add_argument('-k', help='run only tests whose name contains this string')
+    args = ap.parse_args()
+
+    flag = CAN_EFF_FLAG if args.ext else 0
+    pairs = [(args.tx | flag, args.rx | flag)]
+    if args.tx2 is not None and args.rx2 is not None:
+        pairs.append((args.tx2 | flag, args.rx2 | flag))
+    elif args.selftest or args.host:
+        pairs.append(((args.tx + 1) | flag, (args.rx + 1) | flag))
+
+    workdir = None
+    if args.host:
+        workdir = tempfile.mkdtemp(prefix='isotp_host_')
+        host_bus = host_gateway(pairs, args, workdir)
+        args.jitter = 2.0
+    elif args.selftest:
+        if args.iface:
+            host_bus, gw_bus = SocketCanBus(args.iface), SocketCanBus(args.iface)
+        else:
+            host_bus, gw_bus = LoopBus.pair()
+            args.jitter = 2.0
+        reference_gateway(gw_bus, pairs, args.bs, args.stmin, args.fd)
+    elif args.iface:
+        host_bus = SocketCanBus(args.iface)
+    else:
+        ap.error('interface required (or --selftest)')
+
+    ctx = Context()
+    ctx.args = args
+    ctx.link = Link(host_bus, pairs[0][0], pairs[0][1], fd=args.fd)
+    ctx.link2 = Link(host_bus, pairs[1][0], pairs[1][1], fd=args.fd) if len(pairs) > 1 else None
+
+    failed = 0
+    for test in TESTS:
+        if args.k and args.k not in test.__name__:
+            continue
+        t0 = time.monotonic()
+        try:
+            note = test(ctx)
+            print('PASS  %-32s %6.0f ms%s' % (test.__name__, (time.monotonic() - t0) * 1000,
+                                             '  ' + note if note else ''))
+        except (AssertionError, IsoTpError) as e:
+            failed += 1
+            print('FAIL  %-32s %s' % (test.__name__, e))
+    print('%d failed' % failed if failed else 'all passed')
+    if workdir:
+        host_bus.close()
+        shutil.rmtree(workdir, ignore_errors=True)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
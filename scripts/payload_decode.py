@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+解码网关二进制遥测报文 (src/payload_codec.h)，输出与 OneNET 物模型一致的 JSON。
+
+字段名和类型取自 thing_model.json，保证云端/主机侧与设备端使用同一份物模型。
+
+用法:
+    payload_decode.py <file.bin>          # 原始二进制
+    payload_decode.py up1.bin up2.bin ... # 多条报文，分段上报的 ISO-TP 报文拼接为完整报文
+    payload_decode.py --hex EB0100...     # 十六进制字符串
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0xEB
+SCHEMA_VERSION = 1
+HEADER = struct.Struct('<BBBBI')
+CAN_ID_EXT = 0x80000000
+FLAG_LZ = 0x01
+
+# Tag -> 物模型属性标识符，顺序即编码顺序
+SCHEMA = {
+    1: ('can', ['can_id', 'can_data']),
+    2: ('adc', ['voltage', 'raw_adc']),
+    3: ('canfd', ['can_id', 'can_flags', 'can_data']),
+    4: ('can', ['can_ts', 'can_id', 'can_data']),
+    5: ('canfd', ['can_ts', 'can_id', 'can_flags', 'can_data']),
+    6: ('isotp', ['can_ts', 'isotp_id', 'isotp_len', 'isotp_offset', 'isotp_data']),
+    7: ('j1939', ['can_ts', 'j1939_pgn', 'j1939_sa', 'j1939_da', 'j1939_prio', 'j1939_data']),
+    8: ('can_health', ['can_bus_ch', 'can_bus_state', 'can_tec', 'can_rec', 'can_bus_load', 'can_frame_rate',
+                       'can_err_rate', 'can_bus_off']),
+    9: ('adc_stats', ['adc_count', 'adc_mean', 'adc_std', 'adc_min', 'adc_max', 'adc_p50', 'adc_p95', 'adc_p99',
+                      'adc_min_ts', 'adc_max_ts']),
+    10: ('fft_feature', ['fft_size', 'fft_rate', 'fft_rms', 'fft_peak', 'fft_crest', 'fft_dom_freq', 'fft_dom_amp',
+                         'fft_band_rms']),
+    11: ('adc_alarm', ['adc_alarm_ch', 'adc_alarm_state', 'adc_alarm_raw', 'adc_alarm_voltage', 'adc_alarm_ts']),
+    12: ('adc_vertex', ['adc_vtx_ch', 'adc_vtx_ts', 'adc_vtx_v']),
+    13: ('wave_chunk', ['wave_id', 'wave_seq', 'wave_chunks', 'wave_src', 'wave_ch', 'wave_adds', 'wave_rate', 'wave_ts',
+                        'wave_pre', 'wave_post', 'wave_offset', 'wave_data']),
+    14: ('isotp', ['can_ts', 'isotp_id', 'isotp_len', 'isotp_offset', 'isotp_data']),
+}
+TAG_TS_BASE = {4: 1, 5: 3}  # 带微秒时间戳的记录 -> 基础记录
+
+DEFAULT_MODEL = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'thing_model.json')
+
+
+def load_model(path):
+    with open(path, encoding='utf-8') as f:
+        props = json.load(f)['properties']
+    model = {p['identifier']: p['dataType']['type'] for p in props}
+    for tag, (_, fields) in SCHEMA.items():
+        for name in fields:
+            if name not in model:
+                raise SystemExit('thing_model.json has no property "%s" (tag %d)' % (name, tag))
+    return model
+
+
+def decode_record(tag, buf, pos):
+    if tag == 6:
+        # ISO-TP 报文总带毫秒内 us，与 CAN_TS 记录一样由 decode() 补全 can_ts
+        us, can_id, length = struct.unpack_from('<HIH', buf, pos)
+        pos += 8
+        data = buf[pos:pos + length]
+        return {'isotp_id': '0x%08X' % (can_id & ~CAN_ID_EXT), 'ext': bool(can_id & CAN_ID_EXT),
+                'isotp_len': length, 'isotp_offset': 0, 'isotp_data': data.hex().upper(), 'us': us}, pos + length
+    if tag == 14:
+        # 分段上报的 ISO-TP 报文，按 (isotp_id, can_ts) 归并、按 isotp_offset 拼接，见 join_isotp()
+        us, can_id, total, offset, length = struct.unpack_from('<HIHHH', buf, pos)
+        pos += 12
+        data = buf[pos:pos + length]
+        return {'isotp_id': '0x%08X' % (can_id & ~CAN_ID_EXT), 'ext': bool(can_id & CAN_ID_EXT),
+                'isotp_len': total, 'isotp_offset': offset, 'isotp_data': data.hex().upper(), 'us': us}, pos + length
+    if tag == 7:
+        # J1939 PGN 级报文，pgn 字段 bit24-26 为优先级
+        us, pgn, sa, da, length = struct.unpack_from('<HIBBH', buf, pos)
+        pos += 10
+        data = buf[pos:pos + length]
+        return {'j1939_pgn': pgn & 0x3FFFF, 'j1939_sa': sa, 'j1939_da': da, 'j1939_prio': (pgn >> 24) & 7,
+                'j1939_data': data.hex().upper(), 'us': us}, pos + length
+    if tag in TAG_TS_BASE:
+        # 硬件接收时间 = 基准 + 增量 (ms) + 毫秒内 us，由 decode() 补全 can_ts
+        (us,) = struct.unpack_from('<H', buf, pos)
+        fields, pos = decode_record(TAG_TS_BASE[tag], buf, pos + 2)
+        fields['us'] = us
+        return fields, pos
+    if tag == 1:
+        can_id, length = struct.unpack_from('<IB', buf, pos)
+        pos += 5
+        data = buf[pos:pos + length]
+        pos += length
+        ext = bool(can_id & CAN_ID_EXT)
+        return {'can_id': '0x%08X' % (can_id & ~CAN_ID_EXT), 'ext': ext,
+                'can_data': data.hex().upper()}, pos
+    if tag == 3:
+        can_id, fd_flags, length = struct.unpack_from('<IBB', buf, pos)
+        pos += 6
+        data = buf[pos:pos + length]
+        pos += length
+        ext = bool(can_id & CAN_ID_EXT)
+        return {'can_id': '0x%08X' % (can_id & ~CAN_ID_EXT), 'ext': ext,
+                'brs': bool(fd_flags & 0x01), 'esi': bool(fd_flags & 0x02),
+                'can_data': data.hex().upper()}, pos
+    if tag == 8:
+        ch, state, tec, rec, load, rate, err, bus_off = struct.unpack_from('<BBBBHIHH', buf, pos)
+        return {'can_bus_ch': ch, 'can_bus_state': state, 'can_tec': tec, 'can_rec': rec,
+                'can_bus_load': load / 10.0, 'can_frame_rate': rate, 'can_err_rate': err,
+                'can_bus_off': bus_off}, pos + 14
+    if tag == 9:
+        # 上报周期统计，时间为启动后毫秒，按物模型换算为秒
+        count, mean, std, vmin, vmax, p50, p95, p99, t_min, t_max = struct.unpack_from('<I7f2I', buf, pos)
+        fields = {'adc_count': count, 'adc_min_ts': t_min / 1000.0, 'adc_max_ts': t_max / 1000.0}
+        for name, v in zip(SCHEMA[9][1][1:8], (mean, std, vmin, vmax, p50, p95, p99)):
+            fields[name] = round(v, 4)
+        return fields, pos + 40
+    if tag == 10:
+        # 频谱特征，频带为 0..rate/2 等分
+        size, rate, rms, peak, crest, freq, amp, bands = struct.unpack_from('<HI5fB', buf, pos)
+        band_rms = struct.unpack_from('<%df' % bands, buf, pos + 27)
+        return {'fft_size': size, 'fft_rate': rate, 'fft_rms': round(rms, 6), 'fft_peak': round(peak, 6),
+                'fft_crest': round(crest, 3), 'fft_dom_freq': round(freq, 2), 'fft_dom_amp': round(amp, 6),
+                'fft_band_rms': [round(v, 6) for v in band_rms]}, pos + 27 + 4 * bands
+    if tag == 11:
+        # 报警边沿，时间为比较中断时刻 (启动后 ms + 毫秒内 us)
+        chan, state, raw, voltage, t_ms, us = struct.unpack_from('<BBHfIH', buf, pos)
+        return {'adc_alarm_ch': chan, 'adc_alarm_state': state, 'adc_alarm_raw': raw,
+                'adc_alarm_voltage': round(voltage, 4),
+                'adc_alarm_ts': float('%d.%06d' % (t_ms // 1000, t_ms % 1000 * 1000 + us))}, pos + 14
+    if tag == 12:
+        # 旋转门压缩顶点，时间为首顶点 (启动后 ms) 加逐个间隔，重建见 sdt_reconstruct.py
+        chan, n, t = struct.unpack_from('<BBI', buf, pos)
+        ts, volts = [], []
+        for i in range(n):
+            dt, v = struct.unpack_from('<Hf', buf, pos + 6 + 6 * i)
+            t += dt
+            ts.append(t / 1000.0)
+            volts.append(round(v, 6))
+        return {'adc_vtx_ch': chan, 'adc_vtx_ts': ts, 'adc_vtx_v': volts}, pos + 6 + 6 * n
+    if tag == 13:
+        # 触发捕获的一块原始码值 (小端 16 位，按扫描交错)，与 JSON 一样输出十六进制，重组见 wave_assemble.py
+        (cid, seq, chunks, src, channels, rate, t_ms, us, pre, post, offset,
+         scans) = struct.unpack_from('<HHHBBIIHIIIH', buf, pos)
+        pos += 32
+        chans = list(buf[pos:pos + 2 * channels:2])
+        adds = list(buf[pos + 1:pos + 2 * channels:2])
+        pos += 2 * channels
+        size = 2 * scans * channels
+        return {'wave_id': cid, 'wave_seq': seq, 'wave_chunks': chunks, 'wave_src': src, 'wave_ch': chans,
+                'wave_adds': adds, 'wave_rate': rate,
+                'wave_ts': float('%d.%06d' % (t_ms // 1000, t_ms % 1000 * 1000 + us)), 'wave_pre': pre,
+                'wave_post': post, 'wave_offset': offset, 'wave_data': buf[pos:pos + size].hex().upper()}, pos + size
+    if tag == 2:
+        voltage, raw = struct.unpack_from('<fi', buf, pos)
+        return {'voltage': round(voltage, 4), 'raw_adc': raw}, pos + 8
+    raise ValueError('unknown tag %d at offset %d' % (tag, pos - 3))
+
+
+def lz4_block_decompress(src, size):
+    """LZ4 block 解码 (src/lz_compress.c 的输出格式)"""
+    out = bytearray()
+    i = 0
+    while i < len(src):
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i >= len(src):
+            break
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        mlen = token & 0x0F
+        if mlen == 15:
+            while True:
+                b = src[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+        start = len(out) - offset
+        if offset == 0 or start < 0:
+            raise ValueError('corrupt LZ stream')
+        for k in range(mlen):
+            out.append(out[start + k])
+    if len(out) != size:
+        raise ValueError('LZ size mismatch: %d != %d' % (len(out), size))
+    return bytes(out)
+
+
+def decode(buf):
+    magic, version, flags, count, base = HEADER.unpack_from(buf, 0)
+    if magic != MAGIC:
+        raise ValueError('bad magic 0x%02X' % magic)
+    if version != SCHEMA_VERSION:
+        raise ValueError('unsupported schema version %d' % version)
+    if flags & FLAG_LZ:
+        raw_len, = struct.unpack_from('<H', buf, HEADER.size)
+        buf = buf[:HEADER.size] + lz4_block_decompress(buf[HEADER.size + 2:], raw_len)
+
+    records = []
+    pos = HEADER.size
+    for _ in range(count):
+        tag, delta = struct.unpack_from('<BH', buf, pos)
+        pos += 3
+        fields, pos = decode_record(tag, buf, pos)
+        fields['type'] = SCHEMA[tag][0]
+        fields['tick'] = (base + delta) & 0xFFFFFFFF
+        if 'us' in fields:
+            us = fields.pop('us')
+            fields['can_ts'] = float('%d.%06d' % (fields['tick'] // 1000, fields['tick'] % 1000 * 1000 + us))
+        records.append(fields)
+    return {'flags': flags, 'base_tick': base, 'records': records}
+
+
+def join_isotp(records):
+    """把分段上报的 ISO-TP 记录 (可来自多条报文) 拼成完整报文，缺段的报文保持分段不变"""
+    out, parts = [], {}
+    for r in records:
+        if r.get('type') != 'isotp' or r['isotp_len'] * 2 == len(r['isotp_data']):
+            out.append(r)
+            continue
+        parts.setdefault((r['isotp_id'], r['can_ts']), []).append(r)
+    for segs in parts.values():
+        data, total = {}, segs[0]['isotp_len']
+        for r in segs:
+            data[r['isotp_offset']] = bytes.fromhex(r['isotp_data'])
+        joined, pos = b'', 0
+        while pos in data:
+            joined += data[pos]
+            pos += len(data[pos])
+        if len(joined) != total:
+            out += segs
+            continue
+        rec = dict(segs[0], isotp_offset=0, isotp_data=joined.hex().upper())
+        out.append(rec)
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input', nargs='*', help='binary payload files (default: stdin)')
+    ap.add_argument('--hex', help='payload as hex string')
+    ap.add_argument('--model', default=DEFAULT_MODEL, help='thing_model.json path')
+    args = ap.parse_args()
+
+    load_model(args.model)
+    if args.hex:
+        buf = bytes.fromhex(args.hex)
+    elif len(args.input) > 1:
+        # 多条报文：合并记录并拼接分段上报的 ISO-TP 报文
+        records = []
+        for path in args.input:
+            with open(path, 'rb') as f:
+                records += decode(f.read())['records']
+        print(json.dumps({'records': join_isotp(records)}, ensure_ascii=False, indent=2))
+        return
+    elif args.input:
+        with open(args.input[0], 'rb') as f:
+            buf = f.read()
+    else:
+        buf = sys.stdin.buffer.read()
+
+    print(json.dumps(decode(buf), ensure_ascii=False, indent=2))
+
+
+if __name__ == '__main__':
+    main()
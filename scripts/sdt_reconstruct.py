@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+旋转门压缩顶点 (src/sdt_compress.c) 的主机侧重建与误差/体积报告。
+
+设备端只上报/缓存折线顶点 (二进制记录 PAYLOAD_TAG_ADC_VERTEX，或物模型 adc_vtx_ts / adc_vtx_v)，
+顶点之间线性插值即为重建信号。本脚本汇总顶点，按需在参考采样时刻或固定步长上重建，
+并报告最大/均方根误差、压缩比以及上报字节数和离线缓存 (EEPROM) 占用的对比。
+
+只用标准库。
+
+用法:
+    sdt_reconstruct.py up1.bin up2.bin ...             # 二进制报文 (payload_decode.py 可解的格式)
+    sdt_reconstruct.py decoded.json                    # payload_decode.py 的输出或 OneNET 属性上报 JSON
+    sdt_reconstruct.py vtx.csv --ref raw.csv           # 顶点/参考点 CSV: 时间(s),电压(V)
+    sdt_reconstruct.py up.bin --out rebuilt.csv --step 0.1
+    sdt_reconstruct.py --selftest [--dev 0.005]        # 用 Python 复现压缩算法，验证误差上限和编解码
+"""
+import argparse
+import csv
+import json
+import math
+import os
+import random
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import payload_decode  # noqa: E402
+
+VERTEX_BIN_BYTES = 6        # 二进制记录内每顶点: dt(u16) + voltage(f32)
+VERTEX_RECORD_BYTES = 3 + 6  # 记录头 + chan/n/t0
+POINT_BIN_BYTES = 8         # 逐点上报: t_ms(u32) + voltage(f32)
+CACHE_RECORD_BYTES = 16     # offline_cache.h CacheRecord
+CACHE_CAPACITY = (2048 - 16) // CACHE_RECORD_BYTES
+MAX_GAP_MS = 60000
+
+
+def vertices_from_records(records, channel):
+    out = []
+    for r in records:
+        if r.get('type') != 'adc_vertex':
+            continue
+        if channel is not None and r['adc_vtx_ch'] != channel:
+            continue
+        out += zip(r['adc_vtx_ts'], r['adc_vtx_v'])
+    return out
+
+
+def load_vertices(path, channel):
+    """返回 [(t 秒, v)]，以及二进制记录数 (用于字节统计，CSV/JSON 输入时按最少记录数估算)"""
+    if path.endswith('.csv'):
+        return load_csv(path), 0
+    if path.endswith('.json'):
+        with open(path, encoding='utf-8') as f:
+            doc = json.load(f)
+        if 'records' in doc:
+            return vertices_from_records(doc['records'], channel), 0
+        params = doc.get('params', doc)
+        ts, vs = params['adc_vtx_ts']['value'], params['adc_vtx_v']['value']
+        return list(zip(ts, vs)), 0
+    with open(path, 'rb') as f:
+        doc = payload_decode.decode(f.read())
+    records = [r for r in doc['records'] if r.get('type') == 'adc_vertex']
+    return vertices_from_records(records, channel), len(records)
+
+
+def load_csv(path):
+    pts = []
+    with open(path, newline='') as f:
+        for row in csv.reader(f):
+            try:
+                pts.append((float(row[0]), float(row[1])))
+            except (ValueError, IndexError):
+                continue  # 表头或空行
+    return pts
+
+
+def interp(vtx, t, idx):
+    """顶点间线性插值，idx 为上次所在段，返回 (值, idx)"""
+    while idx + 1 < len(vtx) and vtx[idx + 1][0] < t:
+        idx += 1
+    if idx + 1 >= len(vtx) or t <= vtx[idx][0]:
+        return vtx[min(idx, len(vtx) - 1)][1], idx
+    (t0, v0), (t1, v1) = vtx[idx], vtx[idx + 1]
+    return v0 + (v1 - v0) * (t - t0) / (t1 - t0), idx
+
+
+def reconstruct(vtx, times):
+    idx, out = 0, []
+    for t in times:
+        v, idx = interp(vtx, t, idx)
+        out.append(v)
+    return out
+
+
+def error_report(vtx, ref):
+    """只统计顶点覆盖范围内的参考点"""
+    inside = [(t, v) for t, v in ref if vtx[0][0] - 1e-6 <= t <= vtx[-1][0] + 1e-6]
+    if not inside:
+        return None
+    rebuilt = reconstruct(vtx, [t for t, _ in inside])
+    err = [abs(r - v) for r, (_, v) in zip(rebuilt, inside)]
+    worst = max(range(len(err)), key=err.__getitem__)
+    return {'points': len(inside), 'max': err[worst], 'max_at': inside[worst][0],
+            'rms': math.sqrt(sum(e * e for e in err) / len(err))}
+
+
+def size_report(n_points, n_vtx, n_records, duration):
+    """上报字节与离线缓存占用：逐点 vs 顶点，duration 为参考点覆盖的秒数"""
+    if n_records == 0:
+        n_records = max(1, math.ceil(n_vtx / 16))
+    vtx_bytes = n_records * VERTEX_RECORD_BYTES + n_vtx * VERTEX_BIN_BYTES
+    print('size:')
+    print('  uplink (binary)  points %8d B   vertices %8d B   %.1fx' %
+          (n_points * (3 + POINT_BIN_BYTES), vtx_bytes, n_points * (3 + POINT_BIN_BYTES) / max(vtx_bytes, 1)))
+    print('  EEPROM cache     points %8d B   vertices %8d B   (capacity %d records: %s vs %s of signal)' %
+          (n_points * CACHE_RECORD_BYTES, n_vtx * CACHE_RECORD_BYTES, CACHE_CAPACITY,
+           fmt_span(CACHE_CAPACITY, n_points, duration), fmt_span(CACHE_CAPACITY, n_vtx, duration)))
+
+
+def fmt_span(capacity, count, duration):
+    """缓存满容量可容纳的信号时长"""
+    if count == 0 or duration <= 0:
+        return '-'
+    return '%.0f s' % (duration * capacity / count)
+
+
+class Sdt:
+    """src/sdt_compress.c 的 Python 复现，时间单位 ms，按单精度截断"""
+
+    def __init__(self, dev, max_gap=MAX_GAP_MS):
+        self.dev, self.max_gap = f32(dev), max_gap
+        self.state, self.pivot, self.last = 0, None, None
+        self.k_lo = self.k_hi = 0.0
+
+    def _open(self, t, v):
+        dt = float(t - self.pivot[0])
+        self.k_lo = f32((v - self.dev - self.pivot[1]) / dt)
+        self.k_hi = f32((v + self.dev - self.pivot[1]) / dt)
+        self.last, self.state = (t, v), 2
+
+    def _close(self):
+        k = f32(0.5 * (self.k_lo + self.k_hi))
+        vertex = (self.last[0], f32(self.pivot[1] + k * (self.last[0] - self.pivot[0])))
+        self.pivot = self.last = vertex
+        self.state = 1
+        return vertex
+
+    def _restart(self, t, v):
+        self.pivot = self.last = (t, v)
+        self.state = 1
+        return (t, v)
+
+    def push(self, t, v):
+        v = f32(v)
+        if self.state and t <= self.last[0]:
+            return []
+        if self.state == 0:
+            return [self._restart(t, v)]
+        gap = t - self.pivot[0]
+        if self.state == 1:
+            if gap > self.max_gap:
+                return [self._restart(t, v)]
+            self._open(t, v)
+            return []
+        lo = max(self.k_lo, f32((v - self.dev - self.pivot[1]) / gap))
+        hi = min(self.k_hi, f32((v + self.dev - self.pivot[1]) / gap))
+        if lo <= hi and gap <= self.max_gap:
+            self.k_lo, self.k_hi, self.last = lo, hi, (t, v)
+            return []
+        out = [self._close()]
+        if t - self.pivot[0] > self.max_gap:
+            out.append(self._restart(t, v))
+        else:
+            self._open(t, v)
+        return out
+
+    def flush(self):
+        return [self._close()] if self.state == 2 else []
+
+
+def f32(v):
+    return struct.unpack('<f', struct.pack('<f', v))[0]
+
+
+def encode_vertices(chan, vtx_ms, base_tick=0):
+    """按 payload_put_adc_vertices 编码为二进制报文，每条记录最多 16 个顶点"""
+    body, count = b'', 0
+    for i in range(0, len(vtx_ms), 16):
+        chunk = vtx_ms[i:i + 16]
+        rec = struct.pack('<BHBBI', 12, 0, chan, len(chunk), chunk[0][0])
+        prev = chunk[0][0]
+        for t, v in chunk:
+            rec += struct.pack('<Hf', t - prev, v)
+            prev = t
+        body += rec
+        count += 1
+    return struct.pack('<BBBBI', payload_decode.MAGIC, payload_decode.SCHEMA_VERSION, 0, count, base_tick) + body
+
+
+def selftest(dev, n, step_ms):
+    rng = random.Random(1)
+    ref_ms = []
+    level = 1.0
+    for i in range(n):
+        seg, pos = divmod(i, 300)
+        if seg % 3 == 1:
+            level += 0.8 / 300          # 斜坡
+        elif seg % 3 == 2 and pos == 0:
+            level -= 0.3                # 阶跃
+        ref_ms.append((i * step_ms, level + rng.uniform(-0.001, 0.001)))
+
+    sdt = Sdt(dev)
+    vtx_ms = []
+    for t, v in ref_ms:
+        vtx_ms += sdt.push(t, v)
+    vtx_ms += sdt.flush()
+
+    doc = payload_decode.decode(encode_vertices(0, vtx_ms))
+    vtx = vertices_from_records(doc['records'], 0)
+    ref = [(t / 1000.0, v) for t, v in ref_ms]
+
+    rep = error_report(vtx, ref)
+    print('selftest: %d points every %d ms, dev %.1f mV -> %d vertices (%.1fx)' %
+          (n, step_ms, dev * 1000, len(vtx), n / len(vtx)))
+    print('error: max %.1f uV at %.3f s, rms %.1f uV' % (rep['max'] * 1e6, rep['max_at'], rep['rms'] * 1e6))
+    size_report(n, len(vtx), len(doc['records']), ref[-1][0] - ref[0][0])
+
+    # 设备端按单精度计算，允许 dev 的 1e-4 相对余量
+    if rep['max'] > dev * (1 + 1e-4) + 1e-6:
+        print('FAIL: reconstruction error exceeds deviation bound')
+        return 1
+    print('OK')
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('inputs', nargs='*', help='vertex sources (.bin payload, .json, .csv)')
+    ap.add_argument('--channel', type=int, help='ADC_ACQ_CHAN to select (default: all vertex records)')
+    ap.add_argument('--ref', help='reference samples CSV (t seconds, volts) for error report')
+    ap.add_argument('--out', help='write reconstructed CSV')
+    ap.add_argument('--step', type=float, help='resample step in seconds for --out (default: vertex/ref times)')
+    ap.add_argument('--selftest', action='store_true', help='compress a synthetic signal and verify the bound')
+    ap.add_argument('--dev', type=float, default=0.005, help='deviation bound in volts for --selftest')
+    ap.add_argument('--points', type=int, default=6000, help='points for --selftest')
+    args = ap.parse_args()
+
+    if args.selftest:
+        return selftest(args.dev, args.points, 100)
+    if not args.inputs:
+        ap.error('no input')
+
+    vtx, n_records = [], 0
+    for path in args.inputs:
+        pts, recs = load_vertices(path, args.channel)
+        vtx += pts
+        n_records += recs
+    vtx = sorted(set(vtx))
+    if len(vtx) < 2:
+        raise SystemExit('need at least 2 vertices, got %d' % len(vtx))
+    print('vertices: %d over %.3f .. %.3f s' % (len(vtx), vtx[0][0], vtx[-1][0]))
+
+    ref = load_csv(args.ref) if args.ref else []
+    if ref:
+        rep = error_report(vtx, ref)
+        if rep:
+            print('error: %d reference points, max %.1f uV at %.3f s, rms %.1f uV' %
+                  (rep['points'], rep['max'] * 1e6, rep['max_at'], rep['rms'] * 1e6))
+            size_report(rep['points'], len(vtx), n_records, ref[-1][0] - ref[0][0])
+
+    if args.out:
+        if args.step:
+            n = int((vtx[-1][0] - vtx[0][0]) / args.step) + 1
+            times = [vtx[0][0] + i * args.step for i in range(n)]
+        else:
+            times = [t for t, _ in ref] if ref else [t for t, _ in vtx]
+        with open(args.out, 'w', newline='') as f:
+            w = csv.writer(f)
+            w.writerow(['t', 'v'])
+            for t, v in zip(times, reconstruct(vtx, times)):
+                w.writerow(['%.3f' % t, '%.6f' % v])
+        print('wrote %d points to %s' % (len(times), args.out))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
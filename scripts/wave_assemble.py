@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+触发波形捕获 (src/wave_capture.c) 的主机侧重组。
+
+设备端把一次捕获按块上报 (二进制记录 PAYLOAD_TAG_WAVE_CHUNK，或物模型 wave_* 属性)，
+断线后从未确认的块继续，因此分块可能乱序、重复。本脚本按 (wave_id, wave_ts) 归并分块，
+检查缺块，把完整的捕获按 wave_offset 拼接后输出 CSV：触发点为 0 s，每通道一列电压。
+
+只用标准库。
+
+用法:
+    wave_assemble.py up1.bin up2.bin ...               # 二进制报文 (payload_decode.py 可解的格式)
+    wave_assemble.py decoded.json posts.jsonl          # payload_decode.py 的输出或 OneNET 属性上报 JSON (每行一条亦可)
+    wave_assemble.py up*.bin --out-dir waves           # 每个完整捕获写 waves/wave_<id>.csv
+    wave_assemble.py --selftest                        # 编码一个合成捕获，乱序/重复后重组并核对
+    wave_assemble.py --host [--cc gcc]                 # 主机编译 src/wave_capture.c (测试桩 wave_host.c)，
+                                                       # 核对固件编码的分块能否按原数据重组
+"""
+import argparse
+import csv
+import json
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import payload_decode  # noqa: E402
+
+VOLT_PER_CODE = 3.3 / 4096
+SOURCES = {0: 'manual', 1: 'adc', 2: 'can'}
+CHUNK_BYTES = 512           # wave_capture.h WAVE_CHUNK_BYTES
+FIELDS = payload_decode.SCHEMA[13][1]
+
+
+def chunks_from_doc(doc):
+    """payload_decode 输出或一条 OneNET 属性上报，返回 wave_* 字段字典列表"""
+    if 'records' in doc:
+        return [r for r in doc['records'] if r.get('type') == 'wave_chunk']
+    params = doc.get('params', doc)
+    if 'wave_data' not in params:
+        return []
+    return [{k: (params[k]['value'] if isinstance(params[k], dict) else params[k]) for k in FIELDS}]
+
+
+def load_chunks(path):
+    if path.endswith('.json') or path.endswith('.jsonl'):
+        with open(path, encoding='utf-8') as f:
+            text = f.read()
+        try:
+            return chunks_from_doc(json.loads(text))
+        except ValueError:
+            out = []
+            for line in text.splitlines():
+                if line.strip():
+                    out += chunks_from_doc(json.loads(line))
+            return out
+    with open(path, 'rb') as f:
+        return chunks_from_doc(payload_decode.decode(f.read()))
+
+
+def group(chunks):
+    """(id, ts) -> {'meta': 首块字段, 'parts': {seq: chunk}}，重复的块只保留一份"""
+    caps = {}
+    for c in chunks:
+        key = (c['wave_id'], round(c['wave_ts'], 6))
+        cap = caps.setdefault(key, {'meta': c, 'parts': {}})
+        cap['parts'].setdefault(c['wave_seq'], c)
+    return caps
+
+
+def assemble(cap):
+    """返回 (按扫描的码值行列表, 缺失的块号列表)"""
+    meta = cap['meta']
+    channels = len(meta['wave_ch'])
+    total = meta['wave_pre'] + meta['wave_post']
+    missing = [s for s in range(meta['wave_chunks']) if s not in cap['parts']]
+    if missing:
+        return None, missing
+
+    rows = [None] * total
+    for c in cap['parts'].values():
+        data = bytes.fromhex(c['wave_data'])
+        codes = struct.unpack('<%dH' % (len(data) // 2), data)
+        for i in range(len(codes) // channels):
+            if c['wave_offset'] + i < total:
+                rows[c['wave_offset'] + i] = codes[i * channels:(i + 1) * channels]
+    gaps = sum(1 for r in rows if r is None)
+    if gaps:
+        raise SystemExit('capture #%d: %d scans not covered by chunks' % (meta['wave_id'], gaps))
+    return rows, []
+
+
+def chan_name(chan):
+    return 'adc%d_ch%d' % (chan >> 4, chan & 0x0F)
+
+
+def write_csv(path, meta, rows):
+    adds = meta['wave_adds']
+    with open(path, 'w', newline='') as f:
+        w = csv.writer(f)
+        w.writerow(['t'] + [chan_name(c) for c in meta['wave_ch']])
+        for i, row in enumerate(rows):
+            t = (i - meta['wave_pre']) / float(meta['wave_rate'])
+            w.writerow(['%.6f' % t] + ['%.4f' % (code * VOLT_PER_CODE / adds[k]) for k, code in enumerate(row)])
+
+
+def encode_chunk(meta, seq, chunk_scans, rows, base_tick=0):
+    """按 payload_put_wave_chunk 编码一块为单条记录的二进制报文"""
+    offset = seq * chunk_scans
+    part = rows[offset:offset + chunk_scans]
+    t_us = int(round(meta['wave_ts'] * 1e6))
+    rec = struct.pack('<BH', 13, 0)
+    rec += struct.pack('<HHHBBIIHIIIH', meta['wave_id'], seq, meta['wave_chunks'], meta['wave_src'],
+                       len(meta['wave_ch']), meta['wave_rate'], t_us // 1000, t_us % 1000, meta['wave_pre'],
+                       meta['wave_post'], offset, len(part))
+    for chan, add in zip(meta['wave_ch'], meta['wave_adds']):
+        rec += struct.pack('<BB', chan, add)
+    for row in part:
+        rec += struct.pack('<%dH' % len(row), *row)
+    return struct.pack('<BBBBI', payload_decode.MAGIC, payload_decode.SCHEMA_VERSION, 0, 1, base_tick) + rec
+
+
+def selftest():
+    rng = random.Random(1)
+    chans, pre, post, rate = [0x00, 0x01, 0x12], 1000, 1000, 1000
+    rows = [tuple((i * 7 + k * 1000 + rng.randint(0, 3)) & 0xFFF for k in range(len(chans)))
+            for i in range(pre + post)]
+    chunk_scans = CHUNK_BYTES // (2 * len(chans))
+    meta = {'wave_id': 5, 'wave_src': 1, 'wave_ch': chans, 'wave_adds': [1, 1, 4], 'wave_rate': rate,
+            'wave_ts': 12.345678, 'wave_pre': pre, 'wave_post': post,
+            'wave_chunks': (pre + post + chunk_scans - 1) // chunk_scans}
+
+    # 二进制报文经 payload_decode 解码，模拟断线重传：部分块重复，整体乱序
+    chunks = []
+    for seq in range(meta['wave_chunks']):
+        doc = payload_decode.decode(encode_chunk(meta, seq, chunk_scans, rows))
+        chunks += chunks_from_doc(doc) * (2 if rng.random() < 0.2 else 1)
+    rng.shuffle(chunks)
+
+    caps = group(chunks)
+    if len(caps) != 1:
+        print('FAIL: expected 1 capture, got %d' % len(caps))
+        return 1
+    cap = next(iter(caps.values()))
+    got, missing = assemble(cap)
+    if missing or got != rows:
+        print('FAIL: reassembled capture differs (missing %s)' % missing)
+        return 1
+
+    # 去掉一块应报告缺失
+    del cap['parts'][3]
+    _, missing = assemble(cap)
+    if missing != [3]:
+        print('FAIL: missing chunk not reported')
+        return 1
+
+    print('selftest: %d ch x %d scans, %d chunks of %d scans, %d received with duplicates -> OK' %
+          (len(chans), pre + post, meta['wave_chunks'], chunk_scans, len(chunks)))
+    return 0
+
+
+HOST_BLOCK_SCANS = 100      # adc_acq.h ADC_ACQ_BLOCK_SCANS
+
+
+def host_code(k, c):
+    """wave_host.c 喂入的第 k 次扫描第 c 通道的码值"""
+    return (k * 7 + c * 1000) & 0xFFF
+
+
+def host_selftest(cc):
+    """
+    用固件的 wave_capture.c / payload_codec.c 录制两次捕获，解码其输出的报文并与喂入的数据核对：
+    第一次连续采集，第二次在 post 未满时块序号跳号 (采集重启)，捕获应在跳号处截止，不拼入之后的数据。
+    """
+    import host_build
+    workdir = tempfile.mkdtemp(prefix='wave_host_')
+    try:
+        exe = host_build.build('wave_host', [os.path.join(host_build.HERE, 'wave_host.c'), 'wave_capture.c',
+                                             'payload_codec.c', 'lz_compress.c'], workdir, cc,
+                                extra_headers={'hal_data.h': 'typedef int adc_add_t;\n'})
+        rate, channels, pre, post = 1000, 3, 150, 250
+        period_us = HOST_BLOCK_SCANS * 1000000 // rate
+
+        def block(seq):
+            return 'block %d %d %d %d' % (seq, rate, channels, seq * period_us)
+
+        cmds = ['set %d %d' % (pre, post)]
+        cmds += [block(seq) for seq in range(5)]
+        cmds.append('trig %d' % (3 * period_us + 37000))        # 第 337 次扫描
+        cmds += [block(seq) for seq in range(5, 13)]
+        cmds.append('trig %d' % (12 * period_us + 50000))       # 第 1250 次扫描
+        cmds += [block(13), block(20), 'drain']                 # 13 之后跳号
+        out = subprocess.run([exe], input='\n'.join(cmds) + '\n', stdout=subprocess.PIPE, universal_newlines=True,
+                             check=True).stdout
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    chunks = []
+    for line in out.splitlines():
+        if line.startswith('rec '):
+            chunks += chunks_from_doc(payload_decode.decode(bytes.fromhex(line[4:])))
+    caps = sorted(group(chunks).values(), key=lambda cap: cap['meta']['wave_id'])
+    expect = [(337, pre, post), (1250, pre, 1400 - 1250)]
+    if len(caps) != len(expect):
+        print('FAIL: expected %d captures from the firmware, got %d' % (len(expect), len(caps)))
+        return 1
+    for cap, (trig, want_pre, want_post) in zip(caps, expect):
+        meta = cap['meta']
+        rows, missing = assemble(cap)
+        want = [tuple(host_code(k, c) for c in range(channels)) for k in range(trig - want_pre, trig + want_post)]
+        if missing or (meta['wave_pre'], meta['wave_post']) != (want_pre, want_post) or rows != want:
+            print('FAIL: capture #%d pre %d post %d (expected %d/%d), missing %s, data %s' %
+                  (meta['wave_id'], meta['wave_pre'], meta['wave_post'], want_pre, want_post, missing,
+                   'matches' if rows == want else 'differs'))
+            return 1
+        print('host: capture #%d, %d ch x %d scans in %d chunks from wave_capture.c -> OK' %
+              (meta['wave_id'], channels, len(rows), meta['wave_chunks']))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('inputs', nargs='*', help='chunk sources (.bin payload, .json, .jsonl)')
+    ap.add_argument('--out-dir', help='write wave_<id>.csv for each complete capture')
+    ap.add_argument('--selftest', action='store_true', help='encode, shuffle and reassemble a synthetic capture')
+    ap.add_argument('--host', action='store_true', help='reassemble captures recorded by src/wave_capture.c built for the host')
+    ap.add_argument('--cc', help='host C compiler for --host (default $CC or cc)')
+    args = ap.parse_args()
+
+    if args.selftest:
+        return selftest()
+    if args.host:
+        return host_selftest(args.cc)
+    if not args.inputs:
+        ap.error('no input')
+
+    chunks = []
+    for path in args.inputs:
+        chunks += load_chunks(path)
+    caps = group(chunks)
+    if not caps:
+        raise SystemExit('no wave_chunk records found')
+    if args.out_dir:
+        os.makedirs(args.out_dir, exist_ok=True)
+
+    incomplete = 0
+    for (cid, ts), cap in sorted(caps.items(), key=lambda kv: kv[0][1]):
+        meta = cap['meta']
+        print('capture #%d at %.6f s (%s): %d ch at %d Hz, pre %d post %d, %d/%d chunks' %
+              (cid, ts, SOURCES.get(meta['wave_src'], meta['wave_src']), len(meta['wave_ch']), meta['wave_rate'],
+               meta['wave_pre'], meta['wave_post'], len(cap['parts']), meta['wave_chunks']))
+        rows, missing = assemble(cap)
+        if missing:
+            print('  missing chunks: %s' % ' '.join(str(s) for s in missing[:32]))
+            incomplete += 1
+            continue
+        if args.out_dir:
+            path = os.path.join(args.out_dir, 'wave_%d.csv' % cid)
+            write_csv(path, meta, rows)
+            print('  wrote %d scans to %s' % (len(rows), path))
+    return 1 if incomplete else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
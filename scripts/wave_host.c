@@ -0,0 +1,100 @@
+/*
+ * src/wave_capture.c 的主机侧测试桩，由 scripts/wave_assemble.py --host 连同 wave_capture.c / payload_codec.c
+ * 用主机编译器编译 (RT-Thread 头文件替身见 host_build.py，环在片内 RAM)，不属于固件。
+ *
+ * 标准输入逐行命令，结果写到标准输出：
+ *   set <pre> <post>                         wave_capture_set，输出 "set <ret>"
+ *   block <seq> <rate> <channels> <t_us>     喂一个块：第 i 次扫描第 c 通道的码值为 ((seq * 扫描数 + i) * 7 + c * 1000) & 0xFFF，
+ *                                            t_us 为首个扫描的时刻
+ *   trig <t_us>                              手动触发，输出 "trig <ret>"
+ *   drain                                    按 payload_put_wave_chunk 编码所有已完成捕获的各块，
+ *                                            每块输出 "rec <十六进制报文>"，最后输出 "drain <块数>"
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wave_capture.h"
+#include "payload_codec.h"
+#include "perf_counter.h"
+
+#define HOST_LINE   256
+
+static rt_uint64_t host_base;
+
+static rt_uint64_t host_ticks(unsigned long long t_us)
+{
+    return host_base + t_us * 1000ULL;      /* 替身 CNTPCT 以 ns 计 */
+}
+
+static void host_block(const char *args)
+{
+    static AdcBlock block;
+    unsigned long seq, rate, channels;
+    unsigned long long t_us;
+
+    if (sscanf(args, "%lu %lu %lu %llu", &seq, &rate, &channels, &t_us) != 4 || channels == 0 ||
+        channels > ADC_ACQ_MAX_CHANNELS) {
+        return;
+    }
+    memset(&block, 0, sizeof(block));
+    block.seq = (rt_uint32_t)seq;
+    block.rate = (rt_uint32_t)rate;
+    block.channels = (rt_uint8_t)channels;
+    block.scans = ADC_ACQ_BLOCK_SCANS;
+    block.t_first = host_ticks(t_us);
+    for (rt_uint8_t c = 0; c < channels; c++) {
+        block.channel_id[c] = ADC_ACQ_CHAN(c & 1, c);
+        block.adds[c] = 1;
+    }
+    for (rt_uint32_t i = 0; i < ADC_ACQ_BLOCK_SCANS; i++) {
+        rt_uint32_t k = (rt_uint32_t)seq * ADC_ACQ_BLOCK_SCANS + i;
+        for (rt_uint8_t c = 0; c < channels; c++) block.data[i * channels + c] = (rt_uint16_t)((k * 7 + c * 1000) & 0xFFF);
+    }
+    wave_capture_feed(&block);
+}
+
+static void host_drain(void)
+{
+    static rt_uint16_t samples[WAVE_CHUNK_BYTES / 2];
+    static rt_uint8_t bin[PAYLOAD_HEADER_SIZE + 3 + 32 + 2 * ADC_ACQ_MAX_CHANNELS + WAVE_CHUNK_BYTES];
+    WaveCapture *cap;
+    int n = 0;
+
+    while ((cap = wave_capture_pending()) != RT_NULL) {
+        PayloadWriter w;
+        rt_uint16_t seq = cap->next;
+        rt_uint32_t scans = wave_capture_read(cap, (rt_uint32_t)seq * cap->chunk_scans, cap->chunk_scans, samples);
+
+        payload_begin(&w, bin, sizeof(bin), 0);
+        if (payload_put_wave_chunk(&w, 0, cap, seq, samples, scans) != RT_EOK) break;
+        rt_size_t len = payload_end(&w);
+        printf("rec ");
+        for (rt_size_t i = 0; i < len; i++) printf("%02x", bin[i]);
+        printf("\n");
+        wave_capture_ack(cap, 0);
+        n++;
+    }
+    printf("drain %d\n", n);
+}
+
+int main(void)
+{
+    char line[HOST_LINE];
+
+    host_base = perf_now();
+    wave_capture_init();
+    while (fgets(line, sizeof(line), stdin)) {
+        if (strncmp(line, "block ", 6) == 0) {
+            host_block(line + 6);
+        } else if (strncmp(line, "trig ", 5) == 0) {
+            printf("trig %d\n", wave_capture_trigger(WAVE_SRC_MANUAL, host_ticks(strtoull(line + 5, RT_NULL, 10))));
+        } else if (strncmp(line, "set ", 4) == 0) {
+            unsigned long pre = 0, post = 0;
+            sscanf(line + 4, "%lu %lu", &pre, &post);
+            printf("set %d\n", wave_capture_set((rt_uint32_t)pre, (rt_uint32_t)post));
+        } else if (strncmp(line, "drain", 5) == 0) {
+            host_drain();
+        }
+    }
+    return 0;
+}
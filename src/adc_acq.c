@@ -0,0 +1,550 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hal_data.h"
+#include "adc_acq.h"
+#include "adc_alarm.h"
+#include "perf_counter.h"
+
+/*
+ * 触发链：GPT0 计数溢出 (GTPR 比较匹配) -> ELC -> ADC0 / ADC1 启动源 A (ADSTRGR.TRSA = ELC)。
+ * GPT0 不输出波形也不开中断，只作为 ELC 事件源；两个单元每次触发各完成一次单次扫描。
+ *
+ * 本工程 GPT 未开启扩展功能 (GPT_CFG_OUTPUT_SUPPORT_ENABLE != 2)，GTADTRA 的 A/D 启动请求无法由
+ * R_GPT_Open 配置，因此用溢出事件触发，效果相同：每个 GPT 周期一次扫描。
+ * 工程中没有 r_elc 驱动，ELC 连接直接写 ELC_SSEL 寄存器。
+ */
+#define ACQ_GPT_CHANNEL     GPT_CHANNEL_UNIT0_0
+#define ACQ_GPT_EVENT       ELC_EVENT_GPT0_OVF
+#define ACQ_ELC_NONE        0x3FFU      /* ELC_SEL 全 1：不连接任何事件 */
+#define ACQ_ELC_SEL_BITS    10
+#define ACQ_RELEASE_WAIT_MS 500         /* 重新启动时等待处理线程归还块的上限 */
+
+static gpt_instance_ctrl_t acq_gpt_ctrl;
+
+static const gpt_extended_cfg_t acq_gpt_extend =
+{
+    .gtioca = { .output_enabled = false, .stop_level = GPT_PIN_LEVEL_LOW },
+    .gtiocb = { .output_enabled = false, .stop_level = GPT_PIN_LEVEL_LOW },
+    .start_source            = GPT_SOURCE_NONE,
+    .stop_source             = GPT_SOURCE_NONE,
+    .clear_source            = GPT_SOURCE_NONE,
+    .count_up_source         = GPT_SOURCE_NONE,
+    .count_down_source       = GPT_SOURCE_NONE,
+    .capture_a_source        = GPT_SOURCE_NONE,
+    .capture_b_source        = GPT_SOURCE_NONE,
+    .capture_a_ipl           = BSP_IRQ_DISABLED,
+    .capture_b_ipl           = BSP_IRQ_DISABLED,
+    .capture_a_irq           = FSP_INVALID_VECTOR,
+    .capture_b_irq           = FSP_INVALID_VECTOR,
+    .capture_filter_gtioca   = GPT_CAPTURE_FILTER_NONE,
+    .capture_filter_gtiocb   = GPT_CAPTURE_FILTER_NONE,
+    .p_pwm_cfg               = NULL,
+    .dead_time_ipl           = BSP_IRQ_DISABLED,
+    .dead_time_irq           = FSP_INVALID_VECTOR,
+    .capture_a_source_select = BSP_IRQ_DISABLED,
+    .capture_b_source_select = BSP_IRQ_DISABLED,
+    .cycle_end_source_select = BSP_IRQ_DISABLED,
+    .dead_time_error_source_select = BSP_IRQ_DISABLED,
+    .trough_source_select    = BSP_IRQ_DISABLED,
+};
+
+static const timer_cfg_t acq_gpt_cfg =
+{
+    .mode              = TIMER_MODE_PERIODIC,
+    .period_counts     = 0xFFFFFFFFUL,  /* 打开后按频率重新设定 */
+    .duty_cycle_counts = 0,
+    .source_div        = TIMER_SOURCE_DIV_1,
+    .channel           = ACQ_GPT_CHANNEL,
+    .cycle_end_ipl     = BSP_IRQ_DISABLED,
+    .cycle_end_irq     = FSP_INVALID_VECTOR,
+    .p_callback        = NULL,
+    .p_context         = NULL,
+    .p_extend          = &acq_gpt_extend,
+};
+
+/* 单元的扫描组：通道位图及其在块内一行中的列位置 */
+typedef struct {
+    adc_instance_ctrl_t     *ctrl;
+    const adc_cfg_t         *cfg;
+    const adc_channel_cfg_t *base_cfg;
+    adc_cfg_t                open_cfg;      /* 生成的配置 + 运行时加法次数 */
+    adc_extended_cfg_t       ext_cfg;
+    adc_channel_cfg_t        chan_cfg;      /* 生成的配置 + 运行时通道位图 */
+    elc_peripheral_t         elc;
+    rt_uint16_t              valid;         /* 本单元存在的通道 */
+    rt_uint16_t              mask;
+    rt_uint16_t              add_mask;      /* 硬件加法/平均的通道 */
+    adc_add_t                add;
+    rt_uint8_t               first;
+    rt_uint8_t               count;
+    rt_uint8_t               ch[8];
+    rt_uint16_t              fill;          /* 当前块已写入的行数 */
+} AcqUnit;
+
+static AcqUnit acq_unit[ADC_ACQ_UNITS] =
+{
+    { &g_adc0_ctrl, &g_adc0_cfg, &g_adc0_channel_cfg, .elc = ELC_PERIPHERAL_ADC0_A, .valid = BSP_FEATURE_ADC_UNIT_0_CHANNELS },
+    { &g_adc1_ctrl, &g_adc1_cfg, &g_adc1_channel_cfg, .elc = ELC_PERIPHERAL_ADC1_A, .valid = BSP_FEATURE_ADC_UNIT_1_CHANNELS },
+};
+
+static AdcBlock acq_blocks[ADC_ACQ_BLOCKS];
+static struct rt_semaphore acq_sem;
+static rt_bool_t acq_inited = RT_FALSE;
+static volatile rt_bool_t acq_running = RT_FALSE;
+
+/* 中断写 head 块；tail 起的 ready 个块已满，tail 块可能正被处理线程持有 */
+static rt_uint8_t acq_head;
+static rt_uint8_t acq_tail;
+static volatile rt_uint8_t acq_ready;
+static rt_uint32_t acq_seq;
+
+static rt_uint8_t acq_channels;
+static rt_uint8_t acq_channel_id[ADC_ACQ_MAX_CHANNELS];
+static rt_uint8_t acq_adds[ADC_ACQ_MAX_CHANNELS];
+static rt_uint8_t acq_lead;             /* 第一个启用的单元，负责时间戳和扫描计数 */
+static rt_uint64_t acq_last_scan;
+static rt_uint64_t acq_period_min;
+static rt_uint64_t acq_period_max;
+static rt_uint64_t acq_hold_at;         /* 处理线程取得块的时间 */
+static AdcAcqStats acq_stats;
+
+static void acq_elc_link(elc_peripheral_t peripheral, rt_uint32_t event)
+{
+    rt_uint32_t reg = (rt_uint32_t)peripheral / 3;
+    rt_uint32_t shift = ((rt_uint32_t)peripheral % 3) * ACQ_ELC_SEL_BITS;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    R_ELC->ELC_SSEL[reg] = (R_ELC->ELC_SSEL[reg] & ~(R_ELC_ELC_SSEL_ELC_SEL0_Msk << shift)) | (event << shift);
+    rt_hw_interrupt_enable(level);
+}
+
+/* FSP 扫描结束回调 (g_adc0 / g_adc1 p_callback)，中断上下文；比较中断转给 adc_alarm */
+void adc_acq_callback(adc_callback_args_t *p_args)
+{
+    if (p_args->event == ADC_EVENT_WINDOW_COMPARE_A || p_args->event == ADC_EVENT_WINDOW_COMPARE_B) {
+        adc_alarm_isr(p_args);
+        return;
+    }
+    if (p_args->event != ADC_EVENT_SCAN_COMPLETE || !acq_running || p_args->unit >= ADC_ACQ_UNITS) return;
+
+    rt_uint64_t now = perf_now();
+    AcqUnit *u = &acq_unit[p_args->unit];
+    AdcBlock *b = &acq_blocks[acq_head];
+
+    if (u->count == 0) return;
+
+    /* 本单元已写满，另一单元还在追赶：上一次扫描没能在本次触发前完成 */
+    if (u->fill >= ADC_ACQ_BLOCK_SCANS) {
+        acq_stats.late++;
+        goto out;
+    }
+
+    if (p_args->unit == acq_lead) {
+        if (acq_last_scan) {
+            rt_uint64_t d = now - acq_last_scan;
+            if (d < acq_period_min) acq_period_min = d;
+            if (d > acq_period_max) acq_period_max = d;
+        }
+        acq_last_scan = now;
+        acq_stats.scans++;
+        if (u->fill == 0) b->t_first = now;
+    }
+
+    /* 结果寄存器连续读出，写入本行属于该单元的列 */
+    const volatile rt_uint16_t *addr = u->ctrl->p_reg->ADDR;
+    rt_uint16_t *out = &b->data[u->fill * acq_channels + u->first];
+    for (rt_uint8_t i = 0; i < u->count; i++) {
+        out[i] = addr[u->ch[i]];
+    }
+    u->fill++;
+
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        if (acq_unit[i].count && acq_unit[i].fill < ADC_ACQ_BLOCK_SCANS) goto out;
+    }
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) acq_unit[i].fill = 0;
+
+    /* 下一个块仍未被释放：丢弃本块数据，原地重新填充；序号照常递增，下一个交出的块跳号 */
+    if (acq_ready + 1 >= ADC_ACQ_BLOCKS) {
+        acq_stats.overruns++;
+        acq_seq++;
+        goto out;
+    }
+
+    b->seq = acq_seq++;
+    b->scans = ADC_ACQ_BLOCK_SCANS;
+    b->channels = acq_channels;
+    b->rate = acq_stats.rate;
+    memcpy(b->channel_id, acq_channel_id, sizeof(b->channel_id));
+    memcpy(b->adds, acq_adds, sizeof(b->adds));
+
+    acq_head = (acq_head + 1) % ADC_ACQ_BLOCKS;
+    acq_ready++;
+    acq_stats.blocks++;
+    rt_sem_release(&acq_sem);
+
+out:
+    acq_stats.isr_ticks += perf_now() - now;
+    acq_stats.isr_calls++;
+}
+
+static int acq_rate_set(rt_uint32_t rate_hz)
+{
+    timer_info_t info;
+    if (R_GPT_InfoGet(&acq_gpt_ctrl, &info) != FSP_SUCCESS || info.clock_frequency == 0) return -RT_ERROR;
+
+    rt_uint32_t period = (info.clock_frequency + rate_hz / 2) / rate_hz;
+    if (R_GPT_PeriodSet(&acq_gpt_ctrl, period) != FSP_SUCCESS) return -RT_ERROR;
+
+    acq_stats.rate = rate_hz;
+    acq_stats.rate_actual = (rt_uint32_t)((rt_uint64_t)info.clock_frequency * 1000U / period);
+    return RT_EOK;
+}
+
+static void acq_init(void)
+{
+    if (acq_inited) return;
+
+    rt_sem_init(&acq_sem, "adc_acq", 0, RT_IPC_FLAG_FIFO);
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        acq_unit[i].mask = (rt_uint16_t)(acq_unit[i].base_cfg->scan_mask & acq_unit[i].valid);
+    }
+    acq_inited = RT_TRUE;
+}
+
+int adc_acq_set_channels(rt_uint8_t unit, rt_uint16_t mask)
+{
+    if (unit >= ADC_ACQ_UNITS || (mask & ~acq_unit[unit].valid)) return -RT_EINVAL;
+    if (acq_running) return -RT_EBUSY;
+
+    acq_init();
+    acq_unit[unit].mask = mask;
+    return RT_EOK;
+}
+
+/* 加法次数，平均模式为 1 */
+static rt_uint8_t acq_add_times(adc_add_t add)
+{
+    switch (add) {
+    case ADC_ADD_TWO:   return 2;
+    case ADC_ADD_THREE: return 3;
+    case ADC_ADD_FOUR:  return 4;
+    default:            return 1;
+    }
+}
+
+int adc_acq_set_addition(rt_uint8_t unit, rt_uint16_t mask, adc_add_t add)
+{
+    if (unit >= ADC_ACQ_UNITS || (mask & ~acq_unit[unit].valid)) return -RT_EINVAL;
+    switch (add) {
+    case ADC_ADD_OFF:
+    case ADC_ADD_TWO:
+    case ADC_ADD_THREE:
+    case ADC_ADD_FOUR:
+    case ADC_ADD_AVERAGE_TWO:
+    case ADC_ADD_AVERAGE_FOUR:
+        break;
+    default:
+        return -RT_EINVAL;
+    }
+    if (acq_running) return -RT_EBUSY;
+
+    acq_init();
+    acq_unit[unit].add_mask = (add == ADC_ADD_OFF) ? 0 : mask;
+    acq_unit[unit].add = (mask == 0) ? ADC_ADD_OFF : add;
+    return RT_EOK;
+}
+
+void adc_acq_get_addition(rt_uint8_t unit, rt_uint16_t *mask, adc_add_t *add)
+{
+    if (unit >= ADC_ACQ_UNITS) return;
+    acq_init();
+    *mask = acq_unit[unit].add_mask;
+    *add = acq_unit[unit].add;
+}
+
+/* 打开单元并按通道位图配置扫描组，计算在行内的列位置 */
+static int acq_unit_setup(AcqUnit *u)
+{
+    u->first = acq_channels;
+    u->count = 0;
+    u->fill = 0;
+    if (u->mask == 0) return RT_EOK;
+
+    /* 加法次数在 R_ADC_Open 时写入，adc 设备驱动或上次启动已打开该单元时先关闭再按当前设置打开 */
+    rt_uint16_t add_mask = u->add_mask & u->mask;
+    u->ext_cfg = *(const adc_extended_cfg_t *)u->cfg->p_extend;
+    u->ext_cfg.add_average_count = add_mask ? u->add : ADC_ADD_OFF;
+    u->open_cfg = *u->cfg;
+    u->open_cfg.p_extend = &u->ext_cfg;
+
+    fsp_err_t err = R_ADC_Open(u->ctrl, &u->open_cfg);
+    if (err == FSP_ERR_ALREADY_OPEN) {
+        R_ADC_Close(u->ctrl);
+        err = R_ADC_Open(u->ctrl, &u->open_cfg);
+    }
+    if (err != FSP_SUCCESS) {
+        rt_kprintf("[ADC] unit %d open failed: %d\n", u->cfg->unit, err);
+        return -RT_ERROR;
+    }
+
+    u->chan_cfg = *u->base_cfg;
+    u->chan_cfg.scan_mask = u->mask;
+    u->chan_cfg.add_mask = add_mask;
+    u->chan_cfg.p_window_cfg = adc_alarm_window(u->cfg->unit, u->mask, add_mask, acq_add_times(u->add));
+    if (R_ADC_ScanCfg(u->ctrl, &u->chan_cfg) != FSP_SUCCESS) return -RT_ERROR;
+
+    for (rt_uint8_t ch = 0; ch < 8; ch++) {
+        if (u->mask & (1U << ch)) {
+            u->ch[u->count++] = ch;
+            acq_adds[acq_channels] = (add_mask & (1U << ch)) ? acq_add_times(u->add) : 1;
+            acq_channel_id[acq_channels++] = ADC_ACQ_CHAN(u->cfg->unit, ch);
+        }
+    }
+    return RT_EOK;
+}
+
+/* 处理线程已取走 (信号量已减) 而未归还的块，停止后中断不再改动 acq_ready */
+static rt_bool_t acq_block_held(void)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_bool_t held = (acq_ready != acq_sem.value);
+    rt_hw_interrupt_enable(level);
+    return held;
+}
+
+int adc_acq_start(rt_uint32_t rate_hz)
+{
+    if (rate_hz < ADC_ACQ_RATE_MIN || rate_hz > ADC_ACQ_RATE_MAX) return -RT_EINVAL;
+
+    acq_init();
+
+    /* 运行中只改 GPT 周期，块和统计继续 */
+    if (acq_running) return acq_rate_set(rate_hz);
+
+    /* 复位队列前等处理线程归还正在处理的块 (命令线程优先级更高，让出 CPU 等待) */
+    for (rt_uint32_t ms = 0; acq_block_held(); ms++) {
+        if (ms >= ACQ_RELEASE_WAIT_MS) return -RT_EBUSY;
+        rt_thread_mdelay(1);
+    }
+
+    acq_channels = 0;
+    memset(acq_channel_id, 0, sizeof(acq_channel_id));
+    memset(acq_adds, 1, sizeof(acq_adds));
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        if (acq_unit_setup(&acq_unit[i]) != RT_EOK) return -RT_ERROR;
+    }
+    if (acq_channels == 0) return -RT_EEMPTY;
+    acq_lead = acq_unit[0].count ? 0 : 1;
+
+    fsp_err_t err = R_GPT_Open(&acq_gpt_ctrl, &acq_gpt_cfg);
+    if (err != FSP_SUCCESS && err != FSP_ERR_ALREADY_OPEN) {
+        rt_kprintf("[ADC] GPT open failed: %d\n", err);
+        return -RT_ERROR;
+    }
+    if (acq_rate_set(rate_hz) != RT_EOK) {
+        R_GPT_Close(&acq_gpt_ctrl);
+        return -RT_ERROR;
+    }
+
+    rt_sem_control(&acq_sem, RT_IPC_CMD_RESET, RT_NULL);
+    acq_head = acq_tail = 0;
+    acq_ready = 0;
+    acq_seq++;                          /* 与停止前的块不连续，跨块处理 (波形捕获、抽取、过采样) 按跳号重新开始 */
+    acq_last_scan = 0;
+    acq_period_min = ~0ULL;
+    acq_period_max = 0;
+    acq_stats.scans = acq_stats.blocks = acq_stats.overruns = acq_stats.late = 0;
+    acq_stats.isr_ticks = acq_stats.proc_ticks = 0;
+    acq_stats.isr_calls = 0;
+    acq_running = RT_TRUE;
+
+    /* 两个单元连接同一 GPT 事件，同一时刻开始扫描 */
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        AcqUnit *u = &acq_unit[i];
+        if (u->count == 0) continue;
+        acq_elc_link(u->elc, ACQ_GPT_EVENT);
+        R_ADC_ScanStart(u->ctrl);
+    }
+    R_GPT_Start(&acq_gpt_ctrl);
+    return RT_EOK;
+}
+
+void adc_acq_stop(void)
+{
+    if (!acq_running) return;
+
+    R_GPT_Stop(&acq_gpt_ctrl);
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        AcqUnit *u = &acq_unit[i];
+        if (u->count == 0) continue;
+        R_ADC_ScanStop(u->ctrl);
+        acq_elc_link(u->elc, ACQ_ELC_NONE);
+    }
+    R_GPT_Close(&acq_gpt_ctrl);
+    acq_running = RT_FALSE;
+}
+
+rt_bool_t adc_acq_running(void)
+{
+    return acq_running;
+}
+
+const AdcBlock *adc_acq_wait(rt_int32_t timeout)
+{
+    if (!acq_inited || rt_sem_take(&acq_sem, timeout) != RT_EOK) return RT_NULL;
+    acq_hold_at = perf_now();
+    return &acq_blocks[acq_tail];
+}
+
+void adc_acq_release(const AdcBlock *block)
+{
+    if (acq_ready == 0 || block != &acq_blocks[acq_tail]) return;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    acq_tail = (acq_tail + 1) % ADC_ACQ_BLOCKS;
+    acq_ready--;
+    acq_stats.proc_ticks += perf_now() - acq_hold_at;
+    rt_hw_interrupt_enable(level);
+}
+
+void adc_acq_get_stats(AdcAcqStats *stats)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    *stats = acq_stats;
+    rt_uint64_t pmin = acq_period_min, pmax = acq_period_max;
+    rt_hw_interrupt_enable(level);
+
+    stats->period_min_us = (pmin == ~0ULL) ? 0 : perf_to_us(pmin);
+    stats->period_max_us = perf_to_us(pmax);
+}
+
+rt_uint32_t adc_block_mean(const AdcBlock *block, rt_uint8_t index)
+{
+    if (index >= block->channels || block->scans == 0) return 0;
+
+    rt_uint32_t sum = 0;
+    const rt_uint16_t *p = &block->data[index];
+    for (rt_uint16_t i = 0; i < block->scans; i++, p += block->channels) sum += *p;
+    rt_uint32_t div = (rt_uint32_t)block->scans * block->adds[index];
+    return (sum + div / 2) / div;
+}
+
+/* msh 中的加法模式名称 */
+static const struct {
+    const char *name;
+    adc_add_t add;
+} acq_add_names[] = {
+    { "off", ADC_ADD_OFF }, { "sum2", ADC_ADD_TWO }, { "sum3", ADC_ADD_THREE }, { "sum4", ADC_ADD_FOUR },
+    { "avg2", ADC_ADD_AVERAGE_TWO }, { "avg4", ADC_ADD_AVERAGE_FOUR },
+};
+
+static const char *acq_add_name(adc_add_t add)
+{
+    for (rt_size_t i = 0; i < sizeof(acq_add_names) / sizeof(acq_add_names[0]); i++) {
+        if (acq_add_names[i].add == add) return acq_add_names[i].name;
+    }
+    return "?";
+}
+
+static void acq_print_stats(void)
+{
+    AdcAcqStats st;
+    adc_acq_get_stats(&st);
+
+    rt_kprintf("ADC acq: %s, %u Hz (actual %u.%03u Hz), %u scan/block\n", acq_running ? "running" : "stopped",
+               st.rate, st.rate_actual / 1000, st.rate_actual % 1000, ADC_ACQ_BLOCK_SCANS);
+    for (int i = 0; i < ADC_ACQ_UNITS; i++) {
+        rt_kprintf("  ADC%d: mask 0x%02X, addition %s on 0x%02X\n", i, acq_unit[i].mask,
+                   acq_add_name(acq_unit[i].add), acq_unit[i].add_mask);
+    }
+    rt_kprintf("  Scans %u, blocks %u, overruns %u, late %u\n", st.scans, st.blocks, st.overruns, st.late);
+    rt_kprintf("  Scan interval %u..%u us\n", st.period_min_us, st.period_max_us);
+}
+
+/* 按给定频率运行 sec 秒，统计吞吐量和 CPU 占用 (扫描结束中断 + 处理线程持有块的时间) */
+static void acq_bench(rt_uint32_t rate, rt_uint32_t sec)
+{
+    rt_uint32_t prev = acq_running ? acq_stats.rate : 0;
+
+    adc_acq_stop();
+    if (adc_acq_start(rate) != RT_EOK) {
+        rt_kprintf("start failed at %u Hz\n", rate);
+        if (prev) adc_acq_start(prev);
+        return;
+    }
+
+    rt_uint64_t t0 = perf_now();
+    rt_thread_mdelay(sec * 1000);
+    AdcAcqStats st;
+    adc_acq_get_stats(&st);
+    rt_uint64_t elapsed = perf_now() - t0;
+    rt_uint32_t ms = perf_to_us(elapsed) / 1000;
+    adc_acq_stop();
+
+    if (ms == 0) return;
+    rt_uint64_t expected = (rt_uint64_t)st.rate_actual * ms / 1000000U;
+    rt_uint32_t isr_load = (rt_uint32_t)(st.isr_ticks * 10000U / elapsed);
+    rt_uint32_t proc_load = (rt_uint32_t)(st.proc_ticks * 10000U / elapsed);
+    rt_uint32_t isr_ns = st.isr_calls ? (rt_uint32_t)(perf_to_us(st.isr_ticks * 1000U) / st.isr_calls) : 0;
+
+    rt_kprintf("ADC bench: %u Hz x %u ch, %u ms\n", rate, acq_channels, ms);
+    rt_kprintf("  Scans %u (expected %u), %u sample/s, %u block/s\n", st.scans, (rt_uint32_t)expected,
+               (rt_uint32_t)((rt_uint64_t)st.scans * acq_channels * 1000U / ms), st.blocks * 1000U / ms);
+    rt_kprintf("  Overruns %u, late %u, scan interval %u..%u us\n", st.overruns, st.late,
+               st.period_min_us, st.period_max_us);
+    rt_kprintf("  CPU: ISR %u.%02u%% (%u ns/irq, %u irq), block processing %u.%02u%%\n",
+               isr_load / 100, isr_load % 100, isr_ns, st.isr_calls, proc_load / 100, proc_load % 100);
+
+    if (prev) adc_acq_start(prev);
+}
+
+static int adc_acq(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "start") == 0) {
+        int ret = adc_acq_start((rt_uint32_t)atoi(argv[2]));
+        if (ret == -RT_EBUSY) rt_kprintf("start failed: a block is still held by the processing thread\n");
+        else if (ret != RT_EOK) rt_kprintf("start failed (%d), rate %d..%d Hz\n", ret, ADC_ACQ_RATE_MIN, ADC_ACQ_RATE_MAX);
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        adc_acq_stop();
+        return 0;
+    } else if (argc >= 4 && strcmp(argv[1], "chan") == 0) {
+        int ret = adc_acq_set_channels((rt_uint8_t)atoi(argv[2]), (rt_uint16_t)strtoul(argv[3], RT_NULL, 0));
+        if (ret == -RT_EBUSY) rt_kprintf("stop acquisition first\n");
+        else if (ret != RT_EOK) rt_kprintf("invalid unit or channel mask\n");
+        return ret;
+    } else if (argc >= 5 && strcmp(argv[1], "add") == 0) {
+        int ret = -RT_EINVAL;
+        for (rt_size_t i = 0; i < sizeof(acq_add_names) / sizeof(acq_add_names[0]); i++) {
+            if (strcmp(argv[4], acq_add_names[i].name) == 0) {
+                ret = adc_acq_set_addition((rt_uint8_t)atoi(argv[2]), (rt_uint16_t)strtoul(argv[3], RT_NULL, 0),
+                                           acq_add_names[i].add);
+                break;
+            }
+        }
+        if (ret == -RT_EBUSY) rt_kprintf("stop acquisition first\n");
+        else if (ret != RT_EOK) rt_kprintf("invalid unit, mask or mode (off|sum2|sum3|sum4|avg2|avg4)\n");
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        rt_uint32_t rate = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : ADC_ACQ_RATE_MAX;
+        rt_uint32_t sec = (argc >= 4) ? (rt_uint32_t)atoi(argv[3]) : 5;
+        acq_bench(rate, sec ? sec : 1);
+        return 0;
+    } else if (argc < 2 || strcmp(argv[1], "stat") == 0) {
+        acq_init();
+        acq_print_stats();
+        return 0;
+    }
+
+    rt_kprintf("Usage: adc_acq [stat]\n");
+    rt_kprintf("       adc_acq start <hz>\n");
+    rt_kprintf("       adc_acq stop\n");
+    rt_kprintf("       adc_acq chan <unit> <mask>\n");
+    rt_kprintf("       adc_acq add <unit> <mask> <off|sum2|sum3|sum4|avg2|avg4>\n");
+    rt_kprintf("       adc_acq bench [hz] [sec]\n");
+    return 0;
+}
+MSH_CMD_EXPORT(adc_acq, GPT/ELC paced ADC acquisition);
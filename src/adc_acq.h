@@ -0,0 +1,83 @@
+#ifndef __ADC_ACQ_H__
+#define __ADC_ACQ_H__
+
+#include <rtthread.h>
+#include "hal_data.h"
+
+/*
+ * 硬件定时 ADC 采集：GPT 周期溢出事件经 ELC 同时触发 ADC0 和 ADC1 的扫描组，
+ * 两个单元的扫描结束中断把各自通道的结果写入同一采样块的同一行。
+ *
+ * 采样时刻只取决于 GPT 计数，不受线程调度影响；中断中只读结果寄存器和追加到当前块，
+ * 块满 (两个单元都完成 ADC_ACQ_BLOCK_SCANS 次扫描) 后交给处理线程 (adc_acq_wait)，
+ * 处理线程按块处理数据，不再逐点读取。块在 ADC_ACQ_BLOCKS 个缓冲间轮转，
+ * 处理线程来不及释放时丢弃正在填充的块并计入 overruns。
+ *
+ * g_adc0 / g_adc1 由本模块独占 (FSP 配置为 ELC 同步触发、单次扫描)，RT-Thread 的 adc0/adc1 设备不再可用。
+ */
+#define ADC_ACQ_RATE_DEFAULT    1000    /* 扫描频率 Hz */
+#define ADC_ACQ_RATE_MIN        1
+#define ADC_ACQ_RATE_MAX        50000
+#define ADC_ACQ_UNITS           2
+#define ADC_ACQ_MAX_CHANNELS    12      /* ADC0 通道 0-3 + ADC1 通道 0-7 */
+#define ADC_ACQ_BLOCK_SCANS     100     /* 每块扫描次数，默认频率下每 100 ms 一块 */
+#define ADC_ACQ_BLOCKS          4
+
+/* 块内通道标识：单元号和通道号 */
+#define ADC_ACQ_CHAN(unit, ch)  (rt_uint8_t)(((unit) << 4) | (ch))
+#define ADC_ACQ_CHAN_UNIT(id)   ((id) >> 4)
+#define ADC_ACQ_CHAN_NUM(id)    ((id) & 0x0F)
+
+typedef struct {
+    rt_uint32_t seq;            /* 块序号，连续递增，跳号表示溢出丢块 */
+    rt_uint64_t t_first;        /* 首次扫描结束时间 (perf_now 计数) */
+    rt_uint32_t rate;           /* 扫描频率 Hz */
+    rt_uint16_t scans;
+    rt_uint8_t  channels;       /* 每次扫描的通道数 (两个单元合计) */
+    rt_uint8_t  channel_id[ADC_ACQ_MAX_CHANNELS];   /* ADC_ACQ_CHAN，ADC0 在前 */
+    rt_uint8_t  adds[ADC_ACQ_MAX_CHANNELS];         /* 每个结果是几次转换之和 (硬件加法)，平均模式和未启用时为 1 */
+    /* 按扫描交错存放：data[scan * channels + i] 为 channel_id[i] 的结果 */
+    rt_uint16_t data[ADC_ACQ_BLOCK_SCANS * ADC_ACQ_MAX_CHANNELS];
+} AdcBlock;
+
+typedef struct {
+    rt_uint32_t rate;           /* 设定频率 */
+    rt_uint32_t rate_actual;    /* GPT 周期取整后的实际频率，0.001 Hz */
+    rt_uint32_t scans;          /* 完成的扫描行数 */
+    rt_uint32_t blocks;
+    rt_uint32_t overruns;
+    rt_uint32_t late;           /* 某单元扫描未在下一次触发前完成，丢弃的结果数 */
+    rt_uint32_t period_min_us;  /* 相邻扫描结束中断间隔，反映触发抖动 */
+    rt_uint32_t period_max_us;
+    rt_uint64_t isr_ticks;      /* 扫描结束中断累计耗时 (perf_now 计数) */
+    rt_uint32_t isr_calls;
+    rt_uint64_t proc_ticks;     /* 处理线程从 adc_acq_wait 返回到 adc_acq_release 的累计耗时 */
+} AdcAcqStats;
+
+/* API */
+/* 按 rate_hz 启动采集，已在运行时重新设定频率；处理线程持有的块 500 ms 内未归还时返回 -RT_EBUSY */
+int  adc_acq_start(rt_uint32_t rate_hz);
+void adc_acq_stop(void);
+rt_bool_t adc_acq_running(void);
+
+/* 设置单元的扫描通道位图 (0 表示不使用该单元)，停止状态下调用，下次启动生效 */
+int  adc_acq_set_channels(rt_uint8_t unit, rt_uint16_t mask);
+
+/*
+ * 硬件加法/平均：单元内 mask 中的通道每次触发连续转换 add 次，结果寄存器给出和 (ADC_ADD_TWO..FOUR)
+ * 或平均值 (ADC_ADD_AVERAGE_TWO / FOUR)。次数对整个单元生效，停止状态下调用，下次启动生效。
+ * 不支持 16 次加法：和可达 16 位，超出块内按 int16 处理的范围。
+ */
+int  adc_acq_set_addition(rt_uint8_t unit, rt_uint16_t mask, adc_add_t add);
+void adc_acq_get_addition(rt_uint8_t unit, rt_uint16_t *mask, adc_add_t *add);
+
+/* 等待下一个满块，超时返回 RT_NULL；块在 adc_acq_release 之前不会被覆盖 */
+const AdcBlock *adc_acq_wait(rt_int32_t timeout);
+void adc_acq_release(const AdcBlock *block);
+
+void adc_acq_get_stats(AdcAcqStats *stats);
+
+/* 块内指定序号通道的平均值 (12 位码值，加法模式的结果已除以次数) */
+rt_uint32_t adc_block_mean(const AdcBlock *block, rt_uint8_t index);
+
+#endif
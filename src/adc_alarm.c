@@ -0,0 +1,307 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hal_data.h"
+#include "adc_acq.h"
+#include "adc_alarm.h"
+#include "perf_counter.h"
+
+#define ALARM_WIN_A         0
+#define ALARM_WIN_B         1
+#define ALARM_REF_MAX       0xFFFFU     /* 比较上限寄存器最大值，转换结果不可能超过 */
+#define ALARM_MV_FULL       3300        /* msh 命令按 mV 输入门限，12 位满量程 */
+#define ALARM_CODE_FULL     4096
+
+typedef struct {
+    rt_uint8_t  enabled;
+    rt_uint8_t  ch;
+    rt_uint16_t low;
+    rt_uint16_t high;
+    rt_uint16_t hyst;
+    rt_uint8_t  gain;           /* 硬件加法次数，比较器看到的是和 */
+    volatile rt_uint8_t state;
+    rt_uint32_t edges;
+} AlarmSlot;
+
+static AlarmSlot alarm_slot[ADC_ACQ_UNITS][ADC_ALARM_WINDOWS];
+static adc_window_cfg_t alarm_window[ADC_ACQ_UNITS];
+static adc_instance_ctrl_t * const alarm_ctrl[ADC_ACQ_UNITS] = { &g_adc0_ctrl, &g_adc1_ctrl };
+static const rt_uint16_t alarm_valid[ADC_ACQ_UNITS] = { BSP_FEATURE_ADC_UNIT_0_CHANNELS, BSP_FEATURE_ADC_UNIT_1_CHANNELS };
+
+/* 比较中断写 head，上报线程读 tail；所有比较中断同一优先级，不会互相嵌套 */
+static AdcAlarmEvent alarm_queue[ADC_ALARM_QUEUE];
+static volatile rt_uint8_t alarm_head;
+static volatile rt_uint8_t alarm_tail;
+static struct rt_semaphore alarm_sem;
+static rt_bool_t alarm_inited = RT_FALSE;
+static AdcAlarmStats alarm_stats;
+
+static void alarm_init(void)
+{
+    if (alarm_inited) return;
+    rt_sem_init(&alarm_sem, "adc_alm", 0, RT_IPC_FLAG_FIFO);
+    alarm_inited = RT_TRUE;
+}
+
+/* 当前状态对应的窗口 (按加法次数放大)，条件为 "窗口外" */
+static void alarm_bounds(const AlarmSlot *s, rt_uint16_t *lo, rt_uint16_t *hi)
+{
+    switch (s->state) {
+    case ADC_ALARM_HIGH:
+        *lo = (rt_uint16_t)((s->high - s->hyst) * s->gain);
+        *hi = ALARM_REF_MAX;
+        break;
+    case ADC_ALARM_LOW:
+        *lo = 0;
+        *hi = (rt_uint16_t)((s->low + s->hyst) * s->gain);
+        break;
+    default:
+        *lo = (rt_uint16_t)(s->low * s->gain);
+        *hi = (rt_uint16_t)(s->high * s->gain);
+        break;
+    }
+}
+
+static AlarmSlot *alarm_find(rt_uint8_t unit, rt_uint8_t ch)
+{
+    for (int w = 0; w < ADC_ALARM_WINDOWS; w++) {
+        if (alarm_slot[unit][w].enabled && alarm_slot[unit][w].ch == ch) return &alarm_slot[unit][w];
+    }
+    return RT_NULL;
+}
+
+int adc_alarm_set(rt_uint8_t unit, rt_uint8_t ch, rt_uint16_t low, rt_uint16_t high, rt_uint16_t hyst)
+{
+    if (unit >= ADC_ACQ_UNITS || ch >= 16 || !(alarm_valid[unit] & (1U << ch))) return -RT_EINVAL;
+    if (low >= high || hyst >= high - low || (rt_uint32_t)low + hyst > ALARM_REF_MAX) return -RT_EINVAL;
+    if (adc_acq_running()) return -RT_EBUSY;
+
+    alarm_init();
+    AlarmSlot *s = alarm_find(unit, ch);
+    for (int w = 0; s == RT_NULL && w < ADC_ALARM_WINDOWS; w++) {
+        if (!alarm_slot[unit][w].enabled) s = &alarm_slot[unit][w];
+    }
+    if (s == RT_NULL) return -RT_EFULL;
+
+    s->ch = ch;
+    s->low = low;
+    s->high = high;
+    s->hyst = hyst;
+    s->gain = 1;
+    s->state = ADC_ALARM_NORMAL;
+    s->enabled = 1;
+    return RT_EOK;
+}
+
+int adc_alarm_clear(rt_uint8_t unit, rt_uint8_t ch)
+{
+    if (unit >= ADC_ACQ_UNITS) return -RT_EINVAL;
+    if (adc_acq_running()) return -RT_EBUSY;
+
+    AlarmSlot *s = alarm_find(unit, ch);
+    if (s == RT_NULL) return -RT_EEMPTY;
+    s->enabled = 0;
+    return RT_EOK;
+}
+
+adc_window_cfg_t *adc_alarm_window(rt_uint8_t unit, rt_uint16_t scan_mask, rt_uint16_t add_mask, rt_uint8_t add_times)
+{
+    if (unit >= ADC_ACQ_UNITS) return RT_NULL;
+
+    alarm_init();
+    AlarmSlot *a = &alarm_slot[unit][ALARM_WIN_A];
+    AlarmSlot *b = &alarm_slot[unit][ALARM_WIN_B];
+    adc_window_cfg_t *cfg = &alarm_window[unit];
+    rt_uint32_t compare = 0;
+    rt_uint16_t lo, hi;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    /* 不在扫描组内的通道不会转换，也就不会比较 */
+    if (a->enabled && (scan_mask & (1U << a->ch))) {
+        a->state = ADC_ALARM_NORMAL;
+        a->gain = (add_mask & (1U << a->ch)) ? add_times : 1;
+        alarm_bounds(a, &lo, &hi);
+        compare |= ADC_COMPARE_CFG_A_ENABLE;
+        cfg->compare_mask = 1U << a->ch;
+        cfg->compare_mode_mask = 0;             /* 窗口外 */
+        cfg->compare_ref_low = lo;
+        cfg->compare_ref_high = hi;
+    }
+    if (b->enabled && (scan_mask & (1U << b->ch))) {
+        b->state = ADC_ALARM_NORMAL;
+        b->gain = (add_mask & (1U << b->ch)) ? add_times : 1;
+        alarm_bounds(b, &lo, &hi);
+        compare |= ADC_COMPARE_CFG_B_ENABLE;
+        cfg->compare_b_channel = (adc_window_b_channel_t)b->ch;
+        cfg->compare_b_mode = ADC_WINDOW_B_MODE_LESS_THAN_OR_OUTSIDE;
+        cfg->compare_b_ref_low = lo;
+        cfg->compare_b_ref_high = hi;
+    }
+    if (compare == 0) return RT_NULL;
+
+    cfg->compare_cfg = (adc_compare_cfg_t)(compare | ADC_COMPARE_CFG_WINDOW_ENABLE);
+    return cfg;
+}
+
+void adc_alarm_isr(adc_callback_args_t *p_args)
+{
+    rt_uint64_t now = perf_now();
+    rt_uint8_t unit = (rt_uint8_t)p_args->unit;
+    if (unit >= ADC_ACQ_UNITS) return;
+
+    rt_uint8_t win = (p_args->event == ADC_EVENT_WINDOW_COMPARE_A) ? ALARM_WIN_A : ALARM_WIN_B;
+    AlarmSlot *s = &alarm_slot[unit][win];
+    if (!s->enabled || s->ch != (rt_uint8_t)p_args->channel) return;
+
+    R_ADC121_Type *reg = alarm_ctrl[unit]->p_reg;
+    rt_uint16_t raw = (rt_uint16_t)(reg->ADDR[s->ch] / s->gain);
+    rt_uint8_t next;
+    rt_uint16_t threshold;
+
+    /* 正常状态下越出窗口，由结果判断方向；报警状态下触发即表示已越过回差门限 */
+    if (s->state != ADC_ALARM_NORMAL) {
+        threshold = (s->state == ADC_ALARM_HIGH) ? (rt_uint16_t)(s->high - s->hyst) : (rt_uint16_t)(s->low + s->hyst);
+        next = ADC_ALARM_NORMAL;
+    } else if (raw > s->high) {
+        threshold = s->high;
+        next = ADC_ALARM_HIGH;
+    } else if (raw < s->low) {
+        threshold = s->low;
+        next = ADC_ALARM_LOW;
+    } else {
+        alarm_stats.spurious++;
+        return;
+    }
+
+    /* 换成新状态的窗口，下一次转换起生效 */
+    s->state = next;
+    s->edges++;
+    rt_uint16_t lo, hi;
+    alarm_bounds(s, &lo, &hi);
+    if (win == ALARM_WIN_A) {
+        reg->ADCMPDR0 = lo;
+        reg->ADCMPDR1 = hi;
+    } else {
+        reg->ADWINLLB = lo;
+        reg->ADWINULB = hi;
+    }
+
+    alarm_stats.events++;
+    rt_uint8_t head = alarm_head;
+    rt_uint8_t next_head = (rt_uint8_t)((head + 1) % ADC_ALARM_QUEUE);
+    if (next_head == alarm_tail) {
+        alarm_stats.dropped++;
+        return;
+    }
+
+    AdcAlarmEvent *ev = &alarm_queue[head];
+    ev->t = now;
+    ev->chan = ADC_ACQ_CHAN(unit, s->ch);
+    ev->state = next;
+    ev->raw = raw;
+    ev->threshold = threshold;
+    alarm_head = next_head;
+    rt_sem_release(&alarm_sem);
+}
+
+rt_bool_t adc_alarm_wait(rt_int32_t timeout)
+{
+    alarm_init();
+    return rt_sem_take(&alarm_sem, timeout) == RT_EOK;
+}
+
+rt_bool_t adc_alarm_collect(AdcAlarmEvent *ev)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    if (alarm_tail == alarm_head) {
+        rt_hw_interrupt_enable(level);
+        return RT_FALSE;
+    }
+    *ev = alarm_queue[alarm_tail];
+    alarm_tail = (rt_uint8_t)((alarm_tail + 1) % ADC_ALARM_QUEUE);
+    rt_hw_interrupt_enable(level);
+
+    rt_uint32_t wake = perf_to_us(perf_now() - ev->t);
+    if (wake > alarm_stats.wake_max_us) alarm_stats.wake_max_us = wake;
+    return RT_TRUE;
+}
+
+void adc_alarm_done(const AdcAlarmEvent *ev)
+{
+    rt_uint32_t us = perf_to_us(perf_now() - ev->t);
+    alarm_stats.done++;
+    alarm_stats.latency_sum_us += us;
+    if (us > alarm_stats.latency_max_us) alarm_stats.latency_max_us = us;
+}
+
+void adc_alarm_get_stats(AdcAlarmStats *stats)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    *stats = alarm_stats;
+    rt_hw_interrupt_enable(level);
+}
+
+static const char *alarm_state_name(rt_uint8_t state)
+{
+    static const char *const names[] = { "normal", "HIGH", "LOW" };
+    return (state < 3) ? names[state] : "?";
+}
+
+static rt_uint16_t alarm_mv_to_code(rt_uint32_t mv)
+{
+    rt_uint32_t code = (mv * ALARM_CODE_FULL + ALARM_MV_FULL / 2) / ALARM_MV_FULL;
+    return (rt_uint16_t)((code > ALARM_CODE_FULL - 1) ? ALARM_CODE_FULL - 1 : code);
+}
+
+static rt_uint32_t alarm_code_to_mv(rt_uint32_t code)
+{
+    return (code * ALARM_MV_FULL + ALARM_CODE_FULL / 2) / ALARM_CODE_FULL;
+}
+
+static void alarm_print(void)
+{
+    AdcAlarmStats st;
+    adc_alarm_get_stats(&st);
+
+    rt_kprintf("ADC alarms (%s):\n", adc_acq_running() ? "armed" : "acquisition stopped");
+    for (int u = 0; u < ADC_ACQ_UNITS; u++) {
+        for (int w = 0; w < ADC_ALARM_WINDOWS; w++) {
+            const AlarmSlot *s = &alarm_slot[u][w];
+            if (!s->enabled) continue;
+            rt_kprintf("  ADC%d ch%d (window %c): low %u mV high %u mV hyst %u mV, %s, %u edges\n", u, s->ch,
+                       'A' + w, alarm_code_to_mv(s->low), alarm_code_to_mv(s->high), alarm_code_to_mv(s->hyst),
+                       alarm_state_name(s->state), s->edges);
+        }
+    }
+    rt_kprintf("  Events %u, dropped %u, spurious %u\n", st.events, st.dropped, st.spurious);
+    rt_kprintf("  Latency: irq -> thread max %u us, irq -> published max %u us avg %u us\n", st.wake_max_us,
+               st.latency_max_us, st.done ? (rt_uint32_t)(st.latency_sum_us / st.done) : 0);
+}
+
+static int adc_alarm(int argc, char **argv)
+{
+    int ret = RT_EOK;
+
+    if (argc >= 6 && strcmp(argv[1], "set") == 0) {
+        rt_uint32_t hyst = (argc >= 7) ? (rt_uint32_t)atoi(argv[6]) : 0;
+        ret = adc_alarm_set((rt_uint8_t)atoi(argv[2]), (rt_uint8_t)atoi(argv[3]), alarm_mv_to_code(atoi(argv[4])),
+                            alarm_mv_to_code(atoi(argv[5])), alarm_mv_to_code(hyst));
+    } else if (argc >= 4 && strcmp(argv[1], "clear") == 0) {
+        ret = adc_alarm_clear((rt_uint8_t)atoi(argv[2]), (rt_uint8_t)atoi(argv[3]));
+    } else if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        alarm_print();
+        return 0;
+    } else {
+        rt_kprintf("Usage: adc_alarm [list]\n");
+        rt_kprintf("       adc_alarm set <unit> <ch> <low_mV> <high_mV> [hyst_mV]\n");
+        rt_kprintf("       adc_alarm clear <unit> <ch>\n");
+        return 0;
+    }
+
+    if (ret == -RT_EBUSY) rt_kprintf("stop acquisition first (adc_acq stop)\n");
+    else if (ret == -RT_EFULL) rt_kprintf("both comparators of this unit in use\n");
+    else if (ret != RT_EOK) rt_kprintf("invalid channel or thresholds\n");
+    return ret;
+}
+MSH_CMD_EXPORT(adc_alarm, ADC window-compare threshold alarms);
@@ -0,0 +1,70 @@
+#ifndef __ADC_ALARM_H__
+#define __ADC_ALARM_H__
+
+#include <rtthread.h>
+#include "hal_data.h"
+
+/*
+ * ADC 门限报警：由 ADC 比较功能在每次转换后硬件判断，不再由处理线程按上报周期软件比较。
+ *
+ * 每个单元有窗口 A 和窗口 B 两个比较器，各监视一个通道，因此每个单元最多两路报警。
+ * 比较器工作在窗口模式、"窗口外" 条件，窗口随报警状态切换，实现回差：
+ *   正常   [low, high]          低于 low 进入 LOW，高于 high 进入 HIGH
+ *   HIGH   [high - hyst, 上限]   回落到 high - hyst 以下回到正常
+ *   LOW    [0, low + hyst]       回升到 low + hyst 以上回到正常
+ * 条件满足时比较中断中记录时间戳、切换窗口并把边沿事件放入报警队列，由高优先级线程立即上报；
+ * 状态不变时比较器不再触发，中断只在边沿发生。
+ *
+ * 门限为转换结果码值。报警通道须在 adc_acq 的扫描通道内，配置在采集停止时修改，下次 adc_acq_start 生效。
+ * 比较中断里要读结果寄存器判断越限方向，ADC 配置为读后不清零。
+ */
+#define ADC_ALARM_WINDOWS       2       /* 每个单元的比较器：窗口 A / B */
+#define ADC_ALARM_QUEUE         16      /* 中断与上报线程之间的事件队列长度 */
+
+typedef enum {
+    ADC_ALARM_NORMAL = 0,
+    ADC_ALARM_HIGH = 1,
+    ADC_ALARM_LOW = 2,
+} AdcAlarmState;
+
+/* 一次报警状态变化 */
+typedef struct {
+    rt_uint64_t t;              /* 比较中断时刻 (perf_now 计数) */
+    rt_uint8_t  chan;           /* ADC_ACQ_CHAN */
+    rt_uint8_t  state;          /* 进入的状态 AdcAlarmState */
+    rt_uint16_t raw;            /* 触发时的转换结果 (12 位码值) */
+    rt_uint16_t threshold;      /* 越过的门限 (码值) */
+} AdcAlarmEvent;
+
+typedef struct {
+    rt_uint32_t events;
+    rt_uint32_t dropped;        /* 队列满丢弃的事件 */
+    rt_uint32_t spurious;       /* 比较中断时结果已回到窗口内 (噪声)，不产生事件 */
+    rt_uint32_t wake_max_us;    /* 中断到上报线程取出事件的最大延迟 */
+    rt_uint32_t done;           /* 已上报的事件 */
+    rt_uint32_t latency_max_us; /* 中断到上报完成的最大延迟 */
+    rt_uint64_t latency_sum_us;
+} AdcAlarmStats;
+
+/* 设置通道的报警门限 (码值)，low 为 0 时不做低限报警；回差 hyst 须小于 high - low，否则返回 -RT_EINVAL。
+ * 采集运行中返回 -RT_EBUSY，两个比较器都已占用返回 -RT_EFULL */
+int  adc_alarm_set(rt_uint8_t unit, rt_uint8_t ch, rt_uint16_t low, rt_uint16_t high, rt_uint16_t hyst);
+int  adc_alarm_clear(rt_uint8_t unit, rt_uint8_t ch);
+
+/* adc_acq 配置扫描组时调用：按本单元的报警生成比较配置并复位报警状态，无报警时返回 RT_NULL；
+ * add_mask 中的通道结果为 add_times 次转换之和，门限相应放大 */
+adc_window_cfg_t *adc_alarm_window(rt_uint8_t unit, rt_uint16_t scan_mask, rt_uint16_t add_mask, rt_uint8_t add_times);
+
+/* 比较中断回调 (由 adc_acq_callback 转发 ADC_EVENT_WINDOW_COMPARE_A/B)，中断上下文 */
+void adc_alarm_isr(adc_callback_args_t *p_args);
+
+/* 等待报警事件，超时返回 RT_FALSE；之后用 adc_alarm_collect 取空队列 */
+rt_bool_t adc_alarm_wait(rt_int32_t timeout);
+rt_bool_t adc_alarm_collect(AdcAlarmEvent *ev);
+
+/* 事件上报完成后调用，统计端到端延迟 */
+void adc_alarm_done(const AdcAlarmEvent *ev);
+
+void adc_alarm_get_stats(AdcAlarmStats *stats);
+
+#endif
@@ -0,0 +1,284 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "adc_acq.h"
+#include "adc_oversample.h"
+#include "dsp_kernel.h"
+#include "perf_counter.h"
+
+#define OS_CODE_FULL        4096.0      /* 12 位满量程，ENOB 以此为基准 */
+#define OS_SW_WINDOW        10          /* 对比用的软件滑动平均窗口 (原 app_task 的 FILTER_WINDOW_SIZE) */
+#define OS_CHUNK            ADC_ACQ_BLOCK_SCANS
+
+static rt_uint8_t os_bits[ADC_ACQ_UNITS][16];
+
+/* bench 记录：处理线程在 adc_os_tap 中写入，记录满后释放 os_bench_sem */
+static rt_uint16_t os_rec[ADC_OS_BENCH_MAX];
+static volatile rt_uint32_t os_rec_want;
+static rt_uint32_t os_rec_len;
+static rt_uint8_t os_rec_chan;
+static rt_uint8_t os_rec_adds;
+static struct rt_semaphore os_bench_sem;
+static rt_bool_t os_inited = RT_FALSE;
+
+static void os_init(void)
+{
+    if (os_inited) return;
+    rt_sem_init(&os_bench_sem, "adc_os", 0, RT_IPC_FLAG_FIFO);
+    os_inited = RT_TRUE;
+}
+
+int adc_os_set(rt_uint8_t unit, rt_uint8_t ch, rt_uint8_t bits)
+{
+    if (unit >= ADC_ACQ_UNITS || ch >= 16 || bits > ADC_OS_MAX_BITS) return -RT_EINVAL;
+    os_bits[unit][ch] = bits;
+    return RT_EOK;
+}
+
+rt_uint8_t adc_os_get(rt_uint8_t chan)
+{
+    rt_uint8_t unit = ADC_ACQ_CHAN_UNIT(chan);
+    return (unit < ADC_ACQ_UNITS) ? os_bits[unit][ADC_ACQ_CHAN_NUM(chan)] : 0;
+}
+
+void adc_os_reset(AdcOversampler *os)
+{
+    os->fill = 0;
+    os->acc = 0;
+}
+
+rt_uint32_t adc_os_run(AdcOversampler *os, const rt_uint16_t *src, rt_uint32_t stride, rt_uint32_t n,
+                       float scale, float *out)
+{
+    rt_uint32_t len = 1U << (2 * os->bits);
+    float k = scale / (float)len;
+    rt_uint32_t acc = os->acc, fill = os->fill, m = 0;
+
+    for (rt_uint32_t i = 0; i < n; i++, src += stride) {
+        acc += *src;
+        if (++fill == len) {
+            out[m++] = (float)acc * k;
+            acc = 0;
+            fill = 0;
+        }
+    }
+    os->acc = acc;
+    os->fill = (rt_uint16_t)fill;
+    return m;
+}
+
+rt_uint32_t adc_os_process(AdcOversampler *os, const AdcBlock *block, rt_uint8_t index, float volt_per_code,
+                           float *out, rt_uint32_t *first)
+{
+    if (index >= block->channels) return 0;
+
+    rt_uint8_t chan = block->channel_id[index];
+    rt_uint8_t bits = adc_os_get(chan);
+    float scale = volt_per_code / (float)block->adds[index];
+
+    if (chan != os->chan || bits != os->bits || block->seq != os->next_block) {
+        os->chan = chan;
+        os->bits = bits;
+        adc_os_reset(os);
+    }
+    os->next_block = block->seq + 1;
+
+    /* 不过采样时直接换算整列 */
+    if (bits == 0) {
+        dsp_i16_to_f32((const rt_int16_t *)&block->data[index], block->channels, out, block->scans, scale);
+        *first = 0;
+        return block->scans;
+    }
+
+    *first = (1U << (2 * bits)) - 1 - os->fill;
+    return adc_os_run(os, &block->data[index], block->channels, block->scans, scale, out);
+}
+
+void adc_os_tap(const AdcBlock *block)
+{
+    if (os_rec_want == 0) return;
+
+    for (rt_uint8_t i = 0; i < block->channels; i++) {
+        if (block->channel_id[i] != os_rec_chan) continue;
+
+        const rt_uint16_t *p = &block->data[i];
+        os_rec_adds = block->adds[i];
+        for (rt_uint16_t s = 0; s < block->scans && os_rec_len < os_rec_want; s++, p += block->channels) {
+            os_rec[os_rec_len++] = *p;
+        }
+        if (os_rec_len >= os_rec_want) {
+            os_rec_want = 0;
+            rt_sem_release(&os_bench_sem);
+        }
+        return;
+    }
+}
+
+/* ---------- 噪声 / ENOB 测量 ---------- */
+
+typedef struct {
+    rt_uint32_t count;
+    double sum;
+    double sum2;
+    rt_uint64_t ticks;
+} OsResult;
+
+static void os_result_add(OsResult *r, const float *x, rt_uint32_t n)
+{
+    for (rt_uint32_t i = 0; i < n; i++) {
+        r->sum += x[i];
+        r->sum2 += (double)x[i] * x[i];
+    }
+    r->count += n;
+}
+
+/* 输入按 DC 处理：标准差即噪声，ENOB = log2(满量程 / (σ * sqrt(12)))，按 12 位码值计 */
+static void os_result_print(const char *mode, const char *filter, const OsResult *r, rt_uint32_t samples)
+{
+    double mean = r->count ? r->sum / r->count : 0;
+    double var = (r->count > 1) ? (r->sum2 - r->sum * mean) / (r->count - 1) : 0;
+    double sigma = (var > 0) ? sqrt(var) : 0;
+    double enob = (sigma > 0) ? log2(OS_CODE_FULL / (sigma * sqrt(12.0))) : 0;
+    rt_uint32_t cyc100 = samples ? (rt_uint32_t)(perf_to_cycles(r->ticks) * 100 / samples) : 0;
+
+    rt_kprintf("  %-5s %-8s %5u %8d.%03d %3d.%02d %5u.%02u\n", mode, filter, r->count, (int)sigma,
+               (int)(sigma * 1000) % 1000, (int)enob, (int)(enob * 100) % 100, cyc100 / 100, cyc100 % 100);
+}
+
+/* 原 app_task 的滑动平均，逐点输出 */
+static void os_eval_window(const char *mode, rt_uint32_t n, float scale)
+{
+    float ring[OS_SW_WINDOW], out[OS_CHUNK];
+    float sum = 0;
+    rt_uint32_t idx = 0, count = 0;
+    OsResult r;
+
+    memset(&r, 0, sizeof(r));
+    for (rt_uint32_t base = 0; base < n; base += OS_CHUNK) {
+        rt_uint32_t len = (n - base < OS_CHUNK) ? n - base : OS_CHUNK;
+        rt_uint32_t m = 0;
+        rt_uint64_t t0 = perf_now();
+        for (rt_uint32_t i = 0; i < len; i++) {
+            float v = os_rec[base + i] * scale;
+            if (count >= OS_SW_WINDOW) sum -= ring[idx];
+            else count++;
+            ring[idx] = v;
+            sum += v;
+            idx = (idx + 1) % OS_SW_WINDOW;
+            if (count >= OS_SW_WINDOW) out[m++] = sum / OS_SW_WINDOW;
+        }
+        r.ticks += perf_now() - t0;
+        os_result_add(&r, out, m);
+    }
+    os_result_print(mode, "win10", &r, n);
+}
+
+static void os_eval_oversample(const char *mode, rt_uint32_t n, float scale, rt_uint8_t bits)
+{
+    AdcOversampler os = { .bits = bits };
+    float out[OS_CHUNK];
+    OsResult r;
+    char name[12];
+
+    memset(&r, 0, sizeof(r));
+    for (rt_uint32_t base = 0; base < n; base += OS_CHUNK) {
+        rt_uint32_t len = (n - base < OS_CHUNK) ? n - base : OS_CHUNK;
+        rt_uint64_t t0 = perf_now();
+        rt_uint32_t m = adc_os_run(&os, &os_rec[base], 1, len, scale, out);
+        r.ticks += perf_now() - t0;
+        os_result_add(&r, out, m);
+    }
+    rt_snprintf(name, sizeof(name), bits ? "os k=%u" : "raw", bits);
+    os_result_print(mode, name, &r, n);
+}
+
+/* 按硬件加法模式依次重启采集，记录 n 个样本，对同一记录比较原始值、滑动平均和各级软件过采样 */
+static void os_bench(rt_uint8_t unit, rt_uint8_t ch, rt_uint32_t n)
+{
+    static const struct {
+        const char *name;
+        adc_add_t add;
+    } modes[] = {
+        { "off", ADC_ADD_OFF }, { "avg2", ADC_ADD_AVERAGE_TWO }, { "avg4", ADC_ADD_AVERAGE_FOUR }, { "sum4", ADC_ADD_FOUR },
+    };
+    AdcAcqStats st;
+    rt_uint16_t prev_mask;
+    adc_add_t prev_add;
+
+    adc_acq_get_stats(&st);
+    rt_uint32_t rate = adc_acq_running() ? st.rate : ADC_ACQ_RATE_DEFAULT;
+    adc_acq_get_addition(unit, &prev_mask, &prev_add);
+
+    rt_kprintf("ADC%d ch%d: %u samples at %u Hz per mode, input assumed DC\n", unit, ch, n, rate);
+    rt_kprintf("  %-5s %-8s %5s %12s %6s %8s\n", "hw", "filter", "out", "sigma(LSB)", "ENOB", "cyc/smp");
+
+    for (rt_size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        adc_acq_stop();
+        if (adc_acq_set_addition(unit, (rt_uint16_t)(1U << ch), modes[i].add) != RT_EOK ||
+            adc_acq_start(rate) != RT_EOK) {
+            rt_kprintf("  %-5s start failed\n", modes[i].name);
+            continue;
+        }
+
+        rt_sem_control(&os_bench_sem, RT_IPC_CMD_RESET, RT_NULL);
+        os_rec_chan = ADC_ACQ_CHAN(unit, ch);
+        os_rec_len = 0;
+        os_rec_want = n;
+        rt_int32_t timeout = (rt_int32_t)(n * 2000U / rate) + 2000;
+        if (rt_sem_take(&os_bench_sem, rt_tick_from_millisecond(timeout)) != RT_EOK) {
+            os_rec_want = 0;
+            rt_kprintf("  %-5s timeout (%u samples), is the ADC thread running?\n", modes[i].name, os_rec_len);
+            continue;
+        }
+
+        adc_acq_get_stats(&st);
+        float scale = 1.0f / os_rec_adds;
+        os_eval_oversample(modes[i].name, n, scale, 0);
+        os_eval_window(modes[i].name, n, scale);
+        for (rt_uint8_t bits = 1; bits <= ADC_OS_MAX_BITS; bits++) {
+            if ((n >> (2 * bits)) >= 2) os_eval_oversample(modes[i].name, n, scale, bits);
+        }
+        rt_kprintf("  %-5s ISR %u ns/scan\n", modes[i].name,
+                   st.isr_calls ? (rt_uint32_t)(perf_to_us(st.isr_ticks * 1000U) / st.isr_calls) : 0);
+    }
+
+    adc_acq_stop();
+    adc_acq_set_addition(unit, prev_mask, prev_add);
+    adc_acq_start(rate);
+}
+
+static int adc_os(int argc, char **argv)
+{
+    os_init();
+
+    if (argc >= 5 && strcmp(argv[1], "set") == 0) {
+        int ret = adc_os_set((rt_uint8_t)atoi(argv[2]), (rt_uint8_t)atoi(argv[3]), (rt_uint8_t)atoi(argv[4]));
+        if (ret != RT_EOK) rt_kprintf("invalid unit/channel or bits (0..%d)\n", ADC_OS_MAX_BITS);
+        return ret;
+    } else if (argc >= 4 && strcmp(argv[1], "bench") == 0) {
+        rt_uint8_t unit = (rt_uint8_t)atoi(argv[2]), ch = (rt_uint8_t)atoi(argv[3]);
+        rt_uint32_t n = (argc >= 5) ? (rt_uint32_t)atoi(argv[4]) : ADC_OS_BENCH_MAX;
+        if (unit >= ADC_ACQ_UNITS || ch >= 8) {
+            rt_kprintf("invalid unit or channel\n");
+            return -RT_EINVAL;
+        }
+        if (n < 64 || n > ADC_OS_BENCH_MAX) n = ADC_OS_BENCH_MAX;
+        os_bench(unit, ch, n);
+        return 0;
+    } else if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        rt_kprintf("Software oversampling (k extra bits, 4^k samples per output):\n");
+        for (int u = 0; u < ADC_ACQ_UNITS; u++) {
+            for (int c = 0; c < 16; c++) {
+                if (os_bits[u][c]) rt_kprintf("  ADC%d ch%d: k=%u (x%u)\n", u, c, os_bits[u][c], 1U << (2 * os_bits[u][c]));
+            }
+        }
+        return 0;
+    }
+
+    rt_kprintf("Usage: adc_os [list]\n");
+    rt_kprintf("       adc_os set <unit> <ch> <bits 0..%d>\n", ADC_OS_MAX_BITS);
+    rt_kprintf("       adc_os bench <unit> <ch> [samples]\n");
+    return 0;
+}
+MSH_CMD_EXPORT(adc_os, ADC software oversampling and noise / ENOB comparison);
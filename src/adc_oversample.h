@@ -0,0 +1,42 @@
+#ifndef __ADC_OVERSAMPLE_H__
+#define __ADC_OVERSAMPLE_H__
+
+#include <rtthread.h>
+#include "adc_acq.h"
+
+/*
+ * 软件过采样：同一信号连续 4^k 个样本求和后输出一个点。白噪声下有效位数增加 k 位，输出率降为 1/4^k。
+ * 与硬件加法/平均 (adc_acq_set_addition) 可叠加：硬件在一次触发内连续转换，软件跨扫描、跨块累加。
+ *
+ * 每个信号 (单元 + 通道) 的 k 用 adc_os_set 在运行时设定，处理线程用 adc_os_process 按块取结果，
+ * 设定变化时从下一个块重新累加。k = 0 时直接换算，不做累加。
+ */
+#define ADC_OS_MAX_BITS         4       /* 最多 256 倍 */
+#define ADC_OS_BENCH_MAX        8192    /* 噪声测量最多记录的样本数 */
+
+typedef struct {
+    rt_uint8_t  chan;           /* ADC_ACQ_CHAN */
+    rt_uint8_t  bits;           /* 当前使用的 k */
+    rt_uint16_t fill;           /* 已累加的样本数 */
+    rt_uint32_t acc;
+    rt_uint32_t next_block;     /* 期望的下一个块序号，跳号时丢弃未满的累加 */
+} AdcOversampler;
+
+int  adc_os_set(rt_uint8_t unit, rt_uint8_t ch, rt_uint8_t bits);
+rt_uint8_t adc_os_get(rt_uint8_t chan);
+
+void adc_os_reset(AdcOversampler *os);
+
+/* 对 n 个码值 (间隔 stride) 累加，每满 4^bits 个输出一个点 (和 * scale / 4^bits)，返回输出个数 */
+rt_uint32_t adc_os_run(AdcOversampler *os, const rt_uint16_t *src, rt_uint32_t stride, rt_uint32_t n,
+                       float scale, float *out);
+
+/* 取块内第 index 列，按该信号的设定输出电压 (已除去硬件加法次数)，返回输出个数；
+ * *first 为第一个输出的最后一个输入样本在块内的序号，之后每个输出相隔 4^bits 次扫描 */
+rt_uint32_t adc_os_process(AdcOversampler *os, const AdcBlock *block, rt_uint8_t index, float volt_per_code,
+                           float *out, rt_uint32_t *first);
+
+/* 处理线程每取得一个块调用一次，供 "adc_os bench" 记录原始样本 */
+void adc_os_tap(const AdcBlock *block);
+
+#endif
@@ -17,28 +17,65 @@
 #include "hal_data.h"
 #include <string.h>
 #include "offline_cache.h"
+#include "can_ring.h"
+#include "can_filter.h"
+#include "can_signal.h"
+#include "can_policy.h"
+#include "can_udp.h"
+#include "isotp.h"
+#include "j1939.h"
+#include "can_health.h"
+#include "adc_acq.h"
+#include "adc_alarm.h"
+#include "adc_oversample.h"
+#include "dsp_kernel.h"
+#include "stream_stats.h"
+#include "fft_feature.h"
+#include "sdt_compress.h"
+#include "decim_chain.h"
+#include "wave_capture.h"
+#include "perf_counter.h"
 
 /* 定义设备名称，与 factory_test.h 中保持一致或使用标准名称 */
-#define CAN_DEV_NAME       "canfd0"
-#define ADC_DEV_NAME       "adc0"
-#define ADC_DEV_CHANNEL    0
+#define CAN0_DEV_NAME      "canfd0"
+#define CAN1_DEV_NAME      "canfd1"
+/* ADC0 由 adc_acq 按 GPT 定时扫描，上报通道 0 */
+#define ADC_ACQ_REPORT_INDEX   0
+/* 块内第 2 列 (ADC0 通道 1) 接振动传感器，做频谱特征 */
+#define ADC_FFT_INDEX          1
+#define ADC_VOLT_PER_CODE      (3.3f / 4096.0f)
+/* ADC0 通道 0 的门限报警，由 ADC 比较器硬件判断 */
+#define ADC_ALARM_UNIT         0
+#define ADC_ALARM_CHANNEL      0
+#define ADC_ALARM_HIGH_V       2.5f
+#define ADC_ALARM_LOW_V        0.5f
+#define ADC_ALARM_HYST_V       0.1f
+#define ADC_VOLT_TO_CODE(v)    ((rt_uint16_t)((v) / ADC_VOLT_PER_CODE + 0.5f))
+/* 上报通道的块均值经旋转门压缩后上报/缓存，"sdt set adc_report <mV>" 可调 */
+#define ADC_SDT_DEV_V          0.005f
+#define ADC_SDT_MAX_GAP_MS     60000
+/* 上报通道抽取链：默认 1 kHz 经 CIC 3 级 /25、FIR /2 /2 降到 10 Hz，"decim set adc_report ..." 可调。
+ * 只有上报通道的曲线需要降采样，其余通道 (振动通道做 FFT) 不登记抽取链；
+ * 增加上报通道时每个通道配一条 DecimChain 并以各自名称登记 (最多 DECIM_CHAINS_MAX 条) */
+#define ADC_DECIM_ORDER        3
+#define ADC_DECIM_RATE         25
+#define ADC_DECIM_FIR_STAGES   2
+#define ADC_DECIM_TAPS         31
+/* 触发捕获每处理一个块最多上报的分块数 */
+#define WAVE_UPLOAD_BURST      4
 #define RS485_DEV_NAME     "uart5"
 
 /* 时间参数配置 (ms) */
 #define CACHE_UPLOAD_INTERVAL_MS    200   
 #define CACHE_UPLOAD_DELAY_MS       50    
 #define SENSOR_REPORT_INTERVAL_MS   10000 
-#define SENSOR_SAMPLE_INTERVAL_MS   1000 
 
-/* 信号量 */
-static struct rt_semaphore can_rx_sem;
+/* CAN 线程每次从接收队列取出的最大帧数 */
+#define CAN_DRAIN_BATCH    16
+/* 批量 FIFO 按水位中断，低流量时由 CAN 线程定期读出；
+ * 帧在 FIFO 中的停留时间须小于硬件时间戳回绕周期 (见 can_ring_stat)，否则接收时间会偏差一个周期 */
+#define CAN_POLL_INTERVAL_MS    20
 
-/* CAN 接收回调 */
-static rt_err_t can_rx_callback(rt_device_t dev, rt_size_t size)
-{
-    rt_sem_release(&can_rx_sem);
-    return RT_EOK;
-}
 void rs485_callback(uart_callback_args_t * p_args)
 {
 
@@ -48,156 +85,406 @@ void rs485_callback(uart_callback_args_t * p_args)
 /* CAN 处理线程 */
 static void can_thread_entry(void *parameter)
 {
-    rt_device_t dev = (rt_device_t)parameter;
-    struct rt_can_msg rxmsg = {0};
+    CanFrame frames[CAN_DRAIN_BATCH];
+    rt_size_t n;
+    rt_tick_t last_poll = 0;
+    rt_uint8_t bus_state[CAN_HEALTH_CHANNELS] = { 0 };
     extern mqtt_client_t *kawaii_client; /* 引用全局客户端 */
 
     while (1)
     {
-        /* 等待 MQTT 客户端初始化完成 */
-        if (kawaii_client == NULL || kawaii_client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        rt_bool_t mqtt_up = (kawaii_client != NULL && kawaii_client->mqtt_client_state == CLIENT_STATE_CONNECTED);
+
+        /* MQTT 未连接且未开启 UDP 桥接时等待 */
+        if (!mqtt_up && !can_udp_active()) {
             rt_thread_mdelay(1000);
             continue;
         }
 
-        rxmsg.hdr_index = -1;
-        if (rt_sem_take(&can_rx_sem, RT_WAITING_FOREVER) == RT_EOK)
+        /* 超时用于定期读出批量 FIFO、发送到期的 UDP 报文和 ISO-TP 连续帧、处理 J1939 会话超时，并提交二进制模式下未满的批量缓冲 */
+        rt_int32_t timeout = CAN_POLL_INTERVAL_MS;
+        rt_int32_t udp_due = can_udp_flush();
+        if (udp_due >= 0 && udp_due < timeout) timeout = udp_due ? udp_due : 1;
+        rt_int32_t isotp_due = isotp_poll();
+        if (isotp_due >= 0 && isotp_due < timeout) timeout = isotp_due ? isotp_due : 1;
+        rt_int32_t j1939_due = j1939_poll();
+        if (j1939_due >= 0 && j1939_due < timeout) timeout = j1939_due ? j1939_due : 1;
+
+        rt_err_t res = can_ring_wait(timeout);
+
+        if (rt_tick_get() - last_poll >= CAN_POLL_INTERVAL_MS)
+        {
+            can_ring_poll();
+            last_poll = rt_tick_get();
+        }
+
+        /* 发布到期的快照帧 */
+        while (mqtt_up && (n = can_policy_collect(frames, CAN_DRAIN_BATCH, rt_tick_get())) > 0)
         {
-            if (rt_device_read(dev, 0, &rxmsg, sizeof(rxmsg)) > 0)
+            for (rt_size_t i = 0; i < n; i++)
+            {
+                onenet_upload_can(kawaii_client, &frames[i]);
+            }
+        }
+
+        /* 总线健康统计定期上报，状态变化 (错误被动、bus-off、恢复) 时立即上报，总线无帧时也需处理 */
+        CanHealthStats health;
+        while (can_health_collect(&health))
+        {
+            /* 进入错误被动或 bus-off 时捕获当时的模拟量波形 */
+            if (health.channel < CAN_HEALTH_CHANNELS)
+            {
+                rt_uint8_t prev = bus_state[health.channel];
+                if (health.state > prev && health.state >= CAN_BUS_PASSIVE && prev < CAN_BUS_OFF)
+                {
+                    wave_capture_trigger(WAVE_SRC_CAN, perf_now());
+                }
+                bus_state[health.channel] = health.state;
+            }
+            if (mqtt_up) onenet_upload_can_health(kawaii_client, &health);
+        }
+
+        if (res != RT_EOK)
+        {
+            if (mqtt_up) onenet_flush_can_batch(kawaii_client, RT_FALSE);
+            continue;
+        }
+
+        /* 每次唤醒取空队列，can_ring_pop 总是先取高优先级帧 */
+        while ((n = can_ring_pop(frames, CAN_DRAIN_BATCH)) > 0)
+        {
+            rt_tick_t now = rt_tick_get();
+
+            /* UDP 桥接转发全部原始帧，与 MQTT 共用本次取出的帧 */
+            can_udp_feed(frames, n);
+
+            rt_size_t m = 0;
+            for (rt_size_t i = 0; i < n; i++)
+            {
+                /* ISO-TP 会话的分段帧不单独上报，组包完成后整条上报 */
+                if (isotp_input(&frames[i])) continue;
+                /* J1939 传输协议帧同样由 j1939 模块组包，单帧 PGN 报文照常经策略过滤上报 */
+                if (j1939_input(&frames[i])) continue;
+                if (m != i) frames[m] = frames[i];
+                m++;
+            }
+            if (!mqtt_up) continue;
+
+            /* 其余帧整批按 ID 策略过滤后，使用 onenet_app 模块上报数据 */
+            m = can_policy_filter(frames, m, now);
+            for (rt_size_t i = 0; i < m; i++)
             {
-                /* 使用 onenet_app 模块上报数据 */
-                onenet_upload_can(kawaii_client, rxmsg.id, rxmsg.data, rxmsg.len);
+                onenet_upload_can(kawaii_client, &frames[i]);
             }
         }
+
+        IsoTpMessage msg;
+        while (isotp_collect(&msg))
+        {
+            if (mqtt_up) onenet_upload_isotp(kawaii_client, &msg);
+            isotp_release(&msg);
+        }
+
+        J1939Message pgn_msg;
+        while (j1939_collect(&pgn_msg))
+        {
+            if (mqtt_up) onenet_upload_j1939(kawaii_client, &pgn_msg);
+            j1939_release(&pgn_msg);
+        }
     }
 }
 
-/* 边缘计算模型：滑动窗口滤波 */
-#define FILTER_WINDOW_SIZE 10
+/* 边缘计算模型：多级抽取滤波 */
 #define REPORT_INTERVAL_MS 10000  /* 正常上报周期 10秒 */
 
 typedef struct {
-    float buffer[FILTER_WINDOW_SIZE];
-    rt_uint8_t index;
-    rt_uint8_t count;
-    float sum;
-    float average;
+    DecimChain decim;       /* 上报通道 CIC + FIR 抽取，输出送入旋转门压缩 */
+    float filtered;         /* 最近一个抽取输出 (V) */
+    rt_uint32_t filtered_count;
+    StreamStats stats;      /* 本上报周期内全部采样点的分布统计 */
+    AdcOversampler os;      /* 上报通道按 adc_os 设定过采样后再统计 */
+    SdtSignal sdt;          /* 上报通道块均值的旋转门压缩 */
+    SdtPoint vtx[ADC_VERTEX_BATCH];
+    rt_uint8_t vtx_count;   /* 待上报的顶点 */
+    rt_uint8_t chan;        /* 上报通道 ADC_ACQ_CHAN */
     rt_tick_t last_report_tick;
 } Edge_ADC_Model;
 
 static void edge_model_init(Edge_ADC_Model *model) {
+    const DecimConfig decim_cfg = {
+        .order = ADC_DECIM_ORDER,
+        .fir_stages = ADC_DECIM_FIR_STAGES,
+        .rate = ADC_DECIM_RATE,
+        .taps = ADC_DECIM_TAPS,
+    };
+
     memset(model, 0, sizeof(Edge_ADC_Model));
+    stream_stats_reset(&model->stats);
+    decim_init(&model->decim, "adc_report", &decim_cfg);
+    sdt_init(&model->sdt, "adc_report", ADC_SDT_DEV_V, ADC_SDT_MAX_GAP_MS);
 }
 
-static void edge_model_input(Edge_ADC_Model *model, float new_val) {
-    /* 移除旧值 */
-    if (model->count >= FILTER_WINDOW_SIZE) {
-        model->sum -= model->buffer[model->index];
-    } else {
-        model->count++;
+/* 从交错的采样块中取出一列，换算为电压 (硬件加法的结果除以次数) */
+static void block_channel_volts(const AdcBlock *block, rt_uint8_t index, float *volts)
+{
+    dsp_i16_to_f32((const rt_int16_t *)&block->data[index], block->channels, volts, block->scans,
+                   ADC_VOLT_PER_CODE / block->adds[index]);
+}
+
+/* 块内上报通道的每个采样点 (不是块均值，过采样时为每组的和) 计入分布统计，时间为采样时刻 */
+static void edge_model_stats(Edge_ADC_Model *model, const AdcBlock *block)
+{
+    static float volts[ADC_ACQ_BLOCK_SCANS];
+    rt_uint32_t first;
+    rt_uint32_t dt = 1000000U / block->rate;
+
+    rt_uint32_t n = adc_os_process(&model->os, block, ADC_ACQ_REPORT_INDEX, ADC_VOLT_PER_CODE, volts, &first);
+    stream_stats_add_block(&model->stats, volts, n, perf_to_us64(block->t_first) + (rt_uint64_t)first * dt,
+                           dt << (2 * model->os.bits));
+}
+
+/* 振动通道凑满一帧后输出频谱特征，只上报特征向量 */
+static void edge_model_fft(const AdcBlock *block)
+{
+    extern mqtt_client_t *kawaii_client;
+    static float volts[ADC_ACQ_BLOCK_SCANS];
+    static FftFeatures features;
+
+    if (block->channels <= ADC_FFT_INDEX) return;
+
+    block_channel_volts(block, ADC_FFT_INDEX, volts);
+    if (fft_feature_push(volts, block->scans, block->rate, &features)) {
+        onenet_upload_fft_feature(kawaii_client, &features);
     }
-    
-    /* 加入新值 */
-    model->buffer[model->index] = new_val;
-    model->sum += new_val;
-    model->index = (model->index + 1) % FILTER_WINDOW_SIZE;
-    
-    /* 计算平均值 */
-    model->average = model->sum / model->count;
+}
+
+/* 抽取链的输出及其代表的时刻 (启动后 ms，已扣除群时延) */
+static rt_int32_t decim_out[ADC_ACQ_BLOCK_SCANS];
+static rt_uint32_t decim_t_ms[ADC_ACQ_BLOCK_SCANS];
+
+/* 上报通道经抽取链降到上报分辨率，在释放块之前取出结果，返回输出个数 */
+static rt_uint32_t edge_model_filter(Edge_ADC_Model *model, const AdcBlock *block, float *scale)
+{
+    rt_uint32_t first;
+    rt_uint32_t n = decim_process(&model->decim, block, ADC_ACQ_REPORT_INDEX, decim_out, &first);
+    rt_int64_t t0 = (rt_int64_t)perf_to_us64(block->t_first);
+    rt_int64_t step = model->decim.design.factor, delay = model->decim.design.delay;
+
+    for (rt_uint32_t i = 0; i < n; i++) {
+        rt_int64_t t_us = t0 + ((rt_int64_t)first + (rt_int64_t)i * step - delay) * 1000000 / block->rate;
+        decim_t_ms[i] = (rt_uint32_t)(t_us / 1000);
+    }
+    *scale = ADC_VOLT_PER_CODE / (float)(1U << DECIM_FRAC_BITS) / block->adds[ADC_ACQ_REPORT_INDEX];
+    return n;
 }
 
 static rt_tick_t last_cache_upload_tick = 0;
 
-static void handle_data_upload(mqtt_client_t *client, float voltage, uint32_t raw_value)
+/* 补传最旧的一批缓存：连续的同通道顶点合并为一次上报，旧格式的单点记录逐条上报 */
+static void cache_upload_batch(mqtt_client_t *client)
 {
-    /* 1. 尝试发送当前实时数据 */
-    int ret = onenet_upload_adc(client, voltage, raw_value);
-    
+    static SdtPoint pts[ADC_VERTEX_BATCH];     /* app_adc 栈只有 2 KB */
+    CacheRecord record;
+    rt_uint32_t n = 0;
+    int ret;
+
+    if (offline_cache_peek(0, &record) != RT_EOK) return;
+    rt_kprintf("[Cache] Found cached data, uploading...\n");
+
+    /* 稍微延时一下，避免和刚才的实时数据包挨得太近 */
+    rt_thread_mdelay(CACHE_UPLOAD_DELAY_MS);
+
+    if (record.type == CACHE_TYPE_ADC_VERTEX) {
+        rt_uint8_t chan = (rt_uint8_t)record.value_raw;
+        do {
+            pts[n].t = record.timestamp;
+            pts[n].v = record.value_f;
+            n++;
+        } while (n < ADC_VERTEX_BATCH && offline_cache_peek(n, &record) == RT_EOK &&
+                 record.type == CACHE_TYPE_ADC_VERTEX && record.value_raw == chan);
+        ret = onenet_upload_adc_vertices(client, chan, pts, n);
+    } else {
+        n = 1;
+        ret = onenet_upload_adc(client, record.value_f, record.value_raw);
+    }
+
+    if (ret == 0) {
+        /* 补传成功，从缓存中移除 */
+        offline_cache_drop(n);
+        rt_kprintf("[Cache] Upload success, popped %u.\n", n);
+    } else {
+        rt_kprintf("[Cache] Upload failed, keep in cache.\n");
+    }
+}
+
+/* 上报待发的压缩顶点，成功后按间隔补传离线缓存；发送失败时顶点 (带原始时刻) 写入离线缓存 */
+static void handle_data_upload(mqtt_client_t *client, Edge_ADC_Model *model)
+{
+    int ret = 0;
+
+    /* 1. 尝试发送新的顶点 */
+    if (model->vtx_count > 0) {
+        ret = onenet_upload_adc_vertices(client, model->chan, model->vtx, model->vtx_count);
+    } else if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        ret = -1;
+    }
+
     if (ret == 0) {
-        /* 发送成功 */
-        
-        /* 2. 检查是否有离线缓存需要补传 */
-        /* 策略：网络空闲时补传。这里简单策略：每次成功发送实时数据后，尝试补传一条缓存数据 */
-        /* 但为了避免拥塞，限制补传频率，例如每 5 秒最多补传一条 */
-        
+        model->vtx_count = 0;
+
+        /* 2. 检查是否有离线缓存需要补传，限制补传频率避免拥塞 */
         rt_tick_t current_tick = rt_tick_get();
         if (last_cache_upload_tick == 0) last_cache_upload_tick = current_tick; // 初始化
 
         if (!offline_cache_is_empty() && (current_tick - last_cache_upload_tick > CACHE_UPLOAD_INTERVAL_MS)) {
-             CacheRecord record;
-             if (offline_cache_read(&record) == RT_EOK) {
-                 rt_kprintf("[Cache] Found cached data, uploading...\n");
-                 
-                 /* 稍微延时一下，避免和刚才的实时数据包挨得太近 */
-                 rt_thread_mdelay(CACHE_UPLOAD_DELAY_MS); 
-                 
-                 if (onenet_upload_adc(client, record.value_f, record.value_raw) == 0) {
-                     /* 补传成功，从缓存中移除 */
-                     offline_cache_pop();
-                     rt_kprintf("[Cache] Upload success, popped.\n");
-                     last_cache_upload_tick = current_tick;
-                 } else {
-                     rt_kprintf("[Cache] Upload failed, keep in cache.\n");
-                 }
-             }
+            cache_upload_batch(client);
+            last_cache_upload_tick = current_tick;
         }
-        
-    } else {
-        /* 发送失败 (ret != 0) */
-        rt_kprintf("[Edge] Upload failed (ret=%d), saving to cache...\n", ret);
-        offline_cache_write(CACHE_TYPE_ADC, voltage, raw_value);
-
-        /* 如果是发送错误 (如 -19 KAWAII_MQTT_SEND_PACKET_ERROR)，主动关闭连接触发重连 */
-        if (ret != -1) { /* -1 是 onenet_upload_adc 内部判断未连接的返回值，无需处理 */
-            rt_kprintf("[Edge] Connection error, closing MQTT client to force reconnect.\n");
-            mqtt_disconnect(client);
+        return;
+    }
+
+    if (model->vtx_count == 0) return;
+
+    /* 发送失败 (ret != 0) */
+    rt_kprintf("[Edge] Upload failed (ret=%d), caching %d vertices...\n", ret, model->vtx_count);
+    for (int i = 0; i < model->vtx_count; i++) {
+        offline_cache_write_at(CACHE_TYPE_ADC_VERTEX, model->vtx[i].t, model->vtx[i].v, model->chan);
+    }
+    model->vtx_count = 0;
+
+    /* 如果是发送错误 (如 -19 KAWAII_MQTT_SEND_PACKET_ERROR)，主动关闭连接触发重连 */
+    if (ret != -1) { /* -1 是 onenet_upload_* 内部判断未连接的返回值，无需处理 */
+        rt_kprintf("[Edge] Connection error, closing MQTT client to force reconnect.\n");
+        mqtt_disconnect(client);
+    }
+}
+
+/* 触发捕获按块上报：只在连接时发送，失败时保留进度，下次从未确认的块继续 */
+static void handle_wave_upload(mqtt_client_t *client)
+{
+    WaveCapture *cap;
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) return;
+
+    for (int i = 0; i < WAVE_UPLOAD_BURST && (cap = wave_capture_pending()) != RT_NULL; i++) {
+        rt_uint64_t t0 = perf_now();
+        int ret = onenet_upload_wave_chunk(client, cap, cap->next);
+        if (ret != 0) {
+            rt_kprintf("[Wave] Capture #%u chunk %u upload failed (ret=%d), retry later\n", cap->id, cap->next, ret);
+            return;
+        }
+        wave_capture_ack(cap, perf_now() - t0);
+        if (cap->next == cap->chunks) {
+            rt_kprintf("[Wave] Capture #%u uploaded: %u + %u scans in %u chunks\n", cap->id, cap->pre, cap->post,
+                       cap->chunks);
         }
     }
 }
 
-/* 传感器采集线程 (ADC) */
+/* 传感器数据处理线程 (ADC)：采样由 GPT 经 ELC 定时触发，本线程只按块处理，不参与采样定时 */
 static void sensor_thread_entry(void *parameter)
 {
-    rt_adc_device_t adc_dev = (rt_adc_device_t)rt_device_find(ADC_DEV_NAME);
     extern mqtt_client_t *kawaii_client; /* 引用全局客户端 */
 
-    /* 初始化边缘模型 */
-    Edge_ADC_Model adc_model;
+    /* 初始化边缘模型 (抽取链状态较大，不放在线程栈上) */
+    static Edge_ADC_Model adc_model;
     edge_model_init(&adc_model);
 
-    if (adc_dev == RT_NULL)
+    fft_feature_init(FFT_SIZE_DEFAULT);
+
+    /* 触发捕获的环形缓冲在 HyperRAM 中，打开失败时不做捕获，其余处理照常 */
+    if (wave_capture_init() != RT_EOK) rt_kprintf("Waveform capture disabled.\n");
+
+    /* 报警比较配置在扫描组配置时写入，须在启动采集前设置 */
+    adc_alarm_set(ADC_ALARM_UNIT, ADC_ALARM_CHANNEL, ADC_VOLT_TO_CODE(ADC_ALARM_LOW_V),
+                  ADC_VOLT_TO_CODE(ADC_ALARM_HIGH_V), ADC_VOLT_TO_CODE(ADC_ALARM_HYST_V));
+
+    if (adc_acq_start(ADC_ACQ_RATE_DEFAULT) != RT_EOK)
     {
-        rt_kprintf("ADC device %s not found!\n", ADC_DEV_NAME);
+        rt_kprintf("ADC acquisition start failed!\n");
         return;
     }
 
-    rt_adc_enable(adc_dev, ADC_DEV_CHANNEL);
-
     while (1)
     {
         /* 移除阻塞等待，允许离线采集和缓存 */
         /* if (kawaii_client == NULL || kawaii_client->mqtt_client_state != CLIENT_STATE_CONNECTED) { ... } */
 
-        rt_uint32_t value = rt_adc_read(adc_dev, ADC_DEV_CHANNEL);
-        /* 参考电压 3.3V, 12位精度 */
-        float voltage = (float)value * 3.3f / 4096.0f;
+        const AdcBlock *block = adc_acq_wait(RT_WAITING_FOREVER);
+        if (block == RT_NULL) continue;
+
+        float scale;
+        adc_model.chan = block->channel_id[ADC_ACQ_REPORT_INDEX];
+        rt_uint32_t n = edge_model_filter(&adc_model, block, &scale);
+        edge_model_stats(&adc_model, block);
+        edge_model_fft(block);
+        adc_os_tap(block);
+        wave_capture_feed(block);
+        adc_acq_release(block);
+
+        /* 抽取输出压缩为顶点，攒满一批立即上报 */
+        for (rt_uint32_t i = 0; i < n; i++) {
+            adc_model.filtered = (float)decim_out[i] * scale;
+            adc_model.filtered_count++;
+            adc_model.vtx_count += sdt_push(&adc_model.sdt, decim_t_ms[i], adc_model.filtered,
+                                            &adc_model.vtx[adc_model.vtx_count]);
+            if (adc_model.vtx_count > ADC_VERTEX_BATCH - 2) {
+                handle_data_upload(kawaii_client, &adc_model);
+            }
+        }
 
-        /* 输入到滤波模型 */
-        edge_model_input(&adc_model, voltage);
+        handle_wave_upload(kawaii_client);
 
         /* 检查是否达到上报时间间隔 */
         if (rt_tick_get() - adc_model.last_report_tick > SENSOR_REPORT_INTERVAL_MS) {
-             int avg_int = (int)adc_model.average;
-             int avg_dec = (int)((adc_model.average - avg_int) * 100);
-             rt_kprintf("[Edge] Report Average: %d.%02dV (Window: %d)\n", avg_int, avg_dec, adc_model.count);
-             
-             /* 上报平均值 (使用带缓存功能的处理函数) */
-             handle_data_upload(kawaii_client, adc_model.average, (int32_t)(adc_model.average * 4096.0f / 3.3f));
+             int avg_int = (int)adc_model.filtered;
+             int avg_dec = (int)((adc_model.filtered - avg_int) * 100);
+             rt_kprintf("[Edge] Report Filtered: %d.%02dV (1/%u, %u outputs), %d vertices (%u/%u points)\n", avg_int,
+                        avg_dec, adc_model.decim.design.factor, adc_model.filtered_count, adc_model.vtx_count,
+                        adc_model.sdt.out, adc_model.sdt.in);
+             adc_model.filtered_count = 0;
+
+             /* 上报压缩顶点 (使用带缓存功能的处理函数)，没有新顶点时只补传缓存 */
+             handle_data_upload(kawaii_client, &adc_model);
+
+             /* 周期统计只在线时上报，不进离线缓存 */
+             StreamSummary summary;
+             stream_stats_summary(&adc_model.stats, &summary);
+             rt_kprintf("[Edge] Stats: n=%u min %d max %d p50 %d p95 %d p99 %d mV\n", summary.count,
+                        (int)(summary.min * 1000), (int)(summary.max * 1000), (int)(summary.p50 * 1000),
+                        (int)(summary.p95 * 1000), (int)(summary.p99 * 1000));
+             onenet_upload_adc_stats(kawaii_client, &summary);
+             stream_stats_reset(&adc_model.stats);
 
              adc_model.last_report_tick = rt_tick_get();
         }
+    }
+}
+
+/* 报警上报线程：优先级高于 CAN 和 ADC 处理线程，比较中断放入事件后立即被唤醒上报 */
+static void alarm_thread_entry(void *parameter)
+{
+    extern mqtt_client_t *kawaii_client;
+    static const char *const state_names[] = { "cleared", "HIGH", "LOW" };
+    AdcAlarmEvent ev;
+
+    while (1)
+    {
+        if (!adc_alarm_wait(RT_WAITING_FOREVER)) continue;
 
-        rt_thread_mdelay(SENSOR_SAMPLE_INTERVAL_MS); /* 采集间隔，用于更新滑动窗口 */
+        while (adc_alarm_collect(&ev))
+        {
+            /* 进入报警时先冻结波形再上报，触发时刻为比较中断时刻 */
+            if (ev.state != ADC_ALARM_NORMAL) wave_capture_trigger(WAVE_SRC_ADC_ALARM, ev.t);
+
+            float voltage = ev.raw * ADC_VOLT_PER_CODE;
+            int ret = onenet_upload_adc_alarm(kawaii_client, &ev, voltage);
+            adc_alarm_done(&ev);
+
+            rt_kprintf("[Alarm] ADC%d ch%d %s: %d mV (threshold %d mV)%s\n", ADC_ACQ_CHAN_UNIT(ev.chan),
+                       ADC_ACQ_CHAN_NUM(ev.chan), state_names[ev.state % 3], (int)(voltage * 1000),
+                       (int)(ev.threshold * ADC_VOLT_PER_CODE * 1000), ret == 0 ? "" : ", not published");
+        }
     }
 }
 
@@ -236,28 +523,49 @@ int app_task_init(void)
 {
     rt_err_t res;
 
-    /* 1. 初始化 CAN */
-    rt_device_t can_dev = rt_device_find(CAN_DEV_NAME);
-    if (can_dev)
+    /* 1. 初始化 CAN，两个通道的接收帧汇入同一组优先级队列，由一个线程处理 */
+    /* 已定义的报文上报解码后的信号值，其余报文仍上报原始数据 */
+    can_signal_load(can_signal_db, can_signal_db_num);
+
+    static const char *can_names[] = { CAN0_DEV_NAME, CAN1_DEV_NAME };
+    int can_opened = 0;
+
+    for (int i = 0; i < 2; i++)
     {
-        rt_sem_init(&can_rx_sem, "can_sem", 0, RT_IPC_FLAG_FIFO);
-        rt_device_set_rx_indicate(can_dev, can_rx_callback);
+        rt_device_t can_dev = rt_device_find(can_names[i]);
+        if (can_dev == RT_NULL)
+        {
+            rt_kprintf("CAN device %s not found, skip.\n", can_names[i]);
+            continue;
+        }
+
         res = rt_device_open(can_dev, RT_DEVICE_FLAG_INT_TX | RT_DEVICE_FLAG_INT_RX);
         if (res == RT_EOK)
         {
-            rt_thread_t tid = rt_thread_create("app_can", can_thread_entry, can_dev, 2048, 20, 10);
-            if (tid) rt_thread_startup(tid);
+            /* 接收帧由 FSP 中断直接写入 can_ring，不再经过设备层读取 */
+            can_ring_attach(can_dev);
+            /* 默认规则：全部帧进入本通道的批量 FIFO，高优先级 ID 用 can_filter 命令登记 */
+            can_filter_apply(i);
+            can_opened++;
         }
     }
-    else
+
+    if (can_opened > 0)
     {
-        rt_kprintf("CAN device not found, skip.\n");
+        /* 错误计数、总线负载采样和 bus-off 自动恢复 */
+        can_health_start();
+
+        rt_thread_t tid = rt_thread_create("app_can", can_thread_entry, RT_NULL, 4096, 20, 10);
+        if (tid) rt_thread_startup(tid);
     }
 
-    /* 2. 初始化 ADC 采集任务 */
+    /* 2. 初始化 ADC 数据处理任务 (采集由 GPT/ELC 硬件定时) */
     rt_thread_t adc_tid = rt_thread_create("app_adc", sensor_thread_entry, RT_NULL, 2048, 21, 10);
     if (adc_tid) rt_thread_startup(adc_tid);
 
+    rt_thread_t alarm_tid = rt_thread_create("app_alm", alarm_thread_entry, RT_NULL, 2048, 12, 10);
+    if (alarm_tid) rt_thread_startup(alarm_tid);
+
     /* 3. 初始化 RS485 (可选) */
     // rt_thread_t rs485_tid = rt_thread_create("app_485", rs485_thread_entry, RT_NULL, 2048, 22, 10);
     // if (rs485_tid) rt_thread_startup(rs485_tid);
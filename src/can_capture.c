@@ -0,0 +1,264 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include "can_capture.h"
+#include "perf_counter.h"
+
+#define CAN_CAPTURE_MASK        (CAN_CAPTURE_BUF_SIZE - 1)
+#define CAN_CAPTURE_SYNC_SIZE   9
+#define CAN_CAPTURE_DUMP_LINE   32      /* 导出时每行字节数 */
+
+#ifdef CAN_CAPTURE_BUF_ADDR
+static rt_uint8_t *const cap_buf = (rt_uint8_t *)CAN_CAPTURE_BUF_ADDR;
+#else
+static rt_uint8_t cap_storage[CAN_CAPTURE_BUF_SIZE];
+static rt_uint8_t *const cap_buf = cap_storage;
+#endif
+
+/* 以下状态只在关中断时修改：接收中断写入，msh 线程启停/导出 */
+static volatile rt_bool_t cap_running = RT_FALSE;
+static volatile rt_bool_t cap_full = RT_FALSE;     /* 单次模式缓冲已满：不再记录，仍统计丢弃的帧直到 stop/start */
+static rt_uint8_t cap_mode;
+static rt_uint8_t cap_ch_mask;
+static rt_uint32_t cap_head;        /* 字节位置，自由增长 */
+static rt_uint32_t cap_tail;
+static rt_uint64_t cap_last_us;     /* 最后一条记录的时间 */
+static rt_uint64_t cap_base_us;     /* 首条记录的时间增量基准 */
+static CanCaptureStats cap_stats;
+
+static const char *cap_mode_names[] = { "oneshot", "wrap" };
+
+rt_inline void cap_put(rt_uint8_t b)
+{
+    cap_buf[cap_head++ & CAN_CAPTURE_MASK] = b;
+}
+
+rt_inline rt_uint8_t cap_get(rt_uint32_t pos)
+{
+    return cap_buf[pos & CAN_CAPTURE_MASK];
+}
+
+static rt_uint64_t cap_get_le(rt_uint32_t pos, int n)
+{
+    rt_uint64_t v = 0;
+    for (int i = 0; i < n; i++) v |= (rt_uint64_t)cap_get(pos + i) << (8 * i);
+    return v;
+}
+
+/* 有符号时间差按 zigzag 编码，多 FIFO 读出顺序与接收顺序不一致时差值可能为负 */
+rt_inline rt_uint32_t zigzag_encode(rt_int32_t v)
+{
+    return ((rt_uint32_t)v << 1) ^ (rt_uint32_t)(v >> 31);
+}
+
+rt_inline rt_int32_t zigzag_decode(rt_uint32_t v)
+{
+    return (rt_int32_t)(v >> 1) ^ -(rt_int32_t)(v & 1);
+}
+
+static rt_uint32_t cap_record_size(rt_uint32_t pos)
+{
+    rt_uint8_t flags = cap_get(pos);
+    if (flags == CAN_CAPTURE_SYNC) return CAN_CAPTURE_SYNC_SIZE;
+
+    rt_uint32_t dsz = (flags >> 6) + 1;
+    rt_uint32_t len = cap_get(pos + 1 + dsz);
+    return 1 + dsz + 1 + ((flags & CAN_FRAME_FLAG_EXT) ? 4 : 2) + len;
+}
+
+/* 循环模式：丢弃最早一条记录，并把其时间并入基准，保证剩余记录的增量仍可还原 */
+static void cap_drop_oldest(void)
+{
+    rt_uint8_t flags = cap_get(cap_tail);
+
+    if (flags == CAN_CAPTURE_SYNC) {
+        cap_base_us = cap_get_le(cap_tail + 1, 8);
+    } else {
+        rt_uint32_t dsz = (flags >> 6) + 1;
+        cap_base_us += zigzag_decode((rt_uint32_t)cap_get_le(cap_tail + 1, dsz));
+        cap_stats.overwritten++;
+    }
+    cap_tail += cap_record_size(cap_tail);
+}
+
+/* 为 size 字节的记录腾出空间，单次模式缓冲满时停止抓包 */
+static rt_bool_t cap_reserve(rt_uint32_t size)
+{
+    while (CAN_CAPTURE_BUF_SIZE - (cap_head - cap_tail) < size) {
+        if (cap_mode != CAN_CAPTURE_WRAP) {
+            cap_running = RT_FALSE;
+            cap_full = RT_TRUE;
+            return RT_FALSE;
+        }
+        cap_drop_oldest();
+    }
+    return RT_TRUE;
+}
+
+void can_capture_frame(const CanFrame *frame)
+{
+    if (!(cap_running || cap_full) || !(cap_ch_mask & (1U << frame->channel))) return;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    if (!cap_running) {
+        if (cap_full) goto full;
+        goto out;
+    }
+
+    rt_uint64_t us = perf_to_us64(frame->timestamp);
+    rt_int64_t diff = (rt_int64_t)(us - cap_last_us);
+
+    if (diff > 0x3FFFFFFF || diff < -0x40000000) {
+        if (!cap_reserve(CAN_CAPTURE_SYNC_SIZE)) goto full;
+        cap_put(CAN_CAPTURE_SYNC);
+        for (int i = 0; i < 8; i++) cap_put((rt_uint8_t)(us >> (8 * i)));
+        diff = 0;
+    }
+
+    rt_uint32_t delta = zigzag_encode((rt_int32_t)diff);
+    rt_uint32_t dsz = (delta < 0x100) ? 1 : (delta < 0x10000) ? 2 : (delta < 0x1000000) ? 3 : 4;
+    rt_uint32_t idsz = (frame->flags & CAN_FRAME_FLAG_EXT) ? 4 : 2;
+    rt_uint8_t len = (frame->len > CAN_FRAME_MAX_LEN) ? CAN_FRAME_MAX_LEN : frame->len;
+
+    if (!cap_reserve(1 + dsz + 1 + idsz + len)) goto full;
+
+    cap_put((frame->flags & 0x1F) | (frame->channel ? CAN_CAPTURE_FLAG_CH1 : 0) | ((dsz - 1) << 6));
+    for (rt_uint32_t i = 0; i < dsz; i++) cap_put((rt_uint8_t)(delta >> (8 * i)));
+    cap_put(len);
+    for (rt_uint32_t i = 0; i < idsz; i++) cap_put((rt_uint8_t)(frame->id >> (8 * i)));
+    /* 数据段不跨越缓冲末尾时整块复制 */
+    if ((cap_head & CAN_CAPTURE_MASK) + len <= CAN_CAPTURE_BUF_SIZE) {
+        memcpy(&cap_buf[cap_head & CAN_CAPTURE_MASK], frame->data, len);
+        cap_head += len;
+    } else {
+        for (rt_uint8_t i = 0; i < len; i++) cap_put(frame->data[i]);
+    }
+
+    cap_last_us = us;
+    cap_stats.frames++;
+    goto out;
+
+full:
+    cap_stats.dropped++;
+out:
+    rt_hw_interrupt_enable(level);
+}
+
+void can_capture_start(CanCaptureMode mode, rt_uint8_t channel_mask)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    cap_mode = (rt_uint8_t)mode;
+    cap_ch_mask = channel_mask;
+    cap_head = cap_tail = 0;
+    cap_base_us = cap_last_us = perf_to_us64(perf_now());
+    memset(&cap_stats, 0, sizeof(cap_stats));
+    cap_full = RT_FALSE;
+    cap_running = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+}
+
+void can_capture_stop(void)
+{
+    cap_running = RT_FALSE;
+    cap_full = RT_FALSE;
+}
+
+rt_bool_t can_capture_active(void)
+{
+    return cap_running || cap_full;
+}
+
+void can_capture_get_stats(CanCaptureStats *stats)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    *stats = cap_stats;
+    stats->used = cap_head - cap_tail;
+    rt_hw_interrupt_enable(level);
+}
+
+static rt_uint32_t crc32_update(rt_uint32_t crc, rt_uint8_t b)
+{
+    crc ^= b;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & -(crc & 1));
+    return crc;
+}
+
+/* 以十六进制行导出缓冲内容，主机侧从串口日志中提取 CCAP 行 */
+static void can_capture_dump(void)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char line[CAN_CAPTURE_DUMP_LINE * 2 + 1];
+    rt_uint32_t crc = 0xFFFFFFFF;
+    rt_uint32_t frames = cap_stats.frames - cap_stats.overwritten;
+
+    rt_kprintf("CCAP-BEGIN v%d base=%u.%06u bytes=%u frames=%u\n", CAN_CAPTURE_VERSION,
+               (rt_uint32_t)(cap_base_us / 1000000), (rt_uint32_t)(cap_base_us % 1000000),
+               cap_head - cap_tail, frames);
+
+    for (rt_uint32_t pos = cap_tail; pos != cap_head;) {
+        int n = 0;
+        while (n < CAN_CAPTURE_DUMP_LINE && pos != cap_head) {
+            rt_uint8_t b = cap_get(pos++);
+            crc = crc32_update(crc, b);
+            line[n * 2] = hex[b >> 4];
+            line[n * 2 + 1] = hex[b & 0x0F];
+            n++;
+        }
+        line[n * 2] = '\0';
+        rt_kprintf("CCAP %s\n", line);
+    }
+
+    rt_kprintf("CCAP-END crc=%08X\n", crc ^ 0xFFFFFFFF);
+}
+
+static void can_capture_show(void)
+{
+    CanCaptureStats st;
+
+    can_capture_get_stats(&st);
+    rt_kprintf("Capture: %s, mode %s, channels 0x%X\n",
+               cap_running ? "running" : (cap_full ? "full, counting drops" : "stopped"),
+               cap_mode_names[cap_mode], cap_ch_mask);
+    rt_kprintf("Buffer: %u / %u bytes%s\n", st.used, CAN_CAPTURE_BUF_SIZE,
+#ifdef CAN_CAPTURE_BUF_ADDR
+               " (external)"
+#else
+               ""
+#endif
+               );
+    rt_kprintf("Frames: %u recorded, %u dropped, %u overwritten\n", st.frames, st.dropped, st.overwritten);
+    if (st.frames > st.overwritten) {
+        rt_kprintf("Average record size: %u bytes\n", st.used / (st.frames - st.overwritten));
+    }
+}
+
+/* msh: can_capture start [oneshot|wrap] [ch_mask] | stop | dump | stat */
+static int can_capture(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        CanCaptureMode mode = (argc >= 3 && strcmp(argv[2], "wrap") == 0) ? CAN_CAPTURE_WRAP : CAN_CAPTURE_ONESHOT;
+        rt_uint8_t mask = (argc >= 4) ? (rt_uint8_t)strtoul(argv[3], RT_NULL, 0) : 0x3;
+        can_capture_start(mode, mask);
+        rt_kprintf("Capture started (%s, channels 0x%X)\n", cap_mode_names[mode], mask);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        can_capture_stop();
+        can_capture_show();
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "dump") == 0) {
+        /* 导出期间不能写入，先停止抓包 */
+        can_capture_stop();
+        can_capture_dump();
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        can_capture_show();
+        return 0;
+    }
+
+    rt_kprintf("Usage: can_capture start [oneshot|wrap] [ch_mask]\n");
+    rt_kprintf("       can_capture stop|dump|stat\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_capture, Record CAN traffic into a binary capture buffer);
@@ -0,0 +1,52 @@
+#ifndef __CAN_CAPTURE_H__
+#define __CAN_CAPTURE_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * CAN 总线抓包：在接收中断中把帧以紧凑二进制格式追加到字节环形缓冲，
+ * 不经过 rt_kprintf，满总线负载下也不丢帧。停止后用 msh 以十六进制导出，
+ * 主机侧 scripts/can_capture.py 转换为 candump 日志并可回放到 vcan。
+ *
+ * 记录格式 (小端)：
+ *   flags(u8)  bit0-4 = CanFrame.flags，bit5 = 通道，bit6-7 = 时间增量字节数 - 1
+ *   delta      与上一帧的时间差 (us)，1-4 字节
+ *   len(u8)    数据字节数 (0-64)
+ *   id         扩展帧 4 字节，标准帧 2 字节
+ *   data[len]
+ * flags 为 CAN_CAPTURE_SYNC 时为时间同步记录，后跟 8 字节绝对时间 (us)，用于时间差超过 32 位的情况。
+ */
+#ifndef CAN_CAPTURE_BUF_SIZE
+#define CAN_CAPTURE_BUF_SIZE    (64 * 1024)    /* 必须为 2 的幂 */
+#endif
+/* 定义 CAN_CAPTURE_BUF_ADDR 时使用该地址的外部存储器 (如 xSPI 映射的 HyperRAM)，否则使用片内 RAM */
+
+#define CAN_CAPTURE_VERSION     1
+#define CAN_CAPTURE_SYNC        0xFF    /* RTR 与 FD 互斥，正常记录不会出现全 1 */
+#define CAN_CAPTURE_FLAG_CH1    0x20
+
+typedef enum {
+    CAN_CAPTURE_ONESHOT = 0,    /* 缓冲满后停止 */
+    CAN_CAPTURE_WRAP,           /* 覆盖最早的记录，保留最近的流量 */
+} CanCaptureMode;
+
+typedef struct {
+    rt_uint32_t frames;     /* 已记录帧数 */
+    rt_uint32_t dropped;    /* 单次模式缓冲满后丢弃的帧数，直到 stop 一直累计 */
+    rt_uint32_t overwritten;/* 循环模式被覆盖的帧数 */
+    rt_uint32_t used;       /* 缓冲占用字节数 */
+} CanCaptureStats;
+
+/* API */
+void can_capture_start(CanCaptureMode mode, rt_uint8_t channel_mask);
+void can_capture_stop(void);
+/* 正在记录，或单次模式缓冲已满、仍在统计丢弃的帧 */
+rt_bool_t can_capture_active(void);
+
+/* 中断上下文：记录一帧 (timestamp 为 CNTPCT 计数) */
+void can_capture_frame(const CanFrame *frame);
+
+void can_capture_get_stats(CanCaptureStats *stats);
+
+#endif
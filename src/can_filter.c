@@ -0,0 +1,408 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hal_data.h"
+#include "can_filter.h"
+#include "can_ring.h"
+
+#define CAN_FILTER_CHANNELS     BSP_FEATURE_CANFD_NUM_CHANNELS
+#define CAN_FILTER_FIFO_NUM     8
+
+typedef struct {
+    rt_uint32_t value;
+    rt_uint32_t care;       /* 参与比较的位 */
+    rt_uint8_t  ext;
+    rt_uint8_t  fifo;
+} CanFilterBlock;
+
+static struct {
+    CanFilterRange ranges[CAN_FILTER_MAX_RANGES];
+    rt_uint8_t count;
+} can_filters[CAN_FILTER_CHANNELS];
+
+/* 编译在调用线程中进行，中间结果较大，放在静态区并加锁 */
+static CanFilterBlock can_blocks[CAN_FILTER_MAX_BLOCKS];
+static int can_block_num;
+static CanFilterRule can_rules[CAN_FILTER_MAX_RULES];
+static struct rt_mutex can_filter_lock;
+static rt_bool_t can_filter_inited = RT_FALSE;
+
+static rt_uint32_t id_width_mask(rt_uint8_t ext)
+{
+    return ext ? CAN_FILTER_EXT_MASK : CAN_FILTER_STD_MASK;
+}
+
+static int popcount32(rt_uint32_t v)
+{
+    int n = 0;
+    while (v) {
+        v &= v - 1;
+        n++;
+    }
+    return n;
+}
+
+static void can_filter_init(void)
+{
+    if (!can_filter_inited) {
+        rt_mutex_init(&can_filter_lock, "can_flt", RT_IPC_FLAG_PRIO);
+        can_filter_inited = RT_TRUE;
+    }
+}
+
+static void block_remove(int idx)
+{
+    can_block_num--;
+    if (idx < can_block_num) {
+        memmove(&can_blocks[idx], &can_blocks[idx + 1], (can_block_num - idx) * sizeof(CanFilterBlock));
+    }
+}
+
+/* b 所覆盖的 ID 是否全部落在 a 内 */
+static rt_bool_t block_covers(const CanFilterBlock *a, const CanFilterBlock *b)
+{
+    if (a->ext != b->ext || a->fifo != b->fifo) return RT_FALSE;
+    return ((b->care & a->care) == a->care) && ((b->value & a->care) == a->value);
+}
+
+/* 无损化简：去除被覆盖的块，合并掩码相同且仅有一位不同的块，直到不再变化 */
+static void blocks_reduce(void)
+{
+    rt_bool_t changed;
+
+    do {
+        changed = RT_FALSE;
+        for (int i = 0; i < can_block_num; i++) {
+            for (int j = 0; j < can_block_num; j++) {
+                if (i == j) continue;
+
+                CanFilterBlock *a = &can_blocks[i];
+                CanFilterBlock *b = &can_blocks[j];
+
+                if (block_covers(a, b)) {
+                    block_remove(j);
+                    changed = RT_TRUE;
+                    break;
+                }
+
+                rt_uint32_t diff = a->value ^ b->value;
+                if (a->ext == b->ext && a->fifo == b->fifo && a->care == b->care &&
+                    diff != 0 && (diff & (diff - 1)) == 0) {
+                    a->care &= ~diff;
+                    a->value &= ~diff;
+                    block_remove(j);
+                    changed = RT_TRUE;
+                    break;
+                }
+            }
+            if (changed) break;
+        }
+    } while (changed);
+}
+
+/* 有损合并：选择合并后仍比较位最多的一对块 (多收的 ID 最少)，返回 -1 表示无法继续合并 */
+static int blocks_merge_closest(void)
+{
+    int best_i = -1, best_j = -1, best_score = -1;
+
+    for (int i = 0; i < can_block_num; i++) {
+        for (int j = i + 1; j < can_block_num; j++) {
+            const CanFilterBlock *a = &can_blocks[i];
+            const CanFilterBlock *b = &can_blocks[j];
+
+            if (a->ext != b->ext || a->fifo != b->fifo) continue;
+
+            int score = popcount32(a->care & b->care & ~(a->value ^ b->value));
+            if (score > best_score) {
+                best_score = score;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    if (best_i < 0) return -1;
+
+    CanFilterBlock *a = &can_blocks[best_i];
+    const CanFilterBlock *b = &can_blocks[best_j];
+    a->care &= b->care & ~(a->value ^ b->value);
+    a->value &= a->care;
+    block_remove(best_j);
+    blocks_reduce();
+    return 0;
+}
+
+static int block_append(rt_uint32_t value, rt_uint32_t care, rt_uint8_t ext, rt_uint8_t fifo)
+{
+    if (can_block_num >= CAN_FILTER_MAX_BLOCKS) {
+        blocks_reduce();
+        while (can_block_num >= CAN_FILTER_MAX_BLOCKS) {
+            if (blocks_merge_closest() < 0) return -RT_EFULL;
+        }
+    }
+
+    CanFilterBlock *b = &can_blocks[can_block_num++];
+    b->value = value;
+    b->care = care;
+    b->ext = ext;
+    b->fifo = fifo;
+    return RT_EOK;
+}
+
+/* 将 [lo, hi] 拆分为 2 的幂对齐的块，每块对应一条 ID+掩码规则 */
+static int range_decompose(const CanFilterRange *r)
+{
+    rt_uint32_t width = id_width_mask(r->ext);
+    rt_uint64_t lo = r->lo;
+    rt_uint64_t hi = r->hi;
+
+    while (lo <= hi) {
+        rt_uint64_t size = 1;
+
+        while ((lo & (size * 2 - 1)) == 0 && lo + size * 2 - 1 <= hi && size * 2 <= (rt_uint64_t)width + 1) {
+            size *= 2;
+        }
+        if (block_append((rt_uint32_t)lo, width & ~(rt_uint32_t)(size - 1), r->ext, r->fifo) != RT_EOK) {
+            return -RT_EFULL;
+        }
+        lo += size;
+    }
+    return RT_EOK;
+}
+
+void can_filter_clear(rt_uint8_t channel)
+{
+    if (channel >= CAN_FILTER_CHANNELS) return;
+
+    can_filter_init();
+    rt_mutex_take(&can_filter_lock, RT_WAITING_FOREVER);
+    can_filters[channel].count = 0;
+    rt_mutex_release(&can_filter_lock);
+}
+
+int can_filter_add(rt_uint8_t channel, rt_uint8_t fifo, rt_uint8_t ext, rt_uint32_t lo, rt_uint32_t hi)
+{
+    if (channel >= CAN_FILTER_CHANNELS || fifo >= CAN_FILTER_FIFO_NUM) return -RT_EINVAL;
+    if (lo > hi || hi > id_width_mask(ext)) return -RT_EINVAL;
+
+    can_filter_init();
+    rt_mutex_take(&can_filter_lock, RT_WAITING_FOREVER);
+
+    int ret = -RT_EFULL;
+    if (can_filters[channel].count < CAN_FILTER_MAX_RANGES) {
+        CanFilterRange *r = &can_filters[channel].ranges[can_filters[channel].count++];
+        r->lo = lo;
+        r->hi = hi;
+        r->ext = ext ? 1 : 0;
+        r->fifo = fifo;
+        ret = RT_EOK;
+    }
+
+    rt_mutex_release(&can_filter_lock);
+    return ret;
+}
+
+static int can_filter_compile_locked(rt_uint8_t channel, CanFilterRule *rules, rt_size_t max)
+{
+    can_block_num = 0;
+
+    for (int i = 0; i < can_filters[channel].count; i++) {
+        if (range_decompose(&can_filters[channel].ranges[i]) != RT_EOK) return -RT_EFULL;
+    }
+    blocks_reduce();
+
+    while ((rt_size_t)can_block_num > max) {
+        if (blocks_merge_closest() < 0) return -RT_EFULL;
+    }
+
+    /* AFL 按顺序匹配，比较位多 (更具体) 的规则排在前面，使兜底区间不会截走高优先级 ID */
+    for (int i = 1; i < can_block_num; i++) {
+        CanFilterBlock b = can_blocks[i];
+        int bits = popcount32(b.care);
+        int j = i - 1;
+        while (j >= 0 && popcount32(can_blocks[j].care) < bits) {
+            can_blocks[j + 1] = can_blocks[j];
+            j--;
+        }
+        can_blocks[j + 1] = b;
+    }
+
+    for (int i = 0; i < can_block_num; i++) {
+        rules[i].id = can_blocks[i].value;
+        rules[i].mask = can_blocks[i].care;
+        rules[i].ext = can_blocks[i].ext;
+        rules[i].fifo = can_blocks[i].fifo;
+    }
+    return can_block_num;
+}
+
+int can_filter_compile(rt_uint8_t channel, CanFilterRule *rules, rt_size_t max)
+{
+    if (channel >= CAN_FILTER_CHANNELS) return -RT_EINVAL;
+
+    can_filter_init();
+    rt_mutex_take(&can_filter_lock, RT_WAITING_FOREVER);
+    int n = can_filter_compile_locked(channel, rules, max);
+    rt_mutex_release(&can_filter_lock);
+    return n;
+}
+
+static void can_filter_encode(const CanFilterRule *rule, canfd_afl_entry_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+
+    if (rule == RT_NULL) {
+        /* 填充规则：仅命中标准数据帧 ID 0 且无接收目标，即丢弃；真正需要 ID 0 时排在前面的规则先命中 */
+        entry->id.id_mode = CAN_ID_MODE_STANDARD;
+        entry->mask.mask_id = CAN_FILTER_EXT_MASK;
+        entry->mask.mask_frame_type = 1;
+        entry->mask.mask_id_mode = 1;
+        return;
+    }
+
+    entry->id.id = rule->id;
+    entry->id.id_mode = rule->ext ? CAN_ID_MODE_EXTENDED : CAN_ID_MODE_STANDARD;
+    entry->mask.mask_id = rule->mask;
+    entry->mask.mask_id_mode = 1;   /* 数据帧与远程帧都接收 */
+    entry->destination.minimum_dlc = CANFD_MINIMUM_DLC_0;
+    entry->destination.fifo_select_flags = (canfd_rx_fifo_t)(1U << rule->fifo);
+}
+
+/*
+ * AFL 通过 16 条一页的窗口访问 (见 R_CANFD_Open)。写入期间关中断，
+ * 新旧规则混合的窗口只有几微秒；写完后回读校验。
+ */
+static rt_bool_t can_filter_write(R_CANFD_Type *reg, rt_uint8_t channel, const CanFilterRule *rules, int n)
+{
+    rt_uint32_t base = (channel == 1) ? CANFD_CFG_AFL_CH0_RULE_NUM : 0;
+    rt_bool_t ok = RT_TRUE;
+    canfd_afl_entry_t entry;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    reg->CFDGAFLECTR = R_CANFD_CFDGAFLECTR_AFLDAE_Msk;
+    for (int i = 0; i < CAN_FILTER_MAX_RULES; i++) {
+        rt_uint32_t afl_entry = base + i;
+
+        can_filter_encode((i < n) ? &rules[i] : RT_NULL, &entry);
+
+        reg->CFDGAFLECTR = (afl_entry >> 4) | R_CANFD_CFDGAFLECTR_AFLDAE_Msk;
+        volatile R_CANFD_CFDGAFL_Type *cfdgafl = &reg->CFDGAFL[afl_entry & 0xF];
+
+        cfdgafl->ID = entry.id_u32;
+        cfdgafl->M  = entry.mask_u32;
+        cfdgafl->P0 = entry.destination_u32[0];
+        cfdgafl->P1 = entry.destination_u32[1];
+        cfdgafl->P0_b.GAFLIFL0 = channel & 1U;
+
+        if (cfdgafl->ID != entry.id_u32 || cfdgafl->M != entry.mask_u32) ok = RT_FALSE;
+    }
+    reg->CFDGAFLECTR = 0;
+
+    rt_hw_interrupt_enable(level);
+    return ok;
+}
+
+static canfd_instance_ctrl_t *can_filter_ctrl(rt_uint8_t channel)
+{
+    if (g_canfd0_ctrl.p_cfg && g_canfd0_ctrl.p_cfg->channel == channel) return &g_canfd0_ctrl;
+    if (g_canfd1_ctrl.p_cfg && g_canfd1_ctrl.p_cfg->channel == channel) return &g_canfd1_ctrl;
+    return RT_NULL;
+}
+
+int can_filter_apply(rt_uint8_t channel)
+{
+    canfd_instance_ctrl_t *ctrl = can_filter_ctrl(channel);
+    int n;
+
+    if (ctrl == RT_NULL || ctrl->open == 0) return -RT_ERROR;
+
+    can_filter_init();
+    rt_mutex_take(&can_filter_lock, RT_WAITING_FOREVER);
+
+    if (can_filters[channel].count == 0) {
+        /* 未登记过滤条件：标准帧和扩展帧全部接收到本通道的批量 FIFO */
+        memset(can_rules, 0, 2 * sizeof(can_rules[0]));
+        can_rules[0].fifo = can_rules[1].fifo = (channel == 1) ? CAN_FIFO_CH1_BULK : CAN_FIFO_CH0_BULK;
+        can_rules[1].ext = 1;
+        n = 2;
+    } else {
+        n = can_filter_compile_locked(channel, can_rules, CAN_FILTER_MAX_RULES);
+    }
+
+    if (n >= 0 && !can_filter_write(ctrl->p_reg, channel, can_rules, n)) {
+        /* 运行中写入未生效时，短暂进入通道 Halt 重写 (不影响另一通道，不需要全局复位) */
+        can_test_mode_t test_mode = ctrl->test_mode;
+        R_CANFD_ModeTransition(ctrl, CAN_OPERATION_MODE_HALT, test_mode);
+        if (!can_filter_write(ctrl->p_reg, channel, can_rules, n)) n = -RT_EIO;
+        R_CANFD_ModeTransition(ctrl, CAN_OPERATION_MODE_NORMAL, test_mode);
+    }
+
+    rt_mutex_release(&can_filter_lock);
+    return n;
+}
+
+static void can_filter_show(rt_uint8_t channel)
+{
+    /* 在锁内取区间并编译到显示专用的副本，打印时 apply 可能正在改写 can_rules */
+    static CanFilterRange ranges[CAN_FILTER_MAX_RANGES];
+    static CanFilterRule rules[CAN_FILTER_MAX_RULES];
+    int count, n;
+
+    can_filter_init();
+    rt_mutex_take(&can_filter_lock, RT_WAITING_FOREVER);
+    count = can_filters[channel].count;
+    memcpy(ranges, can_filters[channel].ranges, count * sizeof(ranges[0]));
+    n = can_filter_compile_locked(channel, rules, CAN_FILTER_MAX_RULES);
+    rt_mutex_release(&can_filter_lock);
+
+    rt_kprintf("CAN%d filter ranges: %d\n", channel, count);
+    for (int i = 0; i < count; i++) {
+        rt_kprintf("  %s 0x%08x-0x%08x -> FIFO%d\n", ranges[i].ext ? "ext" : "std", ranges[i].lo, ranges[i].hi,
+                   ranges[i].fifo);
+    }
+
+    rt_kprintf("Compiled rules: %d / %d\n", n, CAN_FILTER_MAX_RULES);
+    for (int i = 0; i < n; i++) {
+        rt_kprintf("  [%2d] %s id 0x%08x mask 0x%08x -> FIFO%d\n", i, rules[i].ext ? "ext" : "std",
+                   rules[i].id, rules[i].mask, rules[i].fifo);
+    }
+}
+
+/* msh: can_filter <ch> add <fifo> <std|ext> <lo> [hi] | clear | show | apply */
+static int can_filter(int argc, char **argv)
+{
+    if (argc < 3) goto usage;
+
+    rt_uint8_t channel = (rt_uint8_t)atoi(argv[1]);
+    if (channel >= CAN_FILTER_CHANNELS) goto usage;
+
+    if (strcmp(argv[2], "add") == 0 && argc >= 6) {
+        rt_uint32_t lo = strtoul(argv[5], RT_NULL, 0);
+        rt_uint32_t hi = (argc >= 7) ? strtoul(argv[6], RT_NULL, 0) : lo;
+        int ret = can_filter_add(channel, (rt_uint8_t)atoi(argv[3]), strcmp(argv[4], "ext") == 0, lo, hi);
+        if (ret != RT_EOK) rt_kprintf("Add failed: %d\n", ret);
+        return ret;
+    } else if (strcmp(argv[2], "clear") == 0) {
+        can_filter_clear(channel);
+        return 0;
+    } else if (strcmp(argv[2], "show") == 0) {
+        can_filter_show(channel);
+        return 0;
+    } else if (strcmp(argv[2], "apply") == 0) {
+        int n = can_filter_apply(channel);
+        if (n < 0) {
+            rt_kprintf("Apply failed: %d\n", n);
+            return n;
+        }
+        rt_kprintf("CAN%d AFL updated: %d rules\n", channel, n);
+        return 0;
+    }
+
+usage:
+    rt_kprintf("Usage: can_filter <ch> add <fifo> <std|ext> <lo> [hi]\n");
+    rt_kprintf("       can_filter <ch> clear|show|apply\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_filter, Manage CANFD hardware acceptance filter rules);
@@ -0,0 +1,43 @@
+#ifndef __CAN_FILTER_H__
+#define __CAN_FILTER_H__
+
+#include <rtthread.h>
+
+/*
+ * CANFD 硬件接收过滤 (AFL) 运行时管理：
+ * 按通道登记需要的 ID / ID 区间及其目标 RX FIFO，编译为最少的 ID+掩码规则后写入 AFL。
+ * 未命中任何规则的帧由硬件丢弃，不产生接收中断。
+ */
+#define CAN_FILTER_MAX_RANGES   32      /* 每通道可登记的区间数 */
+#define CAN_FILTER_MAX_RULES    64      /* 每通道 AFL 规则数，与 CANFD_CFG_AFL_CHn_RULE_NUM 一致 */
+#define CAN_FILTER_MAX_BLOCKS   128     /* 编译过程中的中间块数 */
+
+#define CAN_FILTER_STD_MASK     0x7FFUL
+#define CAN_FILTER_EXT_MASK     0x1FFFFFFFUL
+
+typedef struct {
+    rt_uint32_t lo;
+    rt_uint32_t hi;
+    rt_uint8_t  ext;        /* 1: 29 位扩展帧 */
+    rt_uint8_t  fifo;       /* 目标 RX FIFO (0-7) */
+} CanFilterRange;
+
+/* 编译结果：mask 中为 1 的位参与比较 */
+typedef struct {
+    rt_uint32_t id;
+    rt_uint32_t mask;
+    rt_uint8_t  ext;
+    rt_uint8_t  fifo;
+} CanFilterRule;
+
+/* API */
+void can_filter_clear(rt_uint8_t channel);
+int  can_filter_add(rt_uint8_t channel, rt_uint8_t fifo, rt_uint8_t ext, rt_uint32_t lo, rt_uint32_t hi);
+
+/* 编译当前登记的区间，返回规则数；规则数超过 max 时合并相近规则 (多收的帧由软件丢弃) */
+int  can_filter_compile(rt_uint8_t channel, CanFilterRule *rules, rt_size_t max);
+
+/* 编译并写入硬件 AFL，通道保持运行；未登记任何区间时恢复为全部接收到本通道的批量 FIFO */
+int  can_filter_apply(rt_uint8_t channel);
+
+#endif
@@ -0,0 +1,474 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hal_data.h"
+#include "can_health.h"
+#include "can_tx.h"
+
+#define HEALTH_ID_MASK          (CAN_HEALTH_ID_SLOTS - 1)
+#define HEALTH_ID_VALID         0x40000000UL
+#define HEALTH_ID_EXT           0x80000000UL
+#define HEALTH_WINDOW_MS        (CAN_HEALTH_WINDOW * CAN_HEALTH_SAMPLE_MS)
+#define HEALTH_WARNING_LIMIT    95
+
+/* 每个 ID 的本周期计数和窗口历史 */
+typedef struct {
+    rt_uint32_t key;            /* ID | HEALTH_ID_VALID | 扩展帧 HEALTH_ID_EXT，0 为空 */
+    rt_uint16_t cur;
+    rt_uint16_t hist[CAN_HEALTH_WINDOW];
+    rt_uint32_t sum;
+} CanIdSlot;
+
+typedef struct {
+    /* 中断累加，采样时移入窗口 */
+    rt_uint32_t bits_cur;
+    rt_uint32_t frames_cur;
+    rt_uint32_t errors_cur;
+    rt_uint32_t bei_cur;
+
+    rt_uint32_t bits_hist[CAN_HEALTH_WINDOW];
+    rt_uint32_t frames_hist[CAN_HEALTH_WINDOW];
+    rt_uint32_t errors_hist[CAN_HEALTH_WINDOW];
+    rt_uint32_t bits_sum;
+    rt_uint32_t frames_sum;
+    rt_uint32_t errors_sum;
+    CanIdSlot   ids[CAN_HEALTH_ID_SLOTS];
+
+    rt_uint32_t bitrate;        /* 仲裁段波特率 */
+    rt_uint32_t brs_q8;         /* 数据段 / 仲裁段位时间之比，Q8 */
+    rt_uint8_t  policy;
+    rt_uint8_t  in_bus_off;
+    rt_uint8_t  stopped;
+    rt_uint8_t  bei_off;
+    rt_uint32_t backoff_ms;
+    rt_tick_t   off_at;
+    rt_tick_t   recovered_at;
+    rt_tick_t   reported_at;
+    struct rt_work recover_work;
+    CanHealthStats st;
+} CanHealthChannel;
+
+static CanHealthChannel health_ch[CAN_HEALTH_CHANNELS];
+static struct rt_work health_sample_work;
+static rt_uint32_t health_slot;
+static volatile rt_uint8_t health_report;   /* 待上报通道位图 */
+static rt_bool_t health_started = RT_FALSE;
+
+static const char *const state_names[] = { "active", "warning", "passive", "bus-off", "stopped" };
+static const char *const policy_names[] = { "iso", "fast", "backoff", "manual" };
+
+/* 一帧占用的标称位数 (含帧间隔)，位填充按 1/8 估算 */
+rt_inline rt_uint32_t frame_bits(const CanHealthChannel *c, rt_uint8_t flags, rt_uint8_t len)
+{
+    rt_uint32_t ext = (flags & CAN_FRAME_FLAG_EXT) ? 1 : 0;
+
+    if (!(flags & CAN_FRAME_FLAG_FD)) {
+        rt_uint32_t bits = (ext ? 67 : 47) + ((flags & CAN_FRAME_FLAG_RTR) ? 0 : 8U * len);
+        return bits + ((bits - 13) >> 3);
+    }
+
+    /* 仲裁段 (SOF - BRS) 和 CRC 界定符之后的部分按标称速率，其余按数据段速率 */
+    rt_uint32_t arb = (ext ? 36 : 17) + 13;
+    rt_uint32_t data = 8U * len;
+    data += (data >> 3) + ((len > 16) ? 36 : 32);
+    if (flags & CAN_FRAME_FLAG_BRS) data = (data * c->brs_q8) >> 8;
+    return arb + data;
+}
+
+void can_health_rx(rt_uint8_t channel, rt_uint32_t id, rt_uint8_t flags, rt_uint8_t len)
+{
+    if (channel >= CAN_HEALTH_CHANNELS) return;
+
+    CanHealthChannel *c = &health_ch[channel];
+    rt_uint32_t key = id | HEALTH_ID_VALID | ((flags & CAN_FRAME_FLAG_EXT) ? HEALTH_ID_EXT : 0);
+    rt_uint32_t h = (key * 2654435761UL) >> 24;
+    CanIdSlot *free_slot = RT_NULL;
+
+    c->bits_cur += frame_bits(c, flags, len);
+    c->frames_cur++;
+    c->st.rx_frames++;
+
+    /* 短探测；窗口内无帧的表项可被新 ID 复用 */
+    for (int k = 0; k < CAN_HEALTH_ID_PROBE; k++) {
+        CanIdSlot *s = &c->ids[(h + k) & HEALTH_ID_MASK];
+        if (s->key == key) {
+            s->cur++;
+            return;
+        }
+        if (free_slot == RT_NULL && (s->key == 0 || (s->sum == 0 && s->cur == 0))) free_slot = s;
+    }
+    if (free_slot) {
+        free_slot->key = key;
+        free_slot->cur = 1;
+    }
+}
+
+void can_health_tx(rt_uint8_t channel, rt_uint8_t flags, rt_uint8_t len)
+{
+    if (channel >= CAN_HEALTH_CHANNELS) return;
+
+    CanHealthChannel *c = &health_ch[channel];
+    c->bits_cur += frame_bits(c, flags, len);
+    c->frames_cur++;
+    c->st.tx_frames++;
+}
+
+static void health_set_mode(rt_uint8_t channel, rt_uint32_t mode)
+{
+    canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(channel);
+    volatile uint32_t *ctr = &ctrl->p_reg->CFDC[channel].CTR;
+
+    *ctr = (*ctr & ~R_CANFD_CFDC_CTR_CHMDC_Msk) | mode;
+}
+
+/* 关中断或中断上下文调用 */
+static void health_recovered(rt_uint8_t channel)
+{
+    CanHealthChannel *c = &health_ch[channel];
+
+    if (!c->in_bus_off) return;
+    c->in_bus_off = 0;
+    c->stopped = 0;
+    c->recovered_at = rt_tick_get();
+    c->st.recoveries++;
+    c->st.recovery_ms = c->recovered_at - c->off_at;
+    c->st.state = CAN_BUS_ACTIVE;
+    health_report |= 1U << channel;
+}
+
+static void health_bus_off(rt_uint8_t channel)
+{
+    CanHealthChannel *c = &health_ch[channel];
+    canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(channel);
+
+    c->st.bus_off++;
+    c->in_bus_off = 1;
+    c->off_at = rt_tick_get();
+    c->st.state = CAN_BUS_OFF;
+    health_report |= 1U << channel;
+
+    switch (c->policy) {
+    case CAN_BUSOFF_FAST:
+        ctrl->p_reg->CFDC[channel].CTR |= R_CANFD_CFDC_CTR_RTBO_Msk;
+        health_recovered(channel);
+        break;
+    case CAN_BUSOFF_BACKOFF:
+    case CAN_BUSOFF_MANUAL:
+        /* 进入通道复位，错误计数器清零，重新接入前不再发送 */
+        health_set_mode(channel, CAN_OPERATION_MODE_RESET);
+        c->stopped = 1;
+        c->st.state = CAN_BUS_STOPPED;
+        if (c->policy == CAN_BUSOFF_BACKOFF) {
+            rt_work_submit(&c->recover_work, rt_tick_from_millisecond(c->backoff_ms));
+            c->backoff_ms = (c->backoff_ms * 2 > CAN_HEALTH_BACKOFF_MAX_MS) ? CAN_HEALTH_BACKOFF_MAX_MS : c->backoff_ms * 2;
+        }
+        break;
+    default:    /* ISO：硬件自动恢复，在恢复中断中记录 */
+        break;
+    }
+}
+
+void can_health_error_isr(rt_uint8_t channel, rt_uint32_t error)
+{
+    if (channel >= CAN_HEALTH_CHANNELS) return;
+
+    CanHealthChannel *c = &health_ch[channel];
+    CanHealthStats *st = &c->st;
+
+    if (error & CANFD_ERROR_CHANNEL_BUS) {
+        st->error_frames++;
+        c->errors_cur++;
+        if (error & CANFD_ERROR_CHANNEL_STUFF) st->stuff_errors++;
+        if (error & CANFD_ERROR_CHANNEL_FORM) st->form_errors++;
+        if (error & (CANFD_ERROR_CHANNEL_ACK | CANFD_ERROR_CHANNEL_ACK_DELIMITER)) st->ack_errors++;
+        if (error & CANFD_ERROR_CHANNEL_CRC) st->crc_errors++;
+        if (error & (CANFD_ERROR_CHANNEL_BIT_RECESSIVE | CANFD_ERROR_CHANNEL_BIT_DOMINANT)) st->bit_errors++;
+
+        /* 故障总线上每个错误帧都会中断，超过上限后本采样周期内关闭总线错误中断 */
+        if (++c->bei_cur >= CAN_HEALTH_BEI_LIMIT && !c->bei_off) {
+            can_ring_get_ctrl(channel)->p_reg->CFDC[channel].CTR &= ~R_CANFD_CFDC_CTR_BEIE_Msk;
+            c->bei_off = 1;
+            st->bei_throttled++;
+        }
+    }
+    if (error & CANFD_ERROR_CHANNEL_ARBITRATION_LOSS) st->arb_lost++;
+    if (error & CANFD_ERROR_CHANNEL_OVERLOAD) st->overloads++;
+    if (error & CANFD_ERROR_CHANNEL_WARNING) st->warnings++;
+    if (error & CANFD_ERROR_CHANNEL_PASSIVE) {
+        st->passives++;
+        health_report |= 1U << channel;
+    }
+    if (error & CANFD_ERROR_CHANNEL_BUS_OFF_ENTRY) health_bus_off(channel);
+    if ((error & CANFD_ERROR_CHANNEL_BUS_OFF_RECOVERY) && c->policy == CAN_BUSOFF_ISO) health_recovered(channel);
+}
+
+/* 线程上下文：通道从复位回到通信模式 */
+static void health_restart(rt_uint8_t channel)
+{
+    canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(channel);
+
+    R_CANFD_ModeTransition(ctrl, CAN_OPERATION_MODE_NORMAL, ctrl->test_mode);
+    /* 复位时邮箱中的帧已被清除 */
+    can_tx_reset(channel);
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    health_recovered(channel);
+    rt_hw_interrupt_enable(level);
+}
+
+static void health_recover_work(struct rt_work *work, void *data)
+{
+    rt_uint8_t channel = (rt_uint8_t)(rt_ubase_t)data;
+
+    (void)work;
+    if (health_ch[channel].stopped && health_ch[channel].policy == CAN_BUSOFF_BACKOFF) health_restart(channel);
+}
+
+static void health_sample_channel(rt_uint8_t channel, rt_uint32_t slot, rt_tick_t now)
+{
+    CanHealthChannel *c = &health_ch[channel];
+    CanHealthStats *st = &c->st;
+    canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(channel);
+    can_info_t info;
+
+    if (ctrl == RT_NULL) return;
+
+    /* 本周期计数移入窗口 */
+    rt_base_t level = rt_hw_interrupt_disable();
+    c->bits_sum += c->bits_cur - c->bits_hist[slot];
+    c->bits_hist[slot] = c->bits_cur;
+    c->bits_cur = 0;
+    c->frames_sum += c->frames_cur - c->frames_hist[slot];
+    c->frames_hist[slot] = c->frames_cur;
+    c->frames_cur = 0;
+    c->errors_sum += c->errors_cur - c->errors_hist[slot];
+    c->errors_hist[slot] = c->errors_cur;
+    c->errors_cur = 0;
+    for (int i = 0; i < CAN_HEALTH_ID_SLOTS; i++) {
+        CanIdSlot *s = &c->ids[i];
+        if (s->key == 0) continue;
+        s->sum += s->cur - s->hist[slot];
+        s->hist[slot] = s->cur;
+        s->cur = 0;
+    }
+    c->bei_cur = 0;
+    if (c->bei_off) {
+        ctrl->p_reg->CFDC[channel].CTR |= R_CANFD_CFDC_CTR_BEIE_Msk;
+        c->bei_off = 0;
+    }
+    rt_hw_interrupt_enable(level);
+
+    R_CANFD_InfoGet(ctrl, &info);
+
+    /* ISO 策略下错过恢复中断时按状态寄存器补记 */
+    if (c->in_bus_off && !c->stopped && !(info.status & CANFD_STATUS_BUS_OFF)) {
+        level = rt_hw_interrupt_disable();
+        health_recovered(channel);
+        rt_hw_interrupt_enable(level);
+    }
+
+    rt_uint8_t state;
+    if (c->stopped) {
+        state = CAN_BUS_STOPPED;
+    } else if (info.status & CANFD_STATUS_BUS_OFF) {
+        state = CAN_BUS_OFF;
+    } else if (info.status & CANFD_STATUS_ERROR_PASSIVE) {
+        state = CAN_BUS_PASSIVE;
+    } else if (info.error_count_transmit > HEALTH_WARNING_LIMIT || info.error_count_receive > HEALTH_WARNING_LIMIT) {
+        state = CAN_BUS_WARNING;
+    } else {
+        state = CAN_BUS_ACTIVE;
+    }
+    if (state != st->state) {
+        st->state = state;
+        health_report |= 1U << channel;
+    }
+
+    st->tec = info.error_count_transmit;
+    st->rec = info.error_count_receive;
+    if (st->tec > st->tec_peak) st->tec_peak = st->tec;
+    if (st->rec > st->rec_peak) st->rec_peak = st->rec;
+
+    rt_uint64_t window_bits = (rt_uint64_t)c->bitrate * HEALTH_WINDOW_MS / 1000;
+    st->load = window_bits ? (rt_uint16_t)((rt_uint64_t)c->bits_sum * 1000 / window_bits) : 0;
+    if (st->load > st->load_peak) st->load_peak = st->load;
+    st->frame_rate = c->frames_sum * 1000 / HEALTH_WINDOW_MS;
+    st->error_rate = c->errors_sum * 1000 / HEALTH_WINDOW_MS;
+
+    /* 恢复后稳定运行一段时间，退避延时回到初值 */
+    if (!c->in_bus_off && now - c->recovered_at >= rt_tick_from_millisecond(CAN_HEALTH_BACKOFF_RESET_MS)) {
+        c->backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+    }
+    if (now - c->reported_at >= rt_tick_from_millisecond(CAN_HEALTH_REPORT_MS)) {
+        health_report |= 1U << channel;
+    }
+}
+
+static void health_sample(struct rt_work *work, void *data)
+{
+    rt_tick_t now = rt_tick_get();
+
+    (void)data;
+    for (rt_uint8_t ch = 0; ch < CAN_HEALTH_CHANNELS; ch++) health_sample_channel(ch, health_slot, now);
+    health_slot = (health_slot + 1) % CAN_HEALTH_WINDOW;
+
+    rt_work_submit(work, rt_tick_from_millisecond(CAN_HEALTH_SAMPLE_MS));
+}
+
+static rt_uint32_t timing_bitrate(const can_bit_timing_cfg_t *t)
+{
+    rt_uint32_t tq = t->baud_rate_prescaler * (1U + t->time_segment_1 + t->time_segment_2);
+    return tq ? R_FSP_SystemClockHzGet(FSP_PRIV_CLOCK_PCLKCAN) / tq : 0;
+}
+
+void can_health_start(void)
+{
+    if (health_started) return;
+
+    for (rt_uint8_t ch = 0; ch < CAN_HEALTH_CHANNELS; ch++) {
+        CanHealthChannel *c = &health_ch[ch];
+        canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(ch);
+
+        c->st.channel = ch;
+        c->policy = CAN_BUSOFF_BACKOFF;
+        c->backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+        c->brs_q8 = 256;
+        rt_work_init(&c->recover_work, health_recover_work, (void *)(rt_ubase_t)ch);
+        if (ctrl == RT_NULL) continue;
+
+        const canfd_extended_cfg_t *ext = ctrl->p_cfg->p_extend;
+        c->bitrate = timing_bitrate(ctrl->p_cfg->p_bit_timing);
+        if (ext->p_data_timing) {
+            rt_uint32_t data_rate = timing_bitrate(ext->p_data_timing);
+            if (data_rate) c->brs_q8 = (rt_uint32_t)(((rt_uint64_t)c->bitrate << 8) / data_rate);
+        }
+    }
+
+    rt_work_init(&health_sample_work, health_sample, RT_NULL);
+    rt_work_submit(&health_sample_work, rt_tick_from_millisecond(CAN_HEALTH_SAMPLE_MS));
+    health_started = RT_TRUE;
+}
+
+int can_health_set_policy(rt_uint8_t channel, CanBusOffPolicy policy)
+{
+    if (channel >= CAN_HEALTH_CHANNELS || policy > CAN_BUSOFF_MANUAL) return -RT_EINVAL;
+
+    health_ch[channel].policy = (rt_uint8_t)policy;
+    health_ch[channel].backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+    return RT_EOK;
+}
+
+int can_health_recover(rt_uint8_t channel)
+{
+    if (channel >= CAN_HEALTH_CHANNELS || can_ring_get_ctrl(channel) == RT_NULL) return -RT_EINVAL;
+    if (!health_ch[channel].stopped) return -RT_ERROR;
+
+    rt_work_cancel(&health_ch[channel].recover_work);
+    health_restart(channel);
+    return RT_EOK;
+}
+
+void can_health_get_stats(rt_uint8_t channel, CanHealthStats *stats)
+{
+    if (channel >= CAN_HEALTH_CHANNELS) return;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    *stats = health_ch[channel].st;
+    rt_hw_interrupt_enable(level);
+}
+
+int can_health_top_ids(rt_uint8_t channel, CanIdRate *out, int max)
+{
+    int n = 0;
+
+    if (channel >= CAN_HEALTH_CHANNELS) return 0;
+
+    const CanHealthChannel *c = &health_ch[channel];
+    for (int i = 0; i < CAN_HEALTH_ID_SLOTS; i++) {
+        const CanIdSlot *s = &c->ids[i];
+        rt_uint32_t key = s->key, sum = s->sum;
+        if (key == 0 || sum == 0) continue;
+
+        rt_uint32_t rate = sum * 1000 / HEALTH_WINDOW_MS;
+        int pos = (n < max) ? n++ : max;
+        while (pos > 0 && out[pos - 1].rate < rate) {
+            if (pos < max) out[pos] = out[pos - 1];
+            pos--;
+        }
+        if (pos < max) {
+            out[pos].id = key & ~(HEALTH_ID_VALID | HEALTH_ID_EXT);
+            out[pos].ext = (key & HEALTH_ID_EXT) ? 1 : 0;
+            out[pos].rate = rate;
+        }
+    }
+    return n;
+}
+
+rt_bool_t can_health_collect(CanHealthStats *stats)
+{
+    if (health_report == 0) return RT_FALSE;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint8_t channel = (health_report & 1) ? 0 : 1;
+    health_report &= ~(1U << channel);
+    health_ch[channel].reported_at = rt_tick_get();
+    *stats = health_ch[channel].st;
+    rt_hw_interrupt_enable(level);
+    return RT_TRUE;
+}
+
+static void can_health_show(rt_uint8_t channel)
+{
+    const CanHealthChannel *c = &health_ch[channel];
+    CanHealthStats st;
+
+    can_health_get_stats(channel, &st);
+    rt_kprintf("CAN%d: %s, policy %s, %u bit/s\n", channel, state_names[st.state], policy_names[c->policy], c->bitrate);
+    rt_kprintf("  TEC %u (peak %u)  REC %u (peak %u)\n", st.tec, st.tec_peak, st.rec, st.rec_peak);
+    rt_kprintf("  Load %u.%u%% (peak %u.%u%%), %u frame/s, %u error/s\n", st.load / 10, st.load % 10,
+               st.load_peak / 10, st.load_peak % 10, st.frame_rate, st.error_rate);
+    rt_kprintf("  Frames rx %u tx %u, error frames %u (throttled %u)\n", st.rx_frames, st.tx_frames,
+               st.error_frames, st.bei_throttled);
+    rt_kprintf("  Errors: stuff %u form %u ack %u crc %u bit %u, arb lost %u, overload %u\n", st.stuff_errors,
+               st.form_errors, st.ack_errors, st.crc_errors, st.bit_errors, st.arb_lost, st.overloads);
+    rt_kprintf("  Warning %u, passive %u, bus-off %u, recovered %u (last %u ms)\n", st.warnings, st.passives,
+               st.bus_off, st.recoveries, st.recovery_ms);
+}
+
+/* msh: can_health [stat] | ids <ch> | policy <ch> iso|fast|backoff|manual | recover <ch> */
+static int can_health(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "stat") == 0) {
+        for (rt_uint8_t ch = 0; ch < CAN_HEALTH_CHANNELS; ch++) {
+            if (can_ring_get_ctrl(ch)) can_health_show(ch);
+        }
+        return 0;
+    } else if (argc >= 3 && strcmp(argv[1], "ids") == 0) {
+        CanIdRate top[16];
+        int n = can_health_top_ids((rt_uint8_t)atoi(argv[2]), top, 16);
+        rt_kprintf("id          frame/s\n");
+        for (int i = 0; i < n; i++) {
+            rt_kprintf(top[i].ext ? "%08X    %u\n" : "%03X         %u\n", top[i].id, top[i].rate);
+        }
+        return 0;
+    } else if (argc >= 4 && strcmp(argv[1], "policy") == 0) {
+        for (int p = 0; p <= CAN_BUSOFF_MANUAL; p++) {
+            if (strcmp(argv[3], policy_names[p]) == 0) {
+                return can_health_set_policy((rt_uint8_t)atoi(argv[2]), (CanBusOffPolicy)p);
+            }
+        }
+    } else if (argc >= 3 && strcmp(argv[1], "recover") == 0) {
+        int ret = can_health_recover((rt_uint8_t)atoi(argv[2]));
+        if (ret != RT_EOK) rt_kprintf("CAN%s is not stopped\n", argv[2]);
+        return ret;
+    }
+
+    rt_kprintf("Usage: can_health [stat]\n");
+    rt_kprintf("       can_health ids <ch>\n");
+    rt_kprintf("       can_health policy <ch> iso|fast|backoff|manual\n");
+    rt_kprintf("       can_health recover <ch>\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_health, CAN bus error / load monitor and bus-off recovery);
@@ -0,0 +1,104 @@
+#ifndef __CAN_HEALTH_H__
+#define __CAN_HEALTH_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * CAN 总线健康监测：错误计数 (TEC/REC)、错误帧、总线负载、各 ID 帧率及 bus-off 自动恢复。
+ *
+ * 接收中断中每帧只累加估算位数、帧数和所属 ID 的计数 (哈希表最多探测 CAN_HEALTH_ID_PROBE 次)；
+ * 通道错误中断记录错误类型和状态变化；系统工作队列每 CAN_HEALTH_SAMPLE_MS 读取 TEC/REC，
+ * 并把本周期计数移入 CAN_HEALTH_WINDOW 个周期的滑动窗口，负载和帧率均为窗口平均值。
+ *
+ * 位数按标称位时间折算：CAN-FD BRS 帧的数据段按数据段/仲裁段波特率之比缩减，位填充按 1/8 估算。
+ * 总线错误中断在一个采样周期内超过 CAN_HEALTH_BEI_LIMIT 次时暂时关闭，避免故障总线上的中断风暴，
+ * 此时 error_frames 为下限值。
+ */
+#define CAN_HEALTH_CHANNELS     2
+#define CAN_HEALTH_SAMPLE_MS    100
+#define CAN_HEALTH_WINDOW       10      /* 滑动窗口 = 10 个采样周期 (1 s) */
+#define CAN_HEALTH_ID_SLOTS     64      /* 每通道跟踪的 ID 数，必须为 2 的幂 */
+#define CAN_HEALTH_ID_PROBE     4
+#define CAN_HEALTH_BEI_LIMIT    200     /* 每采样周期总线错误中断上限 */
+#define CAN_HEALTH_REPORT_MS    10000   /* 定期上报周期，状态变化时立即上报 */
+
+#define CAN_HEALTH_BACKOFF_MIN_MS   10      /* 退避恢复的首次延时 */
+#define CAN_HEALTH_BACKOFF_MAX_MS   1000
+#define CAN_HEALTH_BACKOFF_RESET_MS 5000    /* 恢复后稳定运行该时长，退避延时回到初值 */
+
+typedef enum {
+    CAN_BUS_ACTIVE = 0,
+    CAN_BUS_WARNING,            /* TEC 或 REC > 95 */
+    CAN_BUS_PASSIVE,            /* TEC 或 REC > 127 */
+    CAN_BUS_OFF,
+    CAN_BUS_STOPPED,            /* bus-off 后通道已复位，等待恢复 */
+} CanBusState;
+
+/* bus-off 恢复策略 */
+typedef enum {
+    CAN_BUSOFF_ISO = 0,         /* 硬件按 ISO 11898-1 在 128 x 11 个隐性位后自动恢复 */
+    CAN_BUSOFF_FAST,            /* 进入 bus-off 立即强制恢复 (RTBO)，不等待 128 x 11 位 */
+    CAN_BUSOFF_BACKOFF,         /* 复位通道，按指数退避延时后重新接入总线 (默认) */
+    CAN_BUSOFF_MANUAL,          /* 复位通道，等待 can_health_recover */
+} CanBusOffPolicy;
+
+typedef struct {
+    rt_uint8_t  channel;
+    rt_uint8_t  state;          /* CanBusState */
+    rt_uint8_t  tec;
+    rt_uint8_t  rec;
+    rt_uint8_t  tec_peak;
+    rt_uint8_t  rec_peak;
+    rt_uint16_t load;           /* 总线负载，0.1% */
+    rt_uint16_t load_peak;
+    rt_uint32_t frame_rate;     /* 帧/秒 (接收 + 本机发送) */
+    rt_uint32_t error_rate;     /* 错误帧/秒 */
+    rt_uint32_t rx_frames;
+    rt_uint32_t tx_frames;
+    rt_uint32_t error_frames;
+    rt_uint32_t stuff_errors;
+    rt_uint32_t form_errors;
+    rt_uint32_t ack_errors;
+    rt_uint32_t crc_errors;
+    rt_uint32_t bit_errors;
+    rt_uint32_t arb_lost;
+    rt_uint32_t overloads;
+    rt_uint32_t warnings;       /* 进入错误警告次数 */
+    rt_uint32_t passives;       /* 进入错误被动次数 */
+    rt_uint32_t bus_off;
+    rt_uint32_t recoveries;
+    rt_uint32_t recovery_ms;    /* 最近一次 bus-off 到恢复的时间 */
+    rt_uint32_t bei_throttled;  /* 总线错误中断被暂停的采样周期数 */
+} CanHealthStats;
+
+typedef struct {
+    rt_uint32_t id;
+    rt_uint8_t  ext;
+    rt_uint32_t rate;           /* 帧/秒 */
+} CanIdRate;
+
+/* API */
+/* 启动采样，在 can_ring_attach 之后调用 */
+void can_health_start(void);
+
+/* 中断上下文：每个接收帧 / 本机发送完成的帧调用一次 */
+void can_health_rx(rt_uint8_t channel, rt_uint32_t id, rt_uint8_t flags, rt_uint8_t len);
+void can_health_tx(rt_uint8_t channel, rt_uint8_t flags, rt_uint8_t len);
+
+/* 中断上下文：通道错误中断的错误标志 (canfd_error_t) */
+void can_health_error_isr(rt_uint8_t channel, rt_uint32_t error);
+
+int  can_health_set_policy(rt_uint8_t channel, CanBusOffPolicy policy);
+/* 手动恢复已停止的通道 */
+int  can_health_recover(rt_uint8_t channel);
+
+void can_health_get_stats(rt_uint8_t channel, CanHealthStats *stats);
+
+/* 窗口内帧率最高的 ID，按帧率降序，返回个数 */
+int  can_health_top_ids(rt_uint8_t channel, CanIdRate *out, int max);
+
+/* CAN 线程：取出一个待上报通道的统计 (定期或状态变化)，无返回 RT_FALSE */
+rt_bool_t can_health_collect(CanHealthStats *stats);
+
+#endif
@@ -0,0 +1,285 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "can_policy.h"
+
+#define CAN_POLICY_HASH_MASK    (CAN_POLICY_HASH_SIZE - 1)
+#define CAN_POLICY_SLOT_EMPTY   0xFFFF
+#define CAN_POLICY_KEY_EXT      0x80000000UL
+#define CAN_POLICY_KEY_CH1      0x40000000UL
+
+typedef struct {
+    rt_uint32_t key;        /* id | 扩展帧 | 通道 */
+    rt_uint8_t  type;       /* CanPolicyType */
+    rt_uint8_t  pending;    /* 快照：有未发布的更新 */
+    rt_uint8_t  valid;      /* 已收到过帧 */
+    rt_uint32_t interval;   /* ms */
+    rt_tick_t   last_tick;  /* 上次转发时间 */
+    rt_uint32_t forwarded;
+    rt_uint32_t suppressed;
+    CanFrame    last;       /* 最近一帧 (变化检测、快照) */
+} CanPolicyEntry;
+
+static CanPolicyEntry policy_table[CAN_POLICY_TABLE_SIZE];
+static rt_uint16_t policy_hash[CAN_POLICY_HASH_SIZE];
+static rt_uint16_t policy_num;
+static rt_uint8_t default_type = CAN_POLICY_FORWARD;
+static rt_uint32_t default_interval;
+static CanPolicyStats policy_stats;
+
+static struct rt_mutex policy_lock;
+static rt_bool_t policy_inited = RT_FALSE;
+
+static const char *policy_names[CAN_POLICY_NUM] = { "fwd", "change", "throttle", "snapshot", "drop" };
+
+static void can_policy_init(void)
+{
+    if (!policy_inited) {
+        rt_mutex_init(&policy_lock, "can_pol", RT_IPC_FLAG_PRIO);
+        memset(policy_hash, 0xFF, sizeof(policy_hash));
+        policy_inited = RT_TRUE;
+    }
+}
+
+rt_inline rt_uint32_t policy_key(rt_uint8_t channel, rt_uint32_t id, rt_uint8_t ext)
+{
+    return id | (ext ? CAN_POLICY_KEY_EXT : 0) | (channel ? CAN_POLICY_KEY_CH1 : 0);
+}
+
+rt_inline rt_uint32_t policy_hash_of(rt_uint32_t key)
+{
+    return ((rt_uint32_t)(key * 2654435761UL) >> 24) & CAN_POLICY_HASH_MASK;
+}
+
+/* 查找 key 对应的表项，create 为真且不存在时按给定策略新建，表满返回 RT_NULL */
+static CanPolicyEntry *policy_lookup(rt_uint32_t key, rt_bool_t create, rt_uint8_t type, rt_uint32_t interval)
+{
+    rt_uint32_t h = policy_hash_of(key);
+
+    while (policy_hash[h] != CAN_POLICY_SLOT_EMPTY) {
+        CanPolicyEntry *e = &policy_table[policy_hash[h]];
+        if (e->key == key) return e;
+        h = (h + 1) & CAN_POLICY_HASH_MASK;
+    }
+
+    if (!create || policy_num >= CAN_POLICY_TABLE_SIZE) return RT_NULL;
+
+    CanPolicyEntry *e = &policy_table[policy_num];
+    memset(e, 0, offsetof(CanPolicyEntry, last));
+    e->key = key;
+    e->type = type;
+    e->interval = interval;
+    policy_hash[h] = policy_num++;
+    return e;
+}
+
+int can_policy_set(rt_uint8_t channel, rt_uint32_t id, rt_uint8_t ext, CanPolicyType type, rt_uint32_t interval_ms)
+{
+    if (type >= CAN_POLICY_NUM) return -RT_EINVAL;
+
+    can_policy_init();
+    rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+
+    CanPolicyEntry *e = policy_lookup(policy_key(channel, id, ext), RT_TRUE, type, interval_ms);
+    if (e) {
+        e->type = type;
+        e->interval = interval_ms;
+        e->pending = 0;
+    }
+
+    rt_mutex_release(&policy_lock);
+    return e ? RT_EOK : -RT_EFULL;
+}
+
+void can_policy_set_default(CanPolicyType type, rt_uint32_t interval_ms)
+{
+    if (type >= CAN_POLICY_NUM) return;
+
+    can_policy_init();
+    rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+    default_type = type;
+    default_interval = interval_ms;
+    rt_mutex_release(&policy_lock);
+}
+
+void can_policy_clear(void)
+{
+    can_policy_init();
+    rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+    memset(policy_hash, 0xFF, sizeof(policy_hash));
+    policy_num = 0;
+    memset(&policy_stats, 0, sizeof(policy_stats));
+    rt_mutex_release(&policy_lock);
+}
+
+static rt_bool_t frame_changed(const CanPolicyEntry *e, const CanFrame *frame)
+{
+    return !e->valid || e->last.len != frame->len || e->last.flags != frame->flags ||
+           memcmp(e->last.data, frame->data, frame->len) != 0;
+}
+
+static void frame_store(CanPolicyEntry *e, const CanFrame *frame)
+{
+    memcpy(&e->last, frame, offsetof(CanFrame, data) + frame->len);
+    e->valid = 1;
+}
+
+/* 持锁调用：按策略判断一帧是否立即上报 */
+static rt_bool_t policy_filter_one(const CanFrame *frame, rt_tick_t now)
+{
+    rt_bool_t forward;
+
+    rt_uint32_t key = policy_key(frame->channel, frame->id, frame->flags & CAN_FRAME_FLAG_EXT);
+    /* 默认策略需要逐 ID 状态时自动建表 */
+    CanPolicyEntry *e = policy_lookup(key, default_type != CAN_POLICY_FORWARD, default_type, default_interval);
+
+    if (e == RT_NULL) {
+        if (default_type != CAN_POLICY_FORWARD) policy_stats.untracked++;
+        forward = RT_TRUE;
+    } else {
+        switch (e->type) {
+        case CAN_POLICY_ON_CHANGE:
+            forward = frame_changed(e, frame) ||
+                      (e->interval && now - e->last_tick >= e->interval);
+            break;
+        case CAN_POLICY_THROTTLE:
+            forward = !e->valid || now - e->last_tick >= e->interval;
+            break;
+        case CAN_POLICY_SNAPSHOT:
+            e->pending = 1;
+            forward = RT_FALSE;
+            break;
+        case CAN_POLICY_DROP:
+            forward = RT_FALSE;
+            break;
+        default:
+            forward = RT_TRUE;
+            break;
+        }
+
+        if (e->type == CAN_POLICY_ON_CHANGE || e->type == CAN_POLICY_SNAPSHOT || forward) {
+            frame_store(e, frame);
+        }
+        if (forward) {
+            e->last_tick = now;
+            e->forwarded++;
+        } else {
+            e->suppressed++;
+        }
+    }
+
+    if (forward) {
+        policy_stats.forwarded++;
+    } else {
+        policy_stats.suppressed++;
+    }
+    return forward;
+}
+
+rt_size_t can_policy_filter(CanFrame *frames, rt_size_t n, rt_tick_t now)
+{
+    rt_size_t m = 0;
+
+    can_policy_init();
+    rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+    for (rt_size_t i = 0; i < n; i++) {
+        if (!policy_filter_one(&frames[i], now)) continue;
+        if (m != i) memcpy(&frames[m], &frames[i], offsetof(CanFrame, data) + frames[i].len);
+        m++;
+    }
+    rt_mutex_release(&policy_lock);
+    return m;
+}
+
+rt_size_t can_policy_collect(CanFrame *frames, rt_size_t max, rt_tick_t now)
+{
+    rt_size_t n = 0;
+
+    can_policy_init();
+    rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+
+    for (int i = 0; i < policy_num && n < max; i++) {
+        CanPolicyEntry *e = &policy_table[i];
+
+        if (e->type != CAN_POLICY_SNAPSHOT || !e->pending) continue;
+        if (now - e->last_tick < e->interval) continue;
+
+        memcpy(&frames[n++], &e->last, offsetof(CanFrame, data) + e->last.len);
+        e->pending = 0;
+        e->last_tick = now;
+        e->forwarded++;
+        /* 快照发布计为转发，被合并的帧已计入 suppressed */
+        e->suppressed--;
+        policy_stats.suppressed--;
+        policy_stats.forwarded++;
+    }
+
+    rt_mutex_release(&policy_lock);
+    return n;
+}
+
+void can_policy_get_stats(CanPolicyStats *stats)
+{
+    *stats = policy_stats;
+}
+
+static CanPolicyType policy_parse(const char *name)
+{
+    for (int i = 0; i < CAN_POLICY_NUM; i++) {
+        if (strcmp(name, policy_names[i]) == 0) return (CanPolicyType)i;
+    }
+    return CAN_POLICY_NUM;
+}
+
+static void can_policy_show(void)
+{
+    rt_uint32_t total = policy_stats.forwarded + policy_stats.suppressed;
+
+    rt_kprintf("Default policy: %s %u ms, tracked IDs: %d / %d\n",
+               policy_names[default_type], default_interval, policy_num, CAN_POLICY_TABLE_SIZE);
+    rt_kprintf("Forwarded %u, suppressed %u (%u%%), untracked %u\n", policy_stats.forwarded,
+               policy_stats.suppressed, total ? policy_stats.suppressed * 100 / total : 0, policy_stats.untracked);
+    rt_kprintf("ch  id          policy    interval  forwarded  suppressed\n");
+    for (int i = 0; i < policy_num; i++) {
+        const CanPolicyEntry *e = &policy_table[i];
+        rt_kprintf("%2d  0x%08X  %-8s  %8u  %9u  %10u\n", (e->key & CAN_POLICY_KEY_CH1) ? 1 : 0,
+                   e->key & 0x1FFFFFFF, policy_names[e->type], e->interval, e->forwarded, e->suppressed);
+    }
+}
+
+/* msh: can_policy set <ch> <id> <policy> [ms] [ext] | default <policy> [ms] | clear | show */
+static int can_policy(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "show") == 0) {
+        can_policy_init();
+        rt_mutex_take(&policy_lock, RT_WAITING_FOREVER);
+        can_policy_show();
+        rt_mutex_release(&policy_lock);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "clear") == 0) {
+        can_policy_clear();
+        return 0;
+    } else if (argc >= 3 && strcmp(argv[1], "default") == 0) {
+        CanPolicyType type = policy_parse(argv[2]);
+        if (type < CAN_POLICY_NUM) {
+            can_policy_set_default(type, (argc >= 4) ? strtoul(argv[3], RT_NULL, 0) : 0);
+            return 0;
+        }
+    } else if (argc >= 5 && strcmp(argv[1], "set") == 0) {
+        CanPolicyType type = policy_parse(argv[4]);
+        if (type < CAN_POLICY_NUM) {
+            int ret = can_policy_set((rt_uint8_t)atoi(argv[2]), strtoul(argv[3], RT_NULL, 0),
+                                     argc >= 7 && strcmp(argv[6], "ext") == 0, type,
+                                     (argc >= 6) ? strtoul(argv[5], RT_NULL, 0) : 0);
+            if (ret != RT_EOK) rt_kprintf("Policy table full\n");
+            return ret;
+        }
+    }
+
+    rt_kprintf("Usage: can_policy set <ch> <id> <fwd|change|throttle|snapshot|drop> [ms] [ext]\n");
+    rt_kprintf("       can_policy default <policy> [ms]\n");
+    rt_kprintf("       can_policy clear|show\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_policy, Configure per-ID CAN forwarding policy);
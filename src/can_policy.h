@@ -0,0 +1,42 @@
+#ifndef __CAN_POLICY_H__
+#define __CAN_POLICY_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * 按 CAN ID 的转发策略：在 CAN 线程中决定每帧是否上报，减少周期报文的重复上行。
+ * ID 表为开放寻址哈希，每帧查找 O(1)；CAN 线程按批筛选，每批加锁一次，msh 修改 (含默认策略) 时同样加锁。
+ */
+#define CAN_POLICY_TABLE_SIZE   128     /* 最多跟踪的 ID 数 */
+#define CAN_POLICY_HASH_SIZE    256     /* 必须为 2 的幂且不小于表大小的 2 倍 */
+
+typedef enum {
+    CAN_POLICY_FORWARD = 0, /* 每帧转发 */
+    CAN_POLICY_ON_CHANGE,   /* 数据变化时转发，interval_ms 非 0 时无变化也至少每 interval_ms 转发一次 */
+    CAN_POLICY_THROTTLE,    /* 两次转发至少间隔 interval_ms */
+    CAN_POLICY_SNAPSHOT,    /* 只保留最新一帧，每 interval_ms 发布一次 (期间有更新才发布) */
+    CAN_POLICY_DROP,        /* 不转发 */
+    CAN_POLICY_NUM
+} CanPolicyType;
+
+typedef struct {
+    rt_uint32_t forwarded;
+    rt_uint32_t suppressed;
+    rt_uint32_t untracked;  /* 表满后按 FORWARD 处理的帧数 */
+} CanPolicyStats;
+
+/* API */
+int  can_policy_set(rt_uint8_t channel, rt_uint32_t id, rt_uint8_t ext, CanPolicyType type, rt_uint32_t interval_ms);
+void can_policy_set_default(CanPolicyType type, rt_uint32_t interval_ms);
+void can_policy_clear(void);
+
+/* 按策略就地筛选一批帧 (整批只加一次锁)，应立即上报的帧按原顺序移到前部，返回其个数 */
+rt_size_t can_policy_filter(CanFrame *frames, rt_size_t n, rt_tick_t now);
+
+/* 取出到期的快照帧，返回帧数 */
+rt_size_t can_policy_collect(CanFrame *frames, rt_size_t max, rt_tick_t now);
+
+void can_policy_get_stats(CanPolicyStats *stats);
+
+#endif
@@ -0,0 +1,405 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stddef.h>
+#include "hal_data.h"
+#include "can_ring.h"
+#include "perf_counter.h"
+#include "can_capture.h"
+#include "can_tx.h"
+#include "can_health.h"
+
+#define CAN_RING_MASK       (CAN_RING_SIZE - 1)
+#define CAN_FRAME_HDR_SIZE  offsetof(CanFrame, data)
+#define CAN_TS_CALIB_US     5000    /* 时间戳计数器标定时长 */
+
+/* 被接管前的驱动回调，非接收事件 (发送完成、错误等) 仍转交给它 */
+typedef struct {
+    canfd_instance_ctrl_t *ctrl;
+    void (*callback)(can_callback_args_t *);
+    void const *context;
+} CanRingHook;
+
+typedef struct {
+    volatile rt_uint32_t head;  /* 仅中断写 */
+    volatile rt_uint32_t tail;  /* 仅线程写 */
+    CanRingStats stats;
+    CanFrame frames[CAN_RING_SIZE];
+} CanRing;
+
+static CanRing can_rings[CAN_CLASS_NUM];
+static CanFifoStats can_fifo_stats[CAN_RING_FIFO_NUM];
+static CanFrame can_drop_frame;     /* 队列满时的暂存帧，仍需交给抓包 */
+static rt_uint8_t can_fifo_class[CAN_RING_FIFO_NUM] = {
+    [CAN_FIFO_CH0_HIGH] = CAN_CLASS_HIGH, [CAN_FIFO_CH0_BULK] = CAN_CLASS_BULK,
+    [CAN_FIFO_CH1_HIGH] = CAN_CLASS_HIGH, [CAN_FIFO_CH1_BULK] = CAN_CLASS_BULK,
+    [4] = CAN_CLASS_BULK, [5] = CAN_CLASS_BULK, [6] = CAN_CLASS_BULK, [7] = CAN_CLASS_BULK,
+};
+
+static rt_uint32_t can_ts_scale_q16;    /* CNTPCT 计数 / CANFD 时间戳计数，Q16；数值上等于一个回绕周期的 CNTPCT 计数 */
+static rt_uint64_t can_fifo_empty_at[CAN_RING_FIFO_NUM];  /* 各 FIFO 最近一次读空的时刻 (CNTPCT) */
+static struct rt_semaphore can_ring_sem;
+static rt_bool_t can_ring_inited = RT_FALSE;
+static CanRingHook can_hooks[BSP_FEATURE_CANFD_NUM_CHANNELS];
+
+/* 硬件 FIFO 溢出标志 (RFMLT) 计数后清除 */
+static void can_fifo_check_lost(R_CANFD_Type *reg, rt_uint32_t fifo)
+{
+    if (reg->CFDRFSTS[fifo] & R_CANFD_CFDRFSTS_RFMLT_Msk) {
+        reg->CFDRFSTS[fifo] &= (uint32_t) ~R_CANFD_CFDRFSTS_RFMLT_Msk;
+        can_fifo_stats[fifo].hw_lost++;
+    }
+}
+
+/*
+ * 标定 CANFD 时间戳计数器 (CFDGTSC，16 位) 与 CNTPCT 的比例。
+ * 计数器时钟为外设时钟 / 2^CANFD_CFG_TIMESTAMP_PRESCALER，采样期间累加增量以跨越回绕。
+ */
+static void can_ts_calibrate(R_CANFD_Type *reg)
+{
+    rt_uint64_t span = (rt_uint64_t)__get_CNTFRQ() * CAN_TS_CALIB_US / 1000000;
+    rt_uint64_t start = perf_now(), now;
+    rt_uint32_t last = reg->CFDGTSC & 0xFFFF;
+    rt_uint32_t ts_total = 0;
+
+    do {
+        rt_uint32_t cur = reg->CFDGTSC & 0xFFFF;
+        ts_total += (cur - last) & 0xFFFF;
+        last = cur;
+        now = perf_now();
+    } while (now - start < span);
+
+    can_ts_scale_q16 = ts_total ? (rt_uint32_t)(((now - start) << 16) / ts_total) : 0;
+}
+
+/*
+ * 帧的 16 位硬件时间戳换算到 CNTPCT：用当前计数器值求出帧在 FIFO 中停留的时长再回推。
+ * 帧里只有 16 位，停留时长只能按一个计数器回绕周期取模得到，软件无法再扩展：
+ * 要求帧在一个回绕周期内被读出 (见 CAN_POLL_INTERVAL_MS)，否则时间戳晚整数个周期。
+ * 帧到达晚于该 FIFO 上次读空的时刻，距今超过一个周期时无法保证，计入 ts_wrap；未标定时退化为读出时刻。
+ */
+static rt_uint64_t can_rx_timestamp(R_CANFD_Type *reg, rt_uint32_t fifo, rt_uint32_t options)
+{
+    rt_uint32_t ts_now = reg->CFDGTSC;
+    rt_uint64_t now = perf_now();
+
+    if (can_ts_scale_q16 == 0) return now;
+    if (now - can_fifo_empty_at[fifo] >= can_ts_scale_q16) can_fifo_stats[fifo].ts_wrap++;
+
+    rt_uint32_t age = (ts_now - (options >> CANFD_FRAME_OPTION_TIMESTAMP_Pos)) & 0xFFFF;
+    return now - (((rt_uint64_t)age * can_ts_scale_q16) >> 16);
+}
+
+rt_inline rt_uint8_t can_frame_flags(const can_frame_t *src)
+{
+    rt_uint8_t flags = 0;
+
+    if (src->id_mode == CAN_ID_MODE_EXTENDED) flags |= CAN_FRAME_FLAG_EXT;
+    if (src->type == CAN_FRAME_TYPE_REMOTE) flags |= CAN_FRAME_FLAG_RTR;
+    if (src->options & CANFD_FRAME_OPTION_FD) flags |= CAN_FRAME_FLAG_FD;
+    if (src->options & CANFD_FRAME_OPTION_BRS) flags |= CAN_FRAME_FLAG_BRS;
+    if (src->options & CANFD_FRAME_OPTION_ERROR) flags |= CAN_FRAME_FLAG_ESI;
+    return flags;
+}
+
+/* 中断上下文：写入一帧，队列由空变非空时才唤醒消费线程 */
+static void can_ring_push(const can_callback_args_t *p_args, R_CANFD_Type *reg)
+{
+    rt_uint32_t fifo = (p_args->buffer - CANFD_RX_BUFFER_FIFO_0) & (CAN_RING_FIFO_NUM - 1);
+    CanRing *ring = &can_rings[can_fifo_class[fifo]];
+    rt_uint32_t head = ring->head;
+    rt_uint32_t used = head - ring->tail;
+    rt_bool_t full = (used >= CAN_RING_SIZE);
+
+    can_fifo_stats[fifo].received++;
+    can_health_rx((rt_uint8_t)p_args->channel, p_args->frame.id, can_frame_flags(&p_args->frame),
+                  p_args->frame.data_length_code);
+
+    /* 队列满且未抓包时直接丢弃，不必转换帧 */
+    if (full && !can_capture_active()) {
+        ring->stats.overflow++;
+        can_fifo_stats[fifo].ring_drop++;
+        return;
+    }
+
+    CanFrame *f = full ? &can_drop_frame : &ring->frames[head & CAN_RING_MASK];
+    const can_frame_t *src = &p_args->frame;
+
+    f->id = src->id;
+    f->flags = can_frame_flags(src);
+    /* r_canfd_mb_read 已将 DLC 转换为字节数 (0-64) */
+    f->len = (src->data_length_code > CAN_FRAME_MAX_LEN) ? CAN_FRAME_MAX_LEN : src->data_length_code;
+    f->channel = (rt_uint8_t)p_args->channel;
+    f->fifo = (rt_uint8_t)fifo;
+    f->timestamp = can_rx_timestamp(reg, fifo, src->options);
+    memcpy(f->data, src->data, f->len);
+
+    can_capture_frame(f);
+
+    if (full) {
+        ring->stats.overflow++;
+        can_fifo_stats[fifo].ring_drop++;
+        return;
+    }
+
+    /* 帧内容写完后再发布 head */
+    __DMB();
+    ring->head = head + 1;
+
+    ring->stats.received++;
+    if (used + 1 > ring->stats.high_water) ring->stats.high_water = used + 1;
+
+    if (used == 0) {
+        ring->stats.wakeups++;
+        rt_sem_release(&can_ring_sem);
+    }
+}
+
+/* FIFO 已读空时记下时刻，之后到达的帧停留时长不会超过距此的时间 */
+rt_inline void can_fifo_mark_empty(R_CANFD_Type *reg, rt_uint32_t fifo)
+{
+    if (reg->CFDFESTS & (1U << fifo)) can_fifo_empty_at[fifo] = perf_now();
+}
+
+static void can_ring_isr_callback(can_callback_args_t *p_args)
+{
+    if (p_args->channel >= BSP_FEATURE_CANFD_NUM_CHANNELS) return;
+
+    CanRingHook *hook = &can_hooks[p_args->channel];
+
+    /* 控制块与原回调在 can_ring_attach 中一同写入，为空说明该通道未经接管，无从处理 */
+    if (hook->ctrl == RT_NULL) return;
+
+    if (p_args->event == CAN_EVENT_RX_COMPLETE) {
+        R_CANFD_Type *reg = hook->ctrl->p_reg;
+        if (p_args->buffer >= CANFD_RX_BUFFER_FIFO_0) {
+            can_fifo_check_lost(reg, p_args->buffer - CANFD_RX_BUFFER_FIFO_0);
+        }
+        can_ring_push(p_args, reg);
+        if (p_args->buffer >= CANFD_RX_BUFFER_FIFO_0) {
+            can_fifo_mark_empty(reg, (p_args->buffer - CANFD_RX_BUFFER_FIFO_0) & (CAN_RING_FIFO_NUM - 1));
+        }
+        return;
+    }
+
+    /* 通道错误计入健康监测后仍交给设备驱动 */
+    if (p_args->event == CAN_EVENT_ERR_CHANNEL) {
+        can_health_error_isr((rt_uint8_t)p_args->channel, p_args->error);
+    }
+
+    /* 发送服务的邮箱在中断中直接补装，其余邮箱仍交给设备驱动 */
+    if ((p_args->event == CAN_EVENT_TX_COMPLETE || p_args->event == CAN_EVENT_TX_ABORTED) &&
+        can_tx_isr((rt_uint8_t)p_args->channel, p_args->buffer, p_args->event == CAN_EVENT_TX_ABORTED)) {
+        return;
+    }
+
+    if (hook->callback) {
+        p_args->p_context = hook->context;
+        hook->callback(p_args);
+    }
+}
+
+int can_ring_attach(rt_device_t dev)
+{
+    canfd_instance_ctrl_t *ctrl;
+    rt_uint32_t channel;
+
+    if (dev == RT_NULL) return -RT_ERROR;
+
+    if (rt_strcmp(dev->parent.name, "canfd0") == 0) {
+        ctrl = &g_canfd0_ctrl;
+    } else if (rt_strcmp(dev->parent.name, "canfd1") == 0) {
+        ctrl = &g_canfd1_ctrl;
+    } else {
+        return -RT_ERROR;
+    }
+
+    if (!can_ring_inited) {
+        rt_sem_init(&can_ring_sem, "can_ring", 0, RT_IPC_FLAG_FIFO);
+        can_ring_inited = RT_TRUE;
+    }
+
+    channel = ctrl->p_cfg->channel;
+    if (channel >= BSP_FEATURE_CANFD_NUM_CHANNELS) return -RT_ERROR;
+
+    /* 全局时间戳计数器两个通道共用，标定一次即可 */
+    if (can_ts_scale_q16 == 0) {
+        can_ts_calibrate(ctrl->p_reg);
+        for (int i = 0; i < CAN_RING_FIFO_NUM; i++) can_fifo_empty_at[i] = perf_now();
+    }
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    can_hooks[channel].ctrl = ctrl;
+    can_hooks[channel].callback = ctrl->p_callback;
+    can_hooks[channel].context = ctrl->p_context;
+    fsp_err_t err = R_CANFD_CallbackSet(ctrl, can_ring_isr_callback, RT_NULL, RT_NULL);
+    rt_hw_interrupt_enable(level);
+
+    return (err == FSP_SUCCESS) ? RT_EOK : -RT_ERROR;
+}
+
+canfd_instance_ctrl_t *can_ring_get_ctrl(rt_uint8_t channel)
+{
+    return (channel < BSP_FEATURE_CANFD_NUM_CHANNELS) ? can_hooks[channel].ctrl : RT_NULL;
+}
+
+rt_uint32_t can_ring_ts_scale(void)
+{
+    return can_ts_scale_q16;
+}
+
+void can_ring_set_fifo_class(rt_uint8_t fifo, CanClass cls)
+{
+    if (fifo < CAN_RING_FIFO_NUM && cls < CAN_CLASS_NUM) can_fifo_class[fifo] = (rt_uint8_t)cls;
+}
+
+void can_ring_poll(void)
+{
+    canfd_instance_ctrl_t *ctrl = RT_NULL;
+    can_callback_args_t args;
+
+    for (int i = 0; i < BSP_FEATURE_CANFD_NUM_CHANNELS && ctrl == RT_NULL; i++) ctrl = can_hooks[i].ctrl;
+    if (ctrl == RT_NULL) return;
+
+    R_CANFD_Type *reg = ctrl->p_reg;
+    args.event = CAN_EVENT_RX_COMPLETE;
+
+    for (rt_uint32_t fifo = 0; fifo < CAN_RING_FIFO_NUM; fifo++) {
+        /* 只处理按水位中断的 FIFO，逐帧中断的 FIFO 不会积压 */
+        rt_uint32_t rfcc = reg->CFDRFCC[fifo];
+        if (!(rfcc & R_CANFD_CFDRFCC_RFE_Msk) || (rfcc & R_CANFD_CFDRFCC_RFIM_Msk)) continue;
+
+        /* 与接收中断互斥访问 FIFO 读指针 */
+        rt_base_t level = rt_hw_interrupt_disable();
+        while (!(reg->CFDFESTS & (1U << fifo))) {
+            args.channel = reg->CFDRF[fifo].FDSTS_b.RFIFL;
+            args.buffer = CANFD_RX_BUFFER_FIFO_0 + fifo;
+            if (R_CANFD_Read(ctrl, args.buffer, &args.frame) != FSP_SUCCESS) break;
+            can_ring_push(&args, reg);
+        }
+        can_fifo_mark_empty(reg, fifo);
+        can_fifo_check_lost(reg, fifo);
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+rt_err_t can_ring_wait(rt_int32_t timeout)
+{
+    for (int c = 0; c < CAN_CLASS_NUM; c++) {
+        if (can_rings[c].head != can_rings[c].tail) return RT_EOK;
+    }
+    return rt_sem_take(&can_ring_sem, timeout);
+}
+
+int can_ring_inject(const CanFrame *frame)
+{
+    CanRing *ring = &can_rings[CAN_CLASS_HIGH];
+
+    if (!can_ring_inited) return -RT_ERROR;
+
+    /* 关中断与接收中断互斥，保持队列单生产者的写入顺序 */
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t head = ring->head;
+    rt_uint32_t used = head - ring->tail;
+
+    if (used >= CAN_RING_SIZE) {
+        ring->stats.overflow++;
+        rt_hw_interrupt_enable(level);
+        return -RT_EFULL;
+    }
+
+    CanFrame *f = &ring->frames[head & CAN_RING_MASK];
+    memcpy(f, frame, CAN_FRAME_HDR_SIZE + frame->len);
+    f->fifo = CAN_FIFO_VIRTUAL;
+    if (f->timestamp == 0) f->timestamp = perf_now();
+    can_capture_frame(f);
+
+    __DMB();
+    ring->head = head + 1;
+    ring->stats.received++;
+    if (used + 1 > ring->stats.high_water) ring->stats.high_water = used + 1;
+    rt_hw_interrupt_enable(level);
+
+    if (used == 0) {
+        ring->stats.wakeups++;
+        rt_sem_release(&can_ring_sem);
+    }
+    return RT_EOK;
+}
+
+static rt_size_t can_ring_pop_one(CanRing *ring, CanFrame *frames, rt_size_t max)
+{
+    rt_uint32_t tail = ring->tail;
+    rt_uint32_t avail = ring->head - tail;
+    rt_size_t n = (avail < max) ? avail : max;
+
+    /* 先读 head 再读帧内容 */
+    __DMB();
+    for (rt_size_t i = 0; i < n; i++) {
+        /* 只复制帧头和有效数据，经典 CAN 帧无需搬运 64 字节 */
+        const CanFrame *f = &ring->frames[(tail + i) & CAN_RING_MASK];
+        memcpy(&frames[i], f, CAN_FRAME_HDR_SIZE + f->len);
+    }
+    __DMB();
+    ring->tail = tail + n;
+
+    return n;
+}
+
+rt_size_t can_ring_pop(CanFrame *frames, rt_size_t max)
+{
+    rt_size_t n = 0;
+
+    /* 按优先级取帧，高优先级队列取空后才取批量帧 */
+    for (int c = 0; c < CAN_CLASS_NUM && n < max; c++) {
+        n += can_ring_pop_one(&can_rings[c], frames + n, max - n);
+    }
+    return n;
+}
+
+void can_ring_get_stats(CanClass cls, CanRingStats *stats)
+{
+    if (cls < CAN_CLASS_NUM) *stats = can_rings[cls].stats;
+}
+
+void can_ring_get_fifo_stats(rt_uint8_t fifo, CanFifoStats *stats)
+{
+    if (fifo < CAN_RING_FIFO_NUM) *stats = can_fifo_stats[fifo];
+}
+
+static int can_ring_stat(int argc, char **argv)
+{
+    static const char *class_name[CAN_CLASS_NUM] = { "high", "bulk" };
+    CanRingStats st;
+    CanFifoStats fs;
+
+    (void)argc;
+    (void)argv;
+
+    rt_kprintf("CAN ring: size %d\n", CAN_RING_SIZE);
+    if (can_ts_scale_q16) {
+        /* 时间戳分辨率 (ns) 与回绕周期 (ms) */
+        rt_uint64_t ns = perf_to_us64((rt_uint64_t)can_ts_scale_q16 * 1000) >> 16;
+        rt_kprintf("HW timestamp: %u ns/count, wraps every %u ms\n", (rt_uint32_t)ns,
+                   (rt_uint32_t)(ns * 65536 / 1000000));
+    } else {
+        rt_kprintf("HW timestamp: not calibrated\n");
+    }
+    rt_kprintf("class  used  received  overflow  high_water  wakeups\n");
+    for (int c = 0; c < CAN_CLASS_NUM; c++) {
+        can_ring_get_stats((CanClass)c, &st);
+        rt_kprintf("%-5s  %4u  %8u  %8u  %10u  %7u\n", class_name[c],
+                   can_rings[c].head - can_rings[c].tail, st.received, st.overflow, st.high_water, st.wakeups);
+    }
+
+    rt_kprintf("fifo  class  received  ring_drop  hw_lost  ts_wrap\n");
+    for (int i = 0; i < CAN_RING_FIFO_NUM; i++) {
+        can_ring_get_fifo_stats((rt_uint8_t)i, &fs);
+        if (fs.received == 0 && fs.hw_lost == 0) continue;
+        rt_kprintf("%4d  %-5s  %8u  %9u  %7u  %7u\n", i, class_name[can_fifo_class[i]],
+                   fs.received, fs.ring_drop, fs.hw_lost, fs.ts_wrap);
+    }
+    return 0;
+}
+MSH_CMD_EXPORT(can_ring_stat, Show CAN receive ring statistics);
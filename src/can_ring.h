@@ -0,0 +1,91 @@
+#ifndef __CAN_RING_H__
+#define __CAN_RING_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+/*
+ * CAN 接收环形队列：FSP 接收中断直接写入，应用线程批量取出。
+ * 单生产者 (CANFD RX FIFO 中断) / 单消费者 (CAN 处理线程)，无锁。
+ * 按 RX FIFO 划分优先级：高优先级队列总是先于批量队列取出，过载时只丢弃批量帧。
+ */
+#define CAN_RING_SIZE           256     /* 必须为 2 的幂 */
+#define CAN_RING_FIFO_NUM       8       /* RX FIFO 0-7 */
+
+/* RX FIFO 分配 (与 r_canfd_cfg.h 一致)：每个通道一个逐帧中断的高优先级 FIFO 和一个按水位中断的批量 FIFO */
+#define CAN_FIFO_CH0_HIGH       0
+#define CAN_FIFO_CH0_BULK       1
+#define CAN_FIFO_CH1_HIGH       2
+#define CAN_FIFO_CH1_BULK       3
+#define CAN_FIFO_VIRTUAL        0xFF    /* CanFrame.fifo：软件注入的帧 (UDP 虚拟总线)，不来自硬件 */
+
+typedef enum {
+    CAN_CLASS_HIGH = 0,
+    CAN_CLASS_BULK,
+    CAN_CLASS_NUM
+} CanClass;
+
+/* CanFrame.flags */
+#define CAN_FRAME_FLAG_EXT      0x01    /* 扩展帧 (29 位 ID) */
+#define CAN_FRAME_FLAG_RTR      0x02    /* 远程帧 */
+#define CAN_FRAME_FLAG_FD       0x04    /* CAN-FD 帧 (FDF) */
+#define CAN_FRAME_FLAG_BRS      0x08    /* 数据段波特率切换 */
+#define CAN_FRAME_FLAG_ESI      0x10    /* 发送节点处于错误被动状态 */
+
+#define CAN_FRAME_MAX_LEN       64
+
+typedef struct {
+    rt_uint32_t id;
+    rt_uint8_t  len;
+    rt_uint8_t  flags;
+    rt_uint8_t  channel;    /* CANFD 通道号 */
+    rt_uint8_t  fifo;       /* 接收 FIFO 编号 */
+    rt_uint64_t timestamp;  /* 硬件接收时间戳，换算到 CNTPCT 计数 (perf_to_us64 转微秒)；
+                             * 硬件只有 16 位，帧在 FIFO 中停留须短于一个回绕周期 (见 can_ring_stat、CanFifoStats.ts_wrap) */
+    rt_uint8_t  data[CAN_FRAME_MAX_LEN];
+} CanFrame;
+
+typedef struct {
+    rt_uint32_t received;   /* 写入队列的帧数 */
+    rt_uint32_t overflow;   /* 队列满被丢弃的帧数 */
+    rt_uint32_t high_water; /* 队列最高占用 */
+    rt_uint32_t wakeups;    /* 唤醒消费线程次数 */
+} CanRingStats;
+
+typedef struct {
+    rt_uint32_t received;   /* 从该 FIFO 读出的帧数 */
+    rt_uint32_t ring_drop;  /* 软件队列满被丢弃的帧数 */
+    rt_uint32_t hw_lost;    /* 硬件 FIFO 溢出 (RFMLT) 次数 */
+    rt_uint32_t ts_wrap;    /* 读出时距 FIFO 上次读空已超过一个时间戳回绕周期的帧数，其时间戳可能晚整数个周期 */
+} CanFifoStats;
+
+struct st_canfd_instance_ctrl;
+
+/* 接管设备 (已 open) 的 FSP 回调，接收帧进入环形队列，其余事件仍交给原驱动处理 */
+int can_ring_attach(rt_device_t dev);
+
+/* 指定 RX FIFO 的优先级类别，默认 CAN_FIFO_CHn_HIGH 为高优先级，其余为批量 */
+void can_ring_set_fifo_class(rt_uint8_t fifo, CanClass cls);
+
+/* 读出按水位中断的 FIFO 中未达水位的帧，由消费线程在空闲超时时调用 */
+void can_ring_poll(void);
+
+/* 等待新帧，超时返回 -RT_ETIMEOUT */
+rt_err_t can_ring_wait(rt_int32_t timeout);
+
+/* 已接管通道的 FSP 控制块，未接管返回 RT_NULL */
+struct st_canfd_instance_ctrl *can_ring_get_ctrl(rt_uint8_t channel);
+
+/* CANFD 时间戳计数器一个计数对应的 CNTPCT 计数 (Q16)，0 表示未标定 */
+rt_uint32_t can_ring_ts_scale(void);
+
+/* 线程上下文注入一帧，如同从总线接收 (进入高优先级队列)；队列满返回 -RT_EFULL */
+int can_ring_inject(const CanFrame *frame);
+
+/* 批量取出最多 max 帧，先取高优先级队列，返回实际帧数 */
+rt_size_t can_ring_pop(CanFrame *frames, rt_size_t max);
+
+void can_ring_get_stats(CanClass cls, CanRingStats *stats);
+void can_ring_get_fifo_stats(rt_uint8_t fifo, CanFifoStats *stats);
+
+#endif
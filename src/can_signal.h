@@ -0,0 +1,57 @@
+#ifndef __CAN_SIGNAL_H__
+#define __CAN_SIGNAL_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * 表驱动 CAN 信号解码 (DBC 语义)：
+ * 报文/信号定义在加载时编译为紧凑的查找表，解码时按 ID 哈希查表，
+ * 字节对齐的 8/16/32 位信号走专用路径，其余按 64 位窗口移位取值。
+ */
+#define CAN_SIGNAL_MAX_MSGS     64
+#define CAN_SIGNAL_MAX_SIGNALS  256
+#define CAN_SIGNAL_HASH_SIZE    128     /* 必须为 2 的幂且不小于报文数的 2 倍 */
+
+/* 字节序：Intel (小端, start_bit 为 LSB) / Motorola (大端, start_bit 为 MSB) */
+typedef enum {
+    CAN_SIG_INTEL = 0,
+    CAN_SIG_MOTOROLA = 1,
+} CanSignalOrder;
+
+typedef struct {
+    const char *name;       /* 同时作为物模型属性标识符 */
+    rt_uint16_t start_bit;  /* DBC 编号 (0-511) */
+    rt_uint8_t  length;     /* 1-57 位 */
+    rt_uint8_t  order;      /* CanSignalOrder */
+    rt_uint8_t  is_signed;
+    float       scale;
+    float       offset;
+} CanSignalDef;
+
+typedef struct {
+    rt_uint32_t id;
+    rt_uint8_t  ext;
+    const char *name;
+    const CanSignalDef *signals;
+    rt_uint8_t  signal_num;
+} CanMessageDef;
+
+typedef struct {
+    rt_uint16_t sig;        /* 信号表下标，名称见 can_signal_name() */
+    float       value;      /* 物理值 = raw * scale + offset */
+} CanSignalValue;
+
+/* 内置信号库 (can_signal_db.c) */
+extern const CanMessageDef can_signal_db[];
+extern const rt_size_t can_signal_db_num;
+
+/* API */
+int can_signal_load(const CanMessageDef *msgs, rt_size_t count);
+
+/* 解码一帧，返回信号个数；未定义的 ID 或帧长不足时返回 0 */
+int can_signal_decode(const CanFrame *frame, CanSignalValue *out, rt_size_t max);
+
+const char *can_signal_name(rt_uint16_t sig);
+
+#endif
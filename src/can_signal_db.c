@@ -0,0 +1,80 @@
+#include <rtthread.h>
+#include "can_signal.h"
+
+/*
+ * 内置信号库：J1939 动力总成常用 PGN + 电池管理 / 电机控制器私有报文。
+ * 信号名与 thing_model.json 中的属性标识符一致。
+ */
+
+/* J1939 EEC1 (PGN 61444) */
+static const CanSignalDef sig_eec1[] = {
+    { "eng_torque_mode",      0,  4, CAN_SIG_INTEL, 0, 1.0f,      0.0f    },
+    { "driver_demand_torque", 8,  8, CAN_SIG_INTEL, 0, 1.0f,      -125.0f },
+    { "actual_eng_torque",    16, 8, CAN_SIG_INTEL, 0, 1.0f,      -125.0f },
+    { "eng_speed",            24, 16, CAN_SIG_INTEL, 0, 0.125f,   0.0f    },
+};
+
+/* J1939 CCVS1 (PGN 65265) */
+static const CanSignalDef sig_ccvs1[] = {
+    { "vehicle_speed",        8,  16, CAN_SIG_INTEL, 0, 1.0f / 256, 0.0f },
+    { "cruise_active",        24, 2,  CAN_SIG_INTEL, 0, 1.0f,       0.0f },
+    { "brake_switch",         28, 2,  CAN_SIG_INTEL, 0, 1.0f,       0.0f },
+};
+
+/* J1939 ET1 (PGN 65262) */
+static const CanSignalDef sig_et1[] = {
+    { "coolant_temp",         0,  8,  CAN_SIG_INTEL, 0, 1.0f,     -40.0f  },
+    { "fuel_temp",            8,  8,  CAN_SIG_INTEL, 0, 1.0f,     -40.0f  },
+    { "eng_oil_temp",         16, 16, CAN_SIG_INTEL, 0, 0.03125f, -273.0f },
+};
+
+/* J1939 VEP1 (PGN 65271) */
+static const CanSignalDef sig_vep1[] = {
+    { "battery_potential",    32, 16, CAN_SIG_INTEL, 0, 0.05f, 0.0f },
+};
+
+/* J1939 LFE1 (PGN 65266) */
+static const CanSignalDef sig_lfe1[] = {
+    { "fuel_rate",            0,  16, CAN_SIG_INTEL, 0, 0.05f,       0.0f },
+    { "inst_fuel_economy",    16, 16, CAN_SIG_INTEL, 0, 1.0f / 512,  0.0f },
+};
+
+/* BMS 状态 (Motorola) */
+static const CanSignalDef sig_bms_status[] = {
+    { "pack_voltage",         7,  16, CAN_SIG_MOTOROLA, 0, 0.1f, 0.0f },
+    { "pack_current",         23, 16, CAN_SIG_MOTOROLA, 1, 0.1f, 0.0f },
+    { "pack_soc",             39, 8,  CAN_SIG_MOTOROLA, 0, 0.5f, 0.0f },
+    { "bms_state",            43, 4,  CAN_SIG_MOTOROLA, 0, 1.0f, 0.0f },
+};
+
+/* BMS 单体极值 (Motorola，13 位电压跨字节) */
+static const CanSignalDef sig_bms_cell[] = {
+    { "cell_v_max",           7,  13, CAN_SIG_MOTOROLA, 0, 0.001f, 0.0f },
+    { "cell_v_min",           23, 13, CAN_SIG_MOTOROLA, 0, 0.001f, 0.0f },
+    { "cell_t_max",           39, 8,  CAN_SIG_MOTOROLA, 1, 1.0f,   0.0f },
+    { "cell_t_min",           47, 8,  CAN_SIG_MOTOROLA, 1, 1.0f,   0.0f },
+};
+
+/* 电机控制器 (CAN-FD 64 字节) */
+static const CanSignalDef sig_inverter[] = {
+    { "motor_speed",          0,   16, CAN_SIG_INTEL, 1, 1.0f,  0.0f   },
+    { "motor_torque",         16,  16, CAN_SIG_INTEL, 1, 0.1f,  0.0f   },
+    { "dc_bus_voltage",       32,  12, CAN_SIG_INTEL, 0, 0.25f, 0.0f   },
+    { "inverter_temp",        44,  8,  CAN_SIG_INTEL, 0, 1.0f,  -40.0f },
+    { "phase_current_rms",    480, 16, CAN_SIG_INTEL, 0, 0.1f,  0.0f   },
+};
+
+#define SIGNALS(s)  s, sizeof(s) / sizeof(s[0])
+
+const CanMessageDef can_signal_db[] = {
+    { 0x0CF00400, 1, "EEC1",       SIGNALS(sig_eec1)       },
+    { 0x18FEF100, 1, "CCVS1",      SIGNALS(sig_ccvs1)      },
+    { 0x18FEEE00, 1, "ET1",        SIGNALS(sig_et1)        },
+    { 0x18FEF700, 1, "VEP1",       SIGNALS(sig_vep1)       },
+    { 0x18FEF200, 1, "LFE1",       SIGNALS(sig_lfe1)       },
+    { 0x3C0,      0, "BMS_Status", SIGNALS(sig_bms_status) },
+    { 0x3C1,      0, "BMS_Cell",   SIGNALS(sig_bms_cell)   },
+    { 0x120,      0, "Inverter",   SIGNALS(sig_inverter)   },
+};
+
+const rt_size_t can_signal_db_num = sizeof(can_signal_db) / sizeof(can_signal_db[0]);
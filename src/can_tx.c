@@ -0,0 +1,411 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "hal_data.h"
+#include "can_tx.h"
+#include "perf_counter.h"
+#include "can_health.h"
+
+#define CAN_TX_CHANNELS         BSP_FEATURE_CANFD_NUM_CHANNELS
+#define CAN_TX_MB_MASK          ((1U << CAN_TX_MB_NUM) - 1)
+#define CAN_TX_KEY_EXT          0x80000000UL
+#define CAN_TX_LAT_BASE_US      100
+#define CAN_TX_BENCH_WAIT_MS    5000
+
+typedef struct {
+    can_frame_t frame;
+    rt_uint8_t  prio;
+    rt_uint32_t seq;
+    rt_uint64_t queued_at;      /* perf_now */
+} CanTxItem;
+
+/* 以下全部在关中断时访问：线程入队，发送完成中断出队 */
+typedef struct {
+    CanTxItem   items[CAN_TX_QUEUE_SIZE];
+    rt_uint8_t  heap[CAN_TX_QUEUE_SIZE];    /* items 下标，按 (prio, seq) 排成最小堆 */
+    rt_uint8_t  free_idx[CAN_TX_QUEUE_SIZE];
+    rt_uint8_t  num;
+    rt_uint8_t  free_num;
+    rt_uint32_t seq;
+    rt_uint32_t mb_busy;                    /* 已装帧的邮箱位图 */
+    rt_uint32_t mb_key[CAN_TX_MB_NUM];      /* 邮箱中帧的 ID | 扩展帧标志 */
+    rt_uint64_t mb_time[CAN_TX_MB_NUM];     /* 邮箱中帧的入队时间 */
+    rt_uint8_t  mb_flags[CAN_TX_MB_NUM];    /* 邮箱中帧的 CanFrame flags 和长度，用于总线负载统计 */
+    rt_uint8_t  mb_len[CAN_TX_MB_NUM];
+    CanTxStats  stats;
+} CanTxQueue;
+
+static CanTxQueue tx_queues[CAN_TX_CHANNELS];
+static rt_bool_t tx_inited = RT_FALSE;
+static CanTxRedirect tx_redirect = RT_NULL;
+
+static const rt_uint8_t fd_lengths[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+static void can_tx_init(void)
+{
+    if (tx_inited) return;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    for (int ch = 0; ch < CAN_TX_CHANNELS; ch++) {
+        CanTxQueue *q = &tx_queues[ch];
+        for (int i = 0; i < CAN_TX_QUEUE_SIZE; i++) q->free_idx[i] = (rt_uint8_t)i;
+        q->free_num = CAN_TX_QUEUE_SIZE;
+        q->stats.lat_min_us = 0xFFFFFFFF;
+    }
+    tx_inited = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+}
+
+rt_inline rt_bool_t item_before(const CanTxQueue *q, rt_uint8_t a, rt_uint8_t b)
+{
+    const CanTxItem *x = &q->items[a], *y = &q->items[b];
+    if (x->prio != y->prio) return x->prio < y->prio;
+    return (rt_int32_t)(x->seq - y->seq) < 0;
+}
+
+static void heap_push(CanTxQueue *q, rt_uint8_t idx)
+{
+    rt_uint32_t i = q->num++;
+
+    while (i > 0) {
+        rt_uint32_t parent = (i - 1) / 2;
+        if (!item_before(q, idx, q->heap[parent])) break;
+        q->heap[i] = q->heap[parent];
+        i = parent;
+    }
+    q->heap[i] = idx;
+}
+
+static void heap_pop(CanTxQueue *q)
+{
+    rt_uint8_t last = q->heap[--q->num];
+    rt_uint32_t i = 0;
+
+    for (;;) {
+        rt_uint32_t child = 2 * i + 1;
+        if (child >= q->num) break;
+        if (child + 1 < q->num && item_before(q, q->heap[child + 1], q->heap[child])) child++;
+        if (!item_before(q, q->heap[child], last)) break;
+        q->heap[i] = q->heap[child];
+        i = child;
+    }
+    q->heap[i] = last;
+}
+
+rt_inline rt_uint32_t frame_key(const can_frame_t *f)
+{
+    return f->id | ((f->id_mode == CAN_ID_MODE_EXTENDED) ? CAN_TX_KEY_EXT : 0);
+}
+
+/* 关中断调用：把队首帧装入空闲邮箱，直到邮箱装满、队列为空或队首 ID 仍在发送中 */
+static void tx_refill(rt_uint8_t channel)
+{
+    CanTxQueue *q = &tx_queues[channel];
+    canfd_instance_ctrl_t *ctrl = can_ring_get_ctrl(channel);
+
+    if (ctrl == RT_NULL) return;
+
+    while (q->num > 0 && q->mb_busy != CAN_TX_MB_MASK) {
+        rt_uint8_t idx = q->heap[0];
+        CanTxItem *it = &q->items[idx];
+        rt_uint32_t key = frame_key(&it->frame);
+        rt_uint32_t busy = q->mb_busy;
+        rt_uint32_t mb = 0;
+
+        /* 多邮箱同 ID 时按邮箱编号仲裁，可能打乱顺序，因此等待前一帧发完 */
+        for (rt_uint32_t m = 0; m < CAN_TX_MB_NUM; m++) {
+            if ((busy & (1U << m)) && q->mb_key[m] == key) return;
+        }
+        while (busy & (1U << mb)) mb++;
+
+        fsp_err_t err = R_CANFD_Write(ctrl, CAN_TX_MB_FIRST + mb, &it->frame);
+        if (err == FSP_ERR_CAN_TRANSMIT_NOT_READY) return;
+
+        heap_pop(q);
+        q->free_idx[q->free_num++] = idx;
+
+        if (err != FSP_SUCCESS) {
+            q->stats.errors++;
+            continue;
+        }
+        q->mb_busy |= 1U << mb;
+        q->mb_key[mb] = key;
+        q->mb_time[mb] = it->queued_at;
+        q->mb_len[mb] = it->frame.data_length_code;
+        q->mb_flags[mb] = (key & CAN_TX_KEY_EXT) ? CAN_FRAME_FLAG_EXT : 0;
+        if (it->frame.options & CANFD_FRAME_OPTION_FD) q->mb_flags[mb] |= CAN_FRAME_FLAG_FD;
+        if (it->frame.options & CANFD_FRAME_OPTION_BRS) q->mb_flags[mb] |= CAN_FRAME_FLAG_BRS;
+        if (it->frame.type == CAN_FRAME_TYPE_REMOTE) q->mb_flags[mb] |= CAN_FRAME_FLAG_RTR;
+    }
+}
+
+static void tx_latency(CanTxStats *st, rt_uint32_t us)
+{
+    int b = 0;
+
+    if (us < st->lat_min_us) st->lat_min_us = us;
+    if (us > st->lat_max_us) st->lat_max_us = us;
+    st->lat_sum_us += us;
+
+    for (rt_uint32_t limit = CAN_TX_LAT_BASE_US; b < CAN_TX_LAT_BUCKETS - 1 && us >= limit; limit <<= 1) b++;
+    st->lat_hist[b]++;
+}
+
+rt_bool_t can_tx_isr(rt_uint8_t channel, rt_uint32_t buffer, rt_bool_t aborted)
+{
+    rt_uint32_t mb = buffer - CAN_TX_MB_FIRST;
+
+    if (!tx_inited || channel >= CAN_TX_CHANNELS || mb >= CAN_TX_MB_NUM) return RT_FALSE;
+
+    CanTxQueue *q = &tx_queues[channel];
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    if (q->mb_busy & (1U << mb)) {
+        if (aborted) {
+            q->stats.aborted++;
+        } else {
+            q->stats.sent++;
+            tx_latency(&q->stats, perf_to_us(perf_now() - q->mb_time[mb]));
+            can_health_tx(channel, q->mb_flags[mb], q->mb_len[mb]);
+        }
+        q->mb_busy &= ~(1U << mb);
+    }
+    tx_refill(channel);
+
+    rt_hw_interrupt_enable(level);
+    return RT_TRUE;
+}
+
+void can_tx_reset(rt_uint8_t channel)
+{
+    if (!tx_inited || channel >= CAN_TX_CHANNELS) return;
+
+    CanTxQueue *q = &tx_queues[channel];
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    for (rt_uint32_t busy = q->mb_busy; busy; busy &= busy - 1) q->stats.aborted++;
+    q->mb_busy = 0;
+    tx_refill(channel);
+
+    rt_hw_interrupt_enable(level);
+}
+
+int can_tx_send(rt_uint8_t channel, const CanFrame *frame, rt_uint8_t prio)
+{
+    if (channel >= CAN_TX_CHANNELS) return -RT_EINVAL;
+    if (frame->len > ((frame->flags & CAN_FRAME_FLAG_FD) ? CAN_FRAME_MAX_LEN : 8)) return -RT_EINVAL;
+    if (tx_redirect) return tx_redirect(channel, frame);
+    if (can_ring_get_ctrl(channel) == RT_NULL) return -RT_EINVAL;
+
+    can_tx_init();
+
+    CanTxQueue *q = &tx_queues[channel];
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    if (q->free_num == 0) {
+        q->stats.dropped++;
+        rt_hw_interrupt_enable(level);
+        return -RT_EFULL;
+    }
+
+    rt_uint8_t idx = q->free_idx[--q->free_num];
+    CanTxItem *it = &q->items[idx];
+    can_frame_t *f = &it->frame;
+
+    f->id = frame->id;
+    f->id_mode = (frame->flags & CAN_FRAME_FLAG_EXT) ? CAN_ID_MODE_EXTENDED : CAN_ID_MODE_STANDARD;
+    f->type = (frame->flags & CAN_FRAME_FLAG_RTR) ? CAN_FRAME_TYPE_REMOTE : CAN_FRAME_TYPE_DATA;
+    f->options = 0;
+    f->data_length_code = frame->len;
+    memcpy(f->data, frame->data, frame->len);
+    if (frame->flags & CAN_FRAME_FLAG_FD) {
+        int k = 0;
+        while (fd_lengths[k] < frame->len) k++;
+        memset(f->data + frame->len, 0, fd_lengths[k] - frame->len);
+        f->data_length_code = fd_lengths[k];
+        f->options = CANFD_FRAME_OPTION_FD | ((frame->flags & CAN_FRAME_FLAG_BRS) ? CANFD_FRAME_OPTION_BRS : 0);
+    }
+    it->prio = prio;
+    it->seq = q->seq++;
+    it->queued_at = perf_now();
+
+    heap_push(q, idx);
+    q->stats.queued++;
+    if (q->num > q->stats.high_water) q->stats.high_water = q->num;
+
+    /* 有空闲邮箱时立即装入，否则等待发送完成中断补装 */
+    tx_refill(channel);
+
+    rt_hw_interrupt_enable(level);
+    return RT_EOK;
+}
+
+rt_size_t can_tx_pending(rt_uint8_t channel)
+{
+    if (channel >= CAN_TX_CHANNELS) return 0;
+
+    CanTxQueue *q = &tx_queues[channel];
+    rt_size_t n = q->num;
+    for (rt_uint32_t busy = q->mb_busy; busy; busy &= busy - 1) n++;
+    return n;
+}
+
+void can_tx_set_redirect(CanTxRedirect fn)
+{
+    tx_redirect = fn;
+}
+
+void can_tx_get_stats(rt_uint8_t channel, CanTxStats *stats)
+{
+    if (channel >= CAN_TX_CHANNELS) return;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    *stats = tx_queues[channel].stats;
+    rt_hw_interrupt_enable(level);
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int can_tx_parse(const char *text, rt_uint8_t *channel, CanFrame *frame)
+{
+    const char *p = text;
+    const char *end;
+
+    memset(frame, 0, offsetof(CanFrame, data));
+    *channel = 0;
+    /* 可选的 "<ch>:" 前缀：只认 '#' 之前、紧跟数字的冒号 */
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == ':' && p > text) {
+        unsigned long ch = strtoul(text, RT_NULL, 10);
+        if (p - text > 3 || ch > 0xFF) return -RT_EINVAL;
+        *channel = (rt_uint8_t)ch;
+        p++;
+    } else {
+        p = text;
+    }
+
+    for (end = p; hex_nibble(*end) >= 0; end++);
+    if (*end != '#' || end == p || end - p > 8) return -RT_EINVAL;
+    frame->id = strtoul(p, RT_NULL, 16);
+    /* 与 cansend 一致：超过 3 位十六进制的 ID 为扩展帧 */
+    if (end - p > 3) frame->flags |= CAN_FRAME_FLAG_EXT;
+    if (frame->id > ((frame->flags & CAN_FRAME_FLAG_EXT) ? 0x1FFFFFFFUL : 0x7FFUL)) return -RT_EINVAL;
+    p = end + 1;
+
+    if (*p == 'R' || *p == 'r') {
+        frame->flags |= CAN_FRAME_FLAG_RTR;
+        return (p[1] == '\0') ? RT_EOK : -RT_EINVAL;
+    }
+    if (*p == '#') {
+        int fd_flags = hex_nibble(p[1]);
+        if (fd_flags < 0) return -RT_EINVAL;
+        frame->flags |= CAN_FRAME_FLAG_FD | ((fd_flags & 1) ? CAN_FRAME_FLAG_BRS : 0);
+        p += 2;
+    }
+
+    rt_uint8_t max = (frame->flags & CAN_FRAME_FLAG_FD) ? CAN_FRAME_MAX_LEN : 8;
+    while (*p) {
+        if (*p == '.') {
+            p++;
+            continue;
+        }
+        int hi = hex_nibble(p[0]), lo = hex_nibble(p[1]);
+        if (hi < 0 || lo < 0 || frame->len >= max) return -RT_EINVAL;
+        frame->data[frame->len++] = (rt_uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    return RT_EOK;
+}
+
+static void can_tx_show(void)
+{
+    CanTxStats st;
+
+    rt_kprintf("ch  pending  queued    sent      dropped  aborted  errors  hwm  lat_min  lat_avg  lat_max (us)\n");
+    for (int ch = 0; ch < CAN_TX_CHANNELS; ch++) {
+        can_tx_get_stats((rt_uint8_t)ch, &st);
+        rt_kprintf("%2d  %7u  %8u  %8u  %7u  %7u  %6u  %3u  %7u  %7u  %7u\n", ch, can_tx_pending((rt_uint8_t)ch),
+                   st.queued, st.sent, st.dropped, st.aborted, st.errors, st.high_water,
+                   st.sent ? st.lat_min_us : 0, st.sent ? (rt_uint32_t)(st.lat_sum_us / st.sent) : 0, st.lat_max_us);
+        if (st.sent == 0) continue;
+
+        rt_kprintf("    latency:");
+        for (int b = 0; b < CAN_TX_LAT_BUCKETS; b++) {
+            rt_kprintf(" %s%u:%u", (b == CAN_TX_LAT_BUCKETS - 1) ? ">=" : "<",
+                       CAN_TX_LAT_BASE_US << ((b == CAN_TX_LAT_BUCKETS - 1) ? b - 1 : b), st.lat_hist[b]);
+        }
+        rt_kprintf("\n");
+    }
+}
+
+/* 持续发送 count 帧，统计吞吐率；位数按无填充位的帧长估算，供与总线波特率比较 */
+static void can_tx_bench(rt_uint8_t channel, rt_uint32_t count, const CanFrame *frame)
+{
+    CanTxStats before, after;
+    rt_uint32_t bits = ((frame->flags & CAN_FRAME_FLAG_EXT) ? 67 : 47) + 8 * frame->len;
+
+    can_tx_get_stats(channel, &before);
+    rt_uint64_t start = perf_now();
+
+    for (rt_uint32_t i = 0; i < count;) {
+        if (can_tx_send(channel, frame, CAN_TX_PRIO_LOW) == RT_EOK) {
+            i++;
+        } else {
+            rt_thread_mdelay(1);
+        }
+    }
+    for (int t = 0; t < CAN_TX_BENCH_WAIT_MS && can_tx_pending(channel) > 0; t++) rt_thread_mdelay(1);
+
+    rt_uint32_t us = perf_to_us(perf_now() - start);
+    can_tx_get_stats(channel, &after);
+
+    rt_uint32_t sent = after.sent - before.sent;
+    rt_uint32_t fps = us ? (rt_uint32_t)((rt_uint64_t)sent * 1000000 / us) : 0;
+    rt_kprintf("Sent %u / %u frames in %u ms: %u frames/s, ~%u kbit/s (%u bits/frame, no stuffing)\n",
+               sent, count, us / 1000, fps, fps * bits / 1000, bits);
+    if (frame->flags & CAN_FRAME_FLAG_FD) rt_kprintf("CAN-FD frame: bit estimate assumes nominal rate only\n");
+}
+
+/* msh: can_tx send <frame> [prio] | bench <ch> <count> [frame] | stat */
+static int can_tx(int argc, char **argv)
+{
+    CanFrame frame;
+    rt_uint8_t channel;
+
+    if (argc >= 3 && strcmp(argv[1], "send") == 0) {
+        if (can_tx_parse(argv[2], &channel, &frame) != RT_EOK) {
+            rt_kprintf("Bad frame: %s\n", argv[2]);
+            return -1;
+        }
+        int ret = can_tx_send(channel, &frame, (argc >= 4) ? (rt_uint8_t)atoi(argv[3]) : CAN_TX_PRIO_NORMAL);
+        if (ret != RT_EOK) rt_kprintf("Send failed (%d)\n", ret);
+        return ret;
+    } else if (argc >= 4 && strcmp(argv[1], "bench") == 0) {
+        rt_uint8_t unused;
+        channel = (rt_uint8_t)atoi(argv[2]);
+        if (can_tx_parse((argc >= 5) ? argv[4] : "7FF#0011223344556677", &unused, &frame) != RT_EOK) {
+            rt_kprintf("Bad frame\n");
+            return -1;
+        }
+        can_tx_bench(channel, strtoul(argv[3], RT_NULL, 0), &frame);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        can_tx_show();
+        return 0;
+    }
+
+    rt_kprintf("Usage: can_tx send [ch:]<id>#<data> [prio]   (cansend syntax, <id>##<flags><data> for CAN-FD)\n");
+    rt_kprintf("       can_tx bench <ch> <count> [frame]\n");
+    rt_kprintf("       can_tx stat\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_tx, Queue CAN frames for transmission and show TX statistics);
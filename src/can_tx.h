@@ -0,0 +1,62 @@
+#ifndef __CAN_TX_H__
+#define __CAN_TX_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * CAN 发送服务：云端命令、本地规则、UDP 桥接等来源的帧按优先级排队，
+ * 分散装入多个发送邮箱由硬件按 ID 仲裁；发送完成中断中直接补装下一帧，不经过线程。
+ * 同一 ID 的帧同一时刻只占用一个邮箱，保证同 ID 帧 (如 ISO-TP 连续帧) 按入队顺序发出。
+ */
+#define CAN_TX_QUEUE_SIZE       64      /* 每通道排队帧数，不超过 255 */
+#define CAN_TX_MB_FIRST         1       /* 邮箱 0 保留给 RT-Thread CAN 设备驱动 */
+#define CAN_TX_MB_NUM           7       /* 使用邮箱 1-7 (hal_data.c 中已开启发送完成中断) */
+
+/* 优先级：数值越小越先发送，同优先级按入队顺序 */
+#define CAN_TX_PRIO_HIGH        0
+#define CAN_TX_PRIO_NORMAL      128
+#define CAN_TX_PRIO_LOW         255
+
+#define CAN_TX_LAT_BUCKETS      8       /* 延迟直方图：<100us, <200us, <400us ... >=6.4ms */
+
+typedef struct {
+    rt_uint32_t queued;
+    rt_uint32_t sent;
+    rt_uint32_t dropped;        /* 队列满被拒绝 */
+    rt_uint32_t aborted;
+    rt_uint32_t errors;         /* 写邮箱失败 (帧格式非法) */
+    rt_uint32_t high_water;
+    rt_uint32_t lat_min_us;     /* 入队到发送完成 */
+    rt_uint32_t lat_max_us;
+    rt_uint64_t lat_sum_us;
+    rt_uint32_t lat_hist[CAN_TX_LAT_BUCKETS];
+} CanTxStats;
+
+/* 发送重定向：设置后帧不进入邮箱，直接交给回调 (如 UDP 虚拟总线) */
+typedef int (*CanTxRedirect)(rt_uint8_t channel, const CanFrame *frame);
+
+/* API */
+/* 入队一帧，CAN-FD 数据长度补齐到合法 DLC 长度；队列满返回 -RT_EFULL */
+int can_tx_send(rt_uint8_t channel, const CanFrame *frame, rt_uint8_t prio);
+
+/* cansend 格式文本的最大长度 (含结束符)："ch:" + 8 位 ID + "##f" + 64 字节数据及 '.' 分隔 */
+#define CAN_TX_TEXT_MAX         208
+
+/* 解析 cansend 格式 "[ch:]123#DEADBEEF"、"18FF0001##1<data>"、"123#R"，整串须符合格式 */
+int can_tx_parse(const char *text, rt_uint8_t *channel, CanFrame *frame);
+
+/* 队列与邮箱中尚未发完的帧数 */
+rt_size_t can_tx_pending(rt_uint8_t channel);
+
+/* 中断上下文：处理发送完成/中止事件，邮箱不属于本服务时返回 RT_FALSE */
+rt_bool_t can_tx_isr(rt_uint8_t channel, rt_uint32_t buffer, rt_bool_t aborted);
+
+/* 通道复位后邮箱中的帧已被清除：丢弃邮箱记录 (计为中止) 并重新装填 */
+void can_tx_reset(rt_uint8_t channel);
+
+void can_tx_set_redirect(CanTxRedirect fn);
+
+void can_tx_get_stats(rt_uint8_t channel, CanTxStats *stats);
+
+#endif
@@ -0,0 +1,410 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include "can_udp.h"
+#include "can_tx.h"
+
+/* cannelloni 报文格式 */
+#define CNL_VERSION             2
+#define CNL_OP_DATA             0
+#define CNL_HEADER_SIZE         5       /* version, op_code, seq_no, count(be16) */
+#define CNL_FRAME_MAX           (4 + 1 + 1 + CAN_FRAME_MAX_LEN)
+#define CNL_ID_EFF              0x80000000UL    /* 与 SocketCAN can_id 标志一致 */
+#define CNL_ID_RTR              0x40000000UL
+#define CNL_ID_ERR              0x20000000UL
+#define CNL_LEN_FD              0x80    /* len 最高位：CAN-FD 帧，后跟 flags 字节 */
+#define CNL_FD_BRS              0x01
+#define CNL_FD_ESI              0x02
+
+#define CAN_UDP_RX_TIMEOUT_MS   200     /* 接收超时，用于检查停止请求 */
+#define CAN_UDP_RX_STACK        2048
+
+typedef struct {
+    int sock;
+    struct sockaddr_in peer;
+    rt_thread_t rx_thread;
+    rt_uint8_t tx_seq;
+    rt_uint8_t rx_seq;
+    rt_bool_t rx_seq_valid;
+    rt_uint16_t count;          /* 待发报文中的帧数 */
+    rt_size_t pos;
+    rt_tick_t first_tick;       /* 待发报文中第一帧的时间 */
+    CanUdpStats stats;
+    rt_uint8_t tx_buf[CAN_UDP_MTU];
+    rt_uint8_t rx_buf[CAN_UDP_MTU];
+} CanUdpChannel;
+
+static CanUdpChannel udp_ch[CAN_UDP_CHANNELS];
+static volatile rt_bool_t udp_running = RT_FALSE;
+static rt_uint32_t udp_flush_ms = CAN_UDP_FLUSH_MS;
+static rt_bool_t udp_vbus = RT_FALSE;
+static struct rt_mutex udp_lock;
+static struct rt_semaphore udp_rx_exit;
+static rt_bool_t udp_inited = RT_FALSE;
+
+static void can_udp_init(void)
+{
+    if (!udp_inited) {
+        rt_mutex_init(&udp_lock, "can_udp", RT_IPC_FLAG_PRIO);
+        rt_sem_init(&udp_rx_exit, "udp_rx", 0, RT_IPC_FLAG_FIFO);
+        for (int i = 0; i < CAN_UDP_CHANNELS; i++) udp_ch[i].sock = -1;
+        udp_inited = RT_TRUE;
+    }
+}
+
+rt_inline void put_be32(rt_uint8_t *p, rt_uint32_t v)
+{
+    p[0] = (rt_uint8_t)(v >> 24);
+    p[1] = (rt_uint8_t)(v >> 16);
+    p[2] = (rt_uint8_t)(v >> 8);
+    p[3] = (rt_uint8_t)v;
+}
+
+rt_inline rt_uint32_t get_be32(const rt_uint8_t *p)
+{
+    return ((rt_uint32_t)p[0] << 24) | ((rt_uint32_t)p[1] << 16) | ((rt_uint32_t)p[2] << 8) | p[3];
+}
+
+/* 持锁调用：发送待发报文 */
+static void udp_send(CanUdpChannel *c)
+{
+    if (c->count == 0) return;
+
+    c->tx_buf[0] = CNL_VERSION;
+    c->tx_buf[1] = CNL_OP_DATA;
+    c->tx_buf[2] = c->tx_seq++;
+    c->tx_buf[3] = (rt_uint8_t)(c->count >> 8);
+    c->tx_buf[4] = (rt_uint8_t)c->count;
+
+    if (sendto(c->sock, c->tx_buf, c->pos, 0, (struct sockaddr *)&c->peer, sizeof(c->peer)) == (int)c->pos) {
+        c->stats.tx_datagrams++;
+        c->stats.tx_frames += c->count;
+    } else {
+        c->stats.tx_errors++;
+    }
+    c->count = 0;
+    c->pos = CNL_HEADER_SIZE;
+}
+
+void can_udp_feed(const CanFrame *frames, rt_size_t n)
+{
+    if (!udp_running) return;
+
+    rt_mutex_take(&udp_lock, RT_WAITING_FOREVER);
+    for (rt_size_t i = 0; i < n && udp_running; i++) {
+        const CanFrame *f = &frames[i];
+        /* 虚拟总线注入的帧本就来自对端，不再发回 */
+        if (f->channel >= CAN_UDP_CHANNELS || f->fifo == CAN_FIFO_VIRTUAL) continue;
+
+        CanUdpChannel *c = &udp_ch[f->channel];
+        if (c->sock < 0) continue;
+
+        if (c->pos + CNL_FRAME_MAX > CAN_UDP_MTU) udp_send(c);
+        if (c->count == 0) c->first_tick = rt_tick_get();
+
+        rt_uint8_t *p = c->tx_buf + c->pos;
+        rt_uint32_t can_id = f->id;
+        if (f->flags & CAN_FRAME_FLAG_EXT) can_id |= CNL_ID_EFF;
+        if (f->flags & CAN_FRAME_FLAG_RTR) can_id |= CNL_ID_RTR;
+        put_be32(p, can_id);
+        p += 4;
+
+        if (f->flags & CAN_FRAME_FLAG_FD) {
+            *p++ = f->len | CNL_LEN_FD;
+            *p++ = ((f->flags & CAN_FRAME_FLAG_BRS) ? CNL_FD_BRS : 0) | ((f->flags & CAN_FRAME_FLAG_ESI) ? CNL_FD_ESI : 0);
+        } else {
+            *p++ = f->len;
+        }
+        /* 远程帧不带数据 */
+        if (!(f->flags & CAN_FRAME_FLAG_RTR)) {
+            memcpy(p, f->data, f->len);
+            p += f->len;
+        }
+
+        c->pos = p - c->tx_buf;
+        c->count++;
+    }
+    rt_mutex_release(&udp_lock);
+}
+
+rt_int32_t can_udp_flush(void)
+{
+    rt_int32_t next = -1;
+
+    if (!udp_running) return -1;
+
+    rt_mutex_take(&udp_lock, RT_WAITING_FOREVER);
+    for (int i = 0; i < CAN_UDP_CHANNELS; i++) {
+        CanUdpChannel *c = &udp_ch[i];
+        if (c->count == 0) continue;
+
+        rt_uint32_t age = rt_tick_get() - c->first_tick;
+        if (age >= udp_flush_ms) {
+            udp_send(c);
+        } else if (next < 0 || (rt_int32_t)(udp_flush_ms - age) < next) {
+            next = udp_flush_ms - age;
+        }
+    }
+    rt_mutex_release(&udp_lock);
+    return next;
+}
+
+/* 下行帧交给 CAN 发送服务排队，多邮箱并行发出；虚拟总线模式下作为接收帧注入 */
+static rt_bool_t udp_tx_frame(CanUdpChannel *c, rt_uint32_t can_id, rt_uint8_t fd, rt_uint8_t fd_flags,
+                              const rt_uint8_t *data, rt_uint8_t len)
+{
+    CanFrame f;
+
+    f.flags = 0;
+    if (can_id & CNL_ID_EFF) f.flags |= CAN_FRAME_FLAG_EXT;
+    if (can_id & CNL_ID_RTR) f.flags |= CAN_FRAME_FLAG_RTR;
+    if (fd) f.flags |= CAN_FRAME_FLAG_FD;
+    if (fd && (fd_flags & CNL_FD_BRS)) f.flags |= CAN_FRAME_FLAG_BRS;
+    f.id = can_id & ((f.flags & CAN_FRAME_FLAG_EXT) ? 0x1FFFFFFF : 0x7FF);
+    f.channel = (rt_uint8_t)(c - udp_ch);
+    f.len = len;
+    memcpy(f.data, data, len);
+
+    if (udp_vbus) {
+        f.timestamp = 0;
+        return can_ring_inject(&f) == RT_EOK;
+    }
+    return can_tx_send(f.channel, &f, CAN_TX_PRIO_NORMAL) == RT_EOK;
+}
+
+/* 虚拟总线模式：本机发送的帧 (ISO-TP 流控等) 不上总线，编码后发给对端 */
+static int udp_vbus_tx(rt_uint8_t channel, const CanFrame *frame)
+{
+    CanFrame f;
+
+    memcpy(&f, frame, offsetof(CanFrame, data) + frame->len);
+    f.channel = channel;
+    f.fifo = 0;
+    can_udp_feed(&f, 1);
+    return RT_EOK;
+}
+
+void can_udp_set_vbus(rt_bool_t enable)
+{
+    udp_vbus = enable;
+    can_tx_set_redirect(enable ? udp_vbus_tx : RT_NULL);
+}
+
+/* 解析一个 cannelloni 报文并转发到总线 */
+static void udp_rx_datagram(CanUdpChannel *c, const rt_uint8_t *buf, rt_size_t len)
+{
+    if (len < CNL_HEADER_SIZE || buf[0] != CNL_VERSION || buf[1] != CNL_OP_DATA) {
+        c->stats.rx_errors++;
+        return;
+    }
+
+    if (c->rx_seq_valid && buf[2] != (rt_uint8_t)(c->rx_seq + 1)) c->stats.rx_seq_gaps++;
+    c->rx_seq = buf[2];
+    c->rx_seq_valid = RT_TRUE;
+    c->stats.rx_datagrams++;
+
+    rt_uint16_t count = ((rt_uint16_t)buf[3] << 8) | buf[4];
+    rt_size_t pos = CNL_HEADER_SIZE;
+
+    for (rt_uint16_t i = 0; i < count; i++) {
+        if (pos + 5 > len) goto bad;
+
+        rt_uint32_t can_id = get_be32(buf + pos);
+        rt_uint8_t dlen = buf[pos + 4];
+        rt_uint8_t fd = (dlen & CNL_LEN_FD) ? 1 : 0;
+        rt_uint8_t fd_flags = 0;
+        pos += 5;
+
+        dlen &= (rt_uint8_t)~CNL_LEN_FD;
+        if (fd) {
+            if (pos >= len) goto bad;
+            fd_flags = buf[pos++];
+        }
+        if (dlen > (fd ? CAN_FRAME_MAX_LEN : 8)) goto bad;
+        if (can_id & CNL_ID_RTR) dlen = 0;
+        if (pos + dlen > len) goto bad;
+
+        /* 错误帧仅用于对端上报，不发到总线 */
+        if (!(can_id & CNL_ID_ERR)) {
+            if (udp_tx_frame(c, can_id, fd, fd_flags, buf + pos, dlen)) {
+                c->stats.rx_frames++;
+            } else {
+                c->stats.rx_errors++;
+            }
+        }
+        pos += dlen;
+    }
+    return;
+
+bad:
+    c->stats.rx_errors++;
+}
+
+static void can_udp_rx_entry(void *parameter)
+{
+    CanUdpChannel *c = (CanUdpChannel *)parameter;
+
+    while (udp_running) {
+        int n = recv(c->sock, c->rx_buf, sizeof(c->rx_buf), 0);
+        if (n > 0) udp_rx_datagram(c, c->rx_buf, n);
+    }
+    rt_sem_release(&udp_rx_exit);
+}
+
+static int udp_open_channel(CanUdpChannel *c, int ch, rt_uint32_t peer_addr, rt_uint16_t port, rt_uint16_t local_port)
+{
+    struct sockaddr_in local;
+    struct timeval tv = { 0, CAN_UDP_RX_TIMEOUT_MS * 1000 };
+
+    c->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (c->sock < 0) return -RT_ERROR;
+
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(local_port + ch);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(c->sock, (struct sockaddr *)&local, sizeof(local)) < 0) {
+        closesocket(c->sock);
+        c->sock = -1;
+        return -RT_ERROR;
+    }
+    setsockopt(c->sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    memset(&c->peer, 0, sizeof(c->peer));
+    c->peer.sin_family = AF_INET;
+    c->peer.sin_port = htons(port + ch);
+    c->peer.sin_addr.s_addr = peer_addr;
+
+    c->pos = CNL_HEADER_SIZE;
+    c->count = 0;
+    c->rx_seq_valid = RT_FALSE;
+    memset(&c->stats, 0, sizeof(c->stats));
+    return RT_EOK;
+}
+
+int can_udp_start(const char *peer_ip, rt_uint16_t port, rt_uint16_t local_port, rt_uint32_t flush_ms)
+{
+    rt_uint32_t peer_addr = inet_addr(peer_ip);
+    int started = 0;
+
+    if (peer_addr == INADDR_NONE) return -RT_EINVAL;
+
+    can_udp_init();
+    if (udp_running) can_udp_stop();
+
+    udp_flush_ms = flush_ms;
+    rt_mutex_take(&udp_lock, RT_WAITING_FOREVER);
+    for (int ch = 0; ch < CAN_UDP_CHANNELS; ch++) {
+        if (udp_open_channel(&udp_ch[ch], ch, peer_addr, port, local_port) != RT_EOK) {
+            rt_kprintf("can_udp: channel %d port %d unavailable\n", ch, local_port + ch);
+        }
+    }
+    udp_running = RT_TRUE;
+    rt_mutex_release(&udp_lock);
+
+    for (int ch = 0; ch < CAN_UDP_CHANNELS; ch++) {
+        CanUdpChannel *c = &udp_ch[ch];
+        char name[RT_NAME_MAX];
+
+        c->rx_thread = RT_NULL;
+        if (c->sock < 0) continue;
+
+        rt_snprintf(name, sizeof(name), "udp_can%d", ch);
+        c->rx_thread = rt_thread_create(name, can_udp_rx_entry, c, CAN_UDP_RX_STACK, 19, 10);
+        if (c->rx_thread) {
+            rt_thread_startup(c->rx_thread);
+            started++;
+        }
+    }
+
+    if (started == 0) {
+        can_udp_stop();
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+void can_udp_stop(void)
+{
+    if (!udp_running) return;
+
+    udp_running = RT_FALSE;
+    if (udp_vbus) can_udp_set_vbus(RT_FALSE);
+    /* 等待接收线程在超时后退出，再关闭 socket */
+    for (int ch = 0; ch < CAN_UDP_CHANNELS; ch++) {
+        if (udp_ch[ch].rx_thread) rt_sem_take(&udp_rx_exit, CAN_UDP_RX_TIMEOUT_MS * 2);
+        udp_ch[ch].rx_thread = RT_NULL;
+    }
+
+    rt_mutex_take(&udp_lock, RT_WAITING_FOREVER);
+    for (int ch = 0; ch < CAN_UDP_CHANNELS; ch++) {
+        if (udp_ch[ch].sock >= 0) {
+            closesocket(udp_ch[ch].sock);
+            udp_ch[ch].sock = -1;
+        }
+        udp_ch[ch].count = 0;
+    }
+    rt_mutex_release(&udp_lock);
+}
+
+rt_bool_t can_udp_active(void)
+{
+    return udp_running;
+}
+
+void can_udp_get_stats(rt_uint8_t channel, CanUdpStats *stats)
+{
+    if (channel < CAN_UDP_CHANNELS) *stats = udp_ch[channel].stats;
+}
+
+static void can_udp_show(void)
+{
+    CanUdpStats st;
+
+    rt_kprintf("CAN UDP bridge: %s, flush %u ms%s\n", udp_running ? "running" : "stopped", udp_flush_ms,
+               udp_vbus ? ", virtual bus" : "");
+    rt_kprintf("ch  port   tx_frames  datagrams  tx_err  rx_frames  datagrams  rx_err  seq_gap\n");
+    for (int ch = 0; ch < CAN_UDP_CHANNELS; ch++) {
+        if (udp_ch[ch].sock < 0) continue;
+        can_udp_get_stats((rt_uint8_t)ch, &st);
+        rt_kprintf("%2d  %5d  %9u  %9u  %6u  %9u  %9u  %6u  %7u\n", ch, ntohs(udp_ch[ch].peer.sin_port),
+                   st.tx_frames, st.tx_datagrams, st.tx_errors, st.rx_frames, st.rx_datagrams,
+                   st.rx_errors, st.rx_seq_gaps);
+    }
+}
+
+/* msh: can_udp start <peer_ip> [port] [flush_ms] [local_port] | stop | stat | vbus on|off */
+static int can_udp(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "start") == 0) {
+        rt_uint16_t port = (argc >= 4) ? (rt_uint16_t)atoi(argv[3]) : CAN_UDP_PORT_DEFAULT;
+        rt_uint32_t flush_ms = (argc >= 5) ? strtoul(argv[4], RT_NULL, 0) : CAN_UDP_FLUSH_MS;
+        rt_uint16_t local_port = (argc >= 6) ? (rt_uint16_t)atoi(argv[5]) : port;
+        int ret = can_udp_start(argv[2], port, local_port, flush_ms);
+        if (ret != RT_EOK) rt_kprintf("can_udp: start failed (%d)\n", ret);
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        can_udp_stop();
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        can_udp_show();
+        return 0;
+    } else if (argc >= 3 && strcmp(argv[1], "vbus") == 0) {
+        if (!udp_running && strcmp(argv[2], "on") == 0) {
+            rt_kprintf("can_udp: start the bridge first\n");
+            return -1;
+        }
+        can_udp_set_vbus(strcmp(argv[2], "on") == 0);
+        return 0;
+    }
+
+    rt_kprintf("Usage: can_udp start <peer_ip> [port] [flush_ms] [local_port]\n");
+    rt_kprintf("       can_udp stop|stat\n");
+    rt_kprintf("       can_udp vbus on|off\n");
+    return -1;
+}
+MSH_CMD_EXPORT(can_udp, Bridge raw CAN frames over UDP (cannelloni));
@@ -0,0 +1,50 @@
+#ifndef __CAN_UDP_H__
+#define __CAN_UDP_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * CAN-over-UDP 桥接 (cannelloni 协议 v2)，与 MQTT 上报并行，供本地 SCADA / 测试台获取原始 CAN 流量。
+ * 每个 CAN 通道一对 UDP 端口 (port + 通道号)，本地端口默认与对端相同，
+ * 对端可直接使用 cannelloni 或 scripts/can_udp_peer.py。
+ *
+ * 上行：CAN 线程取出帧后调用 can_udp_feed，帧直接编码进待发报文，不另行复制；
+ *       报文满或最早一帧等待超过 flush_ms 时发送。
+ * 下行：每通道一个接收线程，收到的帧交给 CAN 发送服务 (can_tx) 发出。
+ *
+ * 虚拟总线模式 (vbus)：下行帧不上总线，作为接收帧注入 CAN 接收队列，本机经 can_tx 发送的帧改发给对端。
+ * 配合主机 vcan + cannelloni，网关即成为 vcan 上的一个节点，可在无 CAN 硬件时测试 ISO-TP 等协议栈。
+ */
+#define CAN_UDP_PORT_DEFAULT    20000
+#define CAN_UDP_FLUSH_MS        2       /* 默认聚合超时 */
+#define CAN_UDP_MTU             1472    /* 以太网 MTU 下不分片的 UDP 载荷 */
+#define CAN_UDP_CHANNELS        2
+
+typedef struct {
+    rt_uint32_t tx_frames;      /* 发往 UDP 的帧数 */
+    rt_uint32_t tx_datagrams;
+    rt_uint32_t tx_errors;      /* sendto 失败 */
+    rt_uint32_t rx_frames;      /* 从 UDP 收到并发到总线的帧数 */
+    rt_uint32_t rx_datagrams;
+    rt_uint32_t rx_errors;      /* 格式错误或总线发送失败 */
+    rt_uint32_t rx_seq_gaps;    /* 对端报文序号不连续次数 */
+} CanUdpStats;
+
+/* API */
+int  can_udp_start(const char *peer_ip, rt_uint16_t port, rt_uint16_t local_port, rt_uint32_t flush_ms);
+void can_udp_stop(void);
+rt_bool_t can_udp_active(void);
+
+/* CAN 线程：编码一批接收帧 */
+void can_udp_feed(const CanFrame *frames, rt_size_t n);
+
+/* CAN 线程：发送到期的报文，返回距下一次到期的 ms，无待发数据返回 -1 */
+rt_int32_t can_udp_flush(void);
+
+/* 开启/关闭虚拟总线模式，桥接停止时自动关闭 */
+void can_udp_set_vbus(rt_bool_t enable);
+
+void can_udp_get_stats(rt_uint8_t channel, CanUdpStats *stats);
+
+#endif
@@ -0,0 +1,402 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "decim_chain.h"
+#include "perf_counter.h"
+
+#define DECIM_PASS          0.4     /* FIR 通带 / 阻带边缘，相对本级输出采样率 (31 抽头时) */
+#define DECIM_STOP          0.6
+#define DECIM_GRID          256     /* 频率取样法的积分点数 */
+#define DECIM_TAPS_DEFAULT  31
+#define DECIM_RESP_POINTS   1000    /* "decim resp" 阻带扫描点数 */
+
+#ifndef M_PI
+#define M_PI                3.14159265358979323846
+#endif
+
+static DecimChain *decim_table[DECIM_CHAINS_MAX];
+
+/* CIC 幅频响应，f 相对 CIC 输出采样率 */
+static double decim_cic_mag(double f, rt_uint16_t rate, rt_uint8_t order)
+{
+    double den = rate * sin(M_PI * f / rate);
+    if (order == 0 || fabs(den) < 1e-12) return 1.0;
+    return pow(fabs(sin(M_PI * f) / den), order);
+}
+
+/*
+ * 频率取样法设计一级 2 倍抽取 FIR：目标响应在通带、阻带边缘中点 (0.5 输出采样率) 以下为 1 (comp 时为 CIC 下垂的逆)，
+ * 以上为 0，逆 DTFT 后加 Hamming 窗，由窗形成过渡带 (31 抽头约 0.4..0.6)；量化为 Q15 后修正中心抽头使直流增益正好为 1。
+ */
+static void decim_design_fir(rt_int16_t *q15, rt_uint16_t taps, rt_bool_t comp, const DecimConfig *cfg)
+{
+    double h[DECIM_FIR_MAX_TAPS], sum = 0;
+    double fc = (DECIM_PASS + DECIM_STOP) / 4, mid = (taps - 1) / 2.0;
+    rt_int32_t qsum = 0;
+
+    for (int n = 0; n < taps; n++) {
+        double acc = 0;
+        for (int g = 0; g < DECIM_GRID; g++) {
+            double f = (g + 0.5) * fc / DECIM_GRID;
+            double target = comp ? 1.0 / decim_cic_mag(f, cfg->rate, cfg->order) : 1.0;
+            acc += target * cos(2 * M_PI * f * (n - mid));
+        }
+        h[n] = acc * fc / DECIM_GRID * (0.54 - 0.46 * cos(2 * M_PI * n / (taps - 1)));
+        sum += h[n];
+    }
+    for (int n = 0; n < taps; n++) {
+        double v = h[n] / sum * 32768.0;
+        q15[n] = (rt_int16_t)(v < -32768 ? -32768 : (v > 32767 ? 32767 : floor(v + 0.5)));
+        qsum += q15[n];
+    }
+    q15[taps / 2] += (rt_int16_t)(32768 - qsum);
+}
+
+int decim_design(const DecimConfig *cfg, DecimDesign *d)
+{
+    DecimConfig c = *cfg;
+    rt_uint32_t gain_den = 1;
+
+    if (c.order > DECIM_CIC_MAX_ORDER || c.fir_stages > DECIM_FIR_MAX_STAGES) return -RT_EINVAL;
+    if (c.order == 0) c.rate = 1;
+    else if (c.rate < 2) return -RT_EINVAL;
+    if (c.fir_stages == 0) c.taps = 0;
+    else if (c.taps == 0) c.taps = DECIM_TAPS_DEFAULT;
+    if (c.fir_stages && (c.taps < 3 || c.taps > DECIM_FIR_MAX_TAPS || (c.taps & 1) == 0)) return -RT_EINVAL;
+
+    /* 码值按 16 位计，R^N 超过 65536 时 32 位回绕运算的结果会溢出 */
+    for (int k = 0; k < c.order; k++) {
+        gain_den *= c.rate;
+        if (gain_den > 65536) return -RT_EINVAL;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->cfg = c;
+    d->gain = (c.order == 0) ? 0 : (rt_uint32_t)((4294967296.0 / gain_den) + 0.5);
+    d->factor = (rt_uint32_t)c.rate << c.fir_stages;
+    d->delay = c.order * (c.rate - 1) / 2;
+    for (int s = 0; s < c.fir_stages; s++) {
+        decim_design_fir(d->coeffs[s], c.taps, s == 0 && c.order > 0, &c);
+        d->delay += (c.taps - 1) / 2 * ((rt_uint32_t)c.rate << s);
+    }
+    return RT_EOK;
+}
+
+void decim_reset(DecimChain *c)
+{
+    const DecimDesign *d = &c->design;
+
+    memset(c->integ, 0, sizeof(c->integ));
+    memset(c->comb, 0, sizeof(c->comb));
+    memset(c->fir, 0, sizeof(c->fir));
+    memset(c->stats, 0, sizeof(c->stats));
+    c->cic_phase = 0;
+    c->count = 0;
+    for (int s = 0; s < d->cfg.fir_stages; s++) {
+        c->fir[s].taps = d->cfg.taps;
+        memcpy(c->fir[s].coeffs, d->coeffs[s], sizeof(c->fir[s].coeffs));
+    }
+}
+
+int decim_init(DecimChain *c, const char *name, const DecimConfig *cfg)
+{
+    memset(c, 0, sizeof(*c));
+    if (decim_design(cfg, &c->design) != RT_EOK) return -RT_EINVAL;
+    c->pending = c->design;
+    c->name = name;
+    decim_reset(c);
+
+    if (name == RT_NULL) return RT_EOK;
+    for (int i = 0; i < DECIM_CHAINS_MAX; i++) {
+        if (decim_table[i] == c) return RT_EOK;
+        if (decim_table[i] == RT_NULL) {
+            decim_table[i] = c;
+            return RT_EOK;
+        }
+    }
+    return -RT_EFULL;
+}
+
+static DecimChain *decim_find(const char *name)
+{
+    for (int i = 0; i < DECIM_CHAINS_MAX; i++) {
+        if (decim_table[i] && strcmp(decim_table[i]->name, name) == 0) return decim_table[i];
+    }
+    return RT_NULL;
+}
+
+int decim_set(const char *name, const DecimConfig *cfg)
+{
+    static DecimDesign d;
+    DecimChain *c = decim_find(name);
+
+    if (c == RT_NULL || decim_design(cfg, &d) != RT_EOK) return -RT_EINVAL;
+
+    rt_enter_critical();
+    c->pending = d;
+    c->pending_seq++;
+    rt_exit_critical();
+    return RT_EOK;
+}
+
+/* CIC：每个输入做 N 次积分，每 R 个输入做 N 次梳状差分并归一化输出 */
+static rt_uint32_t decim_cic(DecimChain *c, const rt_uint16_t *src, rt_uint32_t stride, rt_uint32_t n, rt_int32_t *out)
+{
+    const DecimDesign *d = &c->design;
+    rt_uint8_t order = d->cfg.order;
+    rt_uint16_t rate = d->cfg.rate, phase = c->cic_phase;
+    rt_uint32_t integ[DECIM_CIC_MAX_ORDER], m = 0;
+
+    if (order == 0) {
+        for (rt_uint32_t i = 0; i < n; i++, src += stride) out[i] = (rt_int32_t)*src << DECIM_FRAC_BITS;
+        return n;
+    }
+
+    memcpy(integ, c->integ, sizeof(integ));
+    for (rt_uint32_t i = 0; i < n; i++, src += stride) {
+        rt_uint32_t x = *src;
+        for (int k = 0; k < order; k++) x = integ[k] += x;
+        if (++phase < rate) continue;
+        phase = 0;
+        for (int k = 0; k < order; k++) {
+            rt_uint32_t y = x - c->comb[k];
+            c->comb[k] = x;
+            x = y;
+        }
+        out[m++] = (rt_int32_t)(((rt_uint64_t)x * d->gain) >> (32 - DECIM_FRAC_BITS));
+    }
+    memcpy(c->integ, integ, sizeof(integ));
+    c->cic_phase = phase;
+    return m;
+}
+
+/* FIR 2 倍抽取，就地处理 (输出序号不超过输入序号)，Q15 系数、64 位累加 */
+static rt_uint32_t decim_fir(DecimFir *f, rt_int32_t *io, rt_uint32_t n)
+{
+    rt_uint32_t m = 0;
+
+    for (rt_uint32_t i = 0; i < n; i++) {
+        f->delay[f->pos] = f->delay[f->pos + f->taps] = io[i];
+        if (++f->pos == f->taps) f->pos = 0;
+        if (++f->phase < 2) continue;
+        f->phase = 0;
+
+        const rt_int32_t *x = &f->delay[f->pos];
+        rt_int64_t acc = 1 << 14;
+        for (int k = 0; k < f->taps; k++) acc += (rt_int64_t)f->coeffs[k] * x[k];
+        io[m++] = (rt_int32_t)(acc >> 15);
+    }
+    return m;
+}
+
+rt_uint32_t decim_run(DecimChain *c, const rt_uint16_t *src, rt_uint32_t stride, rt_uint32_t n, rt_int32_t *out)
+{
+    rt_uint32_t total = 0;
+
+    while (n > 0) {
+        rt_uint32_t len = (n < DECIM_CHUNK) ? n : DECIM_CHUNK;
+        rt_uint64_t t0 = perf_now(), t1;
+
+        rt_uint32_t m = decim_cic(c, src, stride, len, c->buf);
+        t1 = perf_now();
+        c->stats[0].ticks += t1 - t0;
+        c->stats[0].in += len;
+        c->stats[0].out += m;
+
+        for (int s = 0; s < c->design.cfg.fir_stages && m > 0; s++) {
+            rt_uint32_t k = decim_fir(&c->fir[s], c->buf, m);
+            t0 = perf_now();
+            c->stats[1 + s].ticks += t0 - t1;
+            c->stats[1 + s].in += m;
+            c->stats[1 + s].out += k;
+            t1 = t0;
+            m = k;
+        }
+
+        memcpy(out + total, c->buf, m * sizeof(rt_int32_t));
+        total += m;
+        src += len * stride;
+        n -= len;
+    }
+    return total;
+}
+
+rt_uint32_t decim_process(DecimChain *c, const AdcBlock *block, rt_uint8_t index, rt_int32_t *out, rt_uint32_t *first)
+{
+    if (index >= block->channels) return 0;
+
+    rt_uint8_t chan = block->channel_id[index];
+
+    if (c->seq != c->pending_seq) {
+        rt_enter_critical();
+        c->design = c->pending;
+        c->seq = c->pending_seq;
+        rt_exit_critical();
+        decim_reset(c);
+    } else if (chan != c->chan || block->seq != c->next_block) {
+        decim_reset(c);
+    }
+    c->chan = chan;
+    c->next_block = block->seq + 1;
+    c->rate = block->rate;
+
+    *first = c->design.factor - 1 - c->count;
+    c->count = (c->count + block->scans) % c->design.factor;
+    return decim_run(c, &block->data[index], block->channels, block->scans, out);
+}
+
+/* ---------- msh ---------- */
+
+/* 命令线程显示用的副本：处理线程随时在更新设计与各级统计，须在临界区内一次取出 */
+typedef struct {
+    const char *name;
+    DecimDesign design;
+    DecimStageStats stats[1 + DECIM_FIR_MAX_STAGES];
+    rt_uint32_t rate;
+    rt_uint8_t  chan;
+} DecimSnapshot;
+
+static DecimSnapshot decim_snap;    /* 含系数约 0.8 KB，不放在 msh 栈上 */
+
+static const DecimSnapshot *decim_snapshot(const DecimChain *c)
+{
+    rt_enter_critical();
+    decim_snap.name = c->name;
+    decim_snap.design = c->design;
+    memcpy(decim_snap.stats, c->stats, sizeof(decim_snap.stats));
+    decim_snap.rate = c->rate;
+    decim_snap.chan = c->chan;
+    rt_exit_critical();
+    return &decim_snap;
+}
+
+/* 以 0.01 dB 为单位输出 */
+static void decim_print_db(const char *prefix, double mag)
+{
+    double db = (mag > 1e-10) ? 20.0 * log10(mag) : -200.0;
+    int c = (int)(db * 100 + (db < 0 ? -0.5 : 0.5));
+    rt_kprintf("%s%s%d.%02d dB", prefix, c < 0 ? "-" : "", abs(c) / 100, abs(c) % 100);
+}
+
+/* 整条链 (量化后的系数) 在 x (相对输入采样率) 处的幅频响应 */
+static double decim_chain_mag(const DecimDesign *d, double x)
+{
+    double mag = decim_cic_mag(x * d->cfg.rate, d->cfg.rate, d->cfg.order);
+
+    for (int s = 0; s < d->cfg.fir_stages; s++) {
+        double w = 2 * M_PI * x * ((rt_uint32_t)d->cfg.rate << s), re = 0, im = 0;
+        for (int k = 0; k < d->cfg.taps; k++) {
+            re += d->coeffs[s][k] * cos(w * k);
+            im -= d->coeffs[s][k] * sin(w * k);
+        }
+        mag *= sqrt(re * re + im * im) / 32768.0;
+    }
+    return mag;
+}
+
+/* 通带 (0..0.4 输出采样率) 起伏与阻带 (0.6 输出采样率 .. 输入奈奎斯特) 最差衰减，后者决定混叠 */
+static void decim_resp(const DecimSnapshot *c)
+{
+    static const float marks[] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 1.0f, 2.0f };
+    const DecimDesign *d = &c->design;
+    double fo = 1.0 / d->factor, pmin = 10, pmax = 0, smax = 0, sat = 0;
+
+    for (int i = 0; i <= 100; i++) {
+        double m = decim_chain_mag(d, 0.4 * fo * i / 100);
+        if (m < pmin) pmin = m;
+        if (m > pmax) pmax = m;
+    }
+    if (d->factor > 1) {
+        for (int i = 0; i <= DECIM_RESP_POINTS; i++) {
+            double x = 0.6 * fo + (0.5 - 0.6 * fo) * i / DECIM_RESP_POINTS;
+            double m = decim_chain_mag(d, x);
+            if (m > smax) {
+                smax = m;
+                sat = x;
+            }
+        }
+    }
+
+    rt_kprintf("%s: 1/%u, output %u mHz at %u Hz input\n", c->name, d->factor,
+               (rt_uint32_t)((rt_uint64_t)c->rate * 1000 / d->factor), c->rate);
+    decim_print_db("  passband 0..0.4 fo: ", pmin);
+    decim_print_db(" .. ", pmax);
+    rt_kprintf("\n");
+    if (d->factor > 1) {
+        decim_print_db("  worst stopband (>= 0.6 fo): ", smax);
+        rt_kprintf(" at %u.%02u fo\n", (rt_uint32_t)(sat / fo), (rt_uint32_t)(sat / fo * 100) % 100);
+    }
+    for (rt_size_t i = 0; i < sizeof(marks) / sizeof(marks[0]); i++) {
+        if (marks[i] * fo > 0.5) break;
+        rt_kprintf("  %u.%u fo:", (rt_uint32_t)marks[i], (rt_uint32_t)(marks[i] * 10) % 10);
+        decim_print_db(" ", decim_chain_mag(d, marks[i] * fo));
+        rt_kprintf("\n");
+    }
+}
+
+/* 各级耗时：本级每个输入的周期数，以及折算到链每个输入样本的周期数 */
+static void decim_list(const DecimSnapshot *c)
+{
+    const DecimDesign *d = &c->design;
+    rt_uint32_t n = c->stats[0].in, rate = c->rate;
+    rt_uint64_t total = 0;
+
+    rt_kprintf("%s: ADC%d ch%d, CIC N=%u R=%u, %u FIR x2 (%u taps), 1/%u, delay %u samples\n", c->name,
+               ADC_ACQ_CHAN_UNIT(c->chan), ADC_ACQ_CHAN_NUM(c->chan), d->cfg.order, d->cfg.rate,
+               d->cfg.fir_stages, d->cfg.taps, d->factor, d->delay);
+    rt_kprintf("  %-6s %9s %10s %10s %9s %9s\n", "stage", "in(Hz)", "in", "out", "cyc/in", "cyc/smp");
+
+    for (int s = 0; s <= d->cfg.fir_stages; s++) {
+        const DecimStageStats *st = &c->stats[s];
+        rt_uint64_t cyc = perf_to_cycles(st->ticks);
+        rt_uint32_t per_in = st->in ? (rt_uint32_t)(cyc * 100 / st->in) : 0;
+        rt_uint32_t per_smp = n ? (rt_uint32_t)(cyc * 100 / n) : 0;
+        char name[8];
+
+        total += cyc;
+        rt_snprintf(name, sizeof(name), s ? "fir%d" : "cic", s);
+        rt_kprintf("  %-6s %9u %10u %10u %6u.%02u %6u.%02u\n", name, rate, st->in, st->out,
+                   per_in / 100, per_in % 100, per_smp / 100, per_smp % 100);
+        rate /= s ? 2 : d->cfg.rate;
+    }
+    rt_uint32_t per_smp = n ? (rt_uint32_t)(total * 100 / n) : 0;
+    rt_kprintf("  %-6s %42s %6u.%02u\n", "total", "", per_smp / 100, per_smp % 100);
+}
+
+static int decim(int argc, char **argv)
+{
+    if (argc >= 6 && strcmp(argv[1], "set") == 0) {
+        DecimConfig cfg = {
+            .order = (rt_uint8_t)atoi(argv[3]),
+            .rate = (rt_uint16_t)atoi(argv[4]),
+            .fir_stages = (rt_uint8_t)atoi(argv[5]),
+            .taps = (argc >= 7) ? (rt_uint16_t)atoi(argv[6]) : 0,
+        };
+        int ret = decim_set(argv[2], &cfg);
+        if (ret != RT_EOK) {
+            rt_kprintf("unknown chain or invalid config (N<=%d, R^N<=65536, stages<=%d, odd taps 3..%d)\n",
+                       DECIM_CIC_MAX_ORDER, DECIM_FIR_MAX_STAGES, DECIM_FIR_MAX_TAPS);
+        }
+        return ret;
+    } else if (argc >= 3 && strcmp(argv[1], "resp") == 0) {
+        DecimChain *c = decim_find(argv[2]);
+        if (c == RT_NULL) {
+            rt_kprintf("unknown chain\n");
+            return -RT_EINVAL;
+        }
+        decim_resp(decim_snapshot(c));
+        return 0;
+    } else if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        for (int i = 0; i < DECIM_CHAINS_MAX; i++) {
+            if (decim_table[i]) decim_list(decim_snapshot(decim_table[i]));
+        }
+        return 0;
+    }
+
+    rt_kprintf("Usage: decim [list]\n");
+    rt_kprintf("       decim set <chain> <cic_order> <cic_rate> <fir_stages> [taps]\n");
+    rt_kprintf("       decim resp <chain>\n");
+    return 0;
+}
+MSH_CMD_EXPORT(decim, CIC + FIR decimation chains and per-stage cycle accounting);
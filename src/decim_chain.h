@@ -0,0 +1,94 @@
+#ifndef __DECIM_CHAIN_H__
+#define __DECIM_CHAIN_H__
+
+#include <rtthread.h>
+#include "adc_acq.h"
+
+/*
+ * 多级抽取滤波：CIC (N 级积分-梳状，抽取 R) 后接若干级 FIR 2 倍抽取，全程定点，按块处理。
+ *
+ * CIC 只用加减法把采样率降到 fs/R，通带内有 sinc^N 下垂、滤不干净的混叠落在 R 倍频附近；
+ * 第一级 FIR 用频率取样法设计为 CIC 下垂的逆 (通带补偿) 兼低通，之后各级 FIR 为普通低通。
+ * 每级 FIR 通带 0.4、阻带 0.6 (相对本级输出采样率)，阻带的混叠只落在输出的 0.4..0.5 过渡带内。
+ *
+ * 数据格式：CIC 积分/梳状用 32 位无符号回绕运算，只要求最终结果不溢出 (码值 <= 16 位时 R^N <= 65536)；
+ * CIC 输出乘归一化增益后为码值 * 2^DECIM_FRAC_BITS，FIR 系数 Q15，64 位累加。
+ * 各级耗时分别累计 (perf_now)，"decim list" 输出每级每样本周期数。
+ *
+ * 链在 decim_init 时登记名称，"decim set" 在命令线程中设计系数，处理线程在下一个块开始时换用新配置。
+ * 一条链处理一个通道 (换通道即复位)，多个通道各用一条链。
+ */
+#define DECIM_CIC_MAX_ORDER     5
+#define DECIM_FIR_MAX_STAGES    3
+#define DECIM_FIR_MAX_TAPS      63
+#define DECIM_FRAC_BITS         8
+#define DECIM_CHUNK             ADC_ACQ_BLOCK_SCANS     /* 内部分段处理的输入样本数 */
+#define DECIM_CHAINS_MAX        4
+
+typedef struct {
+    rt_uint8_t  order;          /* CIC 级数 N，0 为不用 CIC */
+    rt_uint8_t  fir_stages;     /* FIR 2 倍抽取级数 */
+    rt_uint16_t rate;           /* CIC 抽取比 R */
+    rt_uint16_t taps;           /* 每级 FIR 抽头数 (奇数) */
+} DecimConfig;
+
+typedef struct {
+    rt_uint16_t taps;
+    rt_uint16_t phase;          /* 已收到的输入数，满 2 输出一个 */
+    rt_uint16_t pos;
+    rt_int16_t  coeffs[DECIM_FIR_MAX_TAPS];         /* Q15 */
+    rt_int32_t  delay[2 * DECIM_FIR_MAX_TAPS];      /* 双份存放，delay[pos..pos+taps-1] 为时间顺序的窗口 */
+} DecimFir;
+
+/* 设计结果，"decim set" 写入后由处理线程取用 */
+typedef struct {
+    DecimConfig cfg;
+    rt_uint32_t gain;           /* CIC 归一化增益：输出 = (和 * gain) >> (32 - DECIM_FRAC_BITS)，gain = 2^32 / R^N (R^N >= 2) */
+    rt_uint32_t factor;         /* 总抽取比 */
+    rt_uint32_t delay;          /* 群时延 (输入样本数) */
+    rt_int16_t  coeffs[DECIM_FIR_MAX_STAGES][DECIM_FIR_MAX_TAPS];
+} DecimDesign;
+
+typedef struct {
+    rt_uint64_t ticks;
+    rt_uint32_t in;
+    rt_uint32_t out;
+} DecimStageStats;
+
+typedef struct {
+    const char *name;
+    DecimDesign design;         /* 当前使用 */
+    DecimDesign pending;
+    volatile rt_uint32_t pending_seq;
+    rt_uint32_t seq;
+    rt_uint8_t  chan;           /* 当前处理的 ADC_ACQ_CHAN */
+    rt_uint32_t next_block;     /* 期望的下一个块序号，跳号 (采集重启、溢出丢块) 时滤波器状态作废 */
+    rt_uint32_t integ[DECIM_CIC_MAX_ORDER];
+    rt_uint32_t comb[DECIM_CIC_MAX_ORDER];      /* 各级梳状的上一个输入 */
+    rt_uint16_t cic_phase;
+    rt_uint32_t count;          /* 自上一个最终输出以来的输入样本数 */
+    DecimFir    fir[DECIM_FIR_MAX_STAGES];
+    DecimStageStats stats[1 + DECIM_FIR_MAX_STAGES];
+    rt_uint32_t rate;           /* 最近一块的输入采样率 */
+    rt_int32_t  buf[DECIM_CHUNK];               /* 各级就地处理 */
+} DecimChain;
+
+/* 校验并设计系数，失败返回 -RT_EINVAL */
+int  decim_design(const DecimConfig *cfg, DecimDesign *d);
+
+/* 初始化并登记到 "decim" 命令的链表，name 须为静态字符串 (RT_NULL 不登记) */
+int  decim_init(DecimChain *c, const char *name, const DecimConfig *cfg);
+void decim_reset(DecimChain *c);
+
+/* 按名称修改配置，处理线程在下一个块换用 */
+int  decim_set(const char *name, const DecimConfig *cfg);
+
+/* 对 n 个码值 (间隔 stride) 滤波抽取，输出码值 * 2^DECIM_FRAC_BITS，返回输出个数 */
+rt_uint32_t decim_run(DecimChain *c, const rt_uint16_t *src, rt_uint32_t stride, rt_uint32_t n, rt_int32_t *out);
+
+/* 取块内第 index 列滤波抽取 (结果未除以硬件加法次数)，返回输出个数；
+ * *first 为第一个输出完成时的输入样本在块内的序号，之后每个输出相隔 design.factor 次扫描，
+ * 输出代表的时刻比完成时刻早 design.delay 次扫描 */
+rt_uint32_t decim_process(DecimChain *c, const AdcBlock *block, rt_uint8_t index, rt_int32_t *out, rt_uint32_t *first);
+
+#endif
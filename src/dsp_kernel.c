@@ -0,0 +1,472 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "dsp_kernel.h"
+#include "perf_counter.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* ---------- 块统计 ---------- */
+
+static void stats_finish(DspBlockStats *st, float sum, float sq, rt_uint32_t n)
+{
+    st->mean = sum / n;
+    st->rms = sqrtf(sq / n);
+}
+
+void dsp_block_stats_ref(const float *x, rt_uint32_t n, DspBlockStats *st)
+{
+    if (n == 0) {
+        memset(st, 0, sizeof(*st));
+        return;
+    }
+
+    float sum = 0, sq = 0, mn = x[0], mx = x[0];
+    for (rt_uint32_t i = 0; i < n; i++) {
+        float v = x[i];
+        sum += v;
+        sq += v * v;
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+    }
+    st->min = mn;
+    st->max = mx;
+    stats_finish(st, sum, sq, n);
+}
+
+/* ---------- int16 -> float ---------- */
+
+void dsp_i16_to_f32_ref(const rt_int16_t *src, rt_uint32_t stride, float *dst, rt_uint32_t n, float scale)
+{
+    for (rt_uint32_t i = 0; i < n; i++, src += stride) dst[i] = (float)*src * scale;
+}
+
+/* ---------- FIR ---------- */
+
+int dsp_fir_init(DspFir *fir, const float *coeffs, rt_uint16_t taps)
+{
+    if (taps == 0 || taps > DSP_FIR_MAX_TAPS) return -RT_EINVAL;
+
+    memset(fir->coeffs, 0, sizeof(fir->coeffs));
+    for (rt_uint16_t k = 0; k < taps; k++) fir->coeffs[taps - 1 - k] = coeffs[k];
+    fir->taps = taps;
+    dsp_fir_reset(fir);
+    return RT_EOK;
+}
+
+void dsp_fir_reset(DspFir *fir)
+{
+    memset(fir->state, 0, sizeof(fir->state));
+    fir->phase = 0;
+}
+
+/* 把一段输入追加到历史样本之后，返回本段处理的样本数 */
+static rt_uint32_t fir_load(DspFir *fir, const float *in, rt_uint32_t n)
+{
+    if (n > DSP_BLOCK_MAX) n = DSP_BLOCK_MAX;
+    memcpy(&fir->state[fir->taps - 1], in, n * sizeof(float));
+    return n;
+}
+
+/* 保留最后 taps - 1 个样本作为下一段的历史 */
+static void fir_shift(DspFir *fir, rt_uint32_t n)
+{
+    memmove(fir->state, &fir->state[n], (fir->taps - 1) * sizeof(float));
+}
+
+static float fir_dot_ref(const float *c, const float *s, rt_uint16_t taps)
+{
+    float acc = 0;
+    for (rt_uint16_t j = 0; j < taps; j++) acc += c[j] * s[j];
+    return acc;
+}
+
+void dsp_fir_process_ref(DspFir *fir, const float *in, float *out, rt_uint32_t n)
+{
+    while (n) {
+        rt_uint32_t m = fir_load(fir, in, n);
+        for (rt_uint32_t i = 0; i < m; i++) out[i] = fir_dot_ref(fir->coeffs, &fir->state[i], fir->taps);
+        fir_shift(fir, m);
+        in += m;
+        out += m;
+        n -= m;
+    }
+}
+
+rt_uint32_t dsp_fir_decimate_ref(DspFir *fir, const float *in, float *out, rt_uint32_t n, rt_uint16_t factor)
+{
+    rt_uint32_t produced = 0;
+    if (factor == 0) return 0;
+
+    while (n) {
+        rt_uint32_t m = fir_load(fir, in, n);
+        rt_uint32_t i = fir->phase;
+        for (; i < m; i += factor) out[produced++] = fir_dot_ref(fir->coeffs, &fir->state[i], fir->taps);
+        fir->phase = (rt_uint16_t)(i - m);
+        fir_shift(fir, m);
+        in += m;
+        n -= m;
+    }
+    return produced;
+}
+
+/* ---------- 双二阶 IIR 级联 ---------- */
+
+int dsp_biquad_init(DspBiquad *bq, const float *coeffs, rt_uint8_t stages, rt_uint8_t channels)
+{
+    if (stages == 0 || stages > DSP_BIQUAD_MAX_STAGES || channels == 0 || channels > DSP_BIQUAD_MAX_CH) {
+        return -RT_EINVAL;
+    }
+
+    memcpy(bq->coeffs, coeffs, stages * 5 * sizeof(float));
+    bq->stages = stages;
+    bq->channels = channels;
+    dsp_biquad_reset(bq);
+    return RT_EOK;
+}
+
+void dsp_biquad_reset(DspBiquad *bq)
+{
+    memset(bq->state, 0, sizeof(bq->state));
+}
+
+void dsp_biquad_process_ref(DspBiquad *bq, const float *in, float *out, rt_uint32_t n)
+{
+    rt_uint8_t channels = bq->channels;
+
+    for (rt_uint32_t i = 0; i < n; i++, in += channels, out += channels) {
+        for (rt_uint8_t ch = 0; ch < channels; ch++) {
+            float x = in[ch];
+            for (rt_uint8_t s = 0; s < bq->stages; s++) {
+                const float *c = bq->coeffs[s];
+                float *d1 = &bq->state[s][0][ch], *d2 = &bq->state[s][1][ch];
+                float y = c[0] * x + *d1;
+                *d1 = c[1] * x - c[3] * y + *d2;
+                *d2 = c[2] * x - c[4] * y;
+                x = y;
+            }
+            out[ch] = x;
+        }
+    }
+}
+
+#if defined(__ARM_NEON)
+
+rt_inline float neon_hsum(float32x4_t v)
+{
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+void dsp_block_stats(const float *x, rt_uint32_t n, DspBlockStats *st)
+{
+    if (n < 4) {
+        dsp_block_stats_ref(x, n, st);
+        return;
+    }
+
+    float32x4_t vsum = vdupq_n_f32(0), vsq = vdupq_n_f32(0);
+    float32x4_t vmin = vld1q_f32(x), vmax = vmin;
+    rt_uint32_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(&x[i]);
+        vsum = vaddq_f32(vsum, v);
+        vsq = vmlaq_f32(vsq, v, v);
+        vmin = vminq_f32(vmin, v);
+        vmax = vmaxq_f32(vmax, v);
+    }
+
+    float32x2_t m2 = vpmin_f32(vget_low_f32(vmin), vget_high_f32(vmin));
+    float32x2_t x2 = vpmax_f32(vget_low_f32(vmax), vget_high_f32(vmax));
+    float sum = neon_hsum(vsum), sq = neon_hsum(vsq);
+    float mn = vget_lane_f32(vpmin_f32(m2, m2), 0), mx = vget_lane_f32(vpmax_f32(x2, x2), 0);
+
+    for (; i < n; i++) {
+        float v = x[i];
+        sum += v;
+        sq += v * v;
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+    }
+    st->min = mn;
+    st->max = mx;
+    stats_finish(st, sum, sq, n);
+}
+
+void dsp_i16_to_f32(const rt_int16_t *src, rt_uint32_t stride, float *dst, rt_uint32_t n, float scale)
+{
+    if (stride != 1) {
+        dsp_i16_to_f32_ref(src, stride, dst, n, scale);
+        return;
+    }
+
+    rt_uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(&src[i]);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        vst1q_f32(&dst[i], vmulq_n_f32(lo, scale));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(hi, scale));
+    }
+    for (; i < n; i++) dst[i] = (float)src[i] * scale;
+}
+
+/* 沿抽头方向向量化，用于只求单个输出的抽取 */
+static float fir_dot_neon(const float *c, const float *s, rt_uint16_t taps)
+{
+    float32x4_t acc = vdupq_n_f32(0);
+    rt_uint16_t j = 0;
+
+    for (; j + 4 <= taps; j += 4) acc = vmlaq_f32(acc, vld1q_f32(&c[j]), vld1q_f32(&s[j]));
+    float r = neon_hsum(acc);
+    for (; j < taps; j++) r += c[j] * s[j];
+    return r;
+}
+
+/* 沿输出方向向量化：4 个相邻输出共用同一系数，每个抽头一次乘加 */
+void dsp_fir_process(DspFir *fir, const float *in, float *out, rt_uint32_t n)
+{
+    while (n) {
+        rt_uint32_t m = fir_load(fir, in, n);
+        rt_uint32_t i = 0;
+
+        for (; i + 4 <= m; i += 4) {
+            const float *s = &fir->state[i];
+            float32x4_t acc = vdupq_n_f32(0);
+            for (rt_uint16_t j = 0; j < fir->taps; j++) acc = vmlaq_n_f32(acc, vld1q_f32(&s[j]), fir->coeffs[j]);
+            vst1q_f32(&out[i], acc);
+        }
+        for (; i < m; i++) out[i] = fir_dot_ref(fir->coeffs, &fir->state[i], fir->taps);
+
+        fir_shift(fir, m);
+        in += m;
+        out += m;
+        n -= m;
+    }
+}
+
+rt_uint32_t dsp_fir_decimate(DspFir *fir, const float *in, float *out, rt_uint32_t n, rt_uint16_t factor)
+{
+    rt_uint32_t produced = 0;
+    if (factor == 0) return 0;
+
+    while (n) {
+        rt_uint32_t m = fir_load(fir, in, n);
+        rt_uint32_t i = fir->phase;
+        for (; i < m; i += factor) out[produced++] = fir_dot_neon(fir->coeffs, &fir->state[i], fir->taps);
+        fir->phase = (rt_uint16_t)(i - m);
+        fir_shift(fir, m);
+        in += m;
+        n -= m;
+    }
+    return produced;
+}
+
+/* 每个通道占向量的一个通道，状态在循环内常驻寄存器；通道数不足 4 时多余通道计算后丢弃 */
+void dsp_biquad_process(DspBiquad *bq, const float *in, float *out, rt_uint32_t n)
+{
+    rt_uint8_t channels = bq->channels, stages = bq->stages;
+    float32x4_t d1[DSP_BIQUAD_MAX_STAGES], d2[DSP_BIQUAD_MAX_STAGES];
+    float lane_in[4] = {0}, lane_out[4];
+
+    for (rt_uint8_t s = 0; s < stages; s++) {
+        d1[s] = vld1q_f32(bq->state[s][0]);
+        d2[s] = vld1q_f32(bq->state[s][1]);
+    }
+
+    for (rt_uint32_t i = 0; i < n; i++, in += channels, out += channels) {
+        float32x4_t x;
+        if (channels == 4) {
+            x = vld1q_f32(in);
+        } else {
+            memcpy(lane_in, in, channels * sizeof(float));
+            x = vld1q_f32(lane_in);
+        }
+
+        for (rt_uint8_t s = 0; s < stages; s++) {
+            const float *c = bq->coeffs[s];
+            float32x4_t y = vmlaq_n_f32(d1[s], x, c[0]);
+            d1[s] = vmlsq_n_f32(vmlaq_n_f32(d2[s], x, c[1]), y, c[3]);
+            d2[s] = vmlsq_n_f32(vmulq_n_f32(x, c[2]), y, c[4]);
+            x = y;
+        }
+
+        if (channels == 4) {
+            vst1q_f32(out, x);
+        } else {
+            vst1q_f32(lane_out, x);
+            memcpy(out, lane_out, channels * sizeof(float));
+        }
+    }
+
+    for (rt_uint8_t s = 0; s < stages; s++) {
+        vst1q_f32(bq->state[s][0], d1[s]);
+        vst1q_f32(bq->state[s][1], d2[s]);
+    }
+}
+
+#else
+
+void dsp_block_stats(const float *x, rt_uint32_t n, DspBlockStats *st)
+{
+    dsp_block_stats_ref(x, n, st);
+}
+
+void dsp_i16_to_f32(const rt_int16_t *src, rt_uint32_t stride, float *dst, rt_uint32_t n, float scale)
+{
+    dsp_i16_to_f32_ref(src, stride, dst, n, scale);
+}
+
+void dsp_fir_process(DspFir *fir, const float *in, float *out, rt_uint32_t n)
+{
+    dsp_fir_process_ref(fir, in, out, n);
+}
+
+rt_uint32_t dsp_fir_decimate(DspFir *fir, const float *in, float *out, rt_uint32_t n, rt_uint16_t factor)
+{
+    return dsp_fir_decimate_ref(fir, in, out, n, factor);
+}
+
+void dsp_biquad_process(DspBiquad *bq, const float *in, float *out, rt_uint32_t n)
+{
+    dsp_biquad_process_ref(bq, in, out, n);
+}
+
+#endif
+
+/* ---------- 基准 ---------- */
+
+#define BENCH_MAX_SAMPLES   1024
+#define BENCH_ROUNDS        16
+#define BENCH_FIR_TAPS      32
+#define BENCH_DECIMATE      4
+#define BENCH_BIQUAD_CH     4
+
+static float bench_in[BENCH_MAX_SAMPLES];
+static float bench_ref[BENCH_MAX_SAMPLES];
+static float bench_out[BENCH_MAX_SAMPLES];
+static rt_int16_t bench_raw[BENCH_MAX_SAMPLES];
+static DspFir bench_fir_a, bench_fir_b;
+static DspBiquad bench_bq_a, bench_bq_b;
+
+/* 2 阶巴特沃斯低通 fc = fs/20 与 fs/10 两级 */
+static const float bench_biquad_coeffs[2][5] =
+{
+    { 0.02008337f, 0.04016673f, 0.02008337f, -1.56101808f, 0.64135154f },
+    { 0.06745527f, 0.13491055f, 0.06745527f, -1.14298050f, 0.41280160f },
+};
+
+static float bench_max_err(const float *a, const float *b, rt_uint32_t n)
+{
+    float err = 0;
+    for (rt_uint32_t i = 0; i < n; i++) {
+        float d = fabsf(a[i] - b[i]);
+        if (d > err) err = d;
+    }
+    return err;
+}
+
+/* 输出：每样本周期数 (0.01)、加速比、最大误差 (1e-6) */
+static void bench_report(const char *name, rt_uint64_t t_ref, rt_uint64_t t_vec, rt_uint32_t samples, float err)
+{
+    rt_uint32_t c_ref = (rt_uint32_t)(perf_to_cycles(t_ref) * 100 / samples);
+    rt_uint32_t c_vec = (rt_uint32_t)(perf_to_cycles(t_vec) * 100 / samples);
+    rt_uint32_t speedup = c_vec ? c_ref * 100 / c_vec : 0;
+
+    rt_kprintf("  %-10s %4u.%02u %4u.%02u   x%u.%02u   %u\n", name, c_ref / 100, c_ref % 100,
+               c_vec / 100, c_vec % 100, speedup / 100, speedup % 100, (rt_uint32_t)(err * 1e6f));
+}
+
+/* msh: dsp_bench [n] —— 各内核标量参考实现与 NEON 实现的耗时对比，n 为每块样本数 */
+static int dsp_bench(int argc, char **argv)
+{
+    rt_uint32_t n = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 256;
+    rt_uint64_t t0, t_ref, t_vec;
+    DspBlockStats sa, sb;
+    rt_uint32_t seed = 1;
+
+    if (n < 16 || n > BENCH_MAX_SAMPLES) n = 256;
+    n &= ~(rt_uint32_t)(BENCH_BIQUAD_CH - 1);
+
+    /* 测试信号：三角波叠加伪随机噪声，幅度与 12 位 ADC 码值相当 */
+    for (rt_uint32_t i = 0; i < n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        rt_int32_t tri = (rt_int32_t)(i % 64) - 32;
+        bench_raw[i] = (rt_int16_t)(2048 + (tri < 0 ? -tri : tri) * 40 + (rt_int32_t)((seed >> 16) & 0xFF) - 128);
+    }
+
+#if defined(__ARM_NEON)
+    rt_kprintf("DSP kernels, %u samples x %d rounds (NEON)\n", n, BENCH_ROUNDS);
+#else
+    rt_kprintf("DSP kernels, %u samples x %d rounds (no NEON, both columns scalar)\n", n, BENCH_ROUNDS);
+#endif
+    rt_kprintf("  %-10s %7s %7s   %-6s %s\n", "kernel", "ref c/s", "vec c/s", "speed", "max err e-6");
+
+    /* int16 -> float */
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_i16_to_f32_ref(bench_raw, 1, bench_ref, n, 3.3f / 4096.0f);
+    t_ref = perf_now() - t0;
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_i16_to_f32(bench_raw, 1, bench_out, n, 3.3f / 4096.0f);
+    t_vec = perf_now() - t0;
+    bench_report("i16->f32", t_ref, t_vec, n * BENCH_ROUNDS, bench_max_err(bench_ref, bench_out, n));
+    memcpy(bench_in, bench_ref, n * sizeof(float));
+
+    /* 块统计 */
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_block_stats_ref(bench_in, n, &sa);
+    t_ref = perf_now() - t0;
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_block_stats(bench_in, n, &sb);
+    t_vec = perf_now() - t0;
+    bench_report("stats", t_ref, t_vec, n * BENCH_ROUNDS, bench_max_err((float *)&sa, (float *)&sb, 4));
+
+    /* FIR：三角窗低通 */
+    float h[BENCH_FIR_TAPS], hsum = 0;
+    for (int k = 0; k < BENCH_FIR_TAPS; k++) {
+        h[k] = (float)((k < BENCH_FIR_TAPS / 2) ? k + 1 : BENCH_FIR_TAPS - k);
+        hsum += h[k];
+    }
+    for (int k = 0; k < BENCH_FIR_TAPS; k++) h[k] /= hsum;
+    dsp_fir_init(&bench_fir_a, h, BENCH_FIR_TAPS);
+    dsp_fir_init(&bench_fir_b, h, BENCH_FIR_TAPS);
+
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_fir_process_ref(&bench_fir_a, bench_in, bench_ref, n);
+    t_ref = perf_now() - t0;
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_fir_process(&bench_fir_b, bench_in, bench_out, n);
+    t_vec = perf_now() - t0;
+    bench_report("fir32", t_ref, t_vec, n * BENCH_ROUNDS, bench_max_err(bench_ref, bench_out, n));
+
+    /* FIR 抽取 */
+    rt_uint32_t out_n = 0;
+    dsp_fir_reset(&bench_fir_a);
+    dsp_fir_reset(&bench_fir_b);
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) out_n = dsp_fir_decimate_ref(&bench_fir_a, bench_in, bench_ref, n, BENCH_DECIMATE);
+    t_ref = perf_now() - t0;
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_fir_decimate(&bench_fir_b, bench_in, bench_out, n, BENCH_DECIMATE);
+    t_vec = perf_now() - t0;
+    bench_report("fir32/4", t_ref, t_vec, n * BENCH_ROUNDS, bench_max_err(bench_ref, bench_out, out_n));
+
+    /* 两级双二阶，4 通道交错 */
+    rt_uint32_t frames = n / BENCH_BIQUAD_CH;
+    dsp_biquad_init(&bench_bq_a, &bench_biquad_coeffs[0][0], 2, BENCH_BIQUAD_CH);
+    dsp_biquad_init(&bench_bq_b, &bench_biquad_coeffs[0][0], 2, BENCH_BIQUAD_CH);
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_biquad_process_ref(&bench_bq_a, bench_in, bench_ref, frames);
+    t_ref = perf_now() - t0;
+    t0 = perf_now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) dsp_biquad_process(&bench_bq_b, bench_in, bench_out, frames);
+    t_vec = perf_now() - t0;
+    bench_report("biquad2x4", t_ref, t_vec, n * BENCH_ROUNDS, bench_max_err(bench_ref, bench_out, n));
+
+    return 0;
+}
+MSH_CMD_EXPORT(dsp_bench, Benchmark DSP kernels against scalar reference);
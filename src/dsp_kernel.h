@@ -0,0 +1,68 @@
+#ifndef __DSP_KERNEL_H__
+#define __DSP_KERNEL_H__
+
+#include <rtthread.h>
+
+/*
+ * 采样块信号处理内核：块统计、FIR、双二阶 IIR 级联、FIR 抽取、int16 -> float 转换。
+ *
+ * 每个内核都有标量参考实现 (_ref 后缀)，不带后缀的版本在编译器开启 NEON (__ARM_NEON，
+ * rtconfig.py 中 -mfpu=neon-fp-armv8) 时使用 NEON 实现，否则等同于参考实现。
+ * 两者结果只有浮点累加顺序带来的差异，msh 命令 dsp_bench 对比两者的耗时和最大误差。
+ */
+#define DSP_FIR_MAX_TAPS        64
+#define DSP_BLOCK_MAX           256     /* FIR 单次内部处理的最大样本数，更长的输入分段处理 */
+#define DSP_BIQUAD_MAX_STAGES   4
+#define DSP_BIQUAD_MAX_CH       4       /* 双二阶滤波同时处理的交错通道数 */
+
+typedef struct {
+    float mean;
+    float rms;
+    float min;
+    float max;
+} DspBlockStats;
+
+typedef struct {
+    rt_uint16_t taps;
+    rt_uint16_t phase;                  /* 抽取时下一个输出之前还需跳过的输入样本数 */
+    float coeffs[DSP_FIR_MAX_TAPS];     /* 时间反序存放，coeffs[taps - 1] 对应最新样本 */
+    /* 前 taps - 1 个为历史样本，后面是本段输入 */
+    float state[DSP_FIR_MAX_TAPS - 1 + DSP_BLOCK_MAX];
+} DspFir;
+
+/* 每级系数 {b0, b1, b2, a1, a2}，a0 归一化为 1：y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2 */
+typedef struct {
+    rt_uint8_t stages;
+    rt_uint8_t channels;
+    float coeffs[DSP_BIQUAD_MAX_STAGES][5];
+    /* 转置直接 II 型状态，每级两个，按通道存放 */
+    float state[DSP_BIQUAD_MAX_STAGES][2][DSP_BIQUAD_MAX_CH];
+} DspBiquad;
+
+/* 均值 / 均方根 / 最小 / 最大，一次遍历 */
+void dsp_block_stats(const float *x, rt_uint32_t n, DspBlockStats *st);
+void dsp_block_stats_ref(const float *x, rt_uint32_t n, DspBlockStats *st);
+
+/* dst[i] = src[i * stride] * scale，用于从交错的采样块中取出单个通道 (12 位 ADC 码值可直接按 int16 传入)；
+ * stride 为 1 时走 NEON */
+void dsp_i16_to_f32(const rt_int16_t *src, rt_uint32_t stride, float *dst, rt_uint32_t n, float scale);
+void dsp_i16_to_f32_ref(const rt_int16_t *src, rt_uint32_t stride, float *dst, rt_uint32_t n, float scale);
+
+/* coeffs 按常规顺序 h[0..taps-1] 给出；taps 超过 DSP_FIR_MAX_TAPS 返回 -RT_EINVAL */
+int  dsp_fir_init(DspFir *fir, const float *coeffs, rt_uint16_t taps);
+void dsp_fir_reset(DspFir *fir);
+void dsp_fir_process(DspFir *fir, const float *in, float *out, rt_uint32_t n);
+void dsp_fir_process_ref(DspFir *fir, const float *in, float *out, rt_uint32_t n);
+
+/* FIR 抽取：只计算每 factor 个输入对应的一个输出，跨调用保持相位，返回输出个数 */
+rt_uint32_t dsp_fir_decimate(DspFir *fir, const float *in, float *out, rt_uint32_t n, rt_uint16_t factor);
+rt_uint32_t dsp_fir_decimate_ref(DspFir *fir, const float *in, float *out, rt_uint32_t n, rt_uint16_t factor);
+
+/* coeffs 为 stages * 5 个系数；channels 个通道共用系数，输入输出按帧交错 (x[i * channels + c]) */
+int  dsp_biquad_init(DspBiquad *bq, const float *coeffs, rt_uint8_t stages, rt_uint8_t channels);
+void dsp_biquad_reset(DspBiquad *bq);
+/* n 为帧数，in 与 out 可以相同；NEON 版本把各通道放在向量的不同通道上并行计算 */
+void dsp_biquad_process(DspBiquad *bq, const float *in, float *out, rt_uint32_t n);
+void dsp_biquad_process_ref(DspBiquad *bq, const float *in, float *out, rt_uint32_t n);
+
+#endif
@@ -0,0 +1,464 @@
+#include <rtthread.h>
+#include <board.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fft_feature.h"
+#include "dsp_kernel.h"
+#include "perf_counter.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define FFT_HALF_MAX    (FFT_SIZE_MAX / 2)
+#define FFT_PI          3.14159265358979f
+
+static struct rt_mutex fft_lock;
+static rt_bool_t fft_inited = RT_FALSE;
+
+static rt_uint16_t fft_n;               /* 实数 FFT 点数 N */
+static rt_uint16_t fft_m;               /* 复数 FFT 点数 M = N / 2 */
+static rt_uint8_t fft_log2m;
+static float fft_s1, fft_s2;            /* 窗函数之和、平方和，用于幅值和功率归一化 */
+
+/* W_N^k = cos(2πk/N) - j sin(2πk/N)，k < M，拆分步骤用 */
+static float fft_w_re[FFT_HALF_MAX];
+static float fft_w_im[FFT_HALF_MAX];
+/* 复数 FFT 各级旋转因子连续存放：半长 h 的一级 W_2h^k (k < h) 位于 [h - 1, 2h - 1) */
+static float fft_tw_re[FFT_HALF_MAX];
+static float fft_tw_im[FFT_HALF_MAX];
+static rt_uint16_t fft_bitrev[FFT_HALF_MAX];
+static float fft_window[FFT_SIZE_MAX];
+
+static float fft_re[FFT_HALF_MAX];
+static float fft_im[FFT_HALF_MAX];
+static float fft_mag2[FFT_HALF_MAX + 1];    /* 单边功率谱 |X[k]|²，k = 0..N/2 */
+
+static float fft_frame[FFT_SIZE_MAX];
+static rt_uint16_t fft_fill;
+static rt_uint32_t fft_rate;
+
+/* 旋转因子由 TFU 计算；角度在 (-π, 0]，在 TFU 的输入范围内 */
+static void fft_sincos(float angle, float *s, float *c)
+{
+#if BSP_CFG_USE_TFU_MATHLIB
+    __sincosf(angle, s, c);
+#else
+    *s = sinf(angle);
+    *c = cosf(angle);
+#endif
+}
+
+static void fft_tables(rt_uint16_t n)
+{
+    rt_uint16_t m = n / 2;
+
+    fft_n = n;
+    fft_m = m;
+    for (fft_log2m = 0; (1U << fft_log2m) < m; fft_log2m++);
+
+    for (rt_uint16_t k = 0; k < m; k++) {
+        float s, c;
+        fft_sincos(-2.0f * FFT_PI * k / n, &s, &c);
+        fft_w_re[k] = c;
+        fft_w_im[k] = s;
+    }
+
+    /* W_2h^k = W_N^(k * M / h) */
+    for (rt_uint16_t h = 1; h < m; h <<= 1) {
+        for (rt_uint16_t k = 0; k < h; k++) {
+            fft_tw_re[h - 1 + k] = fft_w_re[k * (m / h)];
+            fft_tw_im[h - 1 + k] = fft_w_im[k * (m / h)];
+        }
+    }
+
+    for (rt_uint16_t i = 0; i < m; i++) {
+        rt_uint16_t r = 0;
+        for (rt_uint8_t b = 0; b < fft_log2m; b++) r |= ((i >> b) & 1U) << (fft_log2m - 1 - b);
+        fft_bitrev[i] = r;
+    }
+
+    /* Hann 窗：0.5 - 0.5 cos(2πi/N)，后半周期 cos 取反 */
+    fft_s1 = fft_s2 = 0;
+    for (rt_uint16_t i = 0; i < n; i++) {
+        float c = (i < m) ? fft_w_re[i] : -fft_w_re[i - m];
+        float w = 0.5f - 0.5f * c;
+        fft_window[i] = w;
+        fft_s1 += w;
+        fft_s2 += w * w;
+    }
+}
+
+/* 去直流、加窗，偶数/奇数样本作为复数的实部/虚部按位反序装入；同时累计去直流后的平方和与峰值 */
+static void fft_load(const float *frame, float mean, float *sq, float *peak)
+{
+    float s = 0, p = 0;
+
+    for (rt_uint16_t i = 0; i < fft_m; i++) {
+        rt_uint16_t j = fft_bitrev[i];
+        float a = frame[2 * i] - mean, b = frame[2 * i + 1] - mean;
+        s += a * a + b * b;
+        if (fabsf(a) > p) p = fabsf(a);
+        if (fabsf(b) > p) p = fabsf(b);
+        fft_re[j] = a * fft_window[2 * i];
+        fft_im[j] = b * fft_window[2 * i + 1];
+    }
+    if (sq) *sq = s;
+    if (peak) *peak = p;
+}
+
+static void fft_stage_ref(rt_uint16_t h)
+{
+    const float *wr = &fft_tw_re[h - 1], *wi = &fft_tw_im[h - 1];
+
+    for (rt_uint16_t g = 0; g < fft_m; g += 2 * h) {
+        for (rt_uint16_t k = 0; k < h; k++) {
+            rt_uint16_t a = g + k, b = a + h;
+            float tr = fft_re[b] * wr[k] - fft_im[b] * wi[k];
+            float ti = fft_re[b] * wi[k] + fft_im[b] * wr[k];
+            fft_re[b] = fft_re[a] - tr;
+            fft_im[b] = fft_im[a] - ti;
+            fft_re[a] += tr;
+            fft_im[a] += ti;
+        }
+    }
+}
+
+#if defined(__ARM_NEON)
+/* 同一组内相邻 4 个蝶形的旋转因子连续，一次处理 4 个 */
+static void fft_stage_neon(rt_uint16_t h)
+{
+    const float *wr = &fft_tw_re[h - 1], *wi = &fft_tw_im[h - 1];
+
+    for (rt_uint16_t g = 0; g < fft_m; g += 2 * h) {
+        float *ar = &fft_re[g], *ai = &fft_im[g], *br = &fft_re[g + h], *bi = &fft_im[g + h];
+        for (rt_uint16_t k = 0; k < h; k += 4) {
+            float32x4_t vwr = vld1q_f32(&wr[k]), vwi = vld1q_f32(&wi[k]);
+            float32x4_t vbr = vld1q_f32(&br[k]), vbi = vld1q_f32(&bi[k]);
+            float32x4_t var = vld1q_f32(&ar[k]), vai = vld1q_f32(&ai[k]);
+            float32x4_t tr = vmlsq_f32(vmulq_f32(vbr, vwr), vbi, vwi);
+            float32x4_t ti = vmlaq_f32(vmulq_f32(vbr, vwi), vbi, vwr);
+            vst1q_f32(&br[k], vsubq_f32(var, tr));
+            vst1q_f32(&bi[k], vsubq_f32(vai, ti));
+            vst1q_f32(&ar[k], vaddq_f32(var, tr));
+            vst1q_f32(&ai[k], vaddq_f32(vai, ti));
+        }
+    }
+}
+#endif
+
+static void fft_complex(rt_bool_t vec)
+{
+    for (rt_uint16_t h = 1; h < fft_m; h <<= 1) {
+#if defined(__ARM_NEON)
+        if (vec && h >= 4) {
+            fft_stage_neon(h);
+            continue;
+        }
+#else
+        (void)vec;
+#endif
+        fft_stage_ref(h);
+    }
+}
+
+/* M 点复数结果拆分为 N 点实数序列的单边功率谱 */
+static void fft_split(void)
+{
+    rt_uint16_t m = fft_m;
+
+    fft_mag2[0] = (fft_re[0] + fft_im[0]) * (fft_re[0] + fft_im[0]);
+    fft_mag2[m] = (fft_re[0] - fft_im[0]) * (fft_re[0] - fft_im[0]);
+
+    for (rt_uint16_t k = 1; k < m; k++) {
+        float zr = fft_re[k], zi = fft_im[k], cr = fft_re[m - k], ci = fft_im[m - k];
+        /* Fe = (Z[k] + conj(Z[M-k])) / 2，Fo = -j (Z[k] - conj(Z[M-k])) / 2 */
+        float er = 0.5f * (zr + cr), ei = 0.5f * (zi - ci);
+        float or_ = 0.5f * (zi + ci), oi = -0.5f * (zr - cr);
+        float xr = er + fft_w_re[k] * or_ - fft_w_im[k] * oi;
+        float xi = ei + fft_w_re[k] * oi + fft_w_im[k] * or_;
+        fft_mag2[k] = xr * xr + xi * xi;
+    }
+}
+
+static void fft_features(const float *frame, rt_uint32_t rate, FftFeatures *out)
+{
+    DspBlockStats st;
+    rt_uint16_t n = fft_n, m = fft_m;
+    float sq;
+
+    memset(out, 0, sizeof(*out));
+    out->size = n;
+    out->rate = rate;
+
+    dsp_block_stats(frame, n, &st);
+    fft_load(frame, st.mean, &sq, &out->peak);
+    out->rms = sqrtf(sq / n);
+    out->crest = (out->rms > 0) ? out->peak / out->rms : 0.0f;
+
+    fft_complex(RT_TRUE);
+    fft_split();
+
+    /* 主频：最大功率谱线，相邻三点幅值抛物线插值修正频率 */
+    rt_uint16_t kmax = 1;
+    for (rt_uint16_t k = 2; k < m; k++) {
+        if (fft_mag2[k] > fft_mag2[kmax]) kmax = k;
+    }
+    float a = sqrtf(fft_mag2[kmax - 1]), b = sqrtf(fft_mag2[kmax]), c = sqrtf(fft_mag2[kmax + 1]);
+    float den = a - 2 * b + c;
+    float delta = (den != 0) ? 0.5f * (a - c) / den : 0.0f;
+    out->dom_freq = (kmax + delta) * rate / n;
+    out->dom_amp = 2.0f * b / fft_s1;
+
+    /* Parseval：方差约等于 2 / (N * Σw²) * Σ|X[k]|² (k ≥ 1) */
+    float scale = 2.0f / ((float)n * fft_s2);
+    for (int band = 0; band < FFT_FEATURE_BANDS; band++) {
+        rt_uint16_t k0 = 1 + (rt_uint32_t)band * m / FFT_FEATURE_BANDS;
+        rt_uint16_t k1 = 1 + (rt_uint32_t)(band + 1) * m / FFT_FEATURE_BANDS;
+        float e = 0;
+        for (rt_uint16_t k = k0; k < k1 && k <= m; k++) e += fft_mag2[k];
+        out->band_rms[band] = sqrtf(e * scale);
+    }
+}
+
+static void fft_lock_init(void)
+{
+    if (!fft_inited) {
+        rt_mutex_init(&fft_lock, "fft", RT_IPC_FLAG_PRIO);
+        fft_inited = RT_TRUE;
+    }
+}
+
+int fft_feature_init(rt_uint16_t size)
+{
+    if (size < FFT_SIZE_MIN || size > FFT_SIZE_MAX || (size & (size - 1))) return -RT_EINVAL;
+
+    fft_lock_init();
+    rt_mutex_take(&fft_lock, RT_WAITING_FOREVER);
+    fft_tables(size);
+    fft_fill = 0;
+    rt_mutex_release(&fft_lock);
+    return RT_EOK;
+}
+
+rt_uint16_t fft_feature_size(void)
+{
+    return fft_n;
+}
+
+void fft_feature_compute(const float *frame, rt_uint32_t rate, FftFeatures *out)
+{
+    rt_mutex_take(&fft_lock, RT_WAITING_FOREVER);
+    fft_features(frame, rate, out);
+    rt_mutex_release(&fft_lock);
+}
+
+int fft_feature_push(const float *x, rt_uint32_t n, rt_uint32_t rate, FftFeatures *out)
+{
+    int done = 0;
+
+    if (!fft_inited || fft_n == 0) return 0;
+
+    rt_mutex_take(&fft_lock, RT_WAITING_FOREVER);
+    if (rate != fft_rate) {
+        fft_rate = rate;
+        fft_fill = 0;
+    }
+
+    while (n) {
+        rt_uint32_t take = fft_n - fft_fill;
+        if (take > n) take = n;
+        memcpy(&fft_frame[fft_fill], x, take * sizeof(float));
+        fft_fill += take;
+        x += take;
+        n -= take;
+
+        if (fft_fill == fft_n) {
+            fft_features(fft_frame, rate, out);
+            fft_fill = 0;
+            done = 1;
+        }
+    }
+    rt_mutex_release(&fft_lock);
+    return done;
+}
+
+/* ---------- 校验与基准 ---------- */
+
+#define FFT_CHECK_PERIOD    50      /* 测试信号三角波周期 (样本) */
+#define FFT_BENCH_ROUNDS    8
+
+/* 测试命令的私有帧，不动处理线程正在凑的 fft_frame / fft_fill */
+static float fft_test_buf[FFT_SIZE_MAX];
+
+/*
+ * 测试帧：12 位码值，三角波 + 伪随机噪声，整数运算生成，主机侧 scripts/fft_check.py 可逐位复现
+ */
+static void fft_test_frame(float *frame, rt_uint16_t n, rt_uint16_t period)
+{
+    rt_uint32_t seed = 1;
+
+    for (rt_uint16_t i = 0; i < n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        rt_int32_t ph = (rt_int32_t)(i % period) * 2 * 1600 / period - 1600;
+        rt_int32_t code = 2048 + (ph < 0 ? -ph : ph) - 800 + (rt_int32_t)((seed >> 16) & 0x3F) - 32;
+        frame[i] = (float)code * (3.3f / 4096.0f);
+    }
+}
+
+/* 持锁临时换用 n 点的表，返回原帧长交给 fft_test_end 恢复；实时帧长不变，未凑满的实时帧保留 */
+static rt_uint16_t fft_test_begin(rt_uint16_t n)
+{
+    fft_lock_init();
+    rt_mutex_take(&fft_lock, RT_WAITING_FOREVER);
+    rt_uint16_t prev = fft_n;
+    fft_tables(n);
+    return prev;
+}
+
+static void fft_test_end(rt_uint16_t prev)
+{
+    if (prev == 0) {
+        fft_n = 0;      /* 尚未设定帧长，保持 fft_feature_push 不工作 */
+    } else if (prev != fft_n) {
+        fft_tables(prev);
+    }
+    rt_mutex_release(&fft_lock);
+}
+
+static void fft_print_hex(const char *tag, const float *v, rt_uint32_t count)
+{
+    for (rt_uint32_t i = 0; i < count; i += 8) {
+        rt_kprintf("FFTCHK %s %u", tag, i);
+        for (rt_uint32_t j = i; j < i + 8 && j < count; j++) {
+            rt_uint32_t bits;
+            memcpy(&bits, &v[j], sizeof(bits));
+            rt_kprintf(" %08X", bits);
+        }
+        rt_kprintf("\n");
+    }
+}
+
+/* 输出测试帧的功率谱和特征 (IEEE754 十六进制)，由主机侧对照双精度参考检查精度 */
+static void fft_check(rt_uint16_t size, rt_uint32_t rate)
+{
+    static FftFeatures f;
+    rt_uint16_t prev = fft_test_begin(size);
+
+    fft_test_frame(fft_test_buf, size, FFT_CHECK_PERIOD);
+
+    rt_uint64_t t0 = perf_now();
+    fft_features(fft_test_buf, rate, &f);
+    rt_uint64_t t = perf_now() - t0;
+
+    rt_kprintf("FFTCHK N %u RATE %u PERIOD %u\n", size, rate, FFT_CHECK_PERIOD);
+    fft_print_hex("MAG2", fft_mag2, fft_m + 1);
+    fft_print_hex("FEAT", &f.rms, 5 + FFT_FEATURE_BANDS);
+    rt_kprintf("FFTCHK TIME %u cycles\n", (rt_uint32_t)perf_to_cycles(t));
+    fft_test_end(prev);
+}
+
+/* 各帧长：TFU 生成旋转因子、标量 FFT、NEON FFT、完整特征提取的耗时 */
+static void fft_bench(rt_uint32_t rate)
+{
+    static FftFeatures f;
+    static float ref_re[FFT_HALF_MAX], ref_im[FFT_HALF_MAX];
+
+    rt_kprintf("%-5s %9s %9s %9s %6s %9s %s\n", "N", "tables", "fft ref", "fft neon", "speed", "features", "max diff e-6");
+    for (rt_uint32_t n = FFT_SIZE_MIN; n <= FFT_SIZE_MAX; n <<= 1) {
+        /* 每个帧长单独持锁，之间处理线程可以继续凑实时帧；表再生成一次计时，不含等锁 */
+        rt_uint16_t prev = fft_test_begin((rt_uint16_t)n);
+        rt_uint64_t t0 = perf_now();
+        fft_tables((rt_uint16_t)n);
+        rt_uint64_t t_tab = perf_now() - t0;
+
+        fft_test_frame(fft_test_buf, (rt_uint16_t)n, FFT_CHECK_PERIOD);
+        rt_uint64_t t_ref = 0, t_vec = 0;
+        for (int r = 0; r < FFT_BENCH_ROUNDS; r++) {
+            fft_load(fft_test_buf, 0, RT_NULL, RT_NULL);
+            t0 = perf_now();
+            fft_complex(RT_FALSE);
+            t_ref += perf_now() - t0;
+        }
+        memcpy(ref_re, fft_re, fft_m * sizeof(float));
+        memcpy(ref_im, fft_im, fft_m * sizeof(float));
+        for (int r = 0; r < FFT_BENCH_ROUNDS; r++) {
+            fft_load(fft_test_buf, 0, RT_NULL, RT_NULL);
+            t0 = perf_now();
+            fft_complex(RT_TRUE);
+            t_vec += perf_now() - t0;
+        }
+
+        float diff = 0;
+        for (rt_uint16_t i = 0; i < fft_m; i++) {
+            float d = fabsf(ref_re[i] - fft_re[i]) + fabsf(ref_im[i] - fft_im[i]);
+            if (d > diff) diff = d;
+        }
+
+        t0 = perf_now();
+        fft_features(fft_test_buf, rate, &f);
+        rt_uint64_t t_feat = perf_now() - t0;
+        fft_test_end(prev);
+
+        rt_uint32_t c_ref = (rt_uint32_t)(perf_to_cycles(t_ref) / FFT_BENCH_ROUNDS);
+        rt_uint32_t c_vec = (rt_uint32_t)(perf_to_cycles(t_vec) / FFT_BENCH_ROUNDS);
+        rt_uint32_t speedup = c_vec ? c_ref * 100 / c_vec : 0;
+        rt_kprintf("%-5u %9u %9u %9u x%u.%02u %9u %u\n", n, (rt_uint32_t)perf_to_cycles(t_tab), c_ref, c_vec,
+                   speedup / 100, speedup % 100, (rt_uint32_t)perf_to_cycles(t_feat), (rt_uint32_t)(diff * 1e6f));
+    }
+    rt_kprintf("(cycles; features = detrend + window + NEON FFT + split + features)\n");
+}
+
+static void fft_print_features(const FftFeatures *f)
+{
+    rt_kprintf("N %u @ %u Hz: rms %d peak %d crest %d.%02d (mV)\n", f->size, f->rate, (int)(f->rms * 1000),
+               (int)(f->peak * 1000), (int)f->crest, (int)(f->crest * 100) % 100);
+    rt_kprintf("  dominant %d.%01d Hz, amp %d mV\n", (int)f->dom_freq, (int)(f->dom_freq * 10) % 10,
+               (int)(f->dom_amp * 1000));
+    for (int b = 0; b < FFT_FEATURE_BANDS; b++) {
+        rt_kprintf("  band %d: %d uV\n", b, (int)(f->band_rms[b] * 1e6f));
+    }
+}
+
+/* msh: fft_feature size <n> | check [n] [rate] | bench [rate] | demo [n] [rate] */
+static int fft_feature(int argc, char **argv)
+{
+    rt_uint32_t rate = 1000;
+
+    if (argc >= 3 && strcmp(argv[1], "size") == 0) {
+        int ret = fft_feature_init((rt_uint16_t)atoi(argv[2]));
+        if (ret != RT_EOK) rt_kprintf("size must be a power of 2 in %d..%d\n", FFT_SIZE_MIN, FFT_SIZE_MAX);
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        rt_uint32_t n = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : FFT_SIZE_DEFAULT;
+        if (argc >= 4) rate = (rt_uint32_t)atoi(argv[3]);
+        if (n < FFT_SIZE_MIN || n > FFT_SIZE_MAX || (n & (n - 1))) return -RT_EINVAL;
+        fft_check((rt_uint16_t)n, rate);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        if (argc >= 3) rate = (rt_uint32_t)atoi(argv[2]);
+        fft_bench(rate);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "demo") == 0) {
+        static FftFeatures f;
+        rt_uint32_t n = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : FFT_SIZE_DEFAULT;
+        if (argc >= 4) rate = (rt_uint32_t)atoi(argv[3]);
+        if (n < FFT_SIZE_MIN || n > FFT_SIZE_MAX || (n & (n - 1))) return -RT_EINVAL;
+
+        rt_uint16_t prev = fft_test_begin((rt_uint16_t)n);
+        fft_test_frame(fft_test_buf, (rt_uint16_t)n, FFT_CHECK_PERIOD);
+        fft_features(fft_test_buf, rate, &f);
+        fft_test_end(prev);
+        fft_print_features(&f);
+        return 0;
+    }
+
+    rt_kprintf("FFT size %u\n", fft_n);
+    rt_kprintf("Usage: fft_feature size <n>\n");
+    rt_kprintf("       fft_feature check [n] [rate]   # spectrum dump for scripts/fft_check.py\n");
+    rt_kprintf("       fft_feature bench [rate]\n");
+    rt_kprintf("       fft_feature demo [n] [rate]\n");
+    return 0;
+}
+MSH_CMD_EXPORT(fft_feature, FFT vibration feature extraction);
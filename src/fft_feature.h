@@ -0,0 +1,40 @@
+#ifndef __FFT_FEATURE_H__
+#define __FFT_FEATURE_H__
+
+#include <rtthread.h>
+
+/*
+ * 振动频谱特征：ADC 块流中单个通道的样本凑满一帧 (FFT_SIZE_MIN..FFT_SIZE_MAX，2 的幂) 后，
+ * 去直流、加 Hann 窗做实数 FFT，输出固定长度的特征向量，代替原始波形上报。
+ *
+ * 实数 FFT 由 N/2 点复数 FFT (基 2，分离的实部/虚部数组，NEON 每次 4 个蝶形) 加拆分步骤得到。
+ * 旋转因子和窗函数在 fft_feature_init 中由 TFU (__sincosf) 生成，之后只查表。
+ * 表和缓冲按 FFT_SIZE_MAX 静态分配 (约 110KB，含测试命令的私有帧)，只有一个实例。
+ */
+#define FFT_SIZE_MIN            256
+#define FFT_SIZE_MAX            4096
+#define FFT_SIZE_DEFAULT        1024
+#define FFT_FEATURE_BANDS       8       /* 0..fs/2 等宽频带 */
+
+typedef struct {
+    rt_uint16_t size;           /* 帧长 N */
+    rt_uint32_t rate;           /* 采样率 Hz */
+    float rms;                  /* 去直流后的时域均方根 */
+    float peak;                 /* 去直流后的绝对值峰值 */
+    float crest;                /* 峰值因子 peak / rms */
+    float dom_freq;             /* 主频 Hz (不含直流，抛物线插值) */
+    float dom_amp;              /* 主频正弦幅值 */
+    float band_rms[FFT_FEATURE_BANDS];  /* 各频带均方根，平方和约等于 rms² */
+} FftFeatures;
+
+/* 设定帧长并生成旋转因子和窗函数，丢弃未凑满的帧；size 非法返回 -RT_EINVAL */
+int  fft_feature_init(rt_uint16_t size);
+rt_uint16_t fft_feature_size(void);
+
+/* 追加 n 个样本 (采样率 rate)，凑满一帧时计算特征写入 out 并返回 1，否则返回 0；采样率变化时重新开始一帧 */
+int  fft_feature_push(const float *x, rt_uint32_t n, rt_uint32_t rate, FftFeatures *out);
+
+/* 直接对一帧 (fft_feature_size() 个样本) 计算特征 */
+void fft_feature_compute(const float *frame, rt_uint32_t rate, FftFeatures *out);
+
+#endif
@@ -74,8 +74,8 @@ static void kawaii_mqtt_demo(void *parameter)
     
     /* 设置超时和缓冲区 */
     mqtt_set_cmd_timeout(kawaii_client, 5000);
-    mqtt_set_read_buf_size(kawaii_client, 2048);
-    mqtt_set_write_buf_size(kawaii_client, 2048);
+    mqtt_set_read_buf_size(kawaii_client, ONENET_MQTT_BUF_SIZE);
+    mqtt_set_write_buf_size(kawaii_client, ONENET_MQTT_BUF_SIZE);
     mqtt_set_keep_alive_interval(kawaii_client, 60); /* 设置心跳间隔为 60秒 */
     
     /* 设置自动重连回调和重试间隔 */
@@ -0,0 +1,692 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include "isotp.h"
+#include "can_tx.h"
+#include "perf_counter.h"
+
+#define ISOTP_PCI_SF            0x0
+#define ISOTP_PCI_FF            0x1
+#define ISOTP_PCI_CF            0x2
+#define ISOTP_PCI_FC            0x3
+
+#define ISOTP_FS_CTS            0
+#define ISOTP_FS_WAIT           1
+#define ISOTP_FS_OVFLW          2
+
+#define ISOTP_CLASSIC_DL        8
+#define ISOTP_FD_DL             64
+#define ISOTP_FF_DL_MAX_SHORT   4095    /* 超过时使用 32 位 FF_DL 转义 */
+
+typedef enum {
+    ISOTP_TX_IDLE = 0,
+    ISOTP_TX_WAIT_FC,
+    ISOTP_TX_SEND,
+} IsoTpTxState;
+
+typedef struct {
+    rt_uint8_t  used;
+    rt_uint8_t  channel;
+    rt_uint8_t  flags;          /* ISOTP_FLAG_* */
+    rt_uint8_t  bs;             /* 本端流控帧的 BS / STmin */
+    rt_uint8_t  stmin;
+    rt_uint32_t rx_id;
+    rt_uint32_t tx_id;
+
+    /* 接收会话 */
+    rt_uint8_t *rx_buf;         /* 非 RT_NULL 表示正在组包 */
+    rt_uint32_t rx_len;
+    rt_uint32_t rx_pos;
+    rt_uint8_t  rx_sn;
+    rt_uint8_t  rx_bs_cnt;
+    rt_uint8_t  rx_frame_flags;
+    rt_uint64_t rx_ts;
+    rt_tick_t   rx_deadline;
+
+    /* 发送会话 */
+    rt_uint8_t  tx_state;
+    rt_uint8_t  tx_sn;
+    rt_uint8_t  tx_bs;          /* 对端流控帧的 BS，0 表示不再等待流控 */
+    rt_uint8_t  tx_block_left;
+    rt_uint8_t  tx_wft;
+    rt_uint32_t tx_stmin_us;
+    rt_uint8_t *tx_buf;
+    rt_uint32_t tx_len;
+    rt_uint32_t tx_pos;
+    rt_uint64_t tx_next_us;
+    rt_tick_t   tx_deadline;
+
+    IsoTpStats  stats;
+} IsoTpBinding;
+
+static IsoTpBinding isotp_bindings[ISOTP_MAX_BINDINGS];
+static rt_uint8_t isotp_num;    /* 已绑定数，为 0 时 isotp_input 不加锁直接返回 */
+
+/* 缓冲池：按块分配连续缓冲，位图记录占用 */
+static rt_uint8_t isotp_pool[ISOTP_POOL_BLOCKS * ISOTP_BLOCK_SIZE] __attribute__((aligned(8)));
+static rt_uint32_t isotp_pool_map;
+static rt_uint8_t isotp_pool_high;
+
+static IsoTpMessage isotp_done[ISOTP_DONE_QUEUE];
+static rt_uint32_t isotp_done_head;
+static rt_uint32_t isotp_done_tail;
+static rt_uint32_t isotp_done_drop;
+
+static struct rt_mutex isotp_lock;
+static rt_bool_t isotp_inited = RT_FALSE;
+
+static void isotp_init(void)
+{
+    if (!isotp_inited) {
+        rt_mutex_init(&isotp_lock, "isotp", RT_IPC_FLAG_PRIO);
+        isotp_inited = RT_TRUE;
+    }
+}
+
+rt_inline rt_uint32_t pool_blocks(rt_uint32_t len)
+{
+    return (ISOTP_HEADROOM + len + ISOTP_BLOCK_SIZE - 1) / ISOTP_BLOCK_SIZE;
+}
+
+/* 分配可容纳 len 字节数据的连续缓冲，返回数据起始地址 */
+static rt_uint8_t *pool_alloc(rt_uint32_t len)
+{
+    rt_uint32_t n = pool_blocks(len);
+    rt_uint32_t mask;
+
+    if (len > ISOTP_MAX_LEN) return RT_NULL;
+    mask = (n >= 32) ? 0xFFFFFFFFUL : ((1UL << n) - 1);
+
+    for (rt_uint32_t first = 0; first + n <= ISOTP_POOL_BLOCKS; first++) {
+        if (isotp_pool_map & (mask << first)) continue;
+
+        isotp_pool_map |= mask << first;
+        rt_uint8_t used = 0;
+        for (rt_uint32_t m = isotp_pool_map; m; m &= m - 1) used++;
+        if (used > isotp_pool_high) isotp_pool_high = used;
+        return &isotp_pool[first * ISOTP_BLOCK_SIZE + ISOTP_HEADROOM];
+    }
+    return RT_NULL;
+}
+
+static void pool_free(rt_uint8_t *data, rt_uint32_t len)
+{
+    rt_uint32_t first = (rt_uint32_t)(data - ISOTP_HEADROOM - isotp_pool) / ISOTP_BLOCK_SIZE;
+    rt_uint32_t n = pool_blocks(len);
+
+    isotp_pool_map &= ~(((n >= 32) ? 0xFFFFFFFFUL : ((1UL << n) - 1)) << first);
+}
+
+/* 发送一帧，数据补齐到帧长 (经典帧 8 字节，CAN-FD 补到合法 DLC 长度) */
+static int isotp_tx_frame(IsoTpBinding *b, const rt_uint8_t *data, rt_uint8_t len, rt_uint8_t prio)
+{
+    static const rt_uint8_t fd_lengths[] = { 8, 12, 16, 20, 24, 32, 48, 64 };
+    CanFrame f;
+    rt_uint8_t dl = ISOTP_CLASSIC_DL;
+
+    f.id = b->tx_id;
+    f.flags = (b->flags & ISOTP_FLAG_EXT) ? CAN_FRAME_FLAG_EXT : 0;
+    f.channel = b->channel;
+    if (b->flags & ISOTP_FLAG_FD) {
+        f.flags |= CAN_FRAME_FLAG_FD | CAN_FRAME_FLAG_BRS;
+        for (int k = 0; fd_lengths[k] < len; k++) dl = fd_lengths[k + 1];
+    }
+    memcpy(f.data, data, len);
+    memset(f.data + len, ISOTP_PAD_BYTE, dl - len);
+    f.len = dl;
+
+    return can_tx_send(b->channel, &f, prio);
+}
+
+static void isotp_send_fc(IsoTpBinding *b, rt_uint8_t fs)
+{
+    rt_uint8_t fc[3] = { (ISOTP_PCI_FC << 4) | fs, b->bs, b->stmin };
+
+    /* 流控帧决定对端何时继续发送，优先于普通帧 */
+    isotp_tx_frame(b, fc, sizeof(fc), CAN_TX_PRIO_HIGH);
+}
+
+static void isotp_rx_abort(IsoTpBinding *b)
+{
+    if (b->rx_buf == RT_NULL) return;
+
+    pool_free(b->rx_buf, b->rx_len);
+    b->rx_buf = RT_NULL;
+    b->stats.rx_errors++;
+}
+
+static void isotp_tx_finish(IsoTpBinding *b, rt_bool_t ok)
+{
+    pool_free(b->tx_buf, b->tx_len);
+    b->tx_buf = RT_NULL;
+    b->tx_state = ISOTP_TX_IDLE;
+    if (ok) {
+        b->stats.tx_msgs++;
+    } else {
+        b->stats.tx_errors++;
+    }
+}
+
+/* 发出 SF 或 FF，buf 为缓冲池中的数据，所有权转给发送会话 */
+static void isotp_tx_start(IsoTpBinding *b, rt_uint8_t *buf, rt_uint32_t len)
+{
+    rt_uint8_t frame[ISOTP_FD_DL];
+    rt_uint8_t dl = (b->flags & ISOTP_FLAG_FD) ? ISOTP_FD_DL : ISOTP_CLASSIC_DL;
+    rt_uint32_t off;
+
+    b->tx_buf = buf;
+    b->tx_len = len;
+
+    if (len <= 7) {
+        frame[0] = (ISOTP_PCI_SF << 4) | (rt_uint8_t)len;
+        memcpy(frame + 1, buf, len);
+        isotp_tx_finish(b, isotp_tx_frame(b, frame, (rt_uint8_t)(1 + len), CAN_TX_PRIO_NORMAL) == RT_EOK);
+        return;
+    }
+    if (len <= (rt_uint32_t)dl - 2 && dl > ISOTP_CLASSIC_DL) {
+        frame[0] = ISOTP_PCI_SF << 4;
+        frame[1] = (rt_uint8_t)len;
+        memcpy(frame + 2, buf, len);
+        isotp_tx_finish(b, isotp_tx_frame(b, frame, (rt_uint8_t)(2 + len), CAN_TX_PRIO_NORMAL) == RT_EOK);
+        return;
+    }
+
+    if (len <= ISOTP_FF_DL_MAX_SHORT) {
+        frame[0] = (ISOTP_PCI_FF << 4) | (rt_uint8_t)(len >> 8);
+        frame[1] = (rt_uint8_t)len;
+        off = 2;
+    } else {
+        frame[0] = ISOTP_PCI_FF << 4;
+        frame[1] = 0;
+        frame[2] = (rt_uint8_t)(len >> 24);
+        frame[3] = (rt_uint8_t)(len >> 16);
+        frame[4] = (rt_uint8_t)(len >> 8);
+        frame[5] = (rt_uint8_t)len;
+        off = 6;
+    }
+    memcpy(frame + off, buf, dl - off);
+    if (isotp_tx_frame(b, frame, dl, CAN_TX_PRIO_NORMAL) != RT_EOK) {
+        isotp_tx_finish(b, RT_FALSE);
+        return;
+    }
+
+    b->tx_pos = dl - off;
+    b->tx_sn = 1;
+    b->tx_wft = 0;
+    b->tx_state = ISOTP_TX_WAIT_FC;
+    b->tx_deadline = rt_tick_get() + rt_tick_from_millisecond(ISOTP_TIMEOUT_MS);
+}
+
+/* 按对端流控参数发送连续帧，直到块结束、STmin 未到或 can_tx 队列积压 */
+static void isotp_tx_pump(IsoTpBinding *b, rt_uint64_t now_us)
+{
+    rt_uint8_t frame[ISOTP_FD_DL];
+    rt_uint32_t max = ((b->flags & ISOTP_FLAG_FD) ? ISOTP_FD_DL : ISOTP_CLASSIC_DL) - 1;
+
+    while (b->tx_state == ISOTP_TX_SEND) {
+        if (now_us < b->tx_next_us) return;
+        if (b->tx_stmin_us == 0 && can_tx_pending(b->channel) >= ISOTP_TX_BURST) return;
+
+        rt_uint32_t n = b->tx_len - b->tx_pos;
+        if (n > max) n = max;
+        frame[0] = (ISOTP_PCI_CF << 4) | b->tx_sn;
+        memcpy(frame + 1, b->tx_buf + b->tx_pos, n);
+        /* can_tx 队列满时下次轮询重试 */
+        if (isotp_tx_frame(b, frame, (rt_uint8_t)(1 + n), CAN_TX_PRIO_NORMAL) != RT_EOK) return;
+
+        b->tx_pos += n;
+        b->tx_sn = (b->tx_sn + 1) & 0x0F;
+
+        if (b->tx_pos >= b->tx_len) {
+            isotp_tx_finish(b, RT_TRUE);
+            return;
+        }
+        if (b->tx_bs && --b->tx_block_left == 0) {
+            b->tx_state = ISOTP_TX_WAIT_FC;
+            b->tx_deadline = rt_tick_get() + rt_tick_from_millisecond(ISOTP_TIMEOUT_MS);
+            return;
+        }
+        b->tx_next_us = now_us + b->tx_stmin_us;
+    }
+}
+
+static void isotp_rx_flow_control(IsoTpBinding *b, const CanFrame *f)
+{
+    if (b->tx_state != ISOTP_TX_WAIT_FC || f->len < 3) return;
+
+    switch (f->data[0] & 0x0F) {
+    case ISOTP_FS_CTS: {
+        rt_uint8_t st = f->data[2];
+        b->tx_bs = f->data[1];
+        b->tx_block_left = b->tx_bs;
+        /* 0x00-0x7F 为 ms，0xF1-0xF9 为 100-900 us，保留值按最大值处理 */
+        if (st <= 0x7F) {
+            b->tx_stmin_us = st * 1000UL;
+        } else if (st >= 0xF1 && st <= 0xF9) {
+            b->tx_stmin_us = (st - 0xF0) * 100UL;
+        } else {
+            b->tx_stmin_us = 0x7F * 1000UL;
+        }
+        b->tx_wft = 0;
+        b->tx_next_us = 0;
+        b->tx_state = ISOTP_TX_SEND;
+        break;
+    }
+    case ISOTP_FS_WAIT:
+        if (++b->tx_wft > ISOTP_MAX_WFT) {
+            isotp_tx_finish(b, RT_FALSE);
+        } else {
+            b->tx_deadline = rt_tick_get() + rt_tick_from_millisecond(ISOTP_TIMEOUT_MS);
+        }
+        break;
+    default:    /* 溢出或非法流控状态 */
+        isotp_tx_finish(b, RT_FALSE);
+        break;
+    }
+}
+
+/* 组包完成：回显模式交给发送会话，否则放入待上报队列 */
+static void isotp_rx_complete(IsoTpBinding *b)
+{
+    rt_uint8_t *buf = b->rx_buf;
+
+    b->rx_buf = RT_NULL;
+    b->stats.rx_msgs++;
+    b->stats.rx_bytes += b->rx_len;
+
+    if (b->flags & ISOTP_FLAG_ECHO) {
+        if (b->tx_state == ISOTP_TX_IDLE) {
+            isotp_tx_start(b, buf, b->rx_len);
+        } else {
+            pool_free(buf, b->rx_len);
+            b->stats.tx_errors++;
+        }
+        return;
+    }
+
+    if (isotp_done_head - isotp_done_tail >= ISOTP_DONE_QUEUE) {
+        pool_free(buf, b->rx_len);
+        isotp_done_drop++;
+        return;
+    }
+
+    IsoTpMessage *m = &isotp_done[isotp_done_head++ % ISOTP_DONE_QUEUE];
+    m->binding = (rt_uint8_t)(b - isotp_bindings);
+    m->channel = b->channel;
+    m->flags = b->rx_frame_flags;
+    m->rx_id = b->rx_id;
+    m->timestamp = b->rx_ts;
+    m->len = b->rx_len;
+    m->data = buf;
+}
+
+/* 开始接收一条报文，原有未完成的报文视为被打断 */
+static rt_bool_t isotp_rx_start(IsoTpBinding *b, const CanFrame *f, rt_uint32_t len)
+{
+    isotp_rx_abort(b);
+
+    b->rx_buf = pool_alloc(len);
+    if (b->rx_buf == RT_NULL) {
+        b->stats.no_buffer++;
+        return RT_FALSE;
+    }
+    b->rx_len = len;
+    b->rx_pos = 0;
+    b->rx_frame_flags = f->flags & (CAN_FRAME_FLAG_EXT | CAN_FRAME_FLAG_FD);
+    b->rx_ts = f->timestamp ? f->timestamp : perf_now();
+    return RT_TRUE;
+}
+
+static void isotp_rx_frame(IsoTpBinding *b, const CanFrame *f)
+{
+    const rt_uint8_t *d = f->data;
+    rt_uint32_t len, off;
+
+    if (f->len == 0 || (f->flags & CAN_FRAME_FLAG_RTR)) return;
+
+    switch (d[0] >> 4) {
+    case ISOTP_PCI_SF:
+        if (d[0] & 0x0F) {
+            /* 长度超过 8 的帧必须使用 SF_DL 转义 */
+            if (f->len > ISOTP_CLASSIC_DL) return;
+            len = d[0] & 0x0F;
+            off = 1;
+        } else {
+            if (f->len <= ISOTP_CLASSIC_DL) return;
+            len = d[1];
+            off = 2;
+        }
+        if (len == 0 || off + len > f->len) return;
+        if (!isotp_rx_start(b, f, len)) return;
+        memcpy(b->rx_buf, d + off, len);
+        isotp_rx_complete(b);
+        break;
+
+    case ISOTP_PCI_FF:
+        if (f->len < ISOTP_CLASSIC_DL) return;
+        len = ((rt_uint32_t)(d[0] & 0x0F) << 8) | d[1];
+        off = 2;
+        if (len == 0) {
+            len = ((rt_uint32_t)d[2] << 24) | ((rt_uint32_t)d[3] << 16) | ((rt_uint32_t)d[4] << 8) | d[5];
+            off = 6;
+        }
+        if (len <= f->len - off) return;
+
+        if (!isotp_rx_start(b, f, len)) {
+            if (!(b->flags & ISOTP_FLAG_LISTEN)) isotp_send_fc(b, ISOTP_FS_OVFLW);
+            return;
+        }
+        memcpy(b->rx_buf, d + off, f->len - off);
+        b->rx_pos = f->len - off;
+        b->rx_sn = 1;
+        b->rx_bs_cnt = 0;
+        b->rx_deadline = rt_tick_get() + rt_tick_from_millisecond(ISOTP_TIMEOUT_MS);
+        if (!(b->flags & ISOTP_FLAG_LISTEN)) isotp_send_fc(b, ISOTP_FS_CTS);
+        break;
+
+    case ISOTP_PCI_CF:
+        if (b->rx_buf == RT_NULL) return;
+        if ((d[0] & 0x0F) != b->rx_sn) {
+            isotp_rx_abort(b);
+            return;
+        }
+        len = b->rx_len - b->rx_pos;
+        if (len > (rt_uint32_t)f->len - 1) len = f->len - 1;
+        memcpy(b->rx_buf + b->rx_pos, d + 1, len);
+        b->rx_pos += len;
+        b->rx_sn = (b->rx_sn + 1) & 0x0F;
+
+        if (b->rx_pos >= b->rx_len) {
+            isotp_rx_complete(b);
+            break;
+        }
+        b->rx_deadline = rt_tick_get() + rt_tick_from_millisecond(ISOTP_TIMEOUT_MS);
+        if (b->bs && ++b->rx_bs_cnt >= b->bs && !(b->flags & ISOTP_FLAG_LISTEN)) {
+            b->rx_bs_cnt = 0;
+            isotp_send_fc(b, ISOTP_FS_CTS);
+        }
+        break;
+
+    case ISOTP_PCI_FC:
+        isotp_rx_flow_control(b, f);
+        break;
+
+    default:
+        break;
+    }
+}
+
+int isotp_bind(rt_uint8_t channel, rt_uint32_t rx_id, rt_uint32_t tx_id, rt_uint8_t flags,
+               rt_uint8_t block_size, rt_uint8_t st_min)
+{
+    int ret = -RT_EFULL;
+
+    isotp_init();
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    for (int i = 0; i < ISOTP_MAX_BINDINGS; i++) {
+        IsoTpBinding *b = &isotp_bindings[i];
+        if (b->used) continue;
+
+        memset(b, 0, sizeof(*b));
+        b->used = 1;
+        b->channel = channel;
+        b->flags = flags;
+        b->rx_id = rx_id;
+        b->tx_id = tx_id;
+        b->bs = block_size;
+        b->stmin = st_min;
+        isotp_num++;
+        ret = i;
+        break;
+    }
+    rt_mutex_release(&isotp_lock);
+    return ret;
+}
+
+void isotp_unbind(int binding)
+{
+    if (binding < 0 || binding >= ISOTP_MAX_BINDINGS) return;
+
+    isotp_init();
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    IsoTpBinding *b = &isotp_bindings[binding];
+    if (b->used) {
+        isotp_rx_abort(b);
+        if (b->tx_state != ISOTP_TX_IDLE) isotp_tx_finish(b, RT_FALSE);
+        b->used = 0;
+        isotp_num--;
+    }
+    rt_mutex_release(&isotp_lock);
+}
+
+rt_bool_t isotp_input(const CanFrame *frame)
+{
+    rt_bool_t consumed = RT_FALSE;
+    rt_bool_t ext = (frame->flags & CAN_FRAME_FLAG_EXT) ? RT_TRUE : RT_FALSE;
+
+    if (isotp_num == 0) return RT_FALSE;
+
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    for (int i = 0; i < ISOTP_MAX_BINDINGS; i++) {
+        IsoTpBinding *b = &isotp_bindings[i];
+        if (!b->used || b->rx_id != frame->id || b->channel != frame->channel ||
+            ext != ((b->flags & ISOTP_FLAG_EXT) ? RT_TRUE : RT_FALSE)) {
+            continue;
+        }
+
+        isotp_rx_frame(b, frame);
+        /* 收到流控帧后立即发出首批连续帧 */
+        if (b->tx_state == ISOTP_TX_SEND) isotp_tx_pump(b, perf_to_us64(perf_now()));
+        consumed = RT_TRUE;
+        break;
+    }
+    rt_mutex_release(&isotp_lock);
+    return consumed;
+}
+
+rt_int32_t isotp_poll(void)
+{
+    rt_int32_t next = -1;
+
+    if (isotp_num == 0) return -1;
+
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    rt_tick_t now = rt_tick_get();
+    rt_uint64_t now_us = perf_to_us64(perf_now());
+
+    for (int i = 0; i < ISOTP_MAX_BINDINGS; i++) {
+        IsoTpBinding *b = &isotp_bindings[i];
+        rt_int32_t due = -1;
+
+        if (!b->used) continue;
+
+        if (b->rx_buf != RT_NULL) {
+            if ((rt_int32_t)(now - b->rx_deadline) >= 0) {
+                isotp_rx_abort(b);
+            } else {
+                due = b->rx_deadline - now;
+            }
+        }
+
+        if (b->tx_state == ISOTP_TX_WAIT_FC && (rt_int32_t)(now - b->tx_deadline) >= 0) {
+            isotp_tx_finish(b, RT_FALSE);
+        } else if (b->tx_state == ISOTP_TX_SEND) {
+            isotp_tx_pump(b, now_us);
+        }
+
+        if (b->tx_state == ISOTP_TX_SEND) {
+            /* STmin 未到时等到下一帧时刻，否则 can_tx 队列积压，1 ms 后重试 */
+            rt_int32_t wait = (b->tx_next_us > now_us) ? (rt_int32_t)((b->tx_next_us - now_us + 999) / 1000) : 1;
+            if (due < 0 || wait < due) due = wait;
+        } else if (b->tx_state == ISOTP_TX_WAIT_FC) {
+            rt_int32_t wait = b->tx_deadline - now;
+            if (due < 0 || wait < due) due = wait;
+        }
+
+        if (due >= 0 && (next < 0 || due < next)) next = due;
+    }
+    rt_mutex_release(&isotp_lock);
+    return next;
+}
+
+rt_bool_t isotp_collect(IsoTpMessage *msg)
+{
+    if (isotp_done_head == isotp_done_tail) return RT_FALSE;
+
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    *msg = isotp_done[isotp_done_tail++ % ISOTP_DONE_QUEUE];
+    rt_mutex_release(&isotp_lock);
+    return RT_TRUE;
+}
+
+void isotp_release(IsoTpMessage *msg)
+{
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    pool_free(msg->data, msg->len);
+    msg->data = RT_NULL;
+    rt_mutex_release(&isotp_lock);
+}
+
+/* 持锁调用：发送缓冲池中的数据，成功时缓冲归发送会话，失败时由调用者释放 */
+static int isotp_send_buf(int binding, rt_uint8_t *buf, rt_uint32_t len)
+{
+    IsoTpBinding *b = &isotp_bindings[binding];
+
+    if (!b->used) return -RT_EINVAL;
+    if (b->tx_state != ISOTP_TX_IDLE) return -RT_EBUSY;
+
+    isotp_tx_start(b, buf, len);
+    return RT_EOK;
+}
+
+int isotp_send(int binding, const rt_uint8_t *data, rt_uint32_t len)
+{
+    rt_uint8_t *buf;
+    int ret;
+
+    if (binding < 0 || binding >= ISOTP_MAX_BINDINGS || len == 0) return -RT_EINVAL;
+
+    isotp_init();
+    rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+    buf = pool_alloc(len);
+    if (buf == RT_NULL) {
+        ret = -RT_ENOMEM;
+    } else {
+        memcpy(buf, data, len);
+        ret = isotp_send_buf(binding, buf, len);
+        if (ret != RT_EOK) pool_free(buf, len);
+    }
+    rt_mutex_release(&isotp_lock);
+    return ret;
+}
+
+void isotp_get_stats(int binding, IsoTpStats *stats)
+{
+    if (binding >= 0 && binding < ISOTP_MAX_BINDINGS) *stats = isotp_bindings[binding].stats;
+}
+
+static void isotp_show(void)
+{
+    static const char *tx_names[] = { "idle", "wait_fc", "send" };
+    rt_uint8_t used = 0;
+
+    for (rt_uint32_t m = isotp_pool_map; m; m &= m - 1) used++;
+    rt_kprintf("Buffer pool: %u / %u blocks of %u bytes (high %u), pending %u, dropped %u\n",
+               used, ISOTP_POOL_BLOCKS, ISOTP_BLOCK_SIZE, isotp_pool_high,
+               isotp_done_head - isotp_done_tail, isotp_done_drop);
+    rt_kprintf("#   ch  rx_id       tx_id       bs  stmin  flags  rx_msgs  rx_bytes  rx_err  tx_msgs  tx_err  no_buf  rx/tx\n");
+    for (int i = 0; i < ISOTP_MAX_BINDINGS; i++) {
+        const IsoTpBinding *b = &isotp_bindings[i];
+        if (!b->used) continue;
+        rt_kprintf("%-2d  %2d  0x%08X  0x%08X  %2u  %5u  0x%02X   %7u  %8u  %6u  %7u  %6u  %6u  %s/%s\n",
+                   i, b->channel, b->rx_id, b->tx_id, b->bs, b->stmin, b->flags,
+                   b->stats.rx_msgs, b->stats.rx_bytes, b->stats.rx_errors, b->stats.tx_msgs,
+                   b->stats.tx_errors, b->stats.no_buffer, b->rx_buf ? "rx" : "idle", tx_names[b->tx_state]);
+    }
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* msh: isotp bind <ch> <rx_id> <tx_id> [bs] [stmin] [ext|fd|listen|echo...] | unbind <n>
+ *      | send <n> <hex> | fill <n> <len> | stat */
+static int isotp(int argc, char **argv)
+{
+    static rt_uint8_t buf[ISOTP_BLOCK_SIZE];
+
+    if (argc >= 5 && strcmp(argv[1], "bind") == 0) {
+        rt_uint8_t flags = 0;
+        for (int i = 7; i < argc; i++) {
+            if (strcmp(argv[i], "ext") == 0) flags |= ISOTP_FLAG_EXT;
+            else if (strcmp(argv[i], "fd") == 0) flags |= ISOTP_FLAG_FD;
+            else if (strcmp(argv[i], "listen") == 0) flags |= ISOTP_FLAG_LISTEN;
+            else if (strcmp(argv[i], "echo") == 0) flags |= ISOTP_FLAG_ECHO;
+        }
+        int n = isotp_bind((rt_uint8_t)atoi(argv[2]), strtoul(argv[3], RT_NULL, 16), strtoul(argv[4], RT_NULL, 16),
+                           flags, (argc >= 6) ? (rt_uint8_t)strtoul(argv[5], RT_NULL, 0) : 0,
+                           (argc >= 7) ? (rt_uint8_t)strtoul(argv[6], RT_NULL, 0) : 0);
+        if (n < 0) {
+            rt_kprintf("Binding table full\n");
+            return n;
+        }
+        rt_kprintf("Binding %d\n", n);
+        return 0;
+    } else if (argc >= 3 && strcmp(argv[1], "unbind") == 0) {
+        isotp_unbind(atoi(argv[2]));
+        return 0;
+    } else if (argc >= 4 && strcmp(argv[1], "send") == 0) {
+        const char *p = argv[3];
+        rt_uint32_t len = 0;
+        while (p[0] && p[1] && len < sizeof(buf)) {
+            int hi = hex_nibble(p[0]), lo = hex_nibble(p[1]);
+            if (hi < 0 || lo < 0) break;
+            buf[len++] = (rt_uint8_t)((hi << 4) | lo);
+            p += 2;
+        }
+        int ret = isotp_send(atoi(argv[2]), buf, len);
+        if (ret != RT_EOK) rt_kprintf("isotp: send failed (%d)\n", ret);
+        return ret;
+    } else if (argc >= 4 && strcmp(argv[1], "fill") == 0) {
+        /* 发送 len 字节的递增序列，用于长报文测试；数据直接在缓冲池中生成 */
+        int binding = atoi(argv[2]);
+        rt_uint32_t len = strtoul(argv[3], RT_NULL, 0);
+        rt_uint8_t *data = RT_NULL;
+        int ret = -RT_EINVAL;
+
+        if (binding < 0 || binding >= ISOTP_MAX_BINDINGS || len == 0) goto usage;
+
+        isotp_init();
+        rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+        data = pool_alloc(len);
+        if (data == RT_NULL) {
+            ret = -RT_ENOMEM;
+        } else {
+            for (rt_uint32_t i = 0; i < len; i++) data[i] = (rt_uint8_t)i;
+            ret = isotp_send_buf(binding, data, len);
+            if (ret != RT_EOK) pool_free(data, len);
+        }
+        rt_mutex_release(&isotp_lock);
+        if (ret != RT_EOK) rt_kprintf("isotp: send failed (%d)\n", ret);
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        isotp_init();
+        rt_mutex_take(&isotp_lock, RT_WAITING_FOREVER);
+        isotp_show();
+        rt_mutex_release(&isotp_lock);
+        return 0;
+    }
+
+usage:
+    rt_kprintf("Usage: isotp bind <ch> <rx_id> <tx_id> [bs] [stmin] [ext] [fd] [listen] [echo]\n");
+    rt_kprintf("       isotp unbind <n>\n");
+    rt_kprintf("       isotp send <n> <hex>\n");
+    rt_kprintf("       isotp fill <n> <len>\n");
+    rt_kprintf("       isotp stat\n");
+    return -1;
+}
+MSH_CMD_EXPORT(isotp, ISO-TP sessions: bind ID pairs and send segmented messages);
@@ -0,0 +1,78 @@
+#ifndef __ISOTP_H__
+#define __ISOTP_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * ISO-TP (ISO 15765-2) 传输层：按 ID 对 (接收 ID, 发送 ID) 绑定会话，多个会话并行收发。
+ * 仅支持普通寻址；经典 CAN 与 CAN-FD (SF/FF 长度扩展、FF_DL 32 位转义) 均可接收。
+ *
+ * 接收：CAN 线程调用 isotp_input，FF 到达时从缓冲池分配整块连续缓冲，连续帧数据直接写入，
+ *       组包完成后由 isotp_collect 取出，作为一条报文上报后 isotp_release 归还。
+ *       缓冲前部预留 ISOTP_HEADROOM 字节，上报时就地写入报文头，数据不再复制。
+ * 发送：isotp_send 复制数据到缓冲池后发出 FF，按对端流控帧的 BS/STmin 经 can_tx 发送连续帧。
+ *
+ * 流控帧需及时回复，建议用 can_filter 把绑定的接收 ID 分到高优先级 FIFO。
+ * 会话状态由 CAN 线程处理，msh / 其他线程调用时加锁。
+ */
+#define ISOTP_MAX_BINDINGS      16
+#define ISOTP_BLOCK_SIZE        256
+#define ISOTP_POOL_BLOCKS       32      /* 缓冲池 8 KiB，不超过 32 */
+#define ISOTP_HEADROOM          32      /* 缓冲前部预留给上报报文头 */
+#define ISOTP_MAX_LEN           (ISOTP_BLOCK_SIZE * ISOTP_POOL_BLOCKS - ISOTP_HEADROOM)
+#define ISOTP_DONE_QUEUE        8       /* 待上报的完整报文数 */
+
+#define ISOTP_TIMEOUT_MS        1000    /* N_Bs / N_Cr */
+#define ISOTP_MAX_WFT           8       /* 连续收到 WAIT 流控帧的上限 */
+#define ISOTP_TX_BURST          16      /* STmin 为 0 时 can_tx 中最多排队的连续帧 */
+#define ISOTP_PAD_BYTE          0xCC
+
+/* 绑定选项 */
+#define ISOTP_FLAG_EXT          0x01    /* 29 位 ID */
+#define ISOTP_FLAG_FD           0x02    /* 发送使用 CAN-FD 帧 (TX_DL = 64) */
+#define ISOTP_FLAG_LISTEN       0x04    /* 只监听不回复流控帧，用于旁路已有诊断仪的会话 */
+#define ISOTP_FLAG_ECHO         0x08    /* 收到的报文原样发回 (主机联调用)，不上报 */
+
+typedef struct {
+    rt_uint32_t rx_msgs;
+    rt_uint32_t rx_bytes;
+    rt_uint32_t tx_msgs;
+    rt_uint32_t rx_errors;      /* 序号错误、超时、被新 FF 打断 */
+    rt_uint32_t tx_errors;      /* 流控超时、溢出、非法流控 */
+    rt_uint32_t no_buffer;      /* 缓冲池不足，回复溢出流控 */
+} IsoTpStats;
+
+/* 组包完成的报文，data 之前 ISOTP_HEADROOM 字节可供上报时写入报文头 */
+typedef struct {
+    rt_uint8_t  binding;
+    rt_uint8_t  channel;
+    rt_uint8_t  flags;          /* CAN_FRAME_FLAG_EXT / CAN_FRAME_FLAG_FD */
+    rt_uint32_t rx_id;
+    rt_uint64_t timestamp;      /* 首帧接收时间 (CNTPCT) */
+    rt_uint32_t len;
+    rt_uint8_t *data;
+} IsoTpMessage;
+
+/* API */
+/* 绑定 ID 对，返回绑定编号，表满返回 -RT_EFULL */
+int  isotp_bind(rt_uint8_t channel, rt_uint32_t rx_id, rt_uint32_t tx_id, rt_uint8_t flags,
+                rt_uint8_t block_size, rt_uint8_t st_min);
+void isotp_unbind(int binding);
+
+/* CAN 线程：处理一帧，属于已绑定会话时返回 RT_TRUE (不再按单帧上报) */
+rt_bool_t isotp_input(const CanFrame *frame);
+
+/* CAN 线程：处理超时和待发连续帧，返回距下一次到期的 ms，无待处理返回 -1 */
+rt_int32_t isotp_poll(void);
+
+/* 取出一条组包完成的报文，无报文返回 RT_FALSE；上报后必须调用 isotp_release */
+rt_bool_t isotp_collect(IsoTpMessage *msg);
+void isotp_release(IsoTpMessage *msg);
+
+/* 分段发送，上一条报文未发完时返回 -RT_EBUSY */
+int isotp_send(int binding, const rt_uint8_t *data, rt_uint32_t len);
+
+void isotp_get_stats(int binding, IsoTpStats *stats);
+
+#endif
@@ -0,0 +1,652 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include "j1939.h"
+#include "can_tx.h"
+#include "perf_counter.h"
+
+#define J1939_CHANNELS          2
+#define J1939_HASH_MASK         (J1939_HASH_SIZE - 1)
+#define J1939_NONE              0xFF
+#define J1939_PF_PDU2           240     /* PF >= 240 为 PDU2 (广播，PS 为组扩展) */
+
+#define J1939_TP_RTS            16
+#define J1939_TP_CTS            17
+#define J1939_TP_EOMA           19
+#define J1939_TP_BAM            32
+#define J1939_TP_ABORT          255
+
+#define J1939_PRIO_TP           7
+#define J1939_PRIO_DEFAULT      6
+
+typedef struct {
+    rt_uint8_t  used;
+    rt_uint8_t  next;           /* 哈希链 */
+    rt_uint8_t  channel;
+    rt_uint8_t  sa;             /* 发送方 */
+    rt_uint8_t  da;             /* 接收方，BAM 为 J1939_ADDR_GLOBAL */
+    rt_uint8_t  prio;
+    rt_uint8_t  bam;
+    rt_uint8_t  respond;        /* 发往本机的 RTS，由本机回复 CTS */
+    rt_uint8_t  packets;
+    rt_uint8_t  next_seq;       /* 下一个期望的包序号 (1 起) */
+    rt_uint8_t  window_end;     /* 本机回复的 CTS 窗口最后一包 */
+    rt_uint8_t  cts_max;        /* RTS 中发送方允许的每 CTS 最大包数 */
+    rt_uint16_t size;
+    rt_uint32_t pgn;
+    rt_uint8_t *buf;
+    rt_uint64_t ts;
+    rt_tick_t   deadline;
+} J1939Session;
+
+typedef struct {
+    rt_uint8_t  used;
+    rt_uint8_t  channel;
+    rt_uint8_t  addr;
+    rt_uint64_t name;
+    rt_tick_t   last_seen;
+} J1939Node;
+
+static J1939Session j1939_sessions[J1939_MAX_SESSIONS];
+static rt_uint8_t j1939_hash[J1939_HASH_SIZE];
+static rt_uint8_t j1939_free[J1939_MAX_SESSIONS];
+static rt_uint8_t j1939_free_num;
+static rt_uint8_t j1939_active;
+
+static J1939Node j1939_nodes[J1939_MAX_NODES];
+
+static rt_uint8_t j1939_pool[J1939_POOL_BLOCKS * J1939_BLOCK_SIZE] __attribute__((aligned(8)));
+static rt_uint32_t j1939_pool_map[J1939_POOL_BLOCKS / 32];
+
+static J1939Message j1939_done[J1939_DONE_QUEUE];
+static rt_uint32_t j1939_done_head;
+static rt_uint32_t j1939_done_tail;
+
+static rt_uint8_t j1939_ch_mask;
+static rt_uint8_t j1939_own_addr[J1939_CHANNELS] = { J1939_ADDR_NULL, J1939_ADDR_NULL };
+static rt_uint64_t j1939_own_name[J1939_CHANNELS];
+static J1939Stats j1939_stats;
+
+static struct rt_mutex j1939_lock;
+static rt_bool_t j1939_inited = RT_FALSE;
+
+static void j1939_init(void)
+{
+    if (!j1939_inited) {
+        rt_mutex_init(&j1939_lock, "j1939", RT_IPC_FLAG_PRIO);
+        memset(j1939_hash, J1939_NONE, sizeof(j1939_hash));
+        for (int i = 0; i < J1939_MAX_SESSIONS; i++) j1939_free[i] = (rt_uint8_t)(J1939_MAX_SESSIONS - 1 - i);
+        j1939_free_num = J1939_MAX_SESSIONS;
+        j1939_inited = RT_TRUE;
+    }
+}
+
+/* ---- 缓冲池：按块分配连续缓冲 ---- */
+
+rt_inline rt_bool_t pool_bit(rt_uint32_t i)
+{
+    return (j1939_pool_map[i / 32] >> (i % 32)) & 1;
+}
+
+rt_inline rt_uint32_t pool_blocks(rt_uint32_t len)
+{
+    return (J1939_HEADROOM + len + J1939_BLOCK_SIZE - 1) / J1939_BLOCK_SIZE;
+}
+
+static void pool_mark(rt_uint32_t first, rt_uint32_t n, rt_bool_t used)
+{
+    for (rt_uint32_t i = first; i < first + n; i++) {
+        if (used) {
+            j1939_pool_map[i / 32] |= 1UL << (i % 32);
+        } else {
+            j1939_pool_map[i / 32] &= ~(1UL << (i % 32));
+        }
+    }
+}
+
+static rt_uint8_t *pool_alloc(rt_uint32_t len)
+{
+    rt_uint32_t n = pool_blocks(len);
+
+    for (rt_uint32_t first = 0; first + n <= J1939_POOL_BLOCKS; first++) {
+        rt_uint32_t k = 0;
+        while (k < n && !pool_bit(first + k)) k++;
+        if (k == n) {
+            pool_mark(first, n, RT_TRUE);
+            return &j1939_pool[first * J1939_BLOCK_SIZE + J1939_HEADROOM];
+        }
+        first += k;     /* 跳过已占用的块 */
+    }
+    return RT_NULL;
+}
+
+static void pool_free(const rt_uint8_t *data, rt_uint32_t len)
+{
+    pool_mark((rt_uint32_t)(data - J1939_HEADROOM - j1939_pool) / J1939_BLOCK_SIZE, pool_blocks(len), RT_FALSE);
+}
+
+/* ---- 会话表：(通道, SA, DA) 哈希，链表解决冲突 ---- */
+
+rt_inline rt_uint32_t session_hash(rt_uint8_t channel, rt_uint8_t sa, rt_uint8_t da)
+{
+    rt_uint32_t key = ((rt_uint32_t)channel << 16) | ((rt_uint32_t)sa << 8) | da;
+    return ((key * 2654435761UL) >> 24) & J1939_HASH_MASK;
+}
+
+static J1939Session *session_find(rt_uint8_t channel, rt_uint8_t sa, rt_uint8_t da)
+{
+    for (rt_uint8_t i = j1939_hash[session_hash(channel, sa, da)]; i != J1939_NONE; i = j1939_sessions[i].next) {
+        J1939Session *s = &j1939_sessions[i];
+        if (s->channel == channel && s->sa == sa && s->da == da) return s;
+    }
+    return RT_NULL;
+}
+
+static void session_free(J1939Session *s)
+{
+    rt_uint8_t idx = (rt_uint8_t)(s - j1939_sessions);
+    rt_uint8_t *link = &j1939_hash[session_hash(s->channel, s->sa, s->da)];
+
+    while (*link != idx) link = &j1939_sessions[*link].next;
+    *link = s->next;
+
+    if (s->buf) pool_free(s->buf, s->size);
+    s->buf = RT_NULL;
+    s->used = 0;
+    j1939_free[j1939_free_num++] = idx;
+    j1939_active--;
+}
+
+static J1939Session *session_new(rt_uint8_t channel, rt_uint8_t sa, rt_uint8_t da, rt_uint16_t size)
+{
+    J1939Session *s = session_find(channel, sa, da);
+
+    /* 同一发送方重新开始时放弃未完成的会话 */
+    if (s) {
+        session_free(s);
+        j1939_stats.aborted++;
+    }
+    if (j1939_free_num == 0) {
+        j1939_stats.no_session++;
+        return RT_NULL;
+    }
+
+    rt_uint8_t *buf = pool_alloc(size);
+    if (buf == RT_NULL) {
+        j1939_stats.no_buffer++;
+        return RT_NULL;
+    }
+
+    rt_uint8_t idx = j1939_free[--j1939_free_num];
+    rt_uint32_t h = session_hash(channel, sa, da);
+    s = &j1939_sessions[idx];
+    memset(s, 0, sizeof(*s));
+    s->used = 1;
+    s->channel = channel;
+    s->sa = sa;
+    s->da = da;
+    s->size = size;
+    s->buf = buf;
+    s->next_seq = 1;
+    s->next = j1939_hash[h];
+    j1939_hash[h] = idx;
+    j1939_active++;
+    return s;
+}
+
+/* ---- 发送 ---- */
+
+static void j1939_send(rt_uint8_t channel, rt_uint8_t prio, rt_uint32_t pgn, rt_uint8_t da, rt_uint8_t sa,
+                       const rt_uint8_t *data, rt_uint8_t len)
+{
+    CanFrame f;
+    rt_uint32_t pf = (pgn >> 8) & 0xFF;
+
+    f.id = ((rt_uint32_t)prio << 26) | ((pgn & 0x3FF00) << 8) | sa;
+    f.id |= (pf < J1939_PF_PDU2) ? ((rt_uint32_t)da << 8) : ((pgn & 0xFF) << 8);
+    f.flags = CAN_FRAME_FLAG_EXT;
+    f.channel = channel;
+    f.len = len;
+    memcpy(f.data, data, len);
+    can_tx_send(channel, &f, CAN_TX_PRIO_HIGH);
+}
+
+static void j1939_send_tp_cm(J1939Session *s, rt_uint8_t ctrl, rt_uint8_t b1, rt_uint8_t b2, rt_uint8_t b3, rt_uint8_t b4)
+{
+    rt_uint8_t d[8] = { ctrl, b1, b2, b3, b4, (rt_uint8_t)s->pgn, (rt_uint8_t)(s->pgn >> 8), (rt_uint8_t)(s->pgn >> 16) };
+
+    /* 本机为接收方，回复给发送方 */
+    j1939_send(s->channel, J1939_PRIO_TP, J1939_PGN_TP_CM, s->sa, s->da, d, sizeof(d));
+}
+
+static void j1939_send_cts(J1939Session *s)
+{
+    rt_uint8_t n = s->packets - s->next_seq + 1;
+
+    if (n > J1939_CTS_PACKETS) n = J1939_CTS_PACKETS;
+    if (s->cts_max && n > s->cts_max) n = s->cts_max;
+    s->window_end = s->next_seq + n - 1;
+    j1939_send_tp_cm(s, J1939_TP_CTS, n, s->next_seq, 0xFF, 0xFF);
+}
+
+static void j1939_send_claim(rt_uint8_t channel, rt_uint8_t sa)
+{
+    rt_uint8_t d[8];
+    rt_uint64_t name = j1939_own_name[channel];
+
+    for (int i = 0; i < 8; i++) d[i] = (rt_uint8_t)(name >> (8 * i));
+    j1939_send(channel, J1939_PRIO_DEFAULT, J1939_PGN_ADDR_CLAIM, J1939_ADDR_GLOBAL, sa, d, sizeof(d));
+}
+
+/* ---- 传输协议 ---- */
+
+static void j1939_complete(J1939Session *s)
+{
+    if (s->respond) {
+        j1939_send_tp_cm(s, J1939_TP_EOMA, (rt_uint8_t)s->size, (rt_uint8_t)(s->size >> 8), s->packets, 0xFF);
+    }
+
+    if (j1939_done_head - j1939_done_tail >= J1939_DONE_QUEUE) {
+        j1939_stats.dropped++;
+        session_free(s);
+        return;
+    }
+
+    J1939Message *m = &j1939_done[j1939_done_head++ % J1939_DONE_QUEUE];
+    m->channel = s->channel;
+    m->prio = s->prio;
+    m->sa = s->sa;
+    m->da = s->da;
+    m->pgn = s->pgn;
+    m->timestamp = s->ts;
+    m->len = s->size;
+    m->multi = 1;
+    m->data = s->buf;
+
+    /* 缓冲所有权转给待上报队列 */
+    s->buf = RT_NULL;
+    session_free(s);
+    j1939_stats.messages++;
+}
+
+static void j1939_tp_cm(const CanFrame *f, rt_uint8_t sa, rt_uint8_t da)
+{
+    const rt_uint8_t *d = f->data;
+    rt_uint16_t size = d[1] | ((rt_uint16_t)d[2] << 8);
+    rt_uint8_t packets = d[3];
+    J1939Session *s;
+
+    if (f->len < 8) return;
+
+    switch (d[0]) {
+    case J1939_TP_BAM:
+    case J1939_TP_RTS:
+        if (d[0] == J1939_TP_BAM && da != J1939_ADDR_GLOBAL) return;
+        if (size < 9 || size > J1939_MAX_LEN || packets != (size + 6) / 7) return;
+
+        s = session_new(f->channel, sa, da, size);
+        if (s == RT_NULL) {
+            /* 发往本机的 RTS 无法接收时回复 Abort (资源不足) */
+            if (d[0] == J1939_TP_RTS && da == j1939_own_addr[f->channel]) {
+                J1939Session tmp = { .channel = f->channel, .sa = sa, .da = da,
+                                     .pgn = d[5] | ((rt_uint32_t)d[6] << 8) | ((rt_uint32_t)d[7] << 16) };
+                j1939_send_tp_cm(&tmp, J1939_TP_ABORT, 1, 0xFF, 0xFF, 0xFF);
+            }
+            return;
+        }
+        s->pgn = d[5] | ((rt_uint32_t)d[6] << 8) | ((rt_uint32_t)d[7] << 16);
+        s->prio = (rt_uint8_t)((f->id >> 26) & 7);
+        s->packets = packets;
+        s->ts = f->timestamp ? f->timestamp : perf_now();
+        if (d[0] == J1939_TP_BAM) {
+            s->bam = 1;
+            s->deadline = rt_tick_get() + rt_tick_from_millisecond(J1939_T1_MS);
+            j1939_stats.bam++;
+        } else {
+            s->cts_max = d[4];
+            s->deadline = rt_tick_get() + rt_tick_from_millisecond(J1939_T2_MS);
+            j1939_stats.rts++;
+            if (da == j1939_own_addr[f->channel]) {
+                s->respond = 1;
+                j1939_send_cts(s);
+            }
+        }
+        break;
+
+    case J1939_TP_CTS:
+        /* 接收方发出，会话键为 (发送方 = DA, 接收方 = SA)；旁听时只刷新超时 */
+        s = session_find(f->channel, da, sa);
+        if (s) s->deadline = rt_tick_get() + rt_tick_from_millisecond(J1939_T2_MS);
+        break;
+
+    case J1939_TP_ABORT:
+        s = session_find(f->channel, sa, da);
+        if (s == RT_NULL) s = session_find(f->channel, da, sa);
+        if (s) {
+            session_free(s);
+            j1939_stats.aborted++;
+        }
+        break;
+
+    default:    /* EndOfMsgAck 等，组包在最后一包时已完成 */
+        break;
+    }
+}
+
+static void j1939_tp_dt(const CanFrame *f, rt_uint8_t sa, rt_uint8_t da)
+{
+    J1939Session *s = session_find(f->channel, sa, da);
+    rt_uint8_t seq = f->data[0];
+
+    if (s == RT_NULL || f->len < 2) return;
+
+    /* 重传的包 (RTS/CTS) 忽略；跳号说明有包丢失，无法再组包 */
+    if (seq < s->next_seq && !s->bam) return;
+    if (seq != s->next_seq) {
+        if (s->respond) j1939_send_tp_cm(s, J1939_TP_ABORT, 3, 0xFF, 0xFF, 0xFF);
+        session_free(s);
+        j1939_stats.aborted++;
+        return;
+    }
+
+    rt_uint32_t pos = (rt_uint32_t)(seq - 1) * 7;
+    rt_uint32_t n = s->size - pos;
+    if (n > 7) n = 7;
+    if (n > (rt_uint32_t)f->len - 1) n = f->len - 1;
+    memcpy(s->buf + pos, f->data + 1, n);
+    s->next_seq++;
+
+    if (s->next_seq > s->packets) {
+        j1939_complete(s);
+        return;
+    }
+    s->deadline = rt_tick_get() + rt_tick_from_millisecond(s->bam ? J1939_T1_MS : J1939_T2_MS);
+    if (s->respond && seq == s->window_end) j1939_send_cts(s);
+}
+
+/* ---- 地址声明 ---- */
+
+static void j1939_addr_claim(const CanFrame *f, rt_uint8_t sa)
+{
+    rt_uint64_t name = 0;
+    rt_tick_t now = rt_tick_get();
+    J1939Node *slot = RT_NULL, *oldest = RT_NULL;
+
+    if (f->len < 8) return;
+    for (int i = 0; i < 8; i++) name |= (rt_uint64_t)f->data[i] << (8 * i);
+    j1939_stats.addr_claims++;
+
+    /* 本机地址被声明：NAME 数值小者优先，本机优先时重新声明，否则放弃地址 */
+    if (sa == j1939_own_addr[f->channel] && name != j1939_own_name[f->channel]) {
+        if (name < j1939_own_name[f->channel]) {
+            j1939_own_addr[f->channel] = J1939_ADDR_NULL;
+            j1939_send_claim(f->channel, J1939_ADDR_NULL);
+            rt_kprintf("j1939: ch%d lost address %u\n", f->channel, sa);
+        } else {
+            j1939_send_claim(f->channel, sa);
+        }
+    }
+
+    for (int i = 0; i < J1939_MAX_NODES; i++) {
+        J1939Node *n = &j1939_nodes[i];
+        if (!n->used) {
+            if (slot == RT_NULL) slot = n;
+            continue;
+        }
+        if (n->channel != f->channel) continue;
+
+        if (n->addr == sa) {
+            if (n->name != name) {
+                j1939_stats.addr_conflicts++;
+                /* 同一地址的竞争中 NAME 较大者失败，保留较小者 */
+                if (name > n->name) return;
+            }
+            slot = n;
+        } else if (n->name == name) {
+            /* 节点改用新地址 (或无法声明地址) */
+            n->used = 0;
+            if (slot == RT_NULL) slot = n;
+        }
+        if (oldest == RT_NULL || (rt_int32_t)(n->last_seen - oldest->last_seen) < 0) oldest = n;
+    }
+
+    if (sa == J1939_ADDR_NULL) return;  /* Cannot Claim Address */
+    if (slot == RT_NULL) slot = oldest;
+    if (slot == RT_NULL) return;
+
+    slot->used = 1;
+    slot->channel = f->channel;
+    slot->addr = sa;
+    slot->name = name;
+    slot->last_seen = now;
+}
+
+/* ---- API ---- */
+
+void j1939_enable(rt_uint8_t channel, rt_bool_t enable)
+{
+    if (channel >= J1939_CHANNELS) return;
+
+    j1939_init();
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    if (enable) {
+        j1939_ch_mask |= 1U << channel;
+    } else {
+        j1939_ch_mask &= ~(1U << channel);
+        for (int i = 0; i < J1939_MAX_SESSIONS; i++) {
+            if (j1939_sessions[i].used && j1939_sessions[i].channel == channel) session_free(&j1939_sessions[i]);
+        }
+    }
+    rt_mutex_release(&j1939_lock);
+}
+
+int j1939_set_address(rt_uint8_t channel, rt_uint8_t addr, rt_uint64_t name)
+{
+    if (channel >= J1939_CHANNELS || addr == J1939_ADDR_GLOBAL) return -RT_EINVAL;
+
+    j1939_init();
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    j1939_own_addr[channel] = addr;
+    j1939_own_name[channel] = name;
+    if (addr != J1939_ADDR_NULL) j1939_send_claim(channel, addr);
+    rt_mutex_release(&j1939_lock);
+    return RT_EOK;
+}
+
+rt_bool_t j1939_parse(const CanFrame *frame, J1939Message *msg)
+{
+    if ((frame->flags & (CAN_FRAME_FLAG_EXT | CAN_FRAME_FLAG_FD)) != CAN_FRAME_FLAG_EXT) return RT_FALSE;
+    if (!(j1939_ch_mask & (1U << frame->channel))) return RT_FALSE;
+
+    rt_uint32_t id = frame->id;
+    rt_uint8_t pf = (rt_uint8_t)(id >> 16);
+    rt_uint8_t ps = (rt_uint8_t)(id >> 8);
+
+    msg->channel = frame->channel;
+    msg->prio = (rt_uint8_t)((id >> 26) & 7);
+    msg->sa = (rt_uint8_t)id;
+    if (pf < J1939_PF_PDU2) {
+        msg->pgn = (id >> 8) & 0x3FF00;
+        msg->da = ps;
+    } else {
+        msg->pgn = (id >> 8) & 0x3FFFF;
+        msg->da = J1939_ADDR_GLOBAL;
+    }
+    msg->timestamp = frame->timestamp;
+    msg->len = frame->len;
+    msg->multi = 0;
+    msg->data = frame->data;
+    return RT_TRUE;
+}
+
+rt_bool_t j1939_input(const CanFrame *frame)
+{
+    J1939Message m;
+    rt_bool_t consumed = RT_FALSE;
+
+    if (!j1939_parse(frame, &m)) return RT_FALSE;
+
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    j1939_stats.frames++;
+    switch (m.pgn) {
+    case J1939_PGN_TP_CM:
+        j1939_tp_cm(frame, m.sa, m.da);
+        consumed = RT_TRUE;
+        break;
+    case J1939_PGN_TP_DT:
+        j1939_tp_dt(frame, m.sa, m.da);
+        consumed = RT_TRUE;
+        break;
+    case J1939_PGN_ADDR_CLAIM:
+        j1939_addr_claim(frame, m.sa);
+        break;
+    case J1939_PGN_REQUEST:
+        /* 请求地址声明时回复本机地址 */
+        if (frame->len >= 3 && (frame->data[0] | ((rt_uint32_t)frame->data[1] << 8) |
+                                ((rt_uint32_t)frame->data[2] << 16)) == J1939_PGN_ADDR_CLAIM) {
+            rt_uint8_t own = j1939_own_addr[frame->channel];
+            if (own != J1939_ADDR_NULL && (m.da == J1939_ADDR_GLOBAL || m.da == own)) {
+                j1939_send_claim(frame->channel, own);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    rt_mutex_release(&j1939_lock);
+    return consumed;
+}
+
+rt_int32_t j1939_poll(void)
+{
+    rt_int32_t next = -1;
+
+    if (j1939_active == 0) return -1;
+
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    rt_tick_t now = rt_tick_get();
+    for (int i = 0; i < J1939_MAX_SESSIONS; i++) {
+        J1939Session *s = &j1939_sessions[i];
+        if (!s->used) continue;
+
+        rt_int32_t left = (rt_int32_t)(s->deadline - now);
+        if (left <= 0) {
+            if (s->respond) j1939_send_tp_cm(s, J1939_TP_ABORT, 3, 0xFF, 0xFF, 0xFF);
+            session_free(s);
+            j1939_stats.aborted++;
+        } else if (next < 0 || left < next) {
+            next = left;
+        }
+    }
+    rt_mutex_release(&j1939_lock);
+    return next;
+}
+
+rt_bool_t j1939_collect(J1939Message *msg)
+{
+    if (j1939_done_head == j1939_done_tail) return RT_FALSE;
+
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    *msg = j1939_done[j1939_done_tail++ % J1939_DONE_QUEUE];
+    rt_mutex_release(&j1939_lock);
+    return RT_TRUE;
+}
+
+void j1939_release(J1939Message *msg)
+{
+    if (!msg->multi) return;
+
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    pool_free(msg->data, msg->len);
+    msg->data = RT_NULL;
+    rt_mutex_release(&j1939_lock);
+}
+
+rt_bool_t j1939_lookup_name(rt_uint8_t channel, rt_uint8_t addr, rt_uint64_t *name)
+{
+    for (int i = 0; i < J1939_MAX_NODES; i++) {
+        const J1939Node *n = &j1939_nodes[i];
+        if (n->used && n->channel == channel && n->addr == addr) {
+            *name = n->name;
+            return RT_TRUE;
+        }
+    }
+    return RT_FALSE;
+}
+
+void j1939_get_stats(J1939Stats *stats)
+{
+    j1939_init();
+    rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+    *stats = j1939_stats;
+    rt_mutex_release(&j1939_lock);
+}
+
+static void j1939_show(void)
+{
+    const J1939Stats *st = &j1939_stats;
+    rt_uint32_t used = 0;
+
+    for (int i = 0; i < J1939_POOL_BLOCKS; i++) used += pool_bit(i);
+    rt_kprintf("Channels 0x%X, own address ch0 %u ch1 %u\n", j1939_ch_mask, j1939_own_addr[0], j1939_own_addr[1]);
+    rt_kprintf("Frames %u, messages %u (BAM %u, RTS %u), aborted %u\n",
+               st->frames, st->messages, st->bam, st->rts, st->aborted);
+    rt_kprintf("Sessions %u / %u, buffer %u / %u blocks, pending %u\n", j1939_active, J1939_MAX_SESSIONS,
+               used, J1939_POOL_BLOCKS, j1939_done_head - j1939_done_tail);
+    rt_kprintf("Rejected: no session %u, no buffer %u, queue full %u\n", st->no_session, st->no_buffer, st->dropped);
+    rt_kprintf("Address claims %u, conflicts %u\n", st->addr_claims, st->addr_conflicts);
+}
+
+static void j1939_show_nodes(void)
+{
+    rt_tick_t now = rt_tick_get();
+
+    rt_kprintf("ch  addr  name              age_ms\n");
+    for (int i = 0; i < J1939_MAX_NODES; i++) {
+        const J1939Node *n = &j1939_nodes[i];
+        if (!n->used) continue;
+        rt_kprintf("%2d  %4u  %08X%08X  %6u\n", n->channel, n->addr, (rt_uint32_t)(n->name >> 32),
+                   (rt_uint32_t)n->name, now - n->last_seen);
+    }
+}
+
+/* msh: j1939 enable|disable <ch> | addr <ch> <sa> [name] | request <ch> | nodes | stat */
+static int j1939(int argc, char **argv)
+{
+    if (argc >= 3 && (strcmp(argv[1], "enable") == 0 || strcmp(argv[1], "disable") == 0)) {
+        j1939_enable((rt_uint8_t)atoi(argv[2]), argv[1][0] == 'e');
+        return 0;
+    } else if (argc >= 4 && strcmp(argv[1], "addr") == 0) {
+        rt_uint64_t name = (argc >= 5) ? strtoull(argv[4], RT_NULL, 16) : 0;
+        return j1939_set_address((rt_uint8_t)atoi(argv[2]), (rt_uint8_t)strtoul(argv[3], RT_NULL, 0), name);
+    } else if (argc >= 3 && strcmp(argv[1], "request") == 0) {
+        /* 全局请求地址声明，刷新节点表 */
+        rt_uint8_t channel = (rt_uint8_t)atoi(argv[2]);
+        rt_uint8_t d[3] = { (rt_uint8_t)J1939_PGN_ADDR_CLAIM, (rt_uint8_t)(J1939_PGN_ADDR_CLAIM >> 8), 0 };
+        if (channel >= J1939_CHANNELS) return -1;
+        j1939_init();
+        rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+        j1939_send(channel, J1939_PRIO_DEFAULT, J1939_PGN_REQUEST, J1939_ADDR_GLOBAL, j1939_own_addr[channel], d, sizeof(d));
+        rt_mutex_release(&j1939_lock);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "nodes") == 0) {
+        j1939_init();
+        rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+        j1939_show_nodes();
+        rt_mutex_release(&j1939_lock);
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        j1939_init();
+        rt_mutex_take(&j1939_lock, RT_WAITING_FOREVER);
+        j1939_show();
+        rt_mutex_release(&j1939_lock);
+        return 0;
+    }
+
+    rt_kprintf("Usage: j1939 enable|disable <ch>\n");
+    rt_kprintf("       j1939 addr <ch> <sa> [name_hex]   (sa 254: listen only)\n");
+    rt_kprintf("       j1939 request <ch>\n");
+    rt_kprintf("       j1939 nodes|stat\n");
+    return -1;
+}
+MSH_CMD_EXPORT(j1939, SAE J1939 transport protocol and address claim tracking);
@@ -0,0 +1,88 @@
+#ifndef __J1939_H__
+#define __J1939_H__
+
+#include <rtthread.h>
+#include "can_ring.h"
+
+/*
+ * SAE J1939 接入：启用的通道上 29 位 ID 按 PGN / 源地址 / 优先级解析，上报 PGN 级报文而非原始 can_id。
+ *
+ * 传输协议 (J1939-21 TP)：BAM 广播与 RTS/CTS 点对点多包报文按 (通道, SA, DA) 建立会话并行组包，
+ * 旁听其他节点之间的会话；配置了本机地址时，对发往本机的 RTS 回复 CTS / EndOfMsgAck。
+ * 组包数据直接写入缓冲池的连续缓冲，前部预留 J1939_HEADROOM 供上报时就地编码。
+ * 地址声明 (J1939-81)：记录各地址对应的 NAME，跟踪地址冲突与无法声明地址的节点。
+ *
+ * 会话表、节点表和缓冲池均为静态分配，内存占用固定；会话数或缓冲不足时新会话被拒绝并计数。
+ * 与 isotp 相同，由 CAN 线程调用 j1939_input / j1939_poll / j1939_collect。
+ */
+#define J1939_MAX_SESSIONS      64
+#define J1939_HASH_SIZE         64      /* 必须为 2 的幂 */
+#define J1939_MAX_NODES         64      /* 地址声明表项数 */
+#define J1939_BLOCK_SIZE        128
+#define J1939_POOL_BLOCKS       128     /* 缓冲池 16 KiB，必须为 32 的倍数 */
+#define J1939_HEADROOM          32
+#define J1939_MAX_LEN           1785    /* 255 包 x 7 字节 */
+#define J1939_DONE_QUEUE        16
+#define J1939_CTS_PACKETS       16      /* 本机作为接收方时每个 CTS 允许的包数 */
+
+#define J1939_T1_MS             750     /* BAM / 数据包间隔超时 */
+#define J1939_T2_MS             1250    /* RTS/CTS 会话等待数据或 CTS 超时 */
+
+#define J1939_ADDR_GLOBAL       0xFF
+#define J1939_ADDR_NULL         0xFE
+
+#define J1939_PGN_REQUEST       0xEA00
+#define J1939_PGN_ADDR_CLAIM    0xEE00
+#define J1939_PGN_TP_CM         0xEC00
+#define J1939_PGN_TP_DT         0xEB00
+
+/* PGN 级报文：单帧报文 data 指向帧数据，多包报文 data 指向缓冲池 */
+typedef struct {
+    rt_uint8_t  channel;
+    rt_uint8_t  prio;
+    rt_uint8_t  sa;
+    rt_uint8_t  da;             /* PDU2 格式或广播为 J1939_ADDR_GLOBAL */
+    rt_uint32_t pgn;
+    rt_uint64_t timestamp;      /* 首帧接收时间 (CNTPCT) */
+    rt_uint16_t len;
+    rt_uint8_t  multi;          /* 多包报文，需 j1939_release */
+    const rt_uint8_t *data;
+} J1939Message;
+
+typedef struct {
+    rt_uint32_t frames;         /* 已启用通道上的 29 位帧 */
+    rt_uint32_t messages;       /* 组包完成的多包报文 */
+    rt_uint32_t bam;
+    rt_uint32_t rts;
+    rt_uint32_t aborted;        /* 超时、序号错误、Abort */
+    rt_uint32_t no_session;     /* 会话表满 */
+    rt_uint32_t no_buffer;      /* 缓冲池不足 */
+    rt_uint32_t dropped;        /* 待上报队列满 */
+    rt_uint32_t addr_claims;
+    rt_uint32_t addr_conflicts; /* 同一地址被不同 NAME 声明 */
+} J1939Stats;
+
+/* API */
+void j1939_enable(rt_uint8_t channel, rt_bool_t enable);
+
+/* 设置本机地址和 NAME 并发送地址声明，addr 为 J1939_ADDR_NULL 时只旁听 */
+int j1939_set_address(rt_uint8_t channel, rt_uint8_t addr, rt_uint64_t name);
+
+/* 解析单帧 PGN 报文 (不做传输协议处理)，通道未启用或非 29 位经典帧返回 RT_FALSE */
+rt_bool_t j1939_parse(const CanFrame *frame, J1939Message *msg);
+
+/* CAN 线程：处理一帧，传输协议帧 (TP.CM / TP.DT) 返回 RT_TRUE，由本模块组包后整条上报 */
+rt_bool_t j1939_input(const CanFrame *frame);
+
+/* CAN 线程：处理会话超时，返回距下一次到期的 ms，无会话返回 -1 */
+rt_int32_t j1939_poll(void);
+
+rt_bool_t j1939_collect(J1939Message *msg);
+void j1939_release(J1939Message *msg);
+
+/* 查询地址声明表，返回 RT_TRUE 表示该地址已被声明 */
+rt_bool_t j1939_lookup_name(rt_uint8_t channel, rt_uint8_t addr, rt_uint64_t *name);
+
+void j1939_get_stats(J1939Stats *stats);
+
+#endif
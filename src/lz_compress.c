@@ -0,0 +1,168 @@
+#include <rtthread.h>
+#include <string.h>
+#include "lz_compress.h"
+
+#define LZ_MIN_MATCH        4
+#define LZ_LAST_LITERALS    5   /* LZ4 规定最后 5 字节必须为字面量 */
+#define LZ_MFLIMIT          12  /* 最后一个匹配必须起始于结尾 12 字节之前 */
+#define LZ_SKIP_TRIGGER     6   /* 连续未命中时加大步长，避免不可压缩数据耗时过长 */
+
+static rt_uint32_t read32(const rt_uint8_t *p)
+{
+    rt_uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static rt_uint32_t lz_hash(rt_uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/* 写 LZ4 扩展长度 (255 累加) */
+static rt_uint8_t *put_length(rt_uint8_t *op, rt_size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (rt_uint8_t)len;
+    return op;
+}
+
+/* 输出一个序列：字面量 + (可选) 匹配 */
+static rt_uint8_t *emit_sequence(rt_uint8_t *op, rt_uint8_t *op_end,
+                                 const rt_uint8_t *lit, rt_size_t lit_len,
+                                 rt_uint16_t offset, rt_size_t match_len)
+{
+    /* 最坏情况长度：token + 扩展长度 + 字面量 + offset + 扩展长度 */
+    rt_size_t need = 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1;
+    if ((rt_size_t)(op_end - op) < need) return RT_NULL;
+
+    rt_uint8_t *token = op++;
+    *token = (rt_uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15) op = put_length(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len == 0) return op; /* 最后一个序列只有字面量 */
+
+    *op++ = (rt_uint8_t)offset;
+    *op++ = (rt_uint8_t)(offset >> 8);
+
+    match_len -= LZ_MIN_MATCH;
+    *token |= (rt_uint8_t)(match_len >= 15 ? 15 : match_len);
+    if (match_len >= 15) op = put_length(op, match_len - 15);
+    return op;
+}
+
+int lz_compress(LzContext *ctx, const rt_uint8_t *src, rt_size_t len, rt_uint8_t *dst, rt_size_t cap)
+{
+    rt_uint8_t *op = dst;
+    rt_uint8_t *op_end = dst + cap;
+    rt_size_t ip = 0, anchor = 0;
+
+    if (len > LZ_MAX_INPUT) return -RT_EFULL;
+
+    memset(ctx->table, 0, sizeof(ctx->table));
+
+    if (len >= LZ_MFLIMIT + 1) {
+        rt_size_t mflimit = len - LZ_MFLIMIT;
+        rt_size_t matchlimit = len - LZ_LAST_LITERALS;
+        rt_uint32_t misses = 0;
+
+        while (ip < mflimit) {
+            rt_uint32_t seq = read32(src + ip);
+            rt_uint32_t h = lz_hash(seq);
+            rt_size_t ref = ctx->table[h];
+            ctx->table[h] = (rt_uint16_t)(ip + 1);
+
+            if (ref == 0 || ip - (ref - 1) > LZ_WINDOW_SIZE || read32(src + ref - 1) != seq) {
+                ip += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+                continue;
+            }
+            ref -= 1;
+            misses = 0;
+
+            /* 向前扩展匹配 */
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+
+            /* 向后扩展匹配 */
+            rt_size_t mlen = LZ_MIN_MATCH;
+            while (ip + mlen < matchlimit && src[ref + mlen] == src[ip + mlen]) {
+                mlen++;
+            }
+
+            op = emit_sequence(op, op_end, src + anchor, ip - anchor, (rt_uint16_t)(ip - ref), mlen);
+            if (op == RT_NULL) return -RT_EFULL;
+
+            ip += mlen;
+            anchor = ip;
+
+            /* 补登记匹配末尾位置，提高下一次命中率 */
+            if (ip < mflimit) {
+                ctx->table[lz_hash(read32(src + ip - 2))] = (rt_uint16_t)(ip - 2 + 1);
+            }
+        }
+    }
+
+    op = emit_sequence(op, op_end, src + anchor, len - anchor, 0, 0);
+    if (op == RT_NULL) return -RT_EFULL;
+
+    return (int)(op - dst);
+}
+
+int lz_decompress(const rt_uint8_t *src, rt_size_t len, rt_uint8_t *dst, rt_size_t cap)
+{
+    const rt_uint8_t *ip = src;
+    const rt_uint8_t *ip_end = src + len;
+    rt_size_t op = 0;
+
+    while (ip < ip_end) {
+        rt_uint8_t token = *ip++;
+        rt_size_t lit_len = token >> 4;
+
+        if (lit_len == 15) {
+            rt_uint8_t b;
+            do {
+                if (ip >= ip_end) return -RT_ERROR;
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255);
+        }
+        if ((rt_size_t)(ip_end - ip) < lit_len || cap - op < lit_len) return -RT_ERROR;
+        memcpy(dst + op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (ip >= ip_end) break; /* 最后一个序列 */
+
+        if (ip_end - ip < 2) return -RT_ERROR;
+        rt_size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return -RT_ERROR;
+
+        rt_size_t mlen = token & 0x0F;
+        if (mlen == 15) {
+            rt_uint8_t b;
+            do {
+                if (ip >= ip_end) return -RT_ERROR;
+                b = *ip++;
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += LZ_MIN_MATCH;
+        if (cap - op < mlen) return -RT_ERROR;
+
+        /* 匹配可能与输出重叠，逐字节复制 */
+        const rt_uint8_t *ref = dst + op - offset;
+        while (mlen--) {
+            dst[op++] = *ref++;
+        }
+    }
+
+    return (int)op;
+}
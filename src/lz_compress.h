@@ -0,0 +1,27 @@
+#ifndef __LZ_COMPRESS_H__
+#define __LZ_COMPRESS_H__
+
+#include <rtthread.h>
+
+/*
+ * 小内存 LZ77 压缩，输出为标准 LZ4 block 格式，主机侧可直接用 lz4 库解压
+ * (或 scripts/payload_decode.py 内置的解码器)。
+ *
+ * 匹配窗口限制在 LZ_WINDOW_SIZE 字节内，哈希表常驻 LzContext (2KB)，
+ * 单次压缩输入不超过 LZ_MAX_INPUT。
+ */
+#define LZ_WINDOW_SIZE      4096
+#define LZ_HASH_BITS        10
+#define LZ_MAX_INPUT        0xFFFE
+
+typedef struct {
+    rt_uint16_t table[1 << LZ_HASH_BITS]; /* 位置 + 1，0 表示空 */
+} LzContext;
+
+/* 压缩 src，返回压缩后长度；输出空间不足返回 -RT_EFULL */
+int lz_compress(LzContext *ctx, const rt_uint8_t *src, rt_size_t len, rt_uint8_t *dst, rt_size_t cap);
+
+/* 解压，返回解压后长度；数据损坏或空间不足返回 -RT_ERROR */
+int lz_decompress(const rt_uint8_t *src, rt_size_t len, rt_uint8_t *dst, rt_size_t cap);
+
+#endif
@@ -73,6 +73,11 @@ int offline_cache_init(void)
 }
 
 int offline_cache_write(CacheType type, float val_f, rt_uint32_t val_raw)
+{
+    return offline_cache_write_at(type, rt_tick_get(), val_f, val_raw);
+}
+
+int offline_cache_write_at(CacheType type, rt_uint32_t timestamp, float val_f, rt_uint32_t val_raw)
 {
     if (ee_dev == RT_NULL) return -RT_ERROR;
 
@@ -86,7 +91,7 @@ int offline_cache_write(CacheType type, float val_f, rt_uint32_t val_raw)
 
     /* ׼¼ */
     CacheRecord record;
-    record.timestamp = rt_tick_get();
+    record.timestamp = timestamp;
     record.type = (rt_uint8_t)type;
     record.value_f = val_f;
     record.value_raw = val_raw;
@@ -109,18 +114,23 @@ int offline_cache_write(CacheType type, float val_f, rt_uint32_t val_raw)
 }
 
 int offline_cache_read(CacheRecord *record)
+{
+    return offline_cache_peek(0, record);
+}
+
+int offline_cache_peek(rt_uint32_t index, CacheRecord *record)
 {
     if (ee_dev == RT_NULL || record == RT_NULL) return -RT_ERROR;
 
     rt_mutex_take(cache_lock, RT_WAITING_FOREVER);
 
-    if (header.count == 0) {
+    if (index >= header.count) {
         rt_mutex_release(cache_lock);
         return -RT_EEMPTY;
     }
 
     /* ȡַ */
-    uint32_t addr = CACHE_HEADER_SIZE + header.tail * CACHE_RECORD_SIZE;
+    uint32_t addr = CACHE_HEADER_SIZE + ((header.tail + index) % MAX_RECORDS) * CACHE_RECORD_SIZE;
 
     if (at24cxx_read(ee_dev, addr, (uint8_t *)record, sizeof(CacheRecord)) == RT_EOK) {
         rt_mutex_release(cache_lock);
@@ -132,14 +142,21 @@ int offline_cache_read(CacheRecord *record)
 }
 
 int offline_cache_pop(void)
+{
+    return offline_cache_drop(1);
+}
+
+/* һƳֻдһ Header EEPROM д */
+int offline_cache_drop(rt_uint32_t n)
 {
     if (ee_dev == RT_NULL) return -RT_ERROR;
 
     rt_mutex_take(cache_lock, RT_WAITING_FOREVER);
 
-    if (header.count > 0) {
-        header.tail = (header.tail + 1) % MAX_RECORDS;
-        header.count--;
+    if (n > header.count) n = header.count;
+    if (n > 0) {
+        header.tail = (header.tail + n) % MAX_RECORDS;
+        header.count -= n;
         save_header();
     }
 
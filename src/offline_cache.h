@@ -7,6 +7,7 @@
 typedef enum {
     CACHE_TYPE_ADC = 1,
     CACHE_TYPE_CAN = 2,
+    CACHE_TYPE_ADC_VERTEX = 3, /* 旋转门压缩顶点：timestamp 为顶点时刻 (ms)，value_raw 为通道号 */
 } CacheType;
 
 /* 缓存记录结构体 (16 bytes) */
@@ -21,8 +22,11 @@ typedef struct {
 /* API */
 int offline_cache_init(void);
 int offline_cache_write(CacheType type, float val_f, rt_uint32_t val_raw);
+int offline_cache_write_at(CacheType type, rt_uint32_t timestamp, float val_f, rt_uint32_t val_raw); /* 指定时间戳 */
 int offline_cache_read(CacheRecord *record);
+int offline_cache_peek(rt_uint32_t index, CacheRecord *record); /* 读取从最旧起第 index 条，不移动读指针 */
 int offline_cache_pop(void); /* 确认读取成功，移动读指针 */
+int offline_cache_drop(rt_uint32_t n); /* 确认前 n 条已补传 */
 int offline_cache_is_empty(void);
 int offline_cache_get_count(void);
 
@@ -3,8 +3,42 @@
 #include <board.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "onenet_app.h"
 #include "onenet_config.h"
+#include "payload_codec.h"
+#include "perf_counter.h"
+#include "can_signal.h"
+#include "can_tx.h"
+#include "isotp.h"
+#include "j1939.h"
+
+#define CAN_BATCH_BUF_SIZE      1024
+#define CAN_SIGNAL_PER_MSG      16
+#define CAN_BATCH_TS_SLACK_MS   1000    /* 批次基准时间相对首帧的提前量，容纳优先级队列造成的接收时间乱序 */
+/* 单次发布的载荷上限，为 MQTT 头 (固定头、Topic、报文 ID) 留出余量 */
+#define ONENET_PUB_MAX          (ONENET_MQTT_BUF_SIZE - 128)
+/* 放不下一次发布的 ISO-TP 报文按段上报，每段的数据字节数 (JSON 模式为十六进制，另留属性文本) */
+#define ISOTP_PART_BIN          (ONENET_PUB_MAX - PAYLOAD_ISOTP_PART_HEADROOM)
+#define ISOTP_PART_JSON         ((ONENET_PUB_MAX - 256) / 2)
+/* JSON 模式 J1939 多包报文每段的数据字节数 (二进制模式整条报文放得下一次发布) */
+#define J1939_PART_JSON         ((ONENET_PUB_MAX - 320) / 2)
+#define FIXED3_MAX              1.0e17f /* format_fixed3 的钳位值，18 位整数 */
+#define LZ_BENCH_ROUNDS         16      /* lz_bench 每项重复次数，单次处理 1 KB 只跨少量 CNTPCT 计数 */
+
+#if PAYLOAD_ISOTP_HEADROOM > ISOTP_HEADROOM || PAYLOAD_ISOTP_PART_HEADROOM > ISOTP_HEADROOM
+#error "ISOTP_HEADROOM too small for in-place binary encoding"
+#endif
+#if ISOTP_MAX_LEN > 0xFFFF
+#error "ISO-TP part records carry 16-bit lengths"
+#endif
+
+#if PAYLOAD_J1939_HEADROOM > J1939_HEADROOM
+#error "J1939_HEADROOM too small for in-place binary encoding"
+#endif
+#if PAYLOAD_J1939_HEADROOM + J1939_MAX_LEN > ONENET_PUB_MAX
+#error "J1939 binary record does not fit one MQTT publish"
+#endif
 
 #define LED_PIN_0    BSP_IO_PORT_14_PIN_3
 #define LED_PIN_1    BSP_IO_PORT_14_PIN_0
@@ -13,6 +47,20 @@
 
 static uint32_t g_onenet_tx_count = 0;
 static uint32_t g_onenet_rx_count = 0;
+static PayloadMode g_payload_mode = PAYLOAD_MODE_JSON;
+static rt_bool_t g_payload_lz = RT_FALSE;
+
+/* CAN 批量上报缓冲 (二进制模式)，仅由 CAN 线程访问 */
+static uint8_t g_can_batch_buf[CAN_BATCH_BUF_SIZE];
+static PayloadWriter g_can_batch;
+static rt_tick_t g_can_batch_start;
+static uint32_t g_can_batch_fail = 0;       /* 发布失败、保留待重试的次数 */
+static uint32_t g_can_batch_drop = 0;       /* 缓冲未能提交时放不下而丢弃的帧数 */
+static rt_bool_t g_can_batch_retry = RT_FALSE;  /* 缓冲内是上次发布失败保留下来的数据 */
+
+/* 批量报文压缩上下文及输出缓冲，同样仅由 CAN 线程访问 */
+static LzContext g_lz_ctx;
+static uint8_t g_lz_buf[CAN_BATCH_BUF_SIZE];
 
 static void onenet_cmd_callback(void* client, message_data_t* msg)
 {
@@ -36,6 +84,36 @@ static void onenet_cmd_callback(void* client, message_data_t* msg)
         rt_pin_write(LED_PIN_2, PIN_LOW);
     }
 
+    /* 下发 CAN 帧: "can_tx":"[ch:]123#DEADBEEF" */
+    char *tx_start = strstr(payload, "\"can_tx\":\"");
+    if (tx_start)
+    {
+        rt_uint8_t channel;
+        CanFrame frame;
+        char text[CAN_TX_TEXT_MAX];
+        const char *value = tx_start + 10;
+        const char *quote = strchr(value, '"');
+        /* 先取出引号内的值，can_tx_parse 只看这一段 */
+        if (quote != RT_NULL && quote - value < (int)sizeof(text))
+        {
+            memcpy(text, value, quote - value);
+            text[quote - value] = '\0';
+        }
+        else
+        {
+            text[0] = '\0';
+        }
+        if (can_tx_parse(text, &channel, &frame) == RT_EOK &&
+            can_tx_send(channel, &frame, CAN_TX_PRIO_NORMAL) == RT_EOK)
+        {
+            KAWAII_MQTT_LOG_I("CAN TX queued: ch%u id 0x%X len %u", channel, frame.id, frame.len);
+        }
+        else
+        {
+            KAWAII_MQTT_LOG_E("CAN TX command rejected");
+        }
+    }
+
     /* 提取 ID 用于回复 */
     char request_id[32] = {0};
     char *id_start = strstr(payload, "\"id\":\"");
@@ -83,29 +161,255 @@ void onenet_app_init(mqtt_client_t *client)
     }
 }
 
-void onenet_upload_can(mqtt_client_t *client, uint32_t can_id, uint8_t *data, uint8_t len)
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/* 帧的硬件接收时间 (启动后微秒)，无时间戳时取当前时间 */
+static rt_uint64_t can_frame_time_us(const CanFrame *frame)
 {
-    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
-        return;
-    }
+    return frame->timestamp ? perf_to_us64(frame->timestamp) : (rt_uint64_t)rt_tick_get() * 1000;
+}
 
-    char payload[512];
-    char can_data_str[64];
-    
-    memset(can_data_str, 0, sizeof(can_data_str));
-    int data_len = (len > 8) ? 8 : len;
+/* 接收时间按 "秒.微秒" 输出 */
+static int format_can_ts(char *buf, rt_size_t size, rt_uint64_t ts_us)
+{
+    return rt_snprintf(buf, size, "%u.%06u", (rt_uint32_t)(ts_us / 1000000), (rt_uint32_t)(ts_us % 1000000));
+}
+
+/* 按 OneNET 物模型格式化一帧 CAN 数据，返回 JSON 长度 */
+static int onenet_format_can(char *payload, rt_size_t size, uint32_t can_id, uint8_t flags, const uint8_t *data, uint8_t len,
+                             rt_uint64_t ts_us)
+{
+    char can_data_str[CAN_FRAME_MAX_LEN * 2 + 1];
+    char ts[24];
+    int data_len = (len > CAN_FRAME_MAX_LEN) ? CAN_FRAME_MAX_LEN : len;
     
+    /* 查表转十六进制，64 字节 CAN-FD 数据避免逐字节调用 rt_snprintf */
     for (int i = 0; i < data_len; i++)
     {
-        rt_snprintf(can_data_str + i * 2, 3, "%02X", data[i]);
+        can_data_str[i * 2] = hex_digits[data[i] >> 4];
+        can_data_str[i * 2 + 1] = hex_digits[data[i] & 0x0F];
     }
+    can_data_str[data_len * 2] = '\0';
+    format_can_ts(ts, sizeof(ts), ts_us);
 
-    rt_snprintf(payload, sizeof(payload), 
+    return rt_snprintf(payload, size, 
                 "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
                 "\"can_id\":{\"value\":\"0x%08X\"},"
-                "\"can_data\":{\"value\":\"%s\"}"
+                "\"can_data\":{\"value\":\"%s\"},"
+                "\"can_flags\":{\"value\":%u},"
+                "\"can_ts\":{\"value\":%s}"
                 "}}", 
-                rt_tick_get(), can_id, can_data_str);
+                rt_tick_get(), can_id, can_data_str, flags, ts);
+}
+
+/*
+ * 按物模型格式化 J1939 PGN 级报文 (单帧或组包后的多包报文) 中 off 起的 n 字节，返回 JSON 长度。
+ * 只取一段时附带 j1939_len / j1939_offset，云端按偏移拼接。
+ */
+static int onenet_format_j1939(char *payload, rt_size_t size, const J1939Message *msg, rt_uint64_t ts_us,
+                               rt_uint32_t off, rt_uint32_t n)
+{
+    char ts[24];
+    int pos;
+
+    format_can_ts(ts, sizeof(ts), ts_us);
+    pos = rt_snprintf(payload, size,
+                      "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                      "\"j1939_pgn\":{\"value\":%u},"
+                      "\"j1939_sa\":{\"value\":%u},"
+                      "\"j1939_da\":{\"value\":%u},"
+                      "\"j1939_prio\":{\"value\":%u},"
+                      "\"can_ts\":{\"value\":%s},",
+                      rt_tick_get(), msg->pgn, msg->sa, msg->da, msg->prio, ts);
+    if (n < msg->len) {
+        pos += rt_snprintf(payload + pos, size - pos, "\"j1939_len\":{\"value\":%u},\"j1939_offset\":{\"value\":%u},",
+                           msg->len, off);
+    }
+    pos += rt_snprintf(payload + pos, size - pos, "\"j1939_data\":{\"value\":\"");
+    for (rt_uint32_t i = off; i < off + n && pos + 6 < (int)size; i++) {
+        payload[pos++] = hex_digits[msg->data[i] >> 4];
+        payload[pos++] = hex_digits[msg->data[i] & 0x0F];
+    }
+    rt_strncpy(payload + pos, "\"}}}", size - pos);
+    return pos + 4;
+}
+
+/*
+ * 浮点数按 3 位小数输出 (rt_snprintf 不支持 %f 与 %llu)：整数部分按 64 位取出，超过 9 位时分两段输出；
+ * 绝对值钳位到 FIXED3_MAX (NaN 同样钳位)，输出不超过 23 个字符
+ */
+static int format_fixed3(char *buf, rt_size_t size, float v)
+{
+    const char *sign = (v < 0) ? "-" : "";
+    float a = (v < 0) ? -v : v;
+
+    if (!(a <= FIXED3_MAX)) a = FIXED3_MAX;
+
+    /* 整数部分超过 2^24 时 float 已无小数位，a - whole 总是精确的 */
+    rt_uint64_t whole = (rt_uint64_t)a;
+    rt_uint32_t milli = (rt_uint32_t)((a - (float)whole) * 1000.0f + 0.5f);
+    if (milli >= 1000) {
+        whole++;
+        milli -= 1000;
+    }
+
+    if (whole >= 1000000000ULL) {
+        return rt_snprintf(buf, size, "%s%u%09u.%03u", sign, (rt_uint32_t)(whole / 1000000000ULL),
+                           (rt_uint32_t)(whole % 1000000000ULL), milli);
+    }
+    return rt_snprintf(buf, size, "%s%u.%03u", sign, (rt_uint32_t)whole, milli);
+}
+
+/* 已在信号库中定义的报文，按物模型属性上报解码后的物理值，返回 JSON 长度 */
+static int onenet_format_signals(char *payload, rt_size_t size, const CanSignalValue *values, int count, rt_uint64_t ts_us)
+{
+    char ts[24];
+
+    format_can_ts(ts, sizeof(ts), ts_us);
+    int pos = rt_snprintf(payload, size, "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{\"can_ts\":{\"value\":%s}",
+                          rt_tick_get(), ts);
+
+    for (int i = 0; i < count && pos < (int)size; i++) {
+        char num[24];
+        format_fixed3(num, sizeof(num), values[i].value);
+        pos += rt_snprintf(payload + pos, size - pos, ",\"%s\":{\"value\":%s}",
+                           can_signal_name(values[i].sig), num);
+    }
+    if (pos < (int)size) pos += rt_snprintf(payload + pos, size - pos, "}}");
+    return pos;
+}
+
+/* 二进制模式发布到自定义透传 Topic */
+static int onenet_publish_bin(mqtt_client_t *client, uint8_t *payload, rt_size_t len, mqtt_qos_t qos)
+{
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = qos;
+    msg.payload = (void *)payload;
+    msg.payloadlen = len;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_BIN_UP, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+int onenet_flush_can_batch(mqtt_client_t *client, rt_bool_t force)
+{
+    int ret = -RT_ERROR;
+
+    if (g_can_batch.count == 0) return 0;
+    if (!force && rt_tick_get() - g_can_batch_start < CAN_BATCH_FLUSH_MS) return 0;
+
+    if (client != NULL && client->mqtt_client_state == CLIENT_STATE_CONNECTED) {
+        uint8_t *payload = g_can_batch_buf;
+        rt_size_t len = payload_end(&g_can_batch);
+
+        /* 开启压缩且有收益时发送压缩后的报文 */
+        if (g_payload_lz) {
+            rt_size_t lz_len = payload_compress(&g_lz_ctx, payload, len, g_lz_buf, sizeof(g_lz_buf));
+            if (lz_len > 0) {
+                payload = g_lz_buf;
+                len = lz_len;
+            }
+        }
+        ret = onenet_publish_bin(client, payload, len, QOS1);
+    }
+
+    if (ret != 0) {
+        /* 保留缓冲 (payload_end 只回填 Header，之后仍可追加)，一个批量时限后再试 */
+        g_can_batch_fail++;
+        g_can_batch_retry = RT_TRUE;
+        g_can_batch_start = rt_tick_get();
+        rt_kprintf("[CAN] Batch publish failed (ret=%d), keeping %d frames. Total Tx: %u, Dropped: %u\n", ret,
+                   g_can_batch.count, g_onenet_tx_count, g_can_batch_drop);
+        return ret;
+    }
+    g_can_batch.count = 0;
+    g_can_batch_retry = RT_FALSE;
+    return 0;
+}
+
+/* 按帧类型写入批量缓冲，经典帧使用紧凑的 CAN 记录；记录时间取硬件接收时间 (ms + 毫秒内 us) */
+static int onenet_put_can(PayloadWriter *w, rt_uint64_t ts_us, const CanFrame *frame)
+{
+    rt_uint32_t tick = (rt_uint32_t)(ts_us / 1000);
+    rt_uint16_t us = (rt_uint16_t)(ts_us % 1000);
+    rt_uint32_t can_id = frame->id;
+    J1939Message jm;
+
+    /* 启用 J1939 的通道按 PGN / 源地址记录 */
+    if (j1939_parse(frame, &jm)) {
+        return payload_put_j1939(w, tick, us, jm.prio, jm.pgn, jm.sa, jm.da, jm.data, jm.len);
+    }
+
+    if (frame->flags & CAN_FRAME_FLAG_EXT) can_id |= PAYLOAD_CAN_ID_EXT;
+
+    if (frame->flags & CAN_FRAME_FLAG_FD) {
+        rt_uint8_t fd_flags = 0;
+        if (frame->flags & CAN_FRAME_FLAG_BRS) fd_flags |= PAYLOAD_CANFD_BRS;
+        if (frame->flags & CAN_FRAME_FLAG_ESI) fd_flags |= PAYLOAD_CANFD_ESI;
+        return payload_put_canfd_ts(w, tick, us, can_id, fd_flags, frame->data, frame->len);
+    }
+    return payload_put_can_ts(w, tick, us, can_id, frame->data, frame->len);
+}
+
+/* 二进制模式：CAN 帧先进入批量缓冲，满或超时后整包发布 */
+static void onenet_can_batch_begin(rt_uint64_t ts_us)
+{
+    payload_begin(&g_can_batch, g_can_batch_buf, sizeof(g_can_batch_buf),
+                  (rt_uint32_t)(ts_us / 1000) - CAN_BATCH_TS_SLACK_MS);
+    g_can_batch_start = rt_tick_get();
+}
+
+static void onenet_upload_can_bin(mqtt_client_t *client, const CanFrame *frame)
+{
+    rt_uint64_t ts_us = can_frame_time_us(frame);
+
+    if (g_can_batch.count == 0) {
+        onenet_can_batch_begin(ts_us);
+    }
+
+    /* 缓冲满或时间超出批次基准范围时先发布，以该帧时间重新开始。
+     * 保留的失败缓冲只按批量时限重试，未到时限或仍失败时丢弃本帧 */
+    if (onenet_put_can(&g_can_batch, ts_us, frame) != RT_EOK) {
+        onenet_flush_can_batch(client, g_can_batch_retry ? RT_FALSE : RT_TRUE);
+        if (g_can_batch.count != 0) {
+            g_can_batch_drop++;
+            return;
+        }
+        onenet_can_batch_begin(ts_us);
+        onenet_put_can(&g_can_batch, ts_us, frame);
+    }
+
+    onenet_flush_can_batch(client, RT_FALSE);
+}
+
+void onenet_upload_can(mqtt_client_t *client, const CanFrame *frame)
+{
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        onenet_upload_can_bin(client, frame);
+        return;
+    }
+
+    char payload[512];
+    CanSignalValue values[CAN_SIGNAL_PER_MSG];
+    J1939Message jm;
+    int n = can_signal_decode(frame, values, CAN_SIGNAL_PER_MSG);
+
+    if (n > 0) {
+        onenet_format_signals(payload, sizeof(payload), values, n, can_frame_time_us(frame));
+    } else if (j1939_parse(frame, &jm)) {
+        onenet_format_j1939(payload, sizeof(payload), &jm, can_frame_time_us(frame), 0, jm.len);
+    } else {
+        onenet_format_can(payload, sizeof(payload), frame->id, frame->flags, frame->data, frame->len,
+                          can_frame_time_us(frame));
+    }
     
     mqtt_message_t msg;
     memset(&msg, 0, sizeof(msg));
@@ -118,12 +422,191 @@ void onenet_upload_can(mqtt_client_t *client, uint32_t can_id, uint8_t *data, ui
     /* rt_kprintf("[CAN] Pub: %s\n", payload); */
 }
 
+/*
+ * 二进制模式：一次发布放得下时整条报文作为 ISOTP 记录，否则按 ISOTP_PART_BIN 分段为 ISOTP_PART 记录。
+ * 都在缓冲池中就地编码：首段的头部写在预留空间中，之后各段的头部覆盖上一段 (已发布) 数据的末尾。
+ */
+static int onenet_upload_isotp_bin(mqtt_client_t *client, const IsoTpMessage *msg, rt_uint64_t ts_us)
+{
+    rt_uint32_t tick = (rt_uint32_t)(ts_us / 1000);
+    rt_uint16_t us = (rt_uint16_t)(ts_us % 1000);
+    rt_uint32_t can_id = msg->rx_id;
+    PayloadWriter w;
+    int ret = 0;
+
+    if (msg->flags & CAN_FRAME_FLAG_EXT) can_id |= PAYLOAD_CAN_ID_EXT;
+
+    if (msg->len <= ISOTP_PART_BIN) {
+        rt_uint8_t *buf = msg->data - PAYLOAD_ISOTP_HEADROOM;
+        payload_begin(&w, buf, PAYLOAD_ISOTP_HEADROOM + msg->len, tick);
+        if (payload_put_isotp(&w, tick, us, can_id, msg->data, (rt_uint16_t)msg->len) != RT_EOK) return -1;
+        return onenet_publish_bin(client, buf, payload_end(&w), QOS1);
+    }
+
+    for (rt_uint32_t off = 0; off < msg->len && ret == 0; off += ISOTP_PART_BIN) {
+        rt_uint32_t n = (msg->len - off < ISOTP_PART_BIN) ? msg->len - off : ISOTP_PART_BIN;
+        rt_uint8_t *buf = msg->data + off - PAYLOAD_ISOTP_PART_HEADROOM;
+
+        payload_begin(&w, buf, PAYLOAD_ISOTP_PART_HEADROOM + n, tick);
+        if (payload_put_isotp_part(&w, tick, us, can_id, (rt_uint16_t)msg->len, (rt_uint16_t)off, msg->data + off,
+                                   (rt_uint16_t)n) != RT_EOK) {
+            return -1;
+        }
+        ret = onenet_publish_bin(client, buf, payload_end(&w), QOS1);
+    }
+    return ret;
+}
+
+int onenet_upload_isotp(mqtt_client_t *client, const IsoTpMessage *msg)
+{
+    static char payload[ISOTP_PART_JSON * 2 + 256];
+    rt_uint64_t ts_us = perf_to_us64(msg->timestamp);
+    char ts[24];
+    int ret = 0;
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        return onenet_upload_isotp_bin(client, msg, ts_us);
+    }
+
+    /* JSON 模式按 ISOTP_PART_JSON 分段，各段 isotp_id / can_ts / isotp_len 相同，isotp_offset 为本段位置 */
+    format_can_ts(ts, sizeof(ts), ts_us);
+    for (rt_uint32_t off = 0; off < msg->len && ret == 0; off += ISOTP_PART_JSON) {
+        rt_uint32_t n = (msg->len - off < ISOTP_PART_JSON) ? msg->len - off : ISOTP_PART_JSON;
+        int pos = rt_snprintf(payload, sizeof(payload),
+                              "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                              "\"isotp_id\":{\"value\":\"0x%08X\"},"
+                              "\"isotp_len\":{\"value\":%u},"
+                              "\"isotp_offset\":{\"value\":%u},"
+                              "\"can_ts\":{\"value\":%s},"
+                              "\"isotp_data\":{\"value\":\"",
+                              rt_tick_get(), msg->rx_id, msg->len, off, ts);
+        for (rt_uint32_t i = off; i < off + n; i++) {
+            payload[pos++] = hex_digits[msg->data[i] >> 4];
+            payload[pos++] = hex_digits[msg->data[i] & 0x0F];
+        }
+        rt_strncpy(payload + pos, "\"}}}", sizeof(payload) - pos);
+
+        mqtt_message_t mqtt_msg;
+        memset(&mqtt_msg, 0, sizeof(mqtt_msg));
+        mqtt_msg.qos = QOS1;
+        mqtt_msg.payload = (void *)payload;
+
+        ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &mqtt_msg);
+        if (ret == 0) {
+            g_onenet_tx_count++;
+        }
+    }
+    return ret;
+}
+
+int onenet_upload_j1939(mqtt_client_t *client, const J1939Message *msg)
+{
+    static char payload[J1939_PART_JSON * 2 + 320];
+    rt_uint64_t ts_us = perf_to_us64(msg->timestamp);
+    int ret = 0;
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        /* 多包报文位于缓冲池，在预留的头部空间中就地编码 */
+        rt_uint8_t *buf = (rt_uint8_t *)msg->data - PAYLOAD_J1939_HEADROOM;
+        rt_uint32_t tick = (rt_uint32_t)(ts_us / 1000);
+        PayloadWriter w;
+
+        payload_begin(&w, buf, PAYLOAD_J1939_HEADROOM + msg->len, tick);
+        if (payload_put_j1939(&w, tick, (rt_uint16_t)(ts_us % 1000), msg->prio, msg->pgn, msg->sa, msg->da,
+                              msg->data, msg->len) != RT_EOK) {
+            return -1;
+        }
+        return onenet_publish_bin(client, buf, payload_end(&w), QOS1);
+    }
+
+    /* 十六进制文本放不下一次发布的多包报文按 J1939_PART_JSON 分段 */
+    for (rt_uint32_t off = 0; off < msg->len && ret == 0; off += J1939_PART_JSON) {
+        rt_uint32_t n = (msg->len - off < J1939_PART_JSON) ? msg->len - off : J1939_PART_JSON;
+
+        onenet_format_j1939(payload, sizeof(payload), msg, ts_us, off, n);
+
+        mqtt_message_t mqtt_msg;
+        memset(&mqtt_msg, 0, sizeof(mqtt_msg));
+        mqtt_msg.qos = QOS1;
+        mqtt_msg.payload = (void *)payload;
+
+        ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &mqtt_msg);
+        if (ret == 0) {
+            g_onenet_tx_count++;
+        }
+    }
+    return ret;
+}
+
+int onenet_upload_can_health(mqtt_client_t *client, const CanHealthStats *stats)
+{
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        uint8_t bin[PAYLOAD_HEADER_SIZE + 3 + 14];
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        payload_put_can_health(&w, now, stats->channel, stats->state, stats->tec, stats->rec, stats->load,
+                               stats->frame_rate, (rt_uint16_t)stats->error_rate, (rt_uint16_t)stats->bus_off);
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS0);
+    }
+
+    char payload[384];
+    rt_snprintf(payload, sizeof(payload),
+                "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                "\"can_bus_ch\":{\"value\":%u},"
+                "\"can_bus_state\":{\"value\":%u},"
+                "\"can_tec\":{\"value\":%u},"
+                "\"can_rec\":{\"value\":%u},"
+                "\"can_bus_load\":{\"value\":%u.%u},"
+                "\"can_frame_rate\":{\"value\":%u},"
+                "\"can_err_rate\":{\"value\":%u},"
+                "\"can_bus_off\":{\"value\":%u}"
+                "}}",
+                rt_tick_get(), stats->channel, stats->state, stats->tec, stats->rec, stats->load / 10, stats->load % 10,
+                stats->frame_rate, stats->error_rate, stats->bus_off);
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS0;
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
 int onenet_upload_adc(mqtt_client_t *client, float voltage, int32_t raw_value)
 {
     if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
         return -1;
     }
 
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        uint8_t bin[PAYLOAD_HEADER_SIZE + 16];
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        payload_put_adc(&w, now, voltage, raw_value);
+
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS0);
+    }
+
     /* RT-Thread 的 rt_snprintf 默认可能不支持浮点数 %f */
     /* 手动转换浮点数为整数+小数部分 */
     int vol_int = (int)voltage;
@@ -150,3 +633,463 @@ int onenet_upload_adc(mqtt_client_t *client, float voltage, int32_t raw_value)
     /* rt_kprintf("[ADC] Pub: %s\n", payload); */
     return ret;
 }
+
+/* 启动后微秒按 "秒.毫秒" 输出 */
+static int format_ms_ts(char *buf, rt_size_t size, rt_uint64_t ts_us)
+{
+    rt_uint64_t ms = ts_us / 1000;
+    return rt_snprintf(buf, size, "%u.%03u", (rt_uint32_t)(ms / 1000), (rt_uint32_t)(ms % 1000));
+}
+
+/* 在 app_adc 线程中调用，文本缓冲放在静态区 */
+int onenet_upload_adc_stats(mqtt_client_t *client, const StreamSummary *stats)
+{
+    static char num[7][24], t_min[24], t_max[24];
+    static char payload[512];
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        uint8_t bin[PAYLOAD_HEADER_SIZE + 3 + 40];
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        payload_put_adc_stats(&w, now, stats);
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS0);
+    }
+
+    const float v[7] = { stats->mean, stats->std, stats->min, stats->max, stats->p50, stats->p95, stats->p99 };
+    for (int i = 0; i < 7; i++) format_fixed3(num[i], sizeof(num[i]), v[i]);
+    format_ms_ts(t_min, sizeof(t_min), stats->t_min);
+    format_ms_ts(t_max, sizeof(t_max), stats->t_max);
+
+    rt_snprintf(payload, sizeof(payload),
+                "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                "\"adc_count\":{\"value\":%u},"
+                "\"adc_mean\":{\"value\":%s},"
+                "\"adc_std\":{\"value\":%s},"
+                "\"adc_min\":{\"value\":%s},"
+                "\"adc_max\":{\"value\":%s},"
+                "\"adc_p50\":{\"value\":%s},"
+                "\"adc_p95\":{\"value\":%s},"
+                "\"adc_p99\":{\"value\":%s},"
+                "\"adc_min_ts\":{\"value\":%s},"
+                "\"adc_max_ts\":{\"value\":%s}"
+                "}}",
+                rt_tick_get(), stats->count, num[0], num[1], num[2], num[3], num[4], num[5], num[6], t_min, t_max);
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS0;
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+/* 在 app_adc 线程中调用，文本缓冲放在静态区 */
+int onenet_upload_fft_feature(mqtt_client_t *client, const FftFeatures *f)
+{
+    static char num[5][24];
+    static char bands[FFT_FEATURE_BANDS * 12 + 2];
+    static char payload[640];
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        uint8_t bin[PAYLOAD_HEADER_SIZE + 3 + 27 + 4 * FFT_FEATURE_BANDS];
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        payload_put_fft_feature(&w, now, f);
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS0);
+    }
+
+    const float v[5] = { f->rms, f->peak, f->crest, f->dom_freq, f->dom_amp };
+    for (int i = 0; i < 5; i++) format_fixed3(num[i], sizeof(num[i]), v[i]);
+
+    /* 频带均方根量级为 mV，按 6 位小数输出 */
+    int pos = 0;
+    for (int i = 0; i < FFT_FEATURE_BANDS; i++) {
+        rt_uint32_t uv = (rt_uint32_t)(f->band_rms[i] * 1e6f + 0.5f);
+        pos += rt_snprintf(bands + pos, sizeof(bands) - pos, "%s%u.%06u", i ? "," : "", uv / 1000000, uv % 1000000);
+    }
+
+    rt_snprintf(payload, sizeof(payload),
+                "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                "\"fft_size\":{\"value\":%u},"
+                "\"fft_rate\":{\"value\":%u},"
+                "\"fft_rms\":{\"value\":%s},"
+                "\"fft_peak\":{\"value\":%s},"
+                "\"fft_crest\":{\"value\":%s},"
+                "\"fft_dom_freq\":{\"value\":%s},"
+                "\"fft_dom_amp\":{\"value\":%s},"
+                "\"fft_band_rms\":{\"value\":[%s]}"
+                "}}",
+                rt_tick_get(), f->size, f->rate, num[0], num[1], num[2], num[3], num[4], bands);
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS0;
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+int onenet_upload_adc_alarm(mqtt_client_t *client, const AdcAlarmEvent *ev, float voltage)
+{
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    rt_uint64_t ts_us = perf_to_us64(ev->t);
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        uint8_t bin[PAYLOAD_HEADER_SIZE + 3 + 14];
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        payload_put_adc_alarm(&w, now, ev->chan, ev->state, ev->raw, voltage, ts_us);
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS1);
+    }
+
+    char volt[24];
+    format_fixed3(volt, sizeof(volt), voltage);
+
+    char payload[320];
+    rt_snprintf(payload, sizeof(payload),
+                "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                "\"adc_alarm_ch\":{\"value\":%u},"
+                "\"adc_alarm_state\":{\"value\":%u},"
+                "\"adc_alarm_raw\":{\"value\":%u},"
+                "\"adc_alarm_voltage\":{\"value\":%s},"
+                "\"adc_alarm_ts\":{\"value\":%u.%06u}"
+                "}}",
+                rt_tick_get(), ev->chan, ev->state, ev->raw, volt,
+                (rt_uint32_t)(ts_us / 1000000), (rt_uint32_t)(ts_us % 1000000));
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS1; /* 报警边沿不能丢 */
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+/* 在 app_adc 线程中调用，缓冲放在静态区，不占线程栈 */
+int onenet_upload_adc_vertices(mqtt_client_t *client, rt_uint8_t chan, const SdtPoint *pts, int n)
+{
+    /* 顶点间隔超过 16 位时分成多条记录，最坏每个顶点一条 */
+    static uint8_t bin[PAYLOAD_HEADER_SIZE + ADC_VERTEX_BATCH * (3 + 6 + 6)];
+    /* 时间按 "秒.毫秒"，电压按 4 位小数 (0.1 mV) */
+    static char ts[ADC_VERTEX_BATCH * 16], volts[ADC_VERTEX_BATCH * 12];
+    static char payload[512];
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+    if (n <= 0) return 0;
+    if (n > ADC_VERTEX_BATCH) n = ADC_VERTEX_BATCH;
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, bin, sizeof(bin), now);
+        for (int i = 0; i < n; ) {
+            int m = payload_put_adc_vertices(&w, now, chan, pts + i, (rt_uint8_t)(n - i));
+            if (m <= 0) break;
+            i += m;
+        }
+        return onenet_publish_bin(client, bin, payload_end(&w), QOS0);
+    }
+
+    int ts_pos = 0, v_pos = 0;
+    for (int i = 0; i < n; i++) {
+        float v = pts[i].v;
+        rt_uint32_t dmv = (rt_uint32_t)((v < 0 ? -v : v) * 10000.0f + 0.5f);
+        ts_pos += rt_snprintf(ts + ts_pos, sizeof(ts) - ts_pos, "%s%u.%03u", i ? "," : "",
+                              pts[i].t / 1000, pts[i].t % 1000);
+        v_pos += rt_snprintf(volts + v_pos, sizeof(volts) - v_pos, "%s%s%u.%04u", i ? "," : "", v < 0 ? "-" : "",
+                             dmv / 10000, dmv % 10000);
+    }
+
+    rt_snprintf(payload, sizeof(payload),
+                "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                "\"adc_vtx_ch\":{\"value\":%u},"
+                "\"adc_vtx_ts\":{\"value\":[%s]},"
+                "\"adc_vtx_v\":{\"value\":[%s]}"
+                "}}",
+                rt_tick_get(), chan, ts, volts);
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS0;
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+int onenet_upload_wave_chunk(mqtt_client_t *client, const WaveCapture *cap, rt_uint16_t seq)
+{
+    static rt_uint16_t samples[WAVE_CHUNK_BYTES / 2];
+    static char payload[WAVE_CHUNK_BYTES * 2 + 512];
+
+    if (client == NULL || client->mqtt_client_state != CLIENT_STATE_CONNECTED) {
+        return -1;
+    }
+
+    rt_uint32_t scans = wave_capture_read(cap, (rt_uint32_t)seq * cap->chunk_scans, cap->chunk_scans, samples);
+    if (scans == 0) return -1;
+
+    if (g_payload_mode == PAYLOAD_MODE_BIN) {
+        /* 与 JSON 缓冲共用，二进制记录远小于其十六进制文本 */
+        PayloadWriter w;
+        rt_uint32_t now = rt_tick_get();
+
+        payload_begin(&w, (rt_uint8_t *)payload, sizeof(payload), now);
+        if (payload_put_wave_chunk(&w, now, cap, seq, samples, scans) != RT_EOK) return -1;
+        return onenet_publish_bin(client, (rt_uint8_t *)payload, payload_end(&w), QOS1);
+    }
+
+    char chans[ADC_ACQ_MAX_CHANNELS * 4], adds[ADC_ACQ_MAX_CHANNELS * 4];
+    int c_pos = 0, a_pos = 0, pos;
+    for (int i = 0; i < cap->channels; i++) {
+        c_pos += rt_snprintf(chans + c_pos, sizeof(chans) - c_pos, "%s%u", i ? "," : "", cap->channel_id[i]);
+        a_pos += rt_snprintf(adds + a_pos, sizeof(adds) - a_pos, "%s%u", i ? "," : "", cap->adds[i]);
+    }
+
+    pos = rt_snprintf(payload, sizeof(payload),
+                      "{\"id\":\"%u\",\"version\":\"1.0\",\"params\":{"
+                      "\"wave_id\":{\"value\":%u},"
+                      "\"wave_seq\":{\"value\":%u},"
+                      "\"wave_chunks\":{\"value\":%u},"
+                      "\"wave_src\":{\"value\":%u},"
+                      "\"wave_ch\":{\"value\":[%s]},"
+                      "\"wave_adds\":{\"value\":[%s]},"
+                      "\"wave_rate\":{\"value\":%u},"
+                      "\"wave_ts\":{\"value\":%u.%06u},"
+                      "\"wave_pre\":{\"value\":%u},"
+                      "\"wave_post\":{\"value\":%u},"
+                      "\"wave_offset\":{\"value\":%u},"
+                      "\"wave_data\":{\"value\":\"",
+                      rt_tick_get(), cap->id, seq, cap->chunks, cap->source, chans, adds, cap->rate,
+                      (rt_uint32_t)(cap->t_trig_us / 1000000), (rt_uint32_t)(cap->t_trig_us % 1000000),
+                      cap->pre, cap->post, (rt_uint32_t)seq * cap->chunk_scans);
+    for (rt_uint32_t i = 0; i < scans * cap->channels; i++) {
+        payload[pos++] = hex_digits[(samples[i] >> 4) & 0x0F];
+        payload[pos++] = hex_digits[samples[i] & 0x0F];
+        payload[pos++] = hex_digits[samples[i] >> 12];
+        payload[pos++] = hex_digits[(samples[i] >> 8) & 0x0F];
+    }
+    rt_strncpy(payload + pos, "\"}}}", sizeof(payload) - pos);
+
+    mqtt_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.qos = QOS1;
+    msg.payload = (void *)payload;
+
+    int ret = mqtt_publish(client, ONENET_TOPIC_PROP_POST, &msg);
+    if (ret == 0) {
+        g_onenet_tx_count++;
+    }
+    return ret;
+}
+
+void onenet_set_payload_mode(PayloadMode mode)
+{
+    g_payload_mode = mode;
+}
+
+PayloadMode onenet_get_payload_mode(void)
+{
+    return g_payload_mode;
+}
+
+/* msh: payload_mode [json|bin] */
+static int payload_mode(int argc, char **argv)
+{
+    if (argc >= 2) {
+        if (strcmp(argv[1], "bin") == 0) {
+            onenet_set_payload_mode(PAYLOAD_MODE_BIN);
+        } else if (strcmp(argv[1], "json") == 0) {
+            onenet_set_payload_mode(PAYLOAD_MODE_JSON);
+        } else {
+            rt_kprintf("Usage: payload_mode [json|bin]\n");
+            return -1;
+        }
+    }
+    rt_kprintf("Payload mode: %s\n", g_payload_mode == PAYLOAD_MODE_BIN ? "bin" : "json");
+    return 0;
+}
+MSH_CMD_EXPORT(payload_mode, Select CAN/ADC upload encoding: json or bin);
+
+/* msh: onenet_stat —— 上下行报文计数及 CAN 批量缓冲的重试/丢帧 */
+static int onenet_stat(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    rt_kprintf("Total Tx: %u, Rx: %u\n", g_onenet_tx_count, g_onenet_rx_count);
+    rt_kprintf("CAN batch: %d frames pending, %u publish failures, %u frames dropped\n", g_can_batch.count,
+               g_can_batch_fail, g_can_batch_drop);
+    return 0;
+}
+MSH_CMD_EXPORT(onenet_stat, Show OneNET Tx/Rx counters and CAN batch drops);
+
+/* msh: payload_lz [on|off] —— 二进制批量报文压缩开关 */
+static int payload_lz(int argc, char **argv)
+{
+    if (argc >= 2) {
+        g_payload_lz = (strcmp(argv[1], "on") == 0) ? RT_TRUE : RT_FALSE;
+    }
+    rt_kprintf("Batch compression: %s\n", g_payload_lz ? "on" : "off");
+    return 0;
+}
+MSH_CMD_EXPORT(payload_lz, Enable LZ compression of binary batch payloads);
+
+/* msh: payload_bench [frames] —— 比较 JSON 与二进制编码的字节数和 CPU 耗时 */
+static int payload_bench(int argc, char **argv)
+{
+    int frames = (argc >= 2) ? atoi(argv[1]) : 1000;
+    static char json[512];
+    static uint8_t bin[1024];
+    uint8_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+    uint32_t json_bytes = 0, bin_single = 0, bin_batch = 0;
+    uint64_t t0, t_json, t_bin;
+    PayloadWriter w;
+
+    if (frames <= 0) frames = 1000;
+
+    t0 = perf_now();
+    for (int i = 0; i < frames; i++) {
+        data[0] = (uint8_t)i;
+        json_bytes += onenet_format_can(json, sizeof(json), 0x18FF0000 + (i & 0xF), CAN_FRAME_FLAG_EXT, data, 8, 0);
+    }
+    t_json = perf_now() - t0;
+
+    t0 = perf_now();
+    for (int i = 0; i < frames; i++) {
+        data[0] = (uint8_t)i;
+        payload_begin(&w, bin, sizeof(bin), 0);
+        payload_put_can(&w, 0, (0x18FF0000 + (i & 0xF)) | PAYLOAD_CAN_ID_EXT, data, 8);
+        bin_single += payload_end(&w);
+    }
+    t_bin = perf_now() - t0;
+
+    /* 批量：同一报文内连续放入记录，直到缓冲区满 */
+    payload_begin(&w, bin, sizeof(bin), 0);
+    for (int i = 0; i < frames; i++) {
+        if (payload_put_can(&w, i, (0x18FF0000 + (i & 0xF)) | PAYLOAD_CAN_ID_EXT, data, 8) != RT_EOK) {
+            bin_batch += payload_end(&w);
+            payload_begin(&w, bin, sizeof(bin), i);
+            payload_put_can(&w, i, (0x18FF0000 + (i & 0xF)) | PAYLOAD_CAN_ID_EXT, data, 8);
+        }
+    }
+    bin_batch += payload_end(&w);
+
+    rt_kprintf("[Bench] %d CAN frames (8 bytes)\n", frames);
+    rt_kprintf("  json  : %u bytes (%u/frame), %u us\n",
+               json_bytes, json_bytes / frames, perf_to_us(t_json));
+    rt_kprintf("  bin   : %u bytes (%u/frame), %u us\n",
+               bin_single, bin_single / frames, perf_to_us(t_bin));
+    rt_kprintf("  batch : %u bytes (%u/frame)\n", bin_batch, bin_batch / frames);
+    return 0;
+}
+MSH_CMD_EXPORT(payload_bench, Compare JSON and binary payload size and encode time);
+
+/* 压缩一段报文并校验，输出压缩率、单次耗时及每字节周期数 (CNTPCT 实测，多轮取总和以覆盖计数器分辨率) */
+static void lz_bench_one(const char *name, const uint8_t *in, rt_size_t len, uint8_t *out, rt_size_t cap, uint8_t *check)
+{
+    static LzContext ctx;
+    uint64_t t0, t_comp, t_decomp;
+    int n = 0, d = 0;
+
+    t0 = perf_now();
+    for (int r = 0; r < LZ_BENCH_ROUNDS; r++) n = lz_compress(&ctx, in, len, out, cap);
+    t_comp = perf_now() - t0;
+    if (n <= 0) {
+        rt_kprintf("  %-6s: compress failed (%d)\n", name, n);
+        return;
+    }
+
+    t0 = perf_now();
+    for (int r = 0; r < LZ_BENCH_ROUNDS; r++) d = lz_decompress(out, n, check, len);
+    t_decomp = perf_now() - t0;
+    if (d != (int)len || memcmp(in, check, len) != 0) {
+        rt_kprintf("  %-6s: verify failed\n", name);
+        return;
+    }
+
+    rt_uint64_t bytes = (rt_uint64_t)len * LZ_BENCH_ROUNDS;
+    rt_uint32_t c_comp = (rt_uint32_t)(perf_to_cycles(t_comp) * 100 / bytes);
+    rt_uint32_t c_decomp = (rt_uint32_t)(perf_to_cycles(t_decomp) * 100 / bytes);
+
+    rt_kprintf("  %-6s: %u -> %d bytes (ratio %u.%02u)\n", name, (uint32_t)len, n, (uint32_t)(len / n),
+               (uint32_t)(len * 100 / n % 100));
+    rt_kprintf("          compress   %5u us, %u.%02u cyc/B\n", perf_to_us(t_comp / LZ_BENCH_ROUNDS),
+               c_comp / 100, c_comp % 100);
+    rt_kprintf("          decompress %5u us, %u.%02u cyc/B\n", perf_to_us(t_decomp / LZ_BENCH_ROUNDS),
+               c_decomp / 100, c_decomp % 100);
+}
+
+/* msh: lz_bench —— 以典型网关流量 (周期 CAN 报文) 评估压缩率与耗时 */
+static int lz_bench(int argc, char **argv)
+{
+    static uint8_t in[CAN_BATCH_BUF_SIZE];
+    static uint8_t out[CAN_BATCH_BUF_SIZE + 64];
+    static uint8_t check[CAN_BATCH_BUF_SIZE];
+    uint8_t data[8] = {0x00, 0x10, 0x27, 0x00, 0x5A, 0x00, 0xFF, 0x01};
+    PayloadWriter w;
+    rt_size_t pos = 0;
+    int i;
+
+    (void)argc;
+    (void)argv;
+
+    /* 二进制批量：16 个周期 ID，10ms 周期，信号缓慢变化 */
+    payload_begin(&w, in, sizeof(in), 0);
+    for (i = 0; ; i++) {
+        data[0] = (uint8_t)(i >> 4);
+        data[3] = (uint8_t)(i & 0x3);
+        if (payload_put_can(&w, i * 10 / 16, (0x18FF0000 + (i & 0xF)) | PAYLOAD_CAN_ID_EXT, data, 8) != RT_EOK) break;
+    }
+    rt_kprintf("[Bench] LZ window %d, context %u bytes, %d rounds (CNTPCT %u Hz, cycles at %u Hz)\n", LZ_WINDOW_SIZE,
+               (uint32_t)sizeof(LzContext), LZ_BENCH_ROUNDS, (uint32_t)__get_CNTFRQ(), (uint32_t)SystemCoreClock);
+    lz_bench_one("bin", in, payload_end(&w), out, sizeof(out), check);
+
+    /* JSON 批量：同样的帧按物模型 JSON 拼接 */
+    for (i = 0; ; i++) {
+        char json[192];
+        data[0] = (uint8_t)(i >> 4);
+        int n = onenet_format_can(json, sizeof(json), 0x18FF0000 + (i & 0xF), CAN_FRAME_FLAG_EXT, data, 8, 0);
+        if (pos + n > sizeof(in)) break;
+        memcpy(in + pos, json, n);
+        pos += n;
+    }
+    lz_bench_one("json", in, pos, out, sizeof(out), check);
+    return 0;
+}
+MSH_CMD_EXPORT(lz_bench, Benchmark batch payload compression ratio and speed);
@@ -3,14 +3,62 @@
 
 #include <rtthread.h>
 #include "mqttclient.h"
+#include "payload_codec.h"
+#include "can_ring.h"
+#include "isotp.h"
+#include "j1939.h"
+#include "can_health.h"
+#include "stream_stats.h"
+#include "fft_feature.h"
+#include "adc_alarm.h"
+#include "sdt_compress.h"
+#include "wave_capture.h"
 
 /* 初始化 OneNET 应用 (订阅 Topic 等) */
 void onenet_app_init(mqtt_client_t *client);
 
 /* 上报 CAN 数据 */
-void onenet_upload_can(mqtt_client_t *client, uint32_t can_id, uint8_t *data, uint8_t len);
+void onenet_upload_can(mqtt_client_t *client, const CanFrame *frame);
+
+/* 上报一条 ISO-TP 组包完成的报文，二进制模式下就地使用报文缓冲的预留头部 */
+int onenet_upload_isotp(mqtt_client_t *client, const IsoTpMessage *msg);
+
+/* 上报一条 J1939 多包报文，二进制模式下同样就地编码 */
+int onenet_upload_j1939(mqtt_client_t *client, const J1939Message *msg);
+
+/* 上报一个通道的总线健康统计 */
+int onenet_upload_can_health(mqtt_client_t *client, const CanHealthStats *stats);
 
 /* 上报 ADC 数据 */
 int onenet_upload_adc(mqtt_client_t *client, float voltage, int32_t raw_value);
 
+/* 上报一个上报周期的 ADC 电压统计 (均值/标准差/极值及时间/分位数) */
+int onenet_upload_adc_stats(mqtt_client_t *client, const StreamSummary *stats);
+
+/* 上报一帧振动频谱特征 */
+int onenet_upload_fft_feature(mqtt_client_t *client, const FftFeatures *f);
+
+/* 上报一次 ADC 报警状态变化，时间为比较中断时刻 */
+int onenet_upload_adc_alarm(mqtt_client_t *client, const AdcAlarmEvent *ev, float voltage);
+
+/* 一次上报的压缩顶点数上限 */
+#define ADC_VERTEX_BATCH    16
+
+/* 上报一个 ADC 通道的一批旋转门压缩顶点 (按时间递增，最多 ADC_VERTEX_BATCH 个) */
+int onenet_upload_adc_vertices(mqtt_client_t *client, rt_uint8_t chan, const SdtPoint *pts, int n);
+
+/* 上报触发捕获的第 seq 块 (从环中读出原始码值)，JSON 模式下采样数据为小端 16 位码值的十六进制 */
+int onenet_upload_wave_chunk(mqtt_client_t *client, const WaveCapture *cap, rt_uint16_t seq);
+
+/* 二进制模式 CAN 批量上报时限 (ms) */
+#define CAN_BATCH_FLUSH_MS  100
+
+/* 二进制模式下提交 CAN 批量缓冲，force=RT_FALSE 时仅在超过批量时限后提交。
+ * 未连接或发布失败时保留缓冲，一个批量时限后重试，返回非 0 */
+int onenet_flush_can_batch(mqtt_client_t *client, rt_bool_t force);
+
+/* 选择上报编码方式 (JSON 物模型 / 二进制透传) */
+void onenet_set_payload_mode(PayloadMode mode);
+PayloadMode onenet_get_payload_mode(void);
+
 #endif /* _ONENET_APP_H_ */
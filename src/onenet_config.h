@@ -12,4 +12,11 @@
 /* 格式: $sys/{pid}/{device-name}/thing/property/set_reply */
 #define ONENET_TOPIC_PROP_SET_REPLY "$sys/" ONENET_PROD_ID "/" ONENET_DEV_NAME "/thing/property/set_reply"
 
+/* 自定义透传 Topic (上行)，用于二进制遥测，需在平台侧预先创建 */
+/* 格式: $sys/{pid}/{device-name}/custome/{topic} */
+#define ONENET_TOPIC_BIN_UP "$sys/" ONENET_PROD_ID "/" ONENET_DEV_NAME "/custome/telemetry/up"
+
+/* MQTT 收发缓冲大小，单次发布的整个报文 (MQTT 头 + Topic + 载荷) 不能超过写缓冲 */
+#define ONENET_MQTT_BUF_SIZE    2048
+
 #endif /* _ONENET_CONFIG_H_ */
@@ -0,0 +1,303 @@
+#include <rtthread.h>
+#include <string.h>
+#include "payload_codec.h"
+
+static void put_u16(rt_uint8_t *p, rt_uint16_t v)
+{
+    p[0] = (rt_uint8_t)v;
+    p[1] = (rt_uint8_t)(v >> 8);
+}
+
+static void put_u32(rt_uint8_t *p, rt_uint32_t v)
+{
+    p[0] = (rt_uint8_t)v;
+    p[1] = (rt_uint8_t)(v >> 8);
+    p[2] = (rt_uint8_t)(v >> 16);
+    p[3] = (rt_uint8_t)(v >> 24);
+}
+
+static void put_f32(rt_uint8_t *p, float v)
+{
+    rt_uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+/* 写入记录公共头 (Tag + 时间增量)，空间不足或增量溢出时返回 RT_NULL */
+static rt_uint8_t *record_alloc(PayloadWriter *w, PayloadTag tag, rt_uint32_t tick, rt_size_t body_len)
+{
+    rt_uint32_t delta = tick - w->base_tick;
+
+    if (w->count == 0xFF || delta > 0xFFFF) return RT_NULL;
+    if (w->pos + 3 + body_len > w->size) return RT_NULL;
+
+    rt_uint8_t *p = w->buf + w->pos;
+    p[0] = (rt_uint8_t)tag;
+    put_u16(p + 1, (rt_uint16_t)delta);
+
+    w->pos += 3 + body_len;
+    w->count++;
+    return p + 3;
+}
+
+void payload_begin(PayloadWriter *w, rt_uint8_t *buf, rt_size_t size, rt_uint32_t base_tick)
+{
+    w->buf = buf;
+    w->size = size;
+    w->pos = PAYLOAD_HEADER_SIZE;
+    w->base_tick = base_tick;
+    w->count = 0;
+}
+
+/* CAN / CAN-FD 记录，us 为毫秒内的微秒数，小于 0 时写入不带微秒的记录 */
+static int put_can_record(PayloadWriter *w, rt_uint32_t tick, int us, rt_bool_t fd, rt_uint32_t can_id,
+                          rt_uint8_t fd_flags, const rt_uint8_t *data, rt_uint8_t len)
+{
+    PayloadTag tag;
+    rt_size_t body;
+
+    if (len > (fd ? 64 : 8)) len = fd ? 64 : 8;
+
+    if (us < 0) {
+        tag = fd ? PAYLOAD_TAG_CANFD : PAYLOAD_TAG_CAN;
+    } else {
+        tag = fd ? PAYLOAD_TAG_CANFD_TS : PAYLOAD_TAG_CAN_TS;
+    }
+    body = (us < 0 ? 0 : 2) + (fd ? 6 : 5) + len;
+
+    rt_uint8_t *p = record_alloc(w, tag, tick, body);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    if (us >= 0) {
+        put_u16(p, (rt_uint16_t)us);
+        p += 2;
+    }
+    put_u32(p, can_id);
+    p += 4;
+    if (fd) *p++ = fd_flags;
+    *p++ = len;
+    memcpy(p, data, len);
+    return RT_EOK;
+}
+
+int payload_put_can(PayloadWriter *w, rt_uint32_t tick, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint8_t len)
+{
+    return put_can_record(w, tick, -1, RT_FALSE, can_id, 0, data, len);
+}
+
+int payload_put_canfd(PayloadWriter *w, rt_uint32_t tick, rt_uint32_t can_id, rt_uint8_t fd_flags, const rt_uint8_t *data, rt_uint8_t len)
+{
+    return put_can_record(w, tick, -1, RT_TRUE, can_id, fd_flags, data, len);
+}
+
+int payload_put_can_ts(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint8_t len)
+{
+    return put_can_record(w, tick, us, RT_FALSE, can_id, 0, data, len);
+}
+
+int payload_put_canfd_ts(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, rt_uint8_t fd_flags, const rt_uint8_t *data, rt_uint8_t len)
+{
+    return put_can_record(w, tick, us, RT_TRUE, can_id, fd_flags, data, len);
+}
+
+int payload_put_isotp(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint16_t len)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_ISOTP, tick, 8 + len);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u16(p, us);
+    put_u32(p + 2, can_id);
+    put_u16(p + 6, len);
+    if (p + 8 != data) memmove(p + 8, data, len);
+    return RT_EOK;
+}
+
+int payload_put_isotp_part(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, rt_uint16_t total,
+                           rt_uint16_t offset, const rt_uint8_t *data, rt_uint16_t len)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_ISOTP_PART, tick, 12 + len);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u16(p, us);
+    put_u32(p + 2, can_id);
+    put_u16(p + 6, total);
+    put_u16(p + 8, offset);
+    put_u16(p + 10, len);
+    if (p + 12 != data) memmove(p + 12, data, len);
+    return RT_EOK;
+}
+
+int payload_put_j1939(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint8_t prio, rt_uint32_t pgn,
+                      rt_uint8_t sa, rt_uint8_t da, const rt_uint8_t *data, rt_uint16_t len)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_J1939, tick, 10 + len);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u16(p, us);
+    put_u32(p + 2, (pgn & 0x3FFFF) | ((rt_uint32_t)(prio & 7) << 24));
+    p[6] = sa;
+    p[7] = da;
+    put_u16(p + 8, len);
+    if (p + 10 != data) memmove(p + 10, data, len);
+    return RT_EOK;
+}
+
+int payload_put_can_health(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t channel, rt_uint8_t state, rt_uint8_t tec,
+                           rt_uint8_t rec, rt_uint16_t load, rt_uint32_t frame_rate, rt_uint16_t error_rate, rt_uint16_t bus_off)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_CAN_HEALTH, tick, 14);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    p[0] = channel;
+    p[1] = state;
+    p[2] = tec;
+    p[3] = rec;
+    put_u16(p + 4, load);
+    put_u32(p + 6, frame_rate);
+    put_u16(p + 10, error_rate);
+    put_u16(p + 12, bus_off);
+    return RT_EOK;
+}
+
+int payload_put_adc(PayloadWriter *w, rt_uint32_t tick, float voltage, rt_int32_t raw_value)
+{
+    rt_uint32_t bits;
+
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_ADC, tick, 8);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    memcpy(&bits, &voltage, sizeof(bits));
+    put_u32(p, bits);
+    put_u32(p + 4, (rt_uint32_t)raw_value);
+    return RT_EOK;
+}
+
+int payload_put_adc_stats(PayloadWriter *w, rt_uint32_t tick, const StreamSummary *stats)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_ADC_STATS, tick, 40);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u32(p, stats->count);
+    put_f32(p + 4, stats->mean);
+    put_f32(p + 8, stats->std);
+    put_f32(p + 12, stats->min);
+    put_f32(p + 16, stats->max);
+    put_f32(p + 20, stats->p50);
+    put_f32(p + 24, stats->p95);
+    put_f32(p + 28, stats->p99);
+    put_u32(p + 32, (rt_uint32_t)(stats->t_min / 1000));
+    put_u32(p + 36, (rt_uint32_t)(stats->t_max / 1000));
+    return RT_EOK;
+}
+
+int payload_put_fft_feature(PayloadWriter *w, rt_uint32_t tick, const FftFeatures *f)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_FFT_FEATURE, tick, 27 + 4 * FFT_FEATURE_BANDS);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u16(p, f->size);
+    put_u32(p + 2, f->rate);
+    put_f32(p + 6, f->rms);
+    put_f32(p + 10, f->peak);
+    put_f32(p + 14, f->crest);
+    put_f32(p + 18, f->dom_freq);
+    put_f32(p + 22, f->dom_amp);
+    p[26] = FFT_FEATURE_BANDS;
+    for (int i = 0; i < FFT_FEATURE_BANDS; i++) put_f32(p + 27 + 4 * i, f->band_rms[i]);
+    return RT_EOK;
+}
+
+int payload_put_adc_alarm(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t chan, rt_uint8_t state, rt_uint16_t raw,
+                          float voltage, rt_uint64_t t_us)
+{
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_ADC_ALARM, tick, 14);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    p[0] = chan;
+    p[1] = state;
+    put_u16(p + 2, raw);
+    put_f32(p + 4, voltage);
+    put_u32(p + 8, (rt_uint32_t)(t_us / 1000));
+    put_u16(p + 12, (rt_uint16_t)(t_us % 1000));
+    return RT_EOK;
+}
+
+int payload_put_adc_vertices(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t chan, const SdtPoint *pts, rt_uint8_t n)
+{
+    rt_size_t room = (w->size > w->pos + 3 + 6) ? (w->size - w->pos - 3 - 6) / 6 : 0;
+    rt_uint8_t m = 0;
+
+    while (m < n && m < room && (m == 0 || pts[m].t - pts[m - 1].t <= 0xFFFF)) m++;
+
+    rt_uint8_t *p = (m > 0) ? record_alloc(w, PAYLOAD_TAG_ADC_VERTEX, tick, 6 + 6 * m) : RT_NULL;
+    if (p == RT_NULL) return -RT_EFULL;
+
+    p[0] = chan;
+    p[1] = m;
+    put_u32(p + 2, pts[0].t);
+    for (rt_uint8_t i = 0; i < m; i++) {
+        put_u16(p + 6 + 6 * i, (rt_uint16_t)(i ? pts[i].t - pts[i - 1].t : 0));
+        put_f32(p + 8 + 6 * i, pts[i].v);
+    }
+    return m;
+}
+
+int payload_put_wave_chunk(PayloadWriter *w, rt_uint32_t tick, const WaveCapture *cap, rt_uint16_t seq,
+                           const rt_uint16_t *samples, rt_uint32_t scans)
+{
+    rt_uint32_t values = scans * cap->channels;
+    rt_uint8_t *p = record_alloc(w, PAYLOAD_TAG_WAVE_CHUNK, tick, 32 + 2 * cap->channels + 2 * values);
+    if (p == RT_NULL) return -RT_EFULL;
+
+    put_u16(p, cap->id);
+    put_u16(p + 2, seq);
+    put_u16(p + 4, cap->chunks);
+    p[6] = cap->source;
+    p[7] = cap->channels;
+    put_u32(p + 8, cap->rate);
+    put_u32(p + 12, (rt_uint32_t)(cap->t_trig_us / 1000));
+    put_u16(p + 16, (rt_uint16_t)(cap->t_trig_us % 1000));
+    put_u32(p + 18, cap->pre);
+    put_u32(p + 22, cap->post);
+    put_u32(p + 26, (rt_uint32_t)seq * cap->chunk_scans);
+    put_u16(p + 30, (rt_uint16_t)scans);
+    p += 32;
+    for (rt_uint8_t i = 0; i < cap->channels; i++) {
+        *p++ = cap->channel_id[i];
+        *p++ = cap->adds[i];
+    }
+    for (rt_uint32_t i = 0; i < values; i++) {
+        put_u16(p + 2 * i, samples[i]);
+    }
+    return RT_EOK;
+}
+
+rt_size_t payload_end(PayloadWriter *w)
+{
+    if (w->size < PAYLOAD_HEADER_SIZE) return 0;
+
+    w->buf[0] = PAYLOAD_MAGIC;
+    w->buf[1] = PAYLOAD_SCHEMA_VERSION;
+    w->buf[2] = 0;
+    w->buf[3] = w->count;
+    put_u32(w->buf + 4, w->base_tick);
+    return w->pos;
+}
+
+rt_size_t payload_compress(LzContext *ctx, const rt_uint8_t *in, rt_size_t len, rt_uint8_t *out, rt_size_t cap)
+{
+    rt_size_t body_len;
+    int n;
+
+    if (len <= PAYLOAD_HEADER_SIZE || cap <= PAYLOAD_HEADER_SIZE + 2) return 0;
+
+    body_len = len - PAYLOAD_HEADER_SIZE;
+    n = lz_compress(ctx, in + PAYLOAD_HEADER_SIZE, body_len,
+                    out + PAYLOAD_HEADER_SIZE + 2, cap - PAYLOAD_HEADER_SIZE - 2);
+    if (n < 0 || (rt_size_t)n + 2 >= body_len) return 0;
+
+    memcpy(out, in, PAYLOAD_HEADER_SIZE);
+    out[2] |= PAYLOAD_FLAG_LZ;
+    put_u16(out + PAYLOAD_HEADER_SIZE, (rt_uint16_t)body_len);
+    return PAYLOAD_HEADER_SIZE + 2 + n;
+}
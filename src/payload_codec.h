@@ -0,0 +1,116 @@
+#ifndef __PAYLOAD_CODEC_H__
+#define __PAYLOAD_CODEC_H__
+
+#include <rtthread.h>
+#include "lz_compress.h"
+#include "stream_stats.h"
+#include "fft_feature.h"
+#include "sdt_compress.h"
+#include "wave_capture.h"
+
+/*
+ * 紧凑二进制遥测格式 (小端序)，字段定义与 thing_model.json 中的属性一一对应，
+ * 主机侧解码见 scripts/payload_decode.py
+ *
+ * Header (8 bytes):
+ * [0]   Magic (0xEB)
+ * [1]   Schema 版本
+ * [2]   Flags
+ * [3]   记录数
+ * [4-7] 基准时间戳 (tick, ms)
+ *
+ * Record:
+ * [0]   Tag (PayloadTag)
+ * [1-2] 相对基准时间戳的增量 (ms)
+ * [...] Tag 对应的定长/变长字段
+ *
+ * Flags 置 PAYLOAD_FLAG_LZ 时，Header 之后为:
+ * [0-1] 原始记录区长度
+ * [...] LZ4 block 格式压缩的记录区 (见 lz_compress.h)
+ */
+#define PAYLOAD_MAGIC           0xEB
+#define PAYLOAD_SCHEMA_VERSION  1
+#define PAYLOAD_HEADER_SIZE     8
+
+#define PAYLOAD_FLAG_LZ         0x01
+
+/* 记录类型，值与 scripts/payload_decode.py 中的 SCHEMA 保持一致 */
+typedef enum {
+    PAYLOAD_TAG_CAN = 1,   /* can_id(u32, bit31=扩展帧) + len(u8) + can_data[len] */
+    PAYLOAD_TAG_ADC = 2,   /* voltage(f32) + raw_adc(i32) */
+    PAYLOAD_TAG_CANFD = 3, /* can_id(u32, bit31=扩展帧) + can_flags(u8) + len(u8) + can_data[len], len<=64 */
+    PAYLOAD_TAG_CAN_TS = 4,   /* us(u16, 毫秒内微秒) + PAYLOAD_TAG_CAN 记录体，时间取自硬件接收时间戳 */
+    PAYLOAD_TAG_CANFD_TS = 5, /* us(u16, 毫秒内微秒) + PAYLOAD_TAG_CANFD 记录体 */
+    PAYLOAD_TAG_ISOTP = 6,    /* us(u16) + can_id(u32, bit31=扩展帧) + len(u16) + data[len]，ISO-TP 组包后的完整报文 */
+    PAYLOAD_TAG_J1939 = 7,    /* us(u16) + pgn(u32, bit24-26=优先级) + sa(u8) + da(u8) + len(u16) + data[len]，J1939 PGN 级报文 */
+    PAYLOAD_TAG_CAN_HEALTH = 8, /* channel(u8) + state(u8) + tec(u8) + rec(u8) + load(u16, 0.1%) + frame_rate(u32) + error_rate(u16) + bus_off(u16) */
+    PAYLOAD_TAG_ADC_STATS = 9,  /* count(u32) + mean/std/min/max/p50/p95/p99(f32) + t_min/t_max(u32, 启动后 ms)，一个上报周期的统计 */
+    PAYLOAD_TAG_FFT_FEATURE = 10, /* size(u16) + rate(u32) + rms/peak/crest/dom_freq/dom_amp(f32) + bands(u8) + band_rms(f32 x bands) */
+    PAYLOAD_TAG_ADC_ALARM = 11,   /* chan(u8, 高 4 位单元号) + state(u8) + raw(u16) + voltage(f32) + t_ms(u32, 启动后 ms) + us(u16, 毫秒内微秒) */
+    PAYLOAD_TAG_ADC_VERTEX = 12,  /* chan(u8) + n(u8) + t0(u32, 启动后 ms) + n * (dt(u16, 相对前一顶点 ms，首个为 0) + voltage(f32))，旋转门压缩顶点 */
+    PAYLOAD_TAG_WAVE_CHUNK = 13,  /* id(u16) + seq(u16) + chunks(u16) + source(u8) + channels(u8) + rate(u32) + t_ms(u32, 触发时刻启动后 ms) + us(u16)
+                                   * + pre(u32) + post(u32) + offset(u32, 本块首个扫描在捕获内的序号) + scans(u16)
+                                   * + channels * (chan(u8) + adds(u8)) + scans * channels * code(u16)，按扫描交错的原始码值 */
+    PAYLOAD_TAG_ISOTP_PART = 14,  /* us(u16) + can_id(u32, bit31=扩展帧) + total(u16) + offset(u16) + len(u16) + data[len]，
+                                   * 一次发布放不下的 ISO-TP 报文分段上报，同一报文各段的 can_id 与时间相同 */
+} PayloadTag;
+
+/* 上报数据编码方式 */
+typedef enum {
+    PAYLOAD_MODE_JSON = 0, /* OneNET 物模型 JSON (默认) */
+    PAYLOAD_MODE_BIN  = 1, /* 自定义 Topic 二进制透传 */
+} PayloadMode;
+
+#define PAYLOAD_CAN_ID_EXT      0x80000000UL
+
+/* PAYLOAD_TAG_CANFD 记录的 can_flags */
+#define PAYLOAD_CANFD_BRS       0x01
+#define PAYLOAD_CANFD_ESI       0x02
+
+/* 单条 ISO-TP 记录的报文头 + 记录头长度，数据前预留该长度即可就地编码 */
+#define PAYLOAD_ISOTP_HEADROOM  (PAYLOAD_HEADER_SIZE + 3 + 2 + 4 + 2)
+#define PAYLOAD_J1939_HEADROOM  (PAYLOAD_HEADER_SIZE + 3 + 2 + 4 + 1 + 1 + 2)
+#define PAYLOAD_ISOTP_PART_HEADROOM (PAYLOAD_HEADER_SIZE + 3 + 2 + 4 + 2 + 2 + 2)
+
+typedef struct {
+    rt_uint8_t *buf;
+    rt_size_t   size;
+    rt_size_t   pos;
+    rt_uint32_t base_tick;
+    rt_uint8_t  count;
+} PayloadWriter;
+
+/* API */
+void payload_begin(PayloadWriter *w, rt_uint8_t *buf, rt_size_t size, rt_uint32_t base_tick);
+int  payload_put_can(PayloadWriter *w, rt_uint32_t tick, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint8_t len);
+int  payload_put_canfd(PayloadWriter *w, rt_uint32_t tick, rt_uint32_t can_id, rt_uint8_t fd_flags, const rt_uint8_t *data, rt_uint8_t len);
+int  payload_put_can_ts(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint8_t len);
+int  payload_put_canfd_ts(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, rt_uint8_t fd_flags, const rt_uint8_t *data, rt_uint8_t len);
+/* data 可以已位于记录数据区 (预留了 PAYLOAD_ISOTP_HEADROOM)，此时不复制 */
+int  payload_put_isotp(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, const rt_uint8_t *data, rt_uint16_t len);
+/* ISO-TP 报文中 offset 起的 len 字节，data 可以已位于记录数据区 (预留了 PAYLOAD_ISOTP_PART_HEADROOM) */
+int  payload_put_isotp_part(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint32_t can_id, rt_uint16_t total,
+                            rt_uint16_t offset, const rt_uint8_t *data, rt_uint16_t len);
+/* 同上，data 可以已位于记录数据区 (预留了 PAYLOAD_J1939_HEADROOM) */
+int  payload_put_j1939(PayloadWriter *w, rt_uint32_t tick, rt_uint16_t us, rt_uint8_t prio, rt_uint32_t pgn,
+                       rt_uint8_t sa, rt_uint8_t da, const rt_uint8_t *data, rt_uint16_t len);
+int  payload_put_can_health(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t channel, rt_uint8_t state, rt_uint8_t tec,
+                            rt_uint8_t rec, rt_uint16_t load, rt_uint32_t frame_rate, rt_uint16_t error_rate, rt_uint16_t bus_off);
+int  payload_put_adc(PayloadWriter *w, rt_uint32_t tick, float voltage, rt_int32_t raw_value);
+/* 统计时间戳为启动后微秒，记录中截断为毫秒 */
+int  payload_put_adc_stats(PayloadWriter *w, rt_uint32_t tick, const StreamSummary *stats);
+int  payload_put_fft_feature(PayloadWriter *w, rt_uint32_t tick, const FftFeatures *f);
+/* 报警边沿时间为启动后微秒 */
+int  payload_put_adc_alarm(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t chan, rt_uint8_t state, rt_uint16_t raw,
+                           float voltage, rt_uint64_t t_us);
+/* 写入一段压缩顶点，顶点间隔超过 16 位或空间不足时截断，返回写入的顶点数，一个都写不下返回 -RT_EFULL */
+int  payload_put_adc_vertices(PayloadWriter *w, rt_uint32_t tick, rt_uint8_t chan, const SdtPoint *pts, rt_uint8_t n);
+/* 写入捕获的第 seq 块，samples 为该块的 scans 次扫描 (wave_capture_read 读出) */
+int  payload_put_wave_chunk(PayloadWriter *w, rt_uint32_t tick, const WaveCapture *cap, rt_uint16_t seq,
+                            const rt_uint16_t *samples, rt_uint32_t scans);
+rt_size_t payload_end(PayloadWriter *w); /* 回填 Header，返回总长度 */
+
+/* 压缩已完成的报文，压缩无收益或空间不足时返回 0 */
+rt_size_t payload_compress(LzContext *ctx, const rt_uint8_t *in, rt_size_t len, rt_uint8_t *out, rt_size_t cap);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __PERF_COUNTER_H__
+#define __PERF_COUNTER_H__
+
+#include <rtthread.h>
+#include <board.h>
+
+/* 基于 ARM Generic Timer (CNTPCT) 的耗时测量，用于各模块的 msh 基准命令 */
+
+rt_inline rt_uint64_t perf_now(void)
+{
+    return __get_CNTPCT();
+}
+
+/* 计数值转换为微秒 */
+rt_inline rt_uint32_t perf_to_us(rt_uint64_t ticks)
+{
+    rt_uint32_t freq = __get_CNTFRQ();
+    return freq ? (rt_uint32_t)(ticks * 1000000ULL / freq) : 0;
+}
+
+/* 计数值转换为 64 位微秒，用于绝对时间戳 */
+rt_inline rt_uint64_t perf_to_us64(rt_uint64_t ticks)
+{
+    rt_uint32_t freq = __get_CNTFRQ();
+    return freq ? (ticks / freq) * 1000000ULL + (ticks % freq) * 1000000ULL / freq : 0;
+}
+
+/* 计数值换算为 CPU 周期数 (按 SystemCoreClock 折算) */
+rt_inline rt_uint64_t perf_to_cycles(rt_uint64_t ticks)
+{
+    rt_uint32_t freq = __get_CNTFRQ();
+    return freq ? ticks * SystemCoreClock / freq : 0;
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sdt_compress.h"
+#include "perf_counter.h"
+
+#define SDT_BENCH_MAX       4096    /* bench 最多的输入点数 */
+#define SDT_BENCH_STEP_MS   100     /* bench 输入间隔，与 ADC 块周期一致 */
+#define SDT_BENCH_SEGMENT   200     /* bench 信号每段 (斜坡或保持) 的点数 */
+
+static SdtSignal *sdt_table[SDT_SIGNALS_MAX];
+
+void sdt_init(SdtSignal *s, const char *name, float dev, rt_uint32_t max_gap)
+{
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    s->dev = dev;
+    s->max_gap = (max_gap == 0 || max_gap > SDT_MAX_GAP_MS) ? SDT_MAX_GAP_MS : max_gap;
+
+    if (name == RT_NULL) return;
+    for (int i = 0; i < SDT_SIGNALS_MAX; i++) {
+        if (sdt_table[i] == s) return;
+        if (sdt_table[i] == RT_NULL) {
+            sdt_table[i] = s;
+            return;
+        }
+    }
+}
+
+int sdt_set(const char *name, float dev, rt_uint32_t max_gap)
+{
+    if (dev < 0) return -RT_EINVAL;
+
+    for (int i = 0; i < SDT_SIGNALS_MAX; i++) {
+        SdtSignal *s = sdt_table[i];
+        if (s == RT_NULL || strcmp(s->name, name) != 0) continue;
+        s->dev = dev;
+        if (max_gap) s->max_gap = (max_gap > SDT_MAX_GAP_MS) ? SDT_MAX_GAP_MS : max_gap;
+        return RT_EOK;
+    }
+    return -RT_EINVAL;
+}
+
+/* 以当前转轴和新点打开门 */
+static void sdt_open(SdtSignal *s, rt_uint32_t t, float v)
+{
+    float dt = (float)(t - s->pivot.t);
+
+    s->k_lo = (v - s->dev - s->pivot.v) / dt;
+    s->k_hi = (v + s->dev - s->pivot.v) / dt;
+    s->last.t = t;
+    s->last.v = v;
+    s->state = 2;
+}
+
+/* 在最近接受的点处关门，输出顶点并作为新的转轴 */
+static void sdt_close(SdtSignal *s, SdtPoint *vertex)
+{
+    float k = 0.5f * (s->k_lo + s->k_hi);
+
+    vertex->t = s->last.t;
+    vertex->v = s->pivot.v + k * (float)(s->last.t - s->pivot.t);
+    s->pivot = *vertex;
+    s->last = *vertex;
+    s->state = 1;
+    s->out++;
+}
+
+/* 转轴之后直接以输入点为顶点 (开始或间隔过长) */
+static void sdt_restart(SdtSignal *s, rt_uint32_t t, float v, SdtPoint *vertex)
+{
+    vertex->t = t;
+    vertex->v = v;
+    s->pivot = *vertex;
+    s->last = *vertex;
+    s->state = 1;
+    s->out++;
+}
+
+int sdt_push(SdtSignal *s, rt_uint32_t t, float v, SdtPoint *vertex)
+{
+    if (s->state != 0 && (rt_int32_t)(t - s->last.t) <= 0) return 0;
+    s->in++;
+
+    if (s->state == 0) {
+        sdt_restart(s, t, v, vertex);
+        return 1;
+    }
+
+    rt_uint32_t gap = t - s->pivot.t;
+    if (s->state == 1) {
+        if (gap > s->max_gap) {
+            sdt_restart(s, t, v, vertex);
+            return 1;
+        }
+        sdt_open(s, t, v);
+        return 0;
+    }
+
+    float lo = (v - s->dev - s->pivot.v) / (float)gap;
+    float hi = (v + s->dev - s->pivot.v) / (float)gap;
+    if (lo < s->k_lo) lo = s->k_lo;
+    if (hi > s->k_hi) hi = s->k_hi;
+    if (lo <= hi && gap <= s->max_gap) {
+        s->k_lo = lo;
+        s->k_hi = hi;
+        s->last.t = t;
+        s->last.v = v;
+        return 0;
+    }
+
+    /* 门关闭 */
+    sdt_close(s, &vertex[0]);
+    if (t - s->pivot.t > s->max_gap) {
+        sdt_restart(s, t, v, &vertex[1]);
+        return 2;
+    }
+    sdt_open(s, t, v);
+    return 1;
+}
+
+int sdt_flush(SdtSignal *s, SdtPoint *vertex)
+{
+    if (s->state != 2) return 0;
+    sdt_close(s, vertex);
+    return 1;
+}
+
+/* bench 输入：斜坡与保持交替的过程量 (0.5..2.5 V) 加 ±noise 均匀噪声 */
+static float sdt_bench_value(rt_uint32_t i, float noise, rt_uint32_t *seed)
+{
+    rt_uint32_t seg = i / SDT_BENCH_SEGMENT, pos = i % SDT_BENCH_SEGMENT;
+    float level = 0.5f + (float)((seg / 2) % 5) * 0.4f;
+    float v = (seg & 1) ? level + 0.4f * pos / SDT_BENCH_SEGMENT : level;
+
+    *seed = *seed * 1103515245U + 12345U;
+    return v + noise * (((float)((*seed >> 16) & 0x7FFF) / 16383.5f) - 1.0f);
+}
+
+/* 顶点间线性插值，返回 t 处的重建值；vtx 按时间递增，idx 为上次所在段 */
+static float sdt_interp(const SdtPoint *vtx, rt_uint32_t n, rt_uint32_t t, rt_uint32_t *idx)
+{
+    while (*idx + 1 < n && vtx[*idx + 1].t < t) (*idx)++;
+    if (*idx + 1 >= n) return vtx[n - 1].v;
+
+    const SdtPoint *a = &vtx[*idx], *b = &vtx[*idx + 1];
+    return a->v + (b->v - a->v) * (float)(t - a->t) / (float)(b->t - a->t);
+}
+
+/* 同一组输入点按不同误差上限压缩，输出压缩比、重建误差和每点耗时 */
+static void sdt_bench(rt_uint32_t n, float noise)
+{
+    static const float devs[] = { 0.0005f, 0.002f, 0.005f, 0.010f, 0.020f };
+    static SdtPoint vtx[SDT_BENCH_MAX + 2];
+
+    rt_kprintf("%u points at %u ms, noise +-%d mV\n", n, SDT_BENCH_STEP_MS, (int)(noise * 1000));
+    rt_kprintf("  %7s %6s %7s %9s %9s %8s %8s\n", "dev(mV)", "vtx", "ratio", "max(uV)", "rms(uV)", "bytes", "cyc/pt");
+
+    for (rt_size_t d = 0; d < sizeof(devs) / sizeof(devs[0]); d++) {
+        SdtSignal s;
+        rt_uint32_t seed = 1, m = 0;
+        rt_uint64_t ticks = 0;
+
+        sdt_init(&s, RT_NULL, devs[d], SDT_MAX_GAP_MS);
+        for (rt_uint32_t i = 0; i < n; i++) {
+            float v = sdt_bench_value(i, noise, &seed);
+            rt_uint64_t t0 = perf_now();
+            m += sdt_push(&s, i * SDT_BENCH_STEP_MS, v, &vtx[m]);
+            ticks += perf_now() - t0;
+        }
+        m += sdt_flush(&s, &vtx[m]);
+
+        /* 重新生成同一组输入，对照重建值 */
+        double err_max = 0, err_sum2 = 0;
+        rt_uint32_t idx = 0;
+        seed = 1;
+        for (rt_uint32_t i = 0; i < n; i++) {
+            float v = sdt_bench_value(i, noise, &seed);
+            double e = fabs((double)sdt_interp(vtx, m, i * SDT_BENCH_STEP_MS, &idx) - v);
+            if (e > err_max) err_max = e;
+            err_sum2 += e * e;
+        }
+
+        /* 二进制上报时顶点 6 字节 (16 位毫秒间隔 + f32)，逐点上报为 8 字节 (ms + f32) */
+        rt_uint32_t ratio100 = m ? n * 100 / m : 0;
+        rt_uint32_t cyc100 = (rt_uint32_t)(perf_to_cycles(ticks) * 100 / n);
+        rt_kprintf("  %7d.%d %6u %4u.%02u %9u %9u %3u/%-4u %5u.%02u\n", (int)(devs[d] * 1000),
+                   (int)(devs[d] * 10000) % 10, m, ratio100 / 100, ratio100 % 100, (rt_uint32_t)(err_max * 1e6),
+                   (rt_uint32_t)(sqrt(err_sum2 / n) * 1e6), m * 6, n * 8, cyc100 / 100, cyc100 % 100);
+    }
+}
+
+static int sdt(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "set") == 0) {
+        rt_uint32_t gap = (argc >= 5) ? (rt_uint32_t)atoi(argv[4]) : 0;
+        int ret = sdt_set(argv[2], atoi(argv[3]) / 1000.0f, gap);
+        if (ret != RT_EOK) rt_kprintf("unknown signal or invalid deviation\n");
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        rt_uint32_t n = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : SDT_BENCH_MAX;
+        float noise = (argc >= 4) ? atoi(argv[3]) / 1000.0f : 0.001f;
+        if (n < 16 || n > SDT_BENCH_MAX) n = SDT_BENCH_MAX;
+        sdt_bench(n, noise);
+        return 0;
+    } else if (argc < 2 || strcmp(argv[1], "list") == 0) {
+        rt_kprintf("Swinging-door compression:\n");
+        rt_kprintf("  %-10s %8s %8s %8s %8s %7s\n", "signal", "dev(mV)", "gap(ms)", "points", "vertices", "ratio");
+        for (int i = 0; i < SDT_SIGNALS_MAX; i++) {
+            const SdtSignal *s = sdt_table[i];
+            if (s == RT_NULL) continue;
+            rt_uint32_t ratio100 = s->out ? (rt_uint32_t)((rt_uint64_t)s->in * 100 / s->out) : 0;
+            rt_kprintf("  %-10s %8d %8u %8u %8u %4u.%02u\n", s->name, (int)(s->dev * 1000 + 0.5f), s->max_gap,
+                       s->in, s->out, ratio100 / 100, ratio100 % 100);
+        }
+        return 0;
+    }
+
+    rt_kprintf("Usage: sdt [list]\n");
+    rt_kprintf("       sdt set <signal> <dev_mV> [max_gap_ms]\n");
+    rt_kprintf("       sdt bench [points] [noise_mV]\n");
+    return 0;
+}
+MSH_CMD_EXPORT(sdt, swinging-door compression of analog signals);
@@ -0,0 +1,48 @@
+#ifndef __SDT_COMPRESS_H__
+#define __SDT_COMPRESS_H__
+
+#include <rtthread.h>
+
+/*
+ * 旋转门 (swinging door) 压缩：把缓变信号压缩为折线顶点，只缓存和上报顶点。
+ *
+ * 以上一个顶点为转轴，每个新点收窄 "门" 的可行斜率区间 [k_lo, k_hi] (过转轴、与已收点的偏差都不超过 dev 的直线)，
+ * 区间为空 (门关闭) 时在前一个输入点的时刻输出顶点，取值为区间中点斜率的直线在该时刻的值，
+ * 新顶点作为下一段的转轴。主机侧在顶点之间线性插值，每个输入点的重建误差不超过 dev。
+ *
+ * 距上一个顶点超过 max_gap 时强制输出，既作心跳，也保证顶点间隔可用 16 位毫秒编码。
+ * 时间单位为 ms，主机侧重建见 scripts/sdt_reconstruct.py。
+ */
+#define SDT_SIGNALS_MAX         4
+#define SDT_MAX_GAP_MS          60000   /* 顶点间隔上限 */
+
+typedef struct {
+    rt_uint32_t t;              /* 启动后 ms */
+    float       v;
+} SdtPoint;
+
+typedef struct {
+    const char *name;
+    float       dev;            /* 允许的重建误差，0 时只去掉共线点 */
+    rt_uint32_t max_gap;        /* ms */
+    rt_uint8_t  state;          /* 0 未开始，1 只有转轴，2 门打开 */
+    SdtPoint    pivot;          /* 最近输出的顶点 */
+    SdtPoint    last;           /* 最近接受的输入点 */
+    float       k_lo, k_hi;     /* 可行斜率 (每 ms) */
+    rt_uint32_t in, out;        /* 输入点数 / 输出顶点数 */
+} SdtSignal;
+
+/* 初始化并登记到 "sdt" 命令的信号表，name 须为静态字符串 */
+void sdt_init(SdtSignal *s, const char *name, float dev, rt_uint32_t max_gap);
+
+/* 按名称修改误差上限 (对之后的输入点生效)，max_gap 为 0 时不修改，找不到返回 -RT_EINVAL */
+int  sdt_set(const char *name, float dev, rt_uint32_t max_gap);
+
+/* 输入一个点，返回输出的顶点数 (0..2，vertex 至少能放 2 个点)；时间不递增的点丢弃。
+ * 门关闭时输出前一点处的顶点，若新点距该顶点又超过 max_gap，新点本身也作为顶点输出 */
+int  sdt_push(SdtSignal *s, rt_uint32_t t, float v, SdtPoint *vertex);
+
+/* 把最近的输入点作为顶点输出 (停止采集或需要立即对齐时)，没有未输出的点时返回 0 */
+int  sdt_flush(SdtSignal *s, SdtPoint *vertex);
+
+#endif
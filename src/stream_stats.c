@@ -0,0 +1,177 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "stream_stats.h"
+#include "perf_counter.h"
+
+static const float stream_quantile_p[STREAM_QUANTILES] = { 0.50f, 0.95f, 0.99f };
+
+/* ---------- P² 分位数估计 ---------- */
+
+static void p2_init(P2Quantile *m, float p)
+{
+    memset(m, 0, sizeof(*m));
+    m->p = p;
+}
+
+/* 前 5 个样本插入排序，第 5 个到达后初始化标记位置 */
+static void p2_fill(P2Quantile *m, float x, rt_uint32_t count)
+{
+    rt_int32_t i = (rt_int32_t)count;
+    while (i > 0 && m->q[i - 1] > x) {
+        m->q[i] = m->q[i - 1];
+        i--;
+    }
+    m->q[i] = x;
+
+    if (count + 1 == STREAM_P2_MARKERS) {
+        float p = m->p;
+        for (int k = 0; k < STREAM_P2_MARKERS; k++) m->n[k] = k;
+        m->np[0] = 0;
+        m->np[1] = 2 * p;
+        m->np[2] = 4 * p;
+        m->np[3] = 2 + 2 * p;
+        m->np[4] = 4;
+    }
+}
+
+static float p2_parabolic(const P2Quantile *m, int i, int d)
+{
+    float n0 = (float)m->n[i - 1], n1 = (float)m->n[i], n2 = (float)m->n[i + 1];
+    return m->q[i] + d / (n2 - n0) * ((n1 - n0 + d) * (m->q[i + 1] - m->q[i]) / (n2 - n1) +
+                                      (n2 - n1 - d) * (m->q[i] - m->q[i - 1]) / (n1 - n0));
+}
+
+static void p2_update(P2Quantile *m, float x)
+{
+    int k;
+
+    /* 找到 x 所在的区间，必要时扩展两端的标记 */
+    if (x < m->q[0]) {
+        m->q[0] = x;
+        k = 0;
+    } else if (x >= m->q[4]) {
+        m->q[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x >= m->q[k + 1]; k++);
+    }
+
+    for (int i = k + 1; i < STREAM_P2_MARKERS; i++) m->n[i]++;
+    /* 期望位置增量：{0, p/2, p, (1+p)/2, 1} */
+    m->np[1] += m->p * 0.5f;
+    m->np[2] += m->p;
+    m->np[3] += (1.0f + m->p) * 0.5f;
+    m->np[4] += 1.0f;
+
+    /* 中间三个标记偏离期望位置超过 1 时移动一格，高度按抛物线插值，越界时退化为线性 */
+    for (int i = 1; i <= 3; i++) {
+        float d = m->np[i] - m->n[i];
+        if ((d >= 1.0f && m->n[i + 1] - m->n[i] > 1) || (d <= -1.0f && m->n[i - 1] - m->n[i] < -1)) {
+            int s = (d > 0) ? 1 : -1;
+            float q = p2_parabolic(m, i, s);
+            if (!(m->q[i - 1] < q && q < m->q[i + 1])) {
+                q = m->q[i] + s * (m->q[i + s] - m->q[i]) / (float)(m->n[i + s] - m->n[i]);
+            }
+            m->q[i] = q;
+            m->n[i] += s;
+        }
+    }
+}
+
+/* 样本不足 5 个时直接在已排序样本中取最近秩 */
+static float p2_result(const P2Quantile *m, rt_uint32_t count)
+{
+    if (count == 0) return 0;
+    if (count < STREAM_P2_MARKERS) return m->q[(rt_uint32_t)(m->p * (count - 1) + 0.5f)];
+    return m->q[2];
+}
+
+/* ---------- 统计 ---------- */
+
+void stream_stats_reset(StreamStats *s)
+{
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < STREAM_QUANTILES; i++) p2_init(&s->quant[i], stream_quantile_p[i]);
+}
+
+void stream_stats_add(StreamStats *s, float x, rt_uint64_t t)
+{
+    rt_uint32_t count = s->count;
+
+    if (count == 0 || x < s->min) {
+        s->min = x;
+        s->t_min = t;
+    }
+    if (count == 0 || x > s->max) {
+        s->max = x;
+        s->t_max = t;
+    }
+
+    /* Welford：增量更新均值和平方和，避免大数相减 */
+    float delta = x - s->mean;
+    s->mean += delta / (float)(count + 1);
+    s->m2 += delta * (x - s->mean);
+
+    for (int i = 0; i < STREAM_QUANTILES; i++) {
+        if (count < STREAM_P2_MARKERS) p2_fill(&s->quant[i], x, count);
+        else p2_update(&s->quant[i], x);
+    }
+    s->count = count + 1;
+}
+
+void stream_stats_add_block(StreamStats *s, const float *x, rt_uint32_t n, rt_uint64_t t0, rt_uint32_t dt)
+{
+    for (rt_uint32_t i = 0; i < n; i++, t0 += dt) stream_stats_add(s, x[i], t0);
+}
+
+void stream_stats_summary(const StreamStats *s, StreamSummary *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (s->count == 0) return;
+
+    out->count = s->count;
+    out->mean = s->mean;
+    out->std = (s->count > 1) ? sqrtf(s->m2 / (float)(s->count - 1)) : 0.0f;
+    out->min = s->min;
+    out->max = s->max;
+    out->t_min = s->t_min;
+    out->t_max = s->t_max;
+    out->p50 = p2_result(&s->quant[0], s->count);
+    out->p95 = p2_result(&s->quant[1], s->count);
+    out->p99 = p2_result(&s->quant[2], s->count);
+}
+
+/* msh: stream_stats_bench [n] —— 对 n 个伪随机样本更新统计，输出每样本周期数和分位数估计 */
+static int stream_stats_bench(int argc, char **argv)
+{
+    rt_uint32_t n = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 10000;
+    static StreamStats st;
+    StreamSummary sum;
+    rt_uint32_t seed = 1;
+
+    if (n == 0) n = 10000;
+    stream_stats_reset(&st);
+
+    /* 两个均匀分布之和 (三角分布，0..2)，p50 理论值 1.0，p95 1.684，p99 1.859 */
+    rt_uint64_t t0 = perf_now();
+    for (rt_uint32_t i = 0; i < n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        float a = (float)((seed >> 8) & 0xFFFF) / 65536.0f;
+        seed = seed * 1103515245U + 12345U;
+        float b = (float)((seed >> 8) & 0xFFFF) / 65536.0f;
+        stream_stats_add(&st, a + b, i);
+    }
+    rt_uint64_t t = perf_now() - t0;
+    stream_stats_summary(&st, &sum);
+
+    rt_kprintf("[Bench] %u samples in %u us, %u cycles/sample (incl. test signal)\n", n, perf_to_us(t),
+               (rt_uint32_t)(perf_to_cycles(t) / n));
+    rt_kprintf("  mean %d std %d min %d max %d (x1000)\n", (int)(sum.mean * 1000), (int)(sum.std * 1000),
+               (int)(sum.min * 1000), (int)(sum.max * 1000));
+    rt_kprintf("  p50 %d p95 %d p99 %d (x1000, expect 1000 / 1684 / 1859)\n", (int)(sum.p50 * 1000),
+               (int)(sum.p95 * 1000), (int)(sum.p99 * 1000));
+    return 0;
+}
+MSH_CMD_EXPORT(stream_stats_bench, Benchmark streaming statistics update);
@@ -0,0 +1,58 @@
+#ifndef __STREAM_STATS_H__
+#define __STREAM_STATS_H__
+
+#include <rtthread.h>
+
+/*
+ * 单个信号的流式统计，内存固定，每个样本 O(1) 更新：
+ *  - Welford 算法的均值 / 方差
+ *  - 最小 / 最大值及其出现时间
+ *  - P² 算法 (Jain & Chlamtac) 估计的 p50 / p95 / p99，每个分位数 5 个标记
+ *
+ * 按上报周期使用：不断 stream_stats_add，周期到时取 stream_stats_summary 上报后 stream_stats_reset。
+ * 时间戳单位由调用者决定 (应用中为启动后微秒)。
+ */
+#define STREAM_QUANTILES    3       /* p50 / p95 / p99 */
+#define STREAM_P2_MARKERS   5
+
+typedef struct {
+    float p;
+    float q[STREAM_P2_MARKERS];     /* 标记高度；样本不足 5 个时为已排序的样本 */
+    rt_int32_t n[STREAM_P2_MARKERS];  /* 实际位置 (从 0 开始) */
+    float np[STREAM_P2_MARKERS];    /* 期望位置 */
+} P2Quantile;
+
+typedef struct {
+    rt_uint32_t count;
+    float mean;
+    float m2;                       /* 与均值之差的平方和 */
+    float min;
+    float max;
+    rt_uint64_t t_min;
+    rt_uint64_t t_max;
+    P2Quantile quant[STREAM_QUANTILES];
+} StreamStats;
+
+typedef struct {
+    rt_uint32_t count;
+    float mean;
+    float std;                      /* 样本标准差 (n - 1) */
+    float min;
+    float max;
+    rt_uint64_t t_min;
+    rt_uint64_t t_max;
+    float p50;
+    float p95;
+    float p99;
+} StreamSummary;
+
+void stream_stats_reset(StreamStats *s);
+void stream_stats_add(StreamStats *s, float x, rt_uint64_t t);
+
+/* 连续等间隔样本，第 i 个样本时间为 t0 + i * dt */
+void stream_stats_add_block(StreamStats *s, const float *x, rt_uint32_t n, rt_uint64_t t0, rt_uint32_t dt);
+
+/* 无样本时各字段为 0 */
+void stream_stats_summary(const StreamStats *s, StreamSummary *out);
+
+#endif
@@ -0,0 +1,540 @@
+#include <rtthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include "hal_data.h"
+#include "wave_capture.h"
+#include "perf_counter.h"
+
+#define WAVE_IDLE           0
+#define WAVE_RECORDING      1   /* 录制中，等待触发 */
+#define WAVE_POST           2   /* 已冻结，继续写触发后的数据 */
+#define WAVE_READY          3   /* 完成，等待上报 */
+
+/* 触发时刻可能早于正在处理的块 (报警线程上报前先触发)，环须多留的余量 */
+#define WAVE_MARGIN_SCANS   (2 * ADC_ACQ_BLOCK_SCANS)
+/* 按通道最多时的每扫描字节数计算环容量上限 */
+#define WAVE_RING_MIN_SCANS (WAVE_RING_BYTES / (2 * ADC_ACQ_MAX_CHANNELS))
+
+#define WAVE_BENCH_BLOCK    (ADC_ACQ_BLOCK_SCANS * ADC_ACQ_MAX_CHANNELS)    /* 一个满通道采样块的码值数 */
+#define WAVE_BENCH_ROUNDS   16
+#define WAVE_BENCH_FREEZES  1000
+#define WAVE_GAP_EXTRA_MS   200     /* "wave bench gap" 扣留块的时长超出缓冲轮转周期的余量 */
+
+#ifdef BSP_USING_HYPERRAM
+/* xSPI0 CS1 映射区 (script/fsp_xspi0_boot.ld 中的 xSPI0_CS1_SPACE)，各环之后留出 bench 区 */
+#define WAVE_HYPERRAM_BASE  (BSP_FEATURE_XSPI_DEVICE_0_START_ADDRESS + BSP_FEATURE_XSPI_DEVICE_ADDRESS_SPACE_SIZE / 2)
+#define WAVE_BENCH_BYTES    (1024 * 1024)
+#define WAVE_MEM_NAME       "HyperRAM"
+#else
+static rt_uint16_t wave_sram[WAVE_SLOTS][WAVE_RING_BYTES / 2];
+#define WAVE_MEM_NAME       "SRAM"
+#endif
+
+typedef struct {
+    volatile rt_uint8_t state;
+    rt_uint8_t  resolved;       /* 触发点已换算为扫描序号 */
+    rt_uint16_t *ring;
+    rt_uint32_t ring_scans;     /* 按当前通道数的容量 */
+    rt_uint64_t written;        /* 本环启用以来写入的扫描数 */
+    rt_uint32_t seq;            /* 期望的下一个块序号 */
+    rt_uint64_t t_trig;         /* 触发时刻 (perf_now 计数) */
+    rt_uint64_t trig_index;     /* 触发点的写入序号 */
+    rt_uint32_t pre, post;      /* 触发时的设定 */
+    WaveCapture cap;
+} WaveSlot;
+
+static WaveSlot wave_slot[WAVE_SLOTS];
+static int wave_active = -1;            /* 正在录制的环 */
+static rt_uint16_t wave_next_id;
+static rt_uint32_t wave_pre = WAVE_PRE_DEFAULT;
+static rt_uint32_t wave_post = WAVE_POST_DEFAULT;
+static rt_bool_t wave_inited = RT_FALSE;
+static WaveStats wave_stats;
+static volatile rt_uint32_t wave_hold_ms;   /* "wave bench gap" 让处理线程扣留下一个块的时长 */
+
+int wave_capture_init(void)
+{
+    if (wave_inited) return RT_EOK;
+
+#ifdef BSP_USING_HYPERRAM
+    fsp_err_t err = g_hyperbus0.p_api->open(g_hyperbus0.p_ctrl, g_hyperbus0.p_cfg);
+    if (err != FSP_SUCCESS && err != FSP_ERR_ALREADY_OPEN) {
+        rt_kprintf("[Wave] HyperRAM open failed: %d\n", err);
+        return -RT_ERROR;
+    }
+
+    /* 确认器件可读写，首尾各写一个图样 */
+    volatile rt_uint32_t *probe = (volatile rt_uint32_t *)WAVE_HYPERRAM_BASE;
+    volatile rt_uint32_t *probe_end = (volatile rt_uint32_t *)(WAVE_HYPERRAM_BASE + WAVE_SLOTS * WAVE_RING_BYTES) - 1;
+    *probe = 0x5AA5C33CUL;
+    *probe_end = 0xA55A3CC3UL;
+    if (*probe != 0x5AA5C33CUL || *probe_end != 0xA55A3CC3UL) {
+        rt_kprintf("[Wave] HyperRAM read back mismatch\n");
+        return -RT_EIO;
+    }
+#endif
+
+    memset(wave_slot, 0, sizeof(wave_slot));
+    for (int i = 0; i < WAVE_SLOTS; i++) {
+#ifdef BSP_USING_HYPERRAM
+        wave_slot[i].ring = (rt_uint16_t *)(WAVE_HYPERRAM_BASE + i * WAVE_RING_BYTES);
+#else
+        wave_slot[i].ring = wave_sram[i];
+#endif
+    }
+    memset(&wave_stats, 0, sizeof(wave_stats));
+    wave_stats.freeze_min_us = 0xFFFFFFFFU;
+    wave_inited = RT_TRUE;
+    return RT_EOK;
+}
+
+int wave_capture_set(rt_uint32_t pre, rt_uint32_t post)
+{
+    if (post == 0 || pre + post + WAVE_MARGIN_SCANS > WAVE_RING_MIN_SCANS) return -RT_EINVAL;
+
+    rt_enter_critical();
+    wave_pre = pre;
+    wave_post = post;
+    rt_exit_critical();
+    return RT_EOK;
+}
+
+/* 记录触发，须在临界区内调用 */
+static void wave_freeze(WaveSlot *s, rt_uint8_t source, rt_uint64_t t)
+{
+    s->t_trig = t;
+    s->cap.source = source;
+    s->pre = wave_pre;
+    s->post = wave_post;
+    s->resolved = 0;
+    s->state = WAVE_POST;
+}
+
+int wave_capture_trigger(rt_uint8_t source, rt_uint64_t t)
+{
+    rt_uint64_t t0 = perf_now();
+    int ret = RT_EOK;
+
+    rt_enter_critical();
+    wave_stats.triggers++;
+    WaveSlot *s = (wave_inited && wave_active >= 0) ? &wave_slot[wave_active] : RT_NULL;
+    if (s == RT_NULL) {
+        wave_stats.dropped++;
+        ret = -RT_EFULL;
+    } else if (s->state != WAVE_RECORDING) {
+        wave_stats.merged++;
+        ret = -RT_EBUSY;
+    } else {
+        wave_freeze(s, source, t);
+
+        rt_uint64_t t1 = perf_now();
+        rt_uint32_t lat = (t1 > t) ? perf_to_us(t1 - t) : 0;
+        rt_uint32_t cyc = (rt_uint32_t)perf_to_cycles(t1 - t0);
+        if (lat < wave_stats.freeze_min_us) wave_stats.freeze_min_us = lat;
+        if (lat > wave_stats.freeze_max_us) wave_stats.freeze_max_us = lat;
+        wave_stats.freeze_sum_us += lat;
+        if (cyc > wave_stats.freeze_cycles_max) wave_stats.freeze_cycles_max = cyc;
+    }
+    rt_exit_critical();
+    return ret;
+}
+
+/* 启用一个空闲的环开始录制，没有时不录制 */
+static void wave_activate(void)
+{
+    wave_active = -1;
+    for (int i = 0; i < WAVE_SLOTS; i++) {
+        if (wave_slot[i].state != WAVE_IDLE) continue;
+        wave_slot[i].written = 0;
+        wave_slot[i].state = WAVE_RECORDING;
+        wave_active = i;
+        return;
+    }
+}
+
+static WaveSlot *wave_slot_of(const WaveCapture *cap)
+{
+    for (int i = 0; i < WAVE_SLOTS; i++) {
+        if (&wave_slot[i].cap == cap) return &wave_slot[i];
+    }
+    return RT_NULL;
+}
+
+/* 按已写入的数据确定捕获范围，环交给上报，录制换到下一个环 */
+static void wave_complete(WaveSlot *s)
+{
+    WaveCapture *cap = &s->cap;
+    rt_uint64_t idx = s->trig_index;
+    rt_uint64_t end = idx + s->post;
+    rt_uint64_t oldest = (s->written > s->ring_scans) ? s->written - s->ring_scans : 0;
+    rt_uint64_t start = (idx > s->pre) ? idx - s->pre : 0;
+
+    if (end > s->written) end = s->written;
+    if (start < oldest) start = oldest;
+
+    cap->pre = (rt_uint32_t)(idx - start);
+    cap->post = (rt_uint32_t)(end - idx);
+    cap->start = start;
+    cap->t_trig_us = perf_to_us64(s->t_trig);
+    cap->chunk_scans = (rt_uint16_t)(WAVE_CHUNK_BYTES / (2 * cap->channels));
+    cap->chunks = (rt_uint16_t)((cap->pre + cap->post + cap->chunk_scans - 1) / cap->chunk_scans);
+    cap->next = 0;
+    cap->id = ++wave_next_id;
+    cap->t_ready = perf_now();
+
+    wave_stats.captures++;
+    if (cap->pre < s->pre || cap->post < s->post) wave_stats.truncated++;
+    rt_uint32_t ms = (rt_uint32_t)(perf_to_us64(cap->t_ready - s->t_trig) / 1000);
+    if (ms > wave_stats.complete_max_ms) wave_stats.complete_max_ms = ms;
+
+    rt_enter_critical();
+    s->state = WAVE_READY;
+    wave_activate();
+    rt_exit_critical();
+}
+
+/* 采集重新启动、丢块或配置变化后数据不连续：已定位触发点的捕获提前结束，其余从头录制 */
+static void wave_restart(WaveSlot *s)
+{
+    wave_stats.restarts++;
+    if (s->state == WAVE_POST && s->resolved) {
+        wave_complete(s);
+        return;
+    }
+
+    rt_enter_critical();
+    if (s->state == WAVE_POST) wave_stats.truncated++;
+    s->written = 0;
+    s->state = WAVE_RECORDING;
+    rt_exit_critical();
+}
+
+/* 块的扫描行追加到环，跨过环尾时分两段 */
+static void wave_write(WaveSlot *s, const AdcBlock *block)
+{
+    rt_uint32_t row = block->channels;
+    rt_uint32_t pos = (rt_uint32_t)(s->written % s->ring_scans);
+    rt_uint32_t first = s->ring_scans - pos;
+    rt_uint64_t t0 = perf_now();
+
+    if (first > block->scans) first = block->scans;
+    memcpy(s->ring + pos * row, block->data, first * row * sizeof(rt_uint16_t));
+    if (block->scans > first) {
+        memcpy(s->ring, block->data + first * row, (block->scans - first) * row * sizeof(rt_uint16_t));
+    }
+    s->written += block->scans;
+
+    wave_stats.write_ticks += perf_now() - t0;
+    wave_stats.write_bytes += block->scans * row * sizeof(rt_uint16_t);
+}
+
+void wave_capture_feed(const AdcBlock *block)
+{
+    if (!wave_inited || block->channels == 0) return;
+
+    /* 扣留本块使采集溢出丢块，只用于验证跳号处理 */
+    if (wave_hold_ms) {
+        rt_uint32_t ms = wave_hold_ms;
+        wave_hold_ms = 0;
+        rt_thread_mdelay(ms);
+    }
+
+    if (wave_active < 0) {
+        rt_enter_critical();
+        wave_activate();
+        rt_exit_critical();
+        if (wave_active < 0) return;
+    }
+
+    WaveSlot *s = &wave_slot[wave_active];
+    WaveCapture *cap = &s->cap;
+    if (s->written && (block->seq != s->seq || block->rate != cap->rate || block->channels != cap->channels)) {
+        wave_restart(s);
+        if (wave_active < 0) return;
+        s = &wave_slot[wave_active];
+        cap = &s->cap;
+    }
+
+    if (s->written == 0) {
+        cap->channels = block->channels;
+        cap->rate = block->rate;
+        memcpy(cap->channel_id, block->channel_id, sizeof(cap->channel_id));
+        memcpy(cap->adds, block->adds, sizeof(cap->adds));
+        s->ring_scans = WAVE_RING_BYTES / (2 * block->channels);
+    }
+
+    rt_uint64_t base = s->written;
+    wave_write(s, block);
+    s->seq = block->seq + 1;
+
+    if (s->state != WAVE_POST) return;
+
+    /* 触发时刻换算为扫描序号：第 k 次扫描在 t_first 之后 k 个采样周期结束，触发在本块之后时等下一块 */
+    if (!s->resolved) {
+        rt_int64_t dt = (rt_int64_t)(s->t_trig - block->t_first);
+        rt_int64_t us = (dt >= 0) ? (rt_int64_t)perf_to_us64(dt) : -(rt_int64_t)perf_to_us64(-dt);
+        rt_int64_t rel = (us >= 0) ? us * block->rate / 1000000 : -((-us * block->rate + 999999) / 1000000);
+        if (rel >= block->scans) return;
+        s->trig_index = ((rt_int64_t)base + rel > 0) ? (rt_uint64_t)((rt_int64_t)base + rel) : 0;
+        s->resolved = 1;
+    }
+
+    if (s->written >= s->trig_index + s->post) wave_complete(s);
+}
+
+WaveCapture *wave_capture_pending(void)
+{
+    WaveCapture *oldest = RT_NULL;
+
+    for (int i = 0; i < WAVE_SLOTS; i++) {
+        if (wave_slot[i].state != WAVE_READY) continue;
+        WaveCapture *cap = &wave_slot[i].cap;
+        if (oldest == RT_NULL || (rt_int16_t)(cap->id - oldest->id) < 0) oldest = cap;
+    }
+    return oldest;
+}
+
+rt_uint32_t wave_capture_read(const WaveCapture *cap, rt_uint32_t offset, rt_uint32_t scans, rt_uint16_t *out)
+{
+    const WaveSlot *s = wave_slot_of(cap);
+    rt_uint32_t total = cap->pre + cap->post;
+
+    if (s == RT_NULL || offset >= total) return 0;
+    if (scans > total - offset) scans = total - offset;
+
+    rt_uint32_t row = cap->channels;
+    rt_uint32_t pos = (rt_uint32_t)((cap->start + offset) % s->ring_scans);
+    rt_uint32_t first = s->ring_scans - pos;
+
+    if (first > scans) first = scans;
+    memcpy(out, s->ring + pos * row, first * row * sizeof(rt_uint16_t));
+    if (scans > first) {
+        memcpy(out + first * row, s->ring, (scans - first) * row * sizeof(rt_uint16_t));
+    }
+    return scans;
+}
+
+void wave_capture_ack(WaveCapture *cap, rt_uint64_t ticks)
+{
+    WaveSlot *s = wave_slot_of(cap);
+    if (s == RT_NULL || cap->next >= cap->chunks) return;
+
+    rt_uint32_t offset = (rt_uint32_t)cap->next * cap->chunk_scans;
+    rt_uint32_t scans = cap->pre + cap->post - offset;
+    if (scans > cap->chunk_scans) scans = cap->chunk_scans;
+
+    wave_stats.upload_bytes += scans * cap->channels * sizeof(rt_uint16_t);
+    wave_stats.upload_ticks += ticks;
+
+    if (++cap->next < cap->chunks) return;
+
+    wave_stats.uploaded++;
+    rt_uint32_t ms = (rt_uint32_t)(perf_to_us64(perf_now() - cap->t_ready) / 1000);
+    if (ms > wave_stats.upload_max_ms) wave_stats.upload_max_ms = ms;
+
+    rt_enter_critical();
+    s->state = WAVE_IDLE;
+    rt_exit_critical();
+}
+
+void wave_capture_get_stats(WaveStats *stats)
+{
+    rt_enter_critical();
+    *stats = wave_stats;
+    rt_exit_critical();
+}
+
+/* 字节数 / 计数值换算为 MB/s x 100 */
+static rt_uint32_t wave_rate100(rt_uint64_t bytes, rt_uint64_t ticks)
+{
+    rt_uint64_t us = perf_to_us64(ticks);
+    return us ? (rt_uint32_t)(bytes * 100 / us) : 0;
+}
+
+static void wave_print(void)
+{
+    static const char *const state_names[] = { "idle", "recording", "post", "ready" };
+    static const char *const source_names[] = { "manual", "adc", "can" };
+    WaveStats st;
+
+    wave_capture_get_stats(&st);
+    rt_kprintf("Waveform capture (%s%s): pre %u post %u scans, %d rings x %u KB, chunk %u bytes\n", WAVE_MEM_NAME,
+               wave_inited ? "" : ", not initialized", wave_pre, wave_post, WAVE_SLOTS, WAVE_RING_BYTES / 1024,
+               WAVE_CHUNK_BYTES);
+    for (int i = 0; i < WAVE_SLOTS; i++) {
+        const WaveSlot *s = &wave_slot[i];
+        const WaveCapture *cap = &s->cap;
+        rt_kprintf("  ring %d: %-9s", i, state_names[s->state & 3]);
+        if (s->state == WAVE_READY) {
+            rt_kprintf(" #%u %s, %u ch at %u Hz, pre %u post %u, chunk %u/%u", cap->id,
+                       source_names[cap->source % 3], cap->channels, cap->rate, cap->pre, cap->post, cap->next,
+                       cap->chunks);
+        } else if (s->state != WAVE_IDLE) {
+            rt_kprintf(" %u scans written", (rt_uint32_t)s->written);
+        }
+        rt_kprintf("\n");
+    }
+
+    rt_kprintf("  Triggers: %u (merged %u, dropped %u), captures %u (truncated %u), uploaded %u, restarts %u\n",
+               st.triggers, st.merged, st.dropped, st.captures, st.truncated, st.uploaded, st.restarts);
+    rt_uint32_t frozen = st.triggers - st.merged - st.dropped;
+    if (frozen) {
+        rt_kprintf("  Latency: trigger -> freeze min %u avg %u max %u us (freeze %u cycles max), "
+                   "trigger -> complete max %u ms\n", st.freeze_min_us, (rt_uint32_t)(st.freeze_sum_us / frozen),
+                   st.freeze_max_us, st.freeze_cycles_max, st.complete_max_ms);
+    }
+
+    rt_uint32_t w100 = wave_rate100(st.write_bytes, st.write_ticks);
+    rt_uint32_t u100 = wave_rate100(st.upload_bytes, st.upload_ticks);
+    rt_kprintf("  Throughput: ring write %u.%02u MB/s (%u KB written), upload %u.%02u MB/s while publishing "
+               "(%u KB), capture upload max %u ms\n", w100 / 100, w100 % 100, (rt_uint32_t)(st.write_bytes / 1024),
+               u100 / 100, u100 % 100, (rt_uint32_t)(st.upload_bytes / 1024), st.upload_max_ms);
+}
+
+/* 把 step 字节的源块依次写满 dst 的 bytes 字节，重复 rounds 遍，输出 MB/s */
+static void wave_bench_copy(const char *name, rt_uint8_t *dst, const rt_uint8_t *src, rt_uint32_t bytes,
+                            rt_uint32_t rounds, rt_uint32_t step)
+{
+    rt_uint64_t ticks = 0;
+
+    for (rt_uint32_t r = 0; r < rounds; r++) {
+        rt_uint64_t t0 = perf_now();
+        for (rt_uint32_t off = 0; off + step <= bytes; off += step) {
+            memcpy(dst + off, src, step);
+        }
+        ticks += perf_now() - t0;
+    }
+    rt_uint64_t total = (rt_uint64_t)(bytes / step * step) * rounds;
+    rt_uint32_t r100 = wave_rate100(total, ticks);
+    rt_kprintf("  %-22s %6u.%02u MB/s\n", name, r100 / 100, r100 % 100);
+}
+
+/* 采样块写入/读出的吞吐量与冻结开销 */
+static void wave_bench(void)
+{
+    static rt_uint16_t block[WAVE_BENCH_BLOCK];
+    static rt_uint16_t sram[WAVE_BENCH_BLOCK * 8];
+    const rt_uint32_t step = sizeof(block);
+
+    for (rt_uint32_t i = 0; i < WAVE_BENCH_BLOCK; i++) block[i] = (rt_uint16_t)(i * 2654435761U >> 20);
+
+    rt_kprintf("Copy in %u-byte blocks (one full %u-scan block):\n", step, ADC_ACQ_BLOCK_SCANS);
+    wave_bench_copy("SRAM -> SRAM", (rt_uint8_t *)sram, (const rt_uint8_t *)block, sizeof(sram),
+                    WAVE_BENCH_ROUNDS * 16, step);
+#ifdef BSP_USING_HYPERRAM
+    if (wave_capture_init() != RT_EOK) return;
+
+    rt_uint8_t *hyper = (rt_uint8_t *)(WAVE_HYPERRAM_BASE + WAVE_SLOTS * WAVE_RING_BYTES);
+    wave_bench_copy("SRAM -> HyperRAM", hyper, (const rt_uint8_t *)block, WAVE_BENCH_BYTES, WAVE_BENCH_ROUNDS, step);
+
+    /* 读出 (上报路径) 并核对内容 */
+    rt_uint64_t ticks = 0;
+    rt_uint32_t errors = 0;
+    for (rt_uint32_t off = 0; off + step <= WAVE_BENCH_BYTES; off += step) {
+        rt_uint64_t t0 = perf_now();
+        memcpy(sram, hyper + off, step);
+        ticks += perf_now() - t0;
+        if (memcmp(sram, block, step) != 0) errors++;
+    }
+    rt_uint32_t r100 = wave_rate100(WAVE_BENCH_BYTES / step * step, ticks);
+    rt_kprintf("  %-22s %6u.%02u MB/s, %u bad blocks\n", "HyperRAM -> SRAM", r100 / 100, r100 % 100, errors);
+#endif
+
+    /* 最高扫描频率、全部通道时的录制数据率 */
+    rt_kprintf("  needed at %u Hz x %d ch: %u.%02u MB/s\n", ADC_ACQ_RATE_MAX, ADC_ACQ_MAX_CHANNELS,
+               ADC_ACQ_RATE_MAX * ADC_ACQ_MAX_CHANNELS * 2 / 1000000,
+               ADC_ACQ_RATE_MAX * ADC_ACQ_MAX_CHANNELS * 2 / 10000 % 100);
+
+    /* 冻结：临界区内记录触发，不复制数据 */
+    WaveSlot dummy;
+    rt_uint64_t ticks_sum = 0, ticks_max = 0;
+    memset(&dummy, 0, sizeof(dummy));
+    for (int i = 0; i < WAVE_BENCH_FREEZES; i++) {
+        rt_uint64_t t0 = perf_now();
+        rt_enter_critical();
+        wave_freeze(&dummy, WAVE_SRC_MANUAL, t0);
+        dummy.state = WAVE_RECORDING;
+        rt_exit_critical();
+        rt_uint64_t dt = perf_now() - t0;
+        ticks_sum += dt;
+        if (dt > ticks_max) ticks_max = dt;
+    }
+    rt_kprintf("Freeze: avg %u max %u cycles\n", (rt_uint32_t)(perf_to_cycles(ticks_sum) / WAVE_BENCH_FREEZES),
+               (rt_uint32_t)perf_to_cycles(ticks_max));
+}
+
+/*
+ * 跳号回归检查：触发一次捕获后让处理线程扣留一个块，超过 ADC_ACQ_BLOCKS 个块的时间，采集必然溢出丢块。
+ * 正确时捕获在断点处提前结束 (truncated) 并从断点重新录制 (restarts)，而不是把断点两侧拼成一段波形。
+ */
+static void wave_bench_gap(void)
+{
+    AdcAcqStats acq0, acq1;
+    WaveStats st0, st1;
+
+    if (!wave_inited || !adc_acq_running()) {
+        rt_kprintf("ADC acquisition or waveform capture not running\n");
+        return;
+    }
+    adc_acq_get_stats(&acq0);
+    if (acq0.rate == 0) return;
+
+    rt_uint32_t block_ms = ADC_ACQ_BLOCK_SCANS * 1000U / acq0.rate;
+    rt_uint32_t hold_ms = (ADC_ACQ_BLOCKS + 1) * block_ms + WAVE_GAP_EXTRA_MS;
+    if (wave_post * 1000U / acq0.rate <= hold_ms) {
+        rt_kprintf("post (%u scans) must outlast the %u ms hold, see \"wave set\"\n", wave_post, hold_ms);
+        return;
+    }
+
+    wave_capture_get_stats(&st0);
+    if (wave_capture_trigger(WAVE_SRC_MANUAL, perf_now()) != RT_EOK) {
+        rt_kprintf("no ring recording, try again after pending captures are uploaded\n");
+        return;
+    }
+    wave_hold_ms = hold_ms;
+
+    /* 等扣留结束、处理线程追上并处理完断点之后的块 */
+    rt_thread_mdelay(hold_ms + 3 * block_ms);
+    adc_acq_get_stats(&acq1);
+    wave_capture_get_stats(&st1);
+
+    rt_uint32_t overruns = acq1.overruns - acq0.overruns;
+    rt_uint32_t restarts = st1.restarts - st0.restarts;
+    rt_uint32_t truncated = st1.truncated - st0.truncated;
+    rt_kprintf("Held one block for %u ms: %u overruns, %u restarts, %u truncated captures -> %s\n", hold_ms,
+               overruns, restarts, truncated,
+               overruns == 0 ? "no overrun, inconclusive" : (restarts && truncated ? "PASS" : "FAIL (spliced)"));
+    wave_print();
+}
+
+static int wave(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "set") == 0) {
+        int ret = wave_capture_set((rt_uint32_t)atoi(argv[2]), (rt_uint32_t)atoi(argv[3]));
+        if (ret != RT_EOK) {
+            rt_kprintf("post must be > 0 and pre + post <= %u scans\n", WAVE_RING_MIN_SCANS - WAVE_MARGIN_SCANS);
+        }
+        return ret;
+    } else if (argc >= 2 && strcmp(argv[1], "trig") == 0) {
+        int ret = wave_capture_trigger(WAVE_SRC_MANUAL, perf_now());
+        if (ret == -RT_EBUSY) rt_kprintf("capture in progress, merged\n");
+        else if (ret == -RT_EFULL) rt_kprintf("no free ring, dropped\n");
+        return 0;
+    } else if (argc >= 3 && strcmp(argv[1], "bench") == 0 && strcmp(argv[2], "gap") == 0) {
+        wave_bench_gap();
+        return 0;
+    } else if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        wave_bench();
+        return 0;
+    } else if (argc < 2 || strcmp(argv[1], "stat") == 0) {
+        wave_print();
+        return 0;
+    }
+
+    rt_kprintf("Usage: wave [stat]\n");
+    rt_kprintf("       wave set <pre_scans> <post_scans>\n");
+    rt_kprintf("       wave trig\n");
+    rt_kprintf("       wave bench [gap]\n");
+    return 0;
+}
+MSH_CMD_EXPORT(wave, triggered waveform capture);
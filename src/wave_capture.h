@@ -0,0 +1,102 @@
+#ifndef __WAVE_CAPTURE_H__
+#define __WAVE_CAPTURE_H__
+
+#include <rtthread.h>
+#include "adc_acq.h"
+
+/*
+ * 触发式波形捕获：处理线程把每个采样块的全部扫描行 (原始码值) 持续写入 HyperRAM 中的环形缓冲，
+ * 报警 (ADC 门限、CAN 总线状态) 或命令触发时冻结触发点之前 pre 次、之后 post 次扫描，分块上报。
+ *
+ * HyperRAM (g_hyperbus0，xSPI0 CS1) 映射到存储空间后直接按内存读写。缓冲分为 WAVE_SLOTS 个环，
+ * 同一时刻只有一个环在录制；触发后该环继续写满 post 次扫描即完成，等待上报，录制切换到下一个空闲环，
+ * 新环需重新积累触发前数据，紧接着的触发 pre 可能不足。所有环都待上报时新的触发丢弃。
+ *
+ * 冻结只在临界区内记录触发时刻和切换状态，不复制数据；触发点在哪个扫描由处理线程按块的时间戳换算，
+ * 环的容量保证冻结到换算之间写入的数据不会覆盖触发前的窗口。
+ * 触发时刻取事件本身的时间 (ADC 报警为比较中断时刻)，触发到冻结的延迟和录制、上报吞吐量见 "wave stat"。
+ *
+ * 上报按 WAVE_CHUNK_BYTES 分块，记录已确认的块号，断线后从未确认的块继续，主机侧重组见 scripts/wave_assemble.py。
+ */
+#define WAVE_SLOTS              4
+#ifdef BSP_USING_HYPERRAM
+#define WAVE_RING_BYTES         (4 * 1024 * 1024)   /* 每个环，4 个环共用 32 MB HyperRAM 的一半 */
+#define WAVE_PRE_DEFAULT        1000                /* 扫描次数，默认频率下 1 s */
+#define WAVE_POST_DEFAULT       1000
+#else
+#define WAVE_RING_BYTES         (16 * 1024)         /* 未启用 HyperRAM 时放在片内 RAM，只能捕获很短的波形 */
+#define WAVE_PRE_DEFAULT        200
+#define WAVE_POST_DEFAULT       200
+#endif
+#define WAVE_CHUNK_BYTES        512     /* 每次上报的采样数据字节数，JSON 模式转为十六进制后须小于 MQTT 写缓冲 (2048) */
+
+/* 触发来源 */
+typedef enum {
+    WAVE_SRC_MANUAL = 0,
+    WAVE_SRC_ADC_ALARM = 1,
+    WAVE_SRC_CAN = 2,
+} WaveSource;
+
+/* 一次完成的捕获，数据按扫描交错存放在环中 */
+typedef struct {
+    rt_uint16_t id;
+    rt_uint8_t  source;         /* WaveSource */
+    rt_uint8_t  channels;
+    rt_uint8_t  channel_id[ADC_ACQ_MAX_CHANNELS];   /* ADC_ACQ_CHAN */
+    rt_uint8_t  adds[ADC_ACQ_MAX_CHANNELS];         /* 硬件加法次数，码值须除以它 */
+    rt_uint32_t rate;           /* 扫描频率 Hz */
+    rt_uint64_t t_trig_us;      /* 触发时刻，启动后 us */
+    rt_uint32_t pre;            /* 触发点之前的扫描数 */
+    rt_uint32_t post;           /* 触发点 (含) 之后的扫描数 */
+    rt_uint64_t start;          /* 首个扫描在环中的写入序号 */
+    rt_uint16_t chunk_scans;    /* 每块扫描数 */
+    rt_uint16_t chunks;
+    rt_uint16_t next;           /* 下一个待上报的块 */
+    rt_uint64_t t_ready;        /* 完成时刻 (perf_now 计数) */
+} WaveCapture;
+
+typedef struct {
+    rt_uint32_t triggers;
+    rt_uint32_t merged;         /* 落在正在进行的捕获窗口内，不单独捕获 */
+    rt_uint32_t dropped;        /* 没有空闲的环 */
+    rt_uint32_t captures;
+    rt_uint32_t truncated;      /* 触发前数据不足 pre 或采集中断，提前结束的捕获 */
+    rt_uint32_t restarts;       /* 块序号跳号 (溢出丢块) 或配置变化，录制中的环从断点重新开始 */
+    rt_uint32_t uploaded;
+    rt_uint32_t freeze_min_us;  /* 触发事件到冻结完成 */
+    rt_uint32_t freeze_max_us;
+    rt_uint64_t freeze_sum_us;
+    rt_uint32_t freeze_cycles_max;  /* wave_capture_trigger 本身的耗时 */
+    rt_uint32_t complete_max_ms;    /* 触发到捕获完成 (含 post 采样时间) */
+    rt_uint64_t write_bytes;    /* 写入环的数据量及耗时 (perf_now 计数) */
+    rt_uint64_t write_ticks;
+    rt_uint64_t upload_bytes;   /* 已确认的分块数据量及发布耗时 */
+    rt_uint64_t upload_ticks;
+    rt_uint32_t upload_max_ms;  /* 完成到全部块上报的最长时间 */
+} WaveStats;
+
+/* 打开 HyperRAM 并初始化各环，处理线程在第一次 wave_capture_feed 之前调用 */
+int  wave_capture_init(void);
+
+/* 设定触发前/后的扫描数，对之后的触发生效，超出环容量返回 -RT_EINVAL */
+int  wave_capture_set(rt_uint32_t pre, rt_uint32_t post);
+
+/* 触发一次捕获，t 为事件时刻 (perf_now 计数)；线程上下文，可在任意线程调用。
+ * 落在正在进行的捕获内返回 -RT_EBUSY，没有空闲的环返回 -RT_EFULL */
+int  wave_capture_trigger(rt_uint8_t source, rt_uint64_t t);
+
+/* 处理线程每取得一个块调用一次 (adc_acq_release 之前)，写入环并推进正在进行的捕获 */
+void wave_capture_feed(const AdcBlock *block);
+
+/* 最早完成、尚未上报完的捕获，没有时返回 RT_NULL；与 feed 在同一线程调用 */
+WaveCapture *wave_capture_pending(void);
+
+/* 从环中复制捕获内第 offset 次起的 scans 次扫描，返回复制的扫描数 */
+rt_uint32_t wave_capture_read(const WaveCapture *cap, rt_uint32_t offset, rt_uint32_t scans, rt_uint16_t *out);
+
+/* 块 cap->next 上报成功，ticks 为发布耗时；全部块上报后释放该环 */
+void wave_capture_ack(WaveCapture *cap, rt_uint64_t ticks);
+
+void wave_capture_get_stats(WaveStats *stats);
+
+#endif